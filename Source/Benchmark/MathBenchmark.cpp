@@ -0,0 +1,825 @@
+/**************************************************************************************************
+	Module:       MathBenchmark.cpp
+	Author:       agent
+	Date created: 16/10/26
+
+	Headless microbenchmarks for the maths library. Builds on Linux (GCC / Clang) as well as
+	Windows, with no dependency on Windows or D3D headers - see the Makefile in this folder
+
+	Copyright 2026, agent
+
+	Change history:
+		V1.0    Created 16/10/26 - AG
+**************************************************************************************************/
+
+// Times each operation over arrays of several batch sizes and writes the results to stdout as
+// JSON. Each measurement repeats the batch until a minimum time has passed, and the best of
+// several such runs is reported to reduce noise. Usage:
+//     MathBenchmark [--quick] [--batch N]...
+// --quick shortens the minimum time per run (for smoke testing). Each --batch replaces the
+// default batch sizes with the given ones
+//
+// Results are ns per operation (one operation = one element of a batch) and operations per
+// second. Inputs are random but seeded identically on each run so results are comparable
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <memory>
+using namespace std;
+
+#include "Defines.h"
+#include "Error.h"
+#include "BaseMath.h"
+#include "MathApprox.h"
+#include "CRandom.h"
+#include "MathSIMD.h"
+#include "MathAligned.h"
+#include "CVector3.h"
+#include "CVector3Stream.h"
+#include "CQuaternion.h"
+#include "CMatrix4x4.h"
+#include "CAABBTree.h"
+#include "CTriangleBVH.h"
+#include "CHashTable.h"
+#include "CChainedHashTable.h"
+
+namespace gen
+{
+
+/*-----------------------------------------------------------------------------------------
+	Settings
+-----------------------------------------------------------------------------------------*/
+
+// Default batch sizes: from fitting in L1 cache to well beyond L2 for matrix arrays
+const TUInt32 kaiDefaultBatches[] = { 16, 256, 4096, 65536 };
+
+// Number of runs of each measurement, the fastest is reported
+const TUInt32 kiNumRuns = 5;
+
+// Minimum time per run in seconds, normal and quick modes
+const TFloat64 kfMinRunTime = 0.05;
+const TFloat64 kfQuickRunTime = 0.002;
+
+
+/*-----------------------------------------------------------------------------------------
+	Benchmark data
+-----------------------------------------------------------------------------------------*/
+
+// Input and output arrays for all benchmarks, sized for the largest batch. Outputs are kept
+// separate from inputs so repeated runs always see the same data
+struct SBenchData
+{
+	TMatrix4x4Array     matrices1;
+	TMatrix4x4Array     matrices2;
+	TMatrix4x4Array     matricesOut;
+	vector<CVector3>    positions;
+	vector<CVector3>    vectorsOut;
+	CVector3Stream      stream;
+	CVector3Stream      streamOut;
+	vector<CQuaternion> quats1;
+	vector<CQuaternion> quats2;
+	vector<CQuaternion> quatsOut;
+	vector<TFloat32>    params;
+	vector<TFloat32>    angles;
+	vector<TFloat32>    floatsOut1;
+	vector<TFloat32>    floatsOut2;
+	vector<TUInt32>     indicesOut;
+
+	// Tree of boxes around the first treeSize positions (radius from params), built on demand
+	CAABBTree           tree;
+	TUInt32             treeSize;
+	vector<TUInt32>     treeResults;
+
+	// Triangle hierarchy over a bumpy terrain, independent of batch size, built on demand
+	CTriangleBVH        triangleBVH;
+
+	// Hash table keys: UIDs allocated in sequence as by the entity manager, and entity names
+	vector<TUInt32>     uids;
+	vector<string>      names;
+};
+
+// Result values are accumulated here to prevent the compiler removing benchmark loops
+volatile TFloat32 gfSink;
+
+// Random unit quaternion
+CQuaternion RandomQuaternion()
+{
+	CQuaternion q( Random( -1.0f, 1.0f ), Random( -1.0f, 1.0f ),
+	               Random( -1.0f, 1.0f ), Random( -1.0f, 1.0f ) );
+	q.Normalise();
+	return q;
+}
+
+// Random affine matrix built from scale, rotation and translation
+CMatrix4x4 RandomAffine()
+{
+	CMatrix4x4 m;
+	m.MakeAffineEuler( CVector3( Random( -100.0f, 100.0f ), Random( -100.0f, 100.0f ),
+	                             Random( -100.0f, 100.0f ) ),
+	                   CVector3( Random( -kfPi, kfPi ), Random( -kfPi, kfPi ),
+	                             Random( -kfPi, kfPi ) ),
+	                   kZXY,
+	                   CVector3( Random( 0.5f, 2.0f ), Random( 0.5f, 2.0f ),
+	                             Random( 0.5f, 2.0f ) ) );
+	return m;
+}
+
+// Fill benchmark data with random values, seeded so each run uses the same data
+void InitBenchData
+(
+	SBenchData&   data,
+	const TUInt32 size
+)
+{
+	ThreadRandom().Seed( 1 );
+
+	data.matrices1.resize( size );
+	data.matrices2.resize( size );
+	data.matricesOut.resize( size );
+	data.positions.resize( size );
+	data.vectorsOut.resize( size );
+	data.stream.Resize( size );
+	data.streamOut.Resize( size );
+	data.quats1.resize( size );
+	data.quats2.resize( size );
+	data.quatsOut.resize( size );
+	data.params.resize( size );
+	data.angles.resize( size );
+	data.floatsOut1.resize( size );
+	data.floatsOut2.resize( size );
+	data.indicesOut.resize( size );
+	data.tree.Clear();
+	data.treeSize = 0;
+	data.uids.resize( size );
+	data.names.resize( size );
+
+	for (TUInt32 i = 0; i < size; ++i)
+	{
+		data.matrices1[i] = RandomAffine();
+		data.matrices2[i] = RandomAffine();
+		data.positions[i] = CVector3( Random( -100.0f, 100.0f ), Random( -100.0f, 100.0f ),
+		                              Random( -100.0f, 100.0f ) );
+		data.stream.X()[i] = data.positions[i].x;
+		data.stream.Y()[i] = data.positions[i].y;
+		data.stream.Z()[i] = data.positions[i].z;
+		data.quats1[i] = RandomQuaternion();
+		data.quats2[i] = RandomQuaternion();
+		data.params[i] = Random( 0.0f, 1.0f );
+		data.angles[i] = Random( -100.0f, 100.0f );
+		data.uids[i] = i;
+		char name[32];
+		sprintf( name, "Entity%u", i );
+		data.names[i] = name;
+	}
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Benchmarks
+-----------------------------------------------------------------------------------------*/
+// Each benchmark processes the first numOps elements of the benchmark data once
+
+typedef void (*TBenchFunction)( SBenchData& data, const TUInt32 numOps );
+
+// Matrices
+
+void BenchMatrixMultiply( SBenchData& data, const TUInt32 numOps )
+{
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		data.matricesOut[i] = data.matrices1[i] * data.matrices2[i];
+	}
+}
+
+void BenchMatrixMultiplyArray( SBenchData& data, const TUInt32 numOps )
+{
+	MultiplyArray( &data.matricesOut[0], &data.matrices1[0], &data.matrices2[0], numOps );
+}
+
+void BenchMatrixInverse( SBenchData& data, const TUInt32 numOps )
+{
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		data.matricesOut[i] = Inverse( data.matrices1[i] );
+	}
+}
+
+void BenchMatrixInverseArray( SBenchData& data, const TUInt32 numOps )
+{
+	InverseArray( &data.matricesOut[0], &data.matrices1[0], numOps );
+}
+
+void BenchMatrixInverseAffineArray( SBenchData& data, const TUInt32 numOps )
+{
+	InverseAffineArray( &data.matricesOut[0], &data.matrices1[0], numOps );
+}
+
+void BenchDecomposeAffineEuler( SBenchData& data, const TUInt32 numOps )
+{
+	CVector3 angles, scale;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		data.matrices1[i].DecomposeAffineEuler( &data.vectorsOut[i], &angles, &scale );
+	}
+	gfSink = angles.x + scale.x;
+}
+
+void BenchDecomposeAffineQuaternion( SBenchData& data, const TUInt32 numOps )
+{
+	CVector3 scale;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		data.matrices1[i].DecomposeAffineQuaternion( &data.vectorsOut[i], &data.quatsOut[i],
+		                                             &scale );
+	}
+	gfSink = scale.x;
+}
+
+void BenchTransformPoints( SBenchData& data, const TUInt32 numOps )
+{
+	TransformPoints( &data.vectorsOut[0], &data.positions[0], numOps, data.matrices1[0] );
+}
+
+// Vectors
+
+void BenchVectorNormalise( SBenchData& data, const TUInt32 numOps )
+{
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		data.vectorsOut[i] = Normalise( data.positions[i] );
+	}
+}
+
+void BenchVectorNormaliseStream( SBenchData& data, const TUInt32 numOps )
+{
+	// Stream functions process whole streams, so resize to the batch (no reallocation)
+	data.stream.Resize( numOps );
+	data.streamOut.Resize( numOps );
+	Normalise( data.streamOut, data.stream );
+}
+
+void BenchSpheresInsidePlanes( SBenchData& data, const TUInt32 numOps )
+{
+	// Six planes of a box around the centre of the positions, about half of the spheres are inside
+	static const CVector3 kaNormals[6] = { CVector3( 1.0f, 0.0f, 0.0f ), CVector3( -1.0f, 0.0f, 0.0f ),
+	                                       CVector3( 0.0f, 1.0f, 0.0f ), CVector3( 0.0f, -1.0f, 0.0f ),
+	                                       CVector3( 0.0f, 0.0f, 1.0f ), CVector3( 0.0f, 0.0f, -1.0f ) };
+	static const TFloat32 kaDistances[6] = { 75.0f, 75.0f, 75.0f, 75.0f, 75.0f, 75.0f };
+	data.stream.Resize( numOps );
+	gfSink = static_cast<TFloat32>(SpheresInsidePlanes( &data.indicesOut[0], data.stream,
+	                                                    &data.params[0], kaNormals, kaDistances, 6 ));
+}
+
+// Four views at once, boxes of several sizes around the centre of the positions - compare with
+// four times vector3_stream_cull_spheres. The bitsets fit in the index output array for batches
+// of 16 or more
+void BenchSpheresInsideFrustums( SBenchData& data, const TUInt32 numOps )
+{
+	const TUInt32 kiNumViews = 4;
+	static const TFloat32 kaSizes[kiNumViews] = { 75.0f, 50.0f, 25.0f, 100.0f };
+	CVector3 normals[kiNumViews * 6];
+	TFloat32 distances[kiNumViews * 6];
+	for (TUInt32 view = 0; view < kiNumViews; ++view)
+	{
+		for (TUInt32 axis = 0; axis < 3; ++axis)
+		{
+			CVector3 normal( 0.0f, 0.0f, 0.0f );
+			normal[axis] = 1.0f;
+			normals[view * 6 + axis * 2] = normal;
+			normals[view * 6 + axis * 2 + 1] = -normal;
+			distances[view * 6 + axis * 2] = kaSizes[view];
+			distances[view * 6 + axis * 2 + 1] = kaSizes[view];
+		}
+	}
+	data.stream.Resize( numOps );
+	SpheresInsideFrustums( &data.indicesOut[0], data.stream, &data.params[0], normals, distances, 6, kiNumViews );
+	gfSink = static_cast<TFloat32>(data.indicesOut[0]);
+}
+
+// Query a tree of numOps boxes (built on the first call for each size) with six planes of a box
+// around the centre of the positions. Result count is numOps times the fraction of the volume inside
+void QueryBenchTree
+(
+	SBenchData&    data,
+	const TUInt32  numOps,
+	const TFloat32 halfSize
+)
+{
+	if (data.treeSize != numOps)
+	{
+		data.tree.Clear();
+		for (TUInt32 i = 0; i < numOps; ++i)
+		{
+			CVector3 extent( data.params[i], data.params[i], data.params[i] );
+			data.tree.Insert( data.positions[i] - extent, data.positions[i] + extent, i );
+		}
+		data.treeSize = numOps;
+	}
+
+	const CVector3 kaNormals[6] = { CVector3( 1.0f, 0.0f, 0.0f ), CVector3( -1.0f, 0.0f, 0.0f ),
+	                                CVector3( 0.0f, 1.0f, 0.0f ), CVector3( 0.0f, -1.0f, 0.0f ),
+	                                CVector3( 0.0f, 0.0f, 1.0f ), CVector3( 0.0f, 0.0f, -1.0f ) };
+	const TFloat32 kaDistances[6] = { halfSize, halfSize, halfSize, halfSize, halfSize, halfSize };
+	data.treeResults.clear();
+	data.tree.QueryPlanes( kaNormals, kaDistances, 6, data.treeResults );
+	gfSink = static_cast<TFloat32>(data.treeResults.size());
+}
+
+// Same planes as BenchSpheresInsidePlanes, about half of the boxes are inside
+void BenchAABBTreeQueryPlanes( SBenchData& data, const TUInt32 numOps )
+{
+	QueryBenchTree( data, numOps, 75.0f );
+}
+
+// Narrow view, about 1 in 100 boxes are inside
+void BenchAABBTreeQueryPlanesNarrow( SBenchData& data, const TUInt32 numOps )
+{
+	QueryBenchTree( data, numOps, 21.5f );
+}
+
+// Size of the benchmark terrain in grid squares (two triangles each) along x and z
+const TUInt32 kiBenchTerrainSize = 64;
+
+// Build a hierarchy over a terrain of kiBenchTerrainSize^2 squares from -100 to 100 in x and z,
+// with random heights from -5 to 5. Seeded separately so other benchmark data is unaffected
+void BuildBenchTerrain( SBenchData& data )
+{
+	if (data.triangleBVH.NumTriangles() > 0)
+	{
+		return;
+	}
+
+	CRandom random( 2 );
+	const TUInt32 kiNumPoints = kiBenchTerrainSize + 1;
+	const TFloat32 kfSquareSize = 200.0f / kiBenchTerrainSize;
+	vector<CVector3> points( kiNumPoints * kiNumPoints );
+	for (TUInt32 z = 0; z < kiNumPoints; ++z)
+	{
+		for (TUInt32 x = 0; x < kiNumPoints; ++x)
+		{
+			points[z * kiNumPoints + x] = CVector3( x * kfSquareSize - 100.0f, random.Float( -5.0f, 5.0f ),
+			                                        z * kfSquareSize - 100.0f );
+		}
+	}
+
+	vector<CVector3> vertices;
+	for (TUInt32 z = 0; z < kiBenchTerrainSize; ++z)
+	{
+		for (TUInt32 x = 0; x < kiBenchTerrainSize; ++x)
+		{
+			TUInt32 corner = z * kiNumPoints + x;
+			vertices.push_back( points[corner] );
+			vertices.push_back( points[corner + kiNumPoints] );
+			vertices.push_back( points[corner + 1] );
+			vertices.push_back( points[corner + 1] );
+			vertices.push_back( points[corner + kiNumPoints] );
+			vertices.push_back( points[corner + kiNumPoints + 1] );
+		}
+	}
+	data.triangleBVH.Build( &vertices[0], static_cast<TUInt32>(vertices.size() / 3) );
+}
+
+// Cast rays down onto the terrain from above random positions (picking), nearest hit
+void BenchTriangleBVHRayCast( SBenchData& data, const TUInt32 numOps )
+{
+	BuildBenchTerrain( data );
+	TFloat32 total = 0.0f;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		CVector3 origin( data.positions[i].x, 150.0f, data.positions[i].z );
+		CVector3 direction( data.params[i] - 0.5f, -1.0f, data.angles[i] * 0.005f );
+		TFloat32 distance;
+		if (data.triangleBVH.RayCast( origin, direction, 1000.0f, &distance ))
+		{
+			total += distance;
+		}
+	}
+	gfSink = total;
+}
+
+// Line of sight tests between random points just above the terrain, which bumps may block
+void BenchTriangleBVHRayHits( SBenchData& data, const TUInt32 numOps )
+{
+	BuildBenchTerrain( data );
+	TUInt32 numBlocked = 0;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		CVector3 from( data.positions[i].x, 3.0f, data.positions[i].z );
+		CVector3 to( -data.positions[i].z, 3.0f, data.positions[i].x );
+		if (data.triangleBVH.RayHits( from, to - from, 1.0f ))
+		{
+			++numBlocked;
+		}
+	}
+	gfSink = static_cast<TFloat32>(numBlocked);
+}
+
+// Hash tables
+
+// Return the i-th UID or name key from the benchmark data
+template <class TKeyType>
+const TKeyType& BenchKey( const SBenchData& data, const TUInt32 i );
+template <>
+const TUInt32& BenchKey<TUInt32>( const SBenchData& data, const TUInt32 i )
+{
+	return data.uids[i];
+}
+template <>
+const string& BenchKey<string>( const SBenchData& data, const TUInt32 i )
+{
+	return data.names[i];
+}
+
+// Create an empty table for the benchmarks - the original chained table needs a hash function
+template <class TTable>
+TTable* NewBenchHashTable()
+{
+	return new TTable( 16 );
+}
+template <>
+CChainedHashTable<TUInt32, TUInt32>* NewBenchHashTable< CChainedHashTable<TUInt32, TUInt32> >()
+{
+	return new CChainedHashTable<TUInt32, TUInt32>( 16, JOneAtATimeHash );
+}
+
+// Return a table of the given type holding the first numOps keys (value is the key index).
+// Rebuilt when the size changes, starting small so the table grows as in use. One table is kept
+// for each table type (tables can't be copied so are held by pointer)
+template <class TKeyType, class TTable>
+TTable* BuildBenchHashTable
+(
+	const SBenchData& data,
+	const TUInt32     numOps
+)
+{
+	static unique_ptr<TTable> table;
+	static TUInt32 tableSize = 0;
+	if (!table || tableSize != numOps)
+	{
+		table.reset( NewBenchHashTable<TTable>() );
+		for (TUInt32 i = 0; i < numOps; ++i)
+		{
+			table->SetKeyValue( BenchKey<TKeyType>( data, i ), i );
+		}
+		tableSize = numOps;
+	}
+	return table.get();
+}
+
+// Look up every key in the table in a scattered order (7919 is prime so all keys are visited)
+template <class TKeyType, class TTable>
+void BenchHashTableLookUp( SBenchData& data, const TUInt32 numOps )
+{
+	TTable* pTable = BuildBenchHashTable<TKeyType, TTable>( data, numOps );
+	TUInt32 total = 0;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		TUInt32 value;
+		if (pTable->LookUpKey( BenchKey<TKeyType>( data, static_cast<TUInt32>((i * 7919ull) % numOps) ), &value ))
+		{
+			total += value;
+		}
+	}
+	gfSink = static_cast<TFloat32>(total);
+}
+
+// Look up numOps UIDs that are not in the table
+template <class TTable>
+void BenchHashTableLookUpMissing( SBenchData& data, const TUInt32 numOps )
+{
+	TTable* pTable = BuildBenchHashTable<TUInt32, TTable>( data, numOps );
+	TUInt32 numFound = 0;
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		TUInt32 value;
+		if (pTable->LookUpKey( numOps + i * 7919, &value ))
+		{
+			++numFound;
+		}
+	}
+	gfSink = static_cast<TFloat32>(numFound);
+}
+
+// Add numOps new UIDs to the table then remove them again - one operation is an add and a remove
+template <class TTable>
+void BenchHashTableAddRemove( SBenchData& data, const TUInt32 numOps )
+{
+	TTable* pTable = BuildBenchHashTable<TUInt32, TTable>( data, numOps );
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		pTable->SetKeyValue( numOps + i, i );
+	}
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		pTable->RemoveKey( numOps + i );
+	}
+}
+
+typedef CHashTable<TUInt32, TUInt32>                            TUIDTable;
+typedef CHashTable<TUInt32, TUInt32, CJOneAtATimeHash<TUInt32> > TUIDTableOneAtATime;
+typedef CHashTable<TUInt32, TUInt32, CAddUpHash<TUInt32> >       TUIDTableAddUp;
+typedef CChainedHashTable<TUInt32, TUInt32>                     TUIDTableChained;
+typedef CHashTable<string, TUInt32>                             TNameTable;
+typedef CHashTable<string, TUInt32, CJOneAtATimeHash<string> >  TNameTableOneAtATime;
+typedef CHashTable<string, TUInt32, CAddUpHash<string> >        TNameTableAddUp;
+
+// Quaternions
+
+void BenchQuaternionSlerp( SBenchData& data, const TUInt32 numOps )
+{
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		Slerp( data.quats1[i], data.quats2[i], data.params[i], data.quatsOut[i] );
+	}
+}
+
+void BenchQuaternionSlerpArray( SBenchData& data, const TUInt32 numOps )
+{
+	SlerpArray( &data.quatsOut[0], &data.quats1[0], &data.quats2[0], &data.params[0], numOps );
+}
+
+void BenchQuaternionNLerpArray( SBenchData& data, const TUInt32 numOps )
+{
+	NLerpArray( &data.quatsOut[0], &data.quats1[0], &data.quats2[0], &data.params[0], numOps );
+}
+
+// BaseMath helpers
+
+void BenchSqrt( SBenchData& data, const TUInt32 numOps )
+{
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		data.floatsOut1[i] = Sqrt( data.params[i] );
+	}
+}
+
+void BenchInvSqrt( SBenchData& data, const TUInt32 numOps )
+{
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		data.floatsOut1[i] = InvSqrt( data.params[i] );
+	}
+}
+
+void BenchSinCos( SBenchData& data, const TUInt32 numOps )
+{
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		data.floatsOut1[i] = Sin( data.angles[i] );
+		data.floatsOut2[i] = Cos( data.angles[i] );
+	}
+}
+
+void BenchACos( SBenchData& data, const TUInt32 numOps )
+{
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		data.floatsOut1[i] = ACos( data.params[i] );
+	}
+}
+
+// MathApprox.h versions
+
+void BenchInvSqrtFastArray( SBenchData& data, const TUInt32 numOps )
+{
+	InvSqrtArray<kMathFast>( &data.floatsOut1[0], &data.params[0], numOps );
+}
+
+void BenchInvSqrtPreciseArray( SBenchData& data, const TUInt32 numOps )
+{
+	InvSqrtArray<kMathPrecise>( &data.floatsOut1[0], &data.params[0], numOps );
+}
+
+void BenchSinCosFastArray( SBenchData& data, const TUInt32 numOps )
+{
+	SinCosArray<kMathFast>( &data.floatsOut1[0], &data.floatsOut2[0], &data.angles[0], numOps );
+}
+
+void BenchSinCosPreciseArray( SBenchData& data, const TUInt32 numOps )
+{
+	SinCosArray<kMathPrecise>( &data.floatsOut1[0], &data.floatsOut2[0], &data.angles[0],
+	                           numOps );
+}
+
+void BenchExpPreciseArray( SBenchData& data, const TUInt32 numOps )
+{
+	ExpArray<kMathPrecise>( &data.floatsOut1[0], &data.angles[0], numOps );
+}
+
+// CRandom.h versions
+CRandom gBenchRandom;
+
+void BenchRandomFloat( SBenchData& data, const TUInt32 numOps )
+{
+	for (TUInt32 i = 0; i < numOps; ++i)
+	{
+		data.floatsOut1[i] = gBenchRandom.Float( -1.0f, 1.0f );
+	}
+}
+
+void BenchRandomFillArray( SBenchData& data, const TUInt32 numOps )
+{
+	gBenchRandom.Fill( &data.floatsOut1[0], numOps, -1.0f, 1.0f );
+}
+
+
+// List of all benchmarks and their names in the output
+struct SBenchmark
+{
+	const char*    name;
+	TBenchFunction function;
+};
+
+const SBenchmark kaBenchmarks[] =
+{
+	{ "matrix_multiply",                 BenchMatrixMultiply },
+	{ "matrix_multiply_array",           BenchMatrixMultiplyArray },
+	{ "matrix_inverse",                  BenchMatrixInverse },
+	{ "matrix_inverse_array",            BenchMatrixInverseArray },
+	{ "matrix_inverse_affine_array",     BenchMatrixInverseAffineArray },
+	{ "matrix_decompose_affine_euler",   BenchDecomposeAffineEuler },
+	{ "matrix_decompose_affine_quat",    BenchDecomposeAffineQuaternion },
+	{ "matrix_transform_points",         BenchTransformPoints },
+	{ "vector3_normalise",               BenchVectorNormalise },
+	{ "vector3_stream_normalise",        BenchVectorNormaliseStream },
+	{ "vector3_stream_cull_spheres",     BenchSpheresInsidePlanes },
+	{ "vector3_stream_cull_4_views",     BenchSpheresInsideFrustums },
+	{ "aabb_tree_query_planes",          BenchAABBTreeQueryPlanes },
+	{ "aabb_tree_query_planes_narrow",   BenchAABBTreeQueryPlanesNarrow },
+	{ "triangle_bvh_ray_cast",           BenchTriangleBVHRayCast },
+	{ "triangle_bvh_ray_hits",           BenchTriangleBVHRayHits },
+	{ "hash_table_lookup",               BenchHashTableLookUp<TUInt32, TUIDTable> },
+	{ "hash_table_lookup_oneatatime",    BenchHashTableLookUp<TUInt32, TUIDTableOneAtATime> },
+	{ "hash_table_lookup_addup",         BenchHashTableLookUp<TUInt32, TUIDTableAddUp> },
+	{ "hash_table_lookup_chained",       BenchHashTableLookUp<TUInt32, TUIDTableChained> },
+	{ "hash_table_lookup_miss",          BenchHashTableLookUpMissing<TUIDTable> },
+	{ "hash_table_lookup_miss_chained",  BenchHashTableLookUpMissing<TUIDTableChained> },
+	{ "hash_table_add_remove",           BenchHashTableAddRemove<TUIDTable> },
+	{ "hash_table_add_remove_chained",   BenchHashTableAddRemove<TUIDTableChained> },
+	{ "hash_table_name_lookup",          BenchHashTableLookUp<string, TNameTable> },
+	{ "hash_table_name_oneatatime",      BenchHashTableLookUp<string, TNameTableOneAtATime> },
+	{ "hash_table_name_addup",           BenchHashTableLookUp<string, TNameTableAddUp> },
+	{ "quaternion_slerp",                BenchQuaternionSlerp },
+	{ "quaternion_slerp_array",          BenchQuaternionSlerpArray },
+	{ "quaternion_nlerp_array",          BenchQuaternionNLerpArray },
+	{ "basemath_sqrt",                   BenchSqrt },
+	{ "basemath_invsqrt",                BenchInvSqrt },
+	{ "basemath_sincos",                 BenchSinCos },
+	{ "basemath_acos",                   BenchACos },
+	{ "approx_invsqrt_fast_array",       BenchInvSqrtFastArray },
+	{ "approx_invsqrt_precise_array",    BenchInvSqrtPreciseArray },
+	{ "approx_sincos_fast_array",        BenchSinCosFastArray },
+	{ "approx_sincos_precise_array",     BenchSinCosPreciseArray },
+	{ "approx_exp_precise_array",        BenchExpPreciseArray },
+	{ "random_float",                    BenchRandomFloat },
+	{ "random_fill_array",               BenchRandomFillArray },
+};
+
+
+/*-----------------------------------------------------------------------------------------
+	Timing
+-----------------------------------------------------------------------------------------*/
+
+// Return best time per operation in seconds for the given benchmark and batch size
+TFloat64 TimeBenchmark
+(
+	const SBenchmark& bench,
+	SBenchData&       data,
+	const TUInt32     numOps,
+	const TFloat64    fMinRunTime,
+	TUInt64*          pIterations
+)
+{
+	typedef chrono::steady_clock TClock;
+
+	// Warm up caches and find how many batches are needed to reach the minimum run time
+	TUInt64 iterations = 1;
+	while (true)
+	{
+		TClock::time_point start = TClock::now();
+		for (TUInt64 i = 0; i < iterations; ++i)
+		{
+			bench.function( data, numOps );
+		}
+		TFloat64 fTime = chrono::duration<TFloat64>( TClock::now() - start ).count();
+		if (fTime >= fMinRunTime)
+		{
+			break;
+		}
+		iterations *= 2;
+	}
+
+	TFloat64 fBestTime = 0.0;
+	for (TUInt32 run = 0; run < kiNumRuns; ++run)
+	{
+		TClock::time_point start = TClock::now();
+		for (TUInt64 i = 0; i < iterations; ++i)
+		{
+			bench.function( data, numOps );
+		}
+		TFloat64 fTime = chrono::duration<TFloat64>( TClock::now() - start ).count();
+		if (run == 0 || fTime < fBestTime)
+		{
+			fBestTime = fTime;
+		}
+	}
+
+	*pIterations = iterations * kiNumRuns;
+	return fBestTime / (static_cast<TFloat64>(iterations) * numOps);
+}
+
+// Return name of SIMD code path in use by the maths library
+const char* SIMDPath()
+{
+#if defined(GEN_MATH_AVX)
+	return "avx";
+#elif defined(GEN_MATH_SSE2)
+	return "sse2";
+#elif defined(GEN_MATH_SSE)
+	return "sse";
+#else
+	return "none";
+#endif
+}
+
+
+} // namespace gen
+
+
+/*-----------------------------------------------------------------------------------------
+	Main
+-----------------------------------------------------------------------------------------*/
+
+int main( int argc, char* argv[] )
+{
+	using namespace gen;
+
+	GEN_SENTRY
+
+	// Parse command line
+	TFloat64 fMinRunTime = kfMinRunTime;
+	vector<TUInt32> batches;
+	for (int arg = 1; arg < argc; ++arg)
+	{
+		if (!strcmp( argv[arg], "--quick" ))
+		{
+			fMinRunTime = kfQuickRunTime;
+		}
+		else if (!strcmp( argv[arg], "--batch" ) && arg + 1 < argc)
+		{
+			TInt32 batch = atoi( argv[++arg] );
+			GEN_ASSERT( batch > 0, "Batch size must be positive" );
+			batches.push_back( static_cast<TUInt32>(batch) );
+		}
+		else
+		{
+			fprintf( stderr, "Usage: %s [--quick] [--batch N]...\n", argv[0] );
+			return 1;
+		}
+	}
+	if (batches.empty())
+	{
+		batches.assign( kaiDefaultBatches, kaiDefaultBatches +
+		                sizeof(kaiDefaultBatches) / sizeof(kaiDefaultBatches[0]) );
+	}
+
+	TUInt32 maxBatch = 0;
+	for (TUInt32 b = 0; b < batches.size(); ++b)
+	{
+		maxBatch = Max( maxBatch, batches[b] );
+	}
+	SBenchData data;
+	InitBenchData( data, maxBatch );
+
+	// Run all benchmarks at each batch size, output as JSON
+	printf( "{\n" );
+	printf( "  \"compiler\": \"%s\",\n", ksCompiler.c_str() );
+	printf( "  \"simd\": \"%s\",\n", SIMDPath() );
+	printf( "  \"min_run_time_s\": %g,\n", fMinRunTime );
+	printf( "  \"results\": [\n" );
+	const TUInt32 kiNumBenchmarks = sizeof(kaBenchmarks) / sizeof(kaBenchmarks[0]);
+	for (TUInt32 n = 0; n < kiNumBenchmarks; ++n)
+	{
+		for (TUInt32 b = 0; b < batches.size(); ++b)
+		{
+			TUInt64 iterations;
+			TFloat64 fOpTime = TimeBenchmark( kaBenchmarks[n], data, batches[b], fMinRunTime,
+			                                  &iterations );
+			bool bLast = (n == kiNumBenchmarks - 1 && b == batches.size() - 1);
+			printf( "    { \"name\": \"%s\", \"batch\": %u, \"iterations\": %llu, "
+			        "\"ns_per_op\": %.3f, \"ops_per_sec\": %.0f }%s\n",
+			        kaBenchmarks[n].name, batches[b], iterations, fOpTime * 1.0e9,
+			        1.0 / fOpTime, bLast ? "" : "," );
+			fflush( stdout );
+		}
+	}
+	printf( "  ]\n" );
+	printf( "}\n" );
+
+	GEN_ENDSENTRY
+	return 0;
+}
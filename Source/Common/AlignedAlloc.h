@@ -0,0 +1,273 @@
+/**************************************************************************************************
+	Module:       AlignedAlloc.h
+	Author:       agent
+	Date created: 16/10/26
+
+	Allocation of memory aligned to a given boundary: raw allocation functions, array new/delete
+	equivalents and an STL allocator so standard containers can hold aligned data
+
+	Copyright 2026, agent
+
+	Change history:
+		V1.0    Created 16/10/26 - AG
+**************************************************************************************************/
+
+// The default new and STL allocators only guarantee alignment suitable for built-in types (8
+// bytes on 32-bit Windows). SIMD code works best on data aligned to 16 bytes (SSE) or 32 bytes
+// (AVX), and a CMatrix4x4 row that straddles a cache line costs an extra memory access to load.
+// Use these functions wherever many matrices or vectors are stored in arrays, e.g.:
+//     CMatrix4x4* matrices = AlignedNew<CMatrix4x4>( numMatrices );
+//     ...
+//     AlignedDelete( matrices );
+// or for an STL container:
+//     vector< CMatrix4x4, CAlignedAllocator<CMatrix4x4> > matrices;
+//
+// Note: types declared with GEN_ALIGN can be stored in a container using CAlignedAllocator, but
+// should not be passed by value to functions (a Visual Studio restriction on 32-bit builds)
+
+#ifndef GEN_ALIGNED_ALLOC_H_INCLUDED
+#define GEN_ALIGNED_ALLOC_H_INCLUDED
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <new>
+#if defined(_MSC_VER)
+	#include <malloc.h>
+#endif
+
+#include "Defines.h"
+
+namespace gen
+{
+
+/*------------------------------------------------------------------------------------------------
+	Constants
+ ------------------------------------------------------------------------------------------------*/
+
+// Alignment required for aligned SSE loads and stores, and for AVX
+const TUInt32 kiSSEAlignment = 16;
+const TUInt32 kiAVXAlignment = 32;
+
+
+/*------------------------------------------------------------------------------------------------
+	Raw allocation
+ ------------------------------------------------------------------------------------------------*/
+
+// Allocate the given number of bytes aligned to the given boundary (a power of 2), returns 0 on
+// failure. Free the memory with AlignedFree only
+inline void* AlignedAlloc
+(
+	const size_t  size,
+	const TUInt32 alignment = kiSSEAlignment
+)
+{
+#if defined(_MSC_VER)
+	return _aligned_malloc( size, alignment );
+#else
+	void* p;
+	size_t align = alignment < sizeof(void*) ? sizeof(void*) : alignment;
+	return posix_memalign( &p, align, size ) == 0 ? p : 0;
+#endif
+}
+
+// Free memory allocated with AlignedAlloc, does nothing if passed 0
+inline void AlignedFree( void* p )
+{
+#if defined(_MSC_VER)
+	_aligned_free( p );
+#else
+	free( p );
+#endif
+}
+
+
+/*------------------------------------------------------------------------------------------------
+	Aligned arrays
+ ------------------------------------------------------------------------------------------------*/
+// Equivalents of new[] and delete[]. The number of elements is stored in a header before the
+// array so it need not be passed to AlignedDelete. The header is a whole multiple of the
+// alignment so the first element remains aligned
+
+// Return size of header used by AlignedNew for the given alignment
+inline size_t AlignedArrayHeaderSize( const TUInt32 alignment )
+{
+	return (sizeof(size_t) + alignment - 1) & ~static_cast<size_t>(alignment - 1);
+}
+
+// Allocate and default construct an array of the given number of elements, aligned to the given
+// boundary. Returns 0 if the memory could not be allocated (like new(nothrow)). The alignment
+// used must also be passed to AlignedDelete
+template <class T>
+T* AlignedNew
+(
+	const size_t  numElts,
+	const TUInt32 alignment = kiSSEAlignment
+)
+{
+	size_t headerSize = AlignedArrayHeaderSize( alignment );
+	TUInt8* pMemory = static_cast<TUInt8*>(AlignedAlloc( headerSize + numElts * sizeof(T), alignment ));
+	if (!pMemory)
+	{
+		return 0;
+	}
+
+	// Store element count immediately before the array
+	T* pArray = reinterpret_cast<T*>(pMemory + headerSize);
+	reinterpret_cast<size_t*>(pArray)[-1] = numElts;
+
+	// Construct elements, destroying any already constructed if an exception occurs
+	size_t elt = 0;
+	try
+	{
+		for (; elt < numElts; ++elt)
+		{
+			new (pArray + elt) T;
+		}
+	}
+	catch (...)
+	{
+		while (elt > 0)
+		{
+			pArray[--elt].~T();
+		}
+		AlignedFree( pMemory );
+		throw;
+	}
+	return pArray;
+}
+
+// Destroy and free an array allocated with AlignedNew, does nothing if passed 0. The alignment
+// must match that used for the allocation
+template <class T>
+void AlignedDelete
+(
+	T*            pArray,
+	const TUInt32 alignment = kiSSEAlignment
+)
+{
+	if (!pArray)
+	{
+		return;
+	}
+	size_t numElts = reinterpret_cast<size_t*>(pArray)[-1];
+	while (numElts > 0)
+	{
+		pArray[--numElts].~T();
+	}
+	AlignedFree( reinterpret_cast<TUInt8*>(pArray) - AlignedArrayHeaderSize( alignment ) );
+}
+
+
+/*------------------------------------------------------------------------------------------------
+	STL allocator
+ ------------------------------------------------------------------------------------------------*/
+
+// Allocator for STL containers that aligns all allocations to the given boundary (a power of 2,
+// 16 by default). Provides the full pre-C++11 allocator interface for older library versions
+template <class T, TUInt32 Alignment = kiSSEAlignment>
+class CAlignedAllocator
+{
+public:
+	typedef T              value_type;
+	typedef T*             pointer;
+	typedef const T*       const_pointer;
+	typedef T&             reference;
+	typedef const T&       const_reference;
+	typedef size_t         size_type;
+	typedef ptrdiff_t      difference_type;
+
+	// Allocator for another type with the same alignment (used by containers for their nodes)
+	template <class U>
+	struct rebind
+	{
+		typedef CAlignedAllocator<U, Alignment> other;
+	};
+
+	CAlignedAllocator() {}
+	CAlignedAllocator( const CAlignedAllocator& ) {}
+	template <class U>
+	CAlignedAllocator( const CAlignedAllocator<U, Alignment>& ) {}
+
+	pointer address( reference x ) const
+	{
+		return &x;
+	}
+	const_pointer address( const_reference x ) const
+	{
+		return &x;
+	}
+
+	// Allocate memory for the given number of elements, throws bad_alloc on failure as required
+	// by the STL
+	pointer allocate
+	(
+		size_type   num,
+		const void* /*hint*/ = 0
+	)
+	{
+		if (num == 0)
+		{
+			return 0;
+		}
+		void* p = AlignedAlloc( num * sizeof(T), Alignment );
+		if (!p)
+		{
+			throw std::bad_alloc();
+		}
+		return static_cast<pointer>(p);
+	}
+
+	void deallocate
+	(
+		pointer   p,
+		size_type /*num*/
+	)
+	{
+		AlignedFree( p );
+	}
+
+	size_type max_size() const
+	{
+		return static_cast<size_type>(-1) / sizeof(T);
+	}
+
+	void construct
+	(
+		pointer  p,
+		const T& val
+	)
+	{
+		new (p) T( val );
+	}
+
+	void destroy( pointer p )
+	{
+		p->~T();
+	}
+};
+
+// All aligned allocators with the same alignment are interchangeable
+template <class T, class U, TUInt32 Alignment>
+inline bool operator==
+(
+	const CAlignedAllocator<T, Alignment>&,
+	const CAlignedAllocator<U, Alignment>&
+)
+{
+	return true;
+}
+
+template <class T, class U, TUInt32 Alignment>
+inline bool operator!=
+(
+	const CAlignedAllocator<T, Alignment>&,
+	const CAlignedAllocator<U, Alignment>&
+)
+{
+	return false;
+}
+
+
+} // namespace gen
+
+#endif // GEN_ALIGNED_ALLOC_H_INCLUDED
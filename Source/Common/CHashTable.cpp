@@ -3,8 +3,8 @@
 	Author:       Laurent Noel
 
 	Hash table class storing keys and associated values, supporting quick lookup of a value for a
-	given a key. A hashing function is needed for the mapping and can be specified through the
-	constructor
+	given a key. A hashing function is needed for the mapping and can be specified as a template
+	parameter. This file contains the byte-wise hashing functions
 
 	See header file for further notes
 
@@ -56,4 +56,56 @@ TUInt32 JOneAtATimeHash( const TUInt8* pKey, const TUInt32 iKeyLen )
 }
 
 
+// Multiply two 4-byte values giving an 8-byte result, return the low half in *pA and the high half
+// in *pB. Combines all the bits of both values, a single instruction on 32-bit and 64-bit x86
+inline void WyMix32( TUInt32* pA, TUInt32* pB )
+{
+	TUInt64 iProduct = static_cast<TUInt64>(*pA ^ 0x53c5ca59u) * (*pB ^ 0x74743c1bu);
+	*pA = static_cast<TUInt32>(iProduct);
+	*pB = static_cast<TUInt32>(iProduct >> 32);
+}
+
+// Read 4 bytes from unaligned data as an integer (memcpy is optimised to a single load)
+inline TUInt32 WyRead32( const TUInt8* pData )
+{
+	TUInt32 iValue;
+	memcpy( &iValue, pData, sizeof(iValue) );
+	return iValue;
+}
+
+// Wang Yi's wyhash (32-bit variant), reads the key 8 bytes at a time and mixes with 32x32->64 bit
+// multiplies. Much faster than one-at-a-time hashing for strings, with as good a distribution
+// Public domain algorithm, see https://github.com/wangyi-fudan/wyhash
+TUInt32 WyHash32( const TUInt8* pKey, const TUInt32 iKeyLen )
+{
+	TUInt32 iSeed = 0;
+	TUInt32 iSeed2 = iKeyLen;
+	WyMix32( &iSeed, &iSeed2 );
+
+	// Mix in 8 bytes at a time, leaving 1 to 8 bytes
+	TUInt32 iRemaining = iKeyLen;
+	for (; iRemaining > 8; iRemaining -= 8, pKey += 8)
+	{
+		iSeed ^= WyRead32( pKey );
+		iSeed2 ^= WyRead32( pKey + 4 );
+		WyMix32( &iSeed, &iSeed2 );
+	}
+
+	// Mix in remaining bytes, with 4 or more read as two (possibly overlapping) integers
+	if (iRemaining >= 4)
+	{
+		iSeed ^= WyRead32( pKey );
+		iSeed2 ^= WyRead32( pKey + iRemaining - 4 );
+	}
+	else if (iRemaining > 0)
+	{
+		iSeed ^= (static_cast<TUInt32>(pKey[0]) << 16) | (static_cast<TUInt32>(pKey[iRemaining >> 1]) << 8) |
+		         pKey[iRemaining - 1];
+	}
+	WyMix32( &iSeed, &iSeed2 );
+	WyMix32( &iSeed, &iSeed2 );
+	return iSeed ^ iSeed2;
+}
+
+
 } // namespace gen
@@ -3,7 +3,12 @@
 	Author:       Laurent Noel
 
 	Hash table class storing keys and associated values, supporting quick lookup of a value for a
-	given a key. A hashing function is needed for the mapping and is specified for the constructor
+	given a key. A hashing function is needed for the mapping and is specified as a template
+	parameter, with suitable defaults for integer and string keys
+
+	Keys and values are stored directly in a single array (open addressing) rather than in a list
+	for each hash value, so there is no memory allocation when adding a key, and a look-up usually
+	reads a single cache line. See the notes on the class below
 	
 	This is a template class, which allows any types for keys and values. E.g. to implement entity
 	UIDs the key is an integer (the UID), and the value is an entity pointer. For a phonebook, the
@@ -18,8 +23,8 @@
 #define GEN_C_HASH_TABLE_H_INCLUDED
 
 #include <math.h>
+#include <string.h>
 #include <iostream>
-#include <list>
 using namespace std;
 
 #include "Defines.h"
@@ -32,11 +37,9 @@ namespace gen
 	Hashing functions
  ------------------------------------------------------------------------------------------------*/
 
-// This hash map class allows the use of different hash functions. To allow this we first define
-// a function pointer *type* for hash functions. This defines the function prototype for user-
-// provided hash functions: the parameters are a pointer to the key data (as a sequence of bytes),
-// and the length of the key data in bytes. This allows keys of any type to be hashed. The hash
-// function returns a 4-byte integer, the index to use for the value associated with the key
+// Byte-wise hashing functions convert a key given as a sequence of bytes into a 4-byte integer.
+// The parameters are a pointer to the key data and the length of the key data in bytes. This
+// function pointer *type* defines the prototype for such functions
 typedef TUInt32 (*THashFunction)( const TUInt8* key, const TUInt32 keyLen );
 
 // Basic hashing function - simply adds up each byte in the key to give the resultant index
@@ -46,11 +49,135 @@ TUInt32 AddUpHash( const TUInt8* pKey, const TUInt32 iKeyLen );
 // distribution of indexes (few collisions)
 TUInt32 JOneAtATimeHash( const TUInt8* pKey, const TUInt32 iKeyLen );
 
+// Wang Yi's wyhash (32-bit variant), reads the key 8 bytes at a time and mixes with 32x32->64 bit
+// multiplies. Much faster than one-at-a-time hashing for strings, with as good a distribution
+TUInt32 WyHash32( const TUInt8* pKey, const TUInt32 iKeyLen );
+
+
+// Mix the bits of an integer so every input bit affects every output bit - for integer keys
+// this is much faster than hashing the bytes one at a time. Constants from Chris Wellons'
+// "lowbias32" search for xor-shift-multiply hashes
+inline TUInt32 HashInteger32( TUInt32 iKey )
+{
+	iKey ^= iKey >> 16;
+	iKey *= 0x7feb352du;
+	iKey ^= iKey >> 15;
+	iKey *= 0x846ca68bu;
+	iKey ^= iKey >> 16;
+	return iKey;
+}
+
+// Mix a 64-bit integer into a 4-byte hash. Uses 32-bit operations only, for 32-bit platforms
+inline TUInt32 HashInteger64( const TUInt64 iKey )
+{
+	return HashInteger32( static_cast<TUInt32>(iKey) ^ HashInteger32( static_cast<TUInt32>(iKey >> 32) ) );
+}
+
+
+// Hash tables take the hash to use as a template parameter: a class (a "functor") whose
+// operator() converts a key to a 4-byte integer. Being a template parameter rather than a
+// function pointer, the hash can be inlined and can be chosen to suit the key type. CHash is the
+// default, specialised below for common key types. The general version hashes the raw bytes of
+// the key, so is only suitable for keys that do not contain pointers - pointers are not followed
+// and the data pointed at will not be hashed
+template <class TKeyType>
+struct CHash
+{
+	TUInt32 operator()( const TKeyType& key ) const
+	{
+		return WyHash32( reinterpret_cast<const TUInt8*>(&key), sizeof(TKeyType) );
+	}
+};
+
+// Integer keys (e.g. UIDs) are mixed directly
+#define GEN_HASH_INTEGER( TIntegerType ) \
+	template <> struct CHash<TIntegerType> \
+	{ \
+		TUInt32 operator()( const TIntegerType key ) const \
+		{ \
+			return (sizeof(TIntegerType) > 4) ? HashInteger64( static_cast<TUInt64>(key) ) : \
+			                                    HashInteger32( static_cast<TUInt32>(key) ); \
+		} \
+	};
+GEN_HASH_INTEGER( char )
+GEN_HASH_INTEGER( signed char )
+GEN_HASH_INTEGER( unsigned char )
+GEN_HASH_INTEGER( signed short )
+GEN_HASH_INTEGER( unsigned short )
+GEN_HASH_INTEGER( signed int )
+GEN_HASH_INTEGER( unsigned int )
+GEN_HASH_INTEGER( signed long )
+GEN_HASH_INTEGER( unsigned long )
+GEN_HASH_INTEGER( TInt64 )
+GEN_HASH_INTEGER( TUInt64 )
+#undef GEN_HASH_INTEGER
+
+// Pointer keys are hashed by address (the object pointed at is not hashed)
+template <class TPointedType>
+struct CHash<TPointedType*>
+{
+	TUInt32 operator()( TPointedType* const key ) const
+	{
+		return HashInteger64( static_cast<TUInt64>(reinterpret_cast<size_t>(key)) );
+	}
+};
+
+// String keys hash the characters of the string
+template <>
+struct CHash<string>
+{
+	TUInt32 operator()( const string& key ) const
+	{
+		return WyHash32( reinterpret_cast<const TUInt8*>(key.data()), static_cast<TUInt32>(key.length()) );
+	}
+};
+
+
+// Adapter to use a byte-wise hashing function (see above) as a hash table template parameter.
+// Hashes the raw bytes of the key, or the characters of a string key
+template <class TKeyType, THashFunction pfHashFunction>
+struct CByteHash
+{
+	TUInt32 operator()( const TKeyType& key ) const
+	{
+		return pfHashFunction( reinterpret_cast<const TUInt8*>(&key), sizeof(TKeyType) );
+	}
+};
+template <THashFunction pfHashFunction>
+struct CByteHash<string, pfHashFunction>
+{
+	TUInt32 operator()( const string& key ) const
+	{
+		return pfHashFunction( reinterpret_cast<const TUInt8*>(key.data()), static_cast<TUInt32>(key.length()) );
+	}
+};
+
+// The original byte-wise hashing functions as hash table template parameters
+template <class TKeyType>
+struct CAddUpHash : public CByteHash<TKeyType, AddUpHash> {};
+template <class TKeyType>
+struct CJOneAtATimeHash : public CByteHash<TKeyType, JOneAtATimeHash> {};
+
 
 /*---------------------------------------------------------------------------------------------
 	CHashTable class
 ---------------------------------------------------------------------------------------------*/
 
+// Statistics on the lengths of the probe sequences in a hash table, see CHashTable::GetProbeStatistics
+struct SHashProbeStatistics
+{
+	TUInt32  numEntries;          // Number of key/value pairs in the table
+	TUInt32  size;                // Number of slots in the table
+	TFloat32 loadFactor;          // numEntries / size
+	TFloat32 averageProbeLength;  // Average number of slots read to find a key in the table
+	TUInt32  maxProbeLength;      // Greatest number of slots read to find a key in the table
+	TUInt32  probeLengthCounts[8]; // Number of keys found after reading 1, 2, ... 8 or more slots
+};
+
+// Greatest number of slots read to find a key. The table grows if an entry would be stored
+// further than this from the slot indicated by its hash
+const TUInt32 kiMaxHashProbeLength = 0xffff;
+
 // This is a template class, allowing any types for key and value. Template classes must have
 // their member functions defined in the class definition or they won't be instantiated (will
 // get link errors). Ask your tutor if you want the full reason for this. However, simply put,
@@ -58,15 +185,35 @@ TUInt32 JOneAtATimeHash( const TUInt8* pKey, const TUInt32 iKeyLen );
 //
 // Often a template class or function has restrictions on the types that can be used, these
 // must be documented. Here the key type (TKeyType here) must have operator== (comparison) and
-// operator= (assignment) defined and the value type must have operator= defined. This is no
-// problem for entity look-up (keys are UIDs (integers), values are pointers), or phonebooks
-// (keys and values are STL strings) - these are standard types have both == and = defined.
-// However, in other cases we may need to implement/overload the == and = operators or the
-// class would not compile.
-// A further restriction is that keys must not contain pointers (although values can). This is
-// because the hash function treats keys as a sequence of raw bytes, pointers are not followed
-// and the data pointed at will not be hashed
-template <class TKeyType, class TValueType>
+// operator= (assignment) defined and the value type must have operator= defined. Both must
+// also have a default constructor. This is no problem for entity look-up (keys are UIDs
+// (integers), values are pointers), or phonebooks (keys and values are STL strings) - these are
+// standard types with all of these defined. However, in other cases we may need to implement/
+// overload the == and = operators or the class would not compile.
+// The hash (THash here) is a functor class converting keys to 4-byte integers, see CHash above.
+// The default suits integer, pointer and string keys. Other key types are hashed as raw bytes,
+// so must not contain pointers unless a suitable hash class is provided
+//
+// Implementation notes:
+// - All key/value pairs are stored in one array of slots, whose size is a power of two. A key
+//   is stored in the slot given by its hash if possible, otherwise in one of the following slots
+//   (linear probing). A look-up reads the slots in turn from the hash slot until it finds the key
+// - Each slot also stores its "probe length" - how far it is from the hash slot of its key, plus
+//   one (zero marks an empty slot). When adding a key, it takes the place of any key stored
+//   nearer to its own hash slot, which then moves on in turn ("Robin Hood" hashing). This keeps
+//   probe lengths short and even, and means a look-up can stop as soon as it meets a slot with a
+//   shorter probe length than it has searched - the key would have been stored there
+// - Removing a key moves the following keys back one slot until a key in its own hash slot or
+//   an empty slot is met ("backward shift" deletion), so there are no "deleted" markers left in
+//   the table to lengthen later look-ups
+// - The hash is multiplied by a large odd constant and the top bits used as the slot index
+//   ("Fibonacci" hashing). This mixes all bits of the hash into the index, which is important
+//   with a power of two size as otherwise only the low bits of the hash would be used
+// - Resizing normally rehashes all keys at once, which may take some time for a large table. In
+//   incremental mode (see SetIncrementalResize) a new table is allocated and keys are moved into
+//   it a few slots at a time by each add or remove, while look-ups search both tables. The cost
+//   of resizing is spread over many operations, so there is no single slow operation
+template <class TKeyType, class TValueType, class THash = CHash<TKeyType> >
 class CHashTable
 {
 
@@ -74,24 +221,29 @@ class CHashTable
 	Constructors / Destructore
 ---------------------------------------------------------------------------------------------*/
 public:
-	// Constructor takes initial table size, a hashing function, and the maximum load factor
-	// before the table is resized - see data section at end
+	// Constructor takes initial table size, the maximum load factor before the table is resized -
+	// see data section at end, and optionally a hash object (for hash classes with state). The
+	// size is rounded up to a power of two
 	CHashTable
 	(
-		const TUInt32  iInitialSize,         // Initial size for the hash table
-		THashFunction  pfHashFunction,       // Hashing function to use
-		const TFloat32 fMaxLoadFactor = 0.7f // Maximum load factor
-	) : m_kfMaxLoadFactor( fMaxLoadFactor ), m_kpfHashFunction( pfHashFunction )
+		const TUInt32  iInitialSize,          // Initial size for the hash table
+		const TFloat32 fMaxLoadFactor = 0.7f, // Maximum load factor
+		const THash&   hash = THash()         // Hash object to use
+	) : m_Hash( hash ), m_kfMaxLoadFactor( fMaxLoadFactor )
 	{
 		GEN_GUARD;
 
-		// Allocate initial hash table array
-		m_iSize = iInitialSize;
-		m_aBuckets = new TBucket[m_iSize];
-		GEN_ASSERT( m_aBuckets, "Fatal memory error reserving hash table memory" );
+		GEN_ASSERT( fMaxLoadFactor > 0.0f && fMaxLoadFactor < 1.0f, "Invalid maximum load factor" );
 
-		// Starting with no hash table entries
-		m_iNumEntries = 0;
+		// Allocate initial hash table arrays, starting with no hash table entries. There is no old
+		// table until an incremental resize starts
+		Allocate( &m_Table, iInitialSize );
+		m_OldTable.aSlots = 0;
+		m_OldTable.aProbeLengths = 0;
+		m_OldTable.iSize = 0;
+		m_OldTable.iNumEntries = 0;
+		m_iMigrateSlot = 0;
+		m_iMigrateSlotsPerOp = 0;
 
 		GEN_ENDGUARD;
 	}
@@ -108,7 +260,8 @@ public:
 	// Destructor to free hash table memory
 	~CHashTable()
 	{
-		delete[] m_aBuckets;
+		Free( &m_Table );
+		Free( &m_OldTable );
 	}
 
 
@@ -122,22 +275,17 @@ public:
 	(
 		const TKeyType& key,
 		TValueType*     pValue
-	)
+	) const
 	{
-		// Find the index of the bucket associated with this key (will use hashing function)
-		TUInt32 iBucket = FindBucket( key );
-
-		// Search the bucket to find the the given key
-		TKeyValuePairIter itKeyValuePair = FindKeyValuePair( iBucket, key );
-
-		// Not found (reached end of list), return false
-		if (itKeyValuePair == m_aBuckets[iBucket].end())
+		const STable* pTable;
+		TUInt32 iSlot = FindKey( key, &pTable );
+		if (!pTable)
 		{
 			return false;
 		}
 
 		// Found key, copy its value out and return true
-		*pValue = itKeyValuePair->value;
+		*pValue = pTable->aSlots[iSlot].value;
 		return true;
 	}
 
@@ -149,112 +297,190 @@ public:
 		const TValueType& value
 	)
 	{
-		// Find the index of the bucket associated with this key (will use hashing function)
-		TUInt32 iBucket = FindBucket( key );
-
-		// See if given key already exists in the bucket 
-		TKeyValuePairIter itKeyValuePair = FindKeyValuePair( iBucket, key );
-		if (itKeyValuePair != m_aBuckets[iBucket].end())
+		// If key already exists (in either table during an incremental resize), simply update the
+		// value associated with it
+		const STable* pTable;
+		TUInt32 iSlot = FindKey( key, &pTable );
+		if (pTable)
 		{
-			// If key already exists, simply update the value associated with it
-			itKeyValuePair->value = value;
+			const_cast<STable*>(pTable)->aSlots[iSlot].value = value;
+			return;
 		}
-		else // otherwise a new key/value pair needs to be inserted in the bucket
-		{
-			// Check loading of table - if too full, then double it in size
-			if (m_iNumEntries > m_iSize * m_kfMaxLoadFactor)
-			{
-				Resize( m_iSize * 2 );
-				iBucket = FindBucket( key ); // Find new bucket for key after resizing
-			}
 
-			// Create a new key/value pair and add it to the list in this bucket
-			TKeyValuePair newPair;
-			newPair.key = key;
-			newPair.value = value;
-			m_aBuckets[iBucket].push_back( newPair );
-
-			// Increase total number of entries in hash table
-			++m_iNumEntries;
+		// Otherwise a new key/value pair needs to be inserted. Check loading of table - if too
+		// full, then double it in size
+		if (m_Table.iNumEntries >= m_Table.iMaxEntries)
+		{
+			Grow( m_Table.iSize * 2 );
 		}
+		TKeyValuePair newPair;
+		newPair.key = key;
+		newPair.value = value;
+		InsertNew( &m_Table, newPair );
+
+		MigrateSlots( m_iMigrateSlotsPerOp );
 	}
 
 
 	// Remove the given key (and associated value) from the table, returns false if not found
 	bool RemoveKey(	const TKeyType& key )
 	{
-		// Find the index of the bucket associated with this key (will use hashing function)
-		TUInt32 iBucket = FindBucket( key );
-
-		// Search the bucket to find the the given key
-		TKeyValuePairIter itKeyValuePair = FindKeyValuePair( iBucket, key );
-
-		// If not found then nothing to do
-		if (itKeyValuePair == m_aBuckets[iBucket].end())
+		const STable* pTable;
+		TUInt32 iSlot = FindKey( key, &pTable );
+		if (!pTable)
 		{   
 			return false;
 		}
+		RemoveSlot( const_cast<STable*>(pTable), iSlot );
 
-		// Remove the found key from the bucket
-		m_aBuckets[iBucket].erase( itKeyValuePair );
-
-		// Decrease number of table entries - note that table is never resized downwards
-		--m_iNumEntries; 
-
+		MigrateSlots( m_iMigrateSlotsPerOp );
 		return true;
 	}
 
 
-	// Remove all keys and associated values
+	// Remove all keys and associated values. The table keeps its current size
 	void RemoveAllKeys()
 	{
-		for (TUInt32 iBucket = 0; iBucket < m_iSize; ++iBucket)
+		Free( &m_OldTable );
+		for (TUInt32 iSlot = 0; iSlot < m_Table.iSize; ++iSlot)
 		{
-			m_aBuckets[iBucket].clear();
+			if (m_Table.aProbeLengths[iSlot])
+			{
+				m_Table.aSlots[iSlot] = TKeyValuePair();
+				m_Table.aProbeLengths[iSlot] = 0;
+			}
 		}
+		m_Table.iNumEntries = 0;
 	}
 
 
-	// Output a table illustrating the number of entries in each bucket - that is the number
-	// of keys that correspond to each hash value. Ideally there should always be 0 or 1 - no
-	// collisions. As ideal has functions are hard to produce, there will be some keys that
-	// have the same hash and so end up in the same bucket. This reduces the efficiency of the
-	// hash table - we find the bucket associated with our key, if it has multiple entries, we
-	// must search through them all. So we aim for a hash function that minimises the number
-	// of such situations. This function will show up good / bad hash functions
-	void OutputDistribution() const
-	{
-		cout << "Hash Table Distribution:" << endl << endl;
-		
-		// Calculate the average size of those buckets that contain keys. This gives an idea of the
-		// efficiency to look up a key
-		TUInt32 iAverageBucketSize = 0;
-		TUInt32 iUsedBuckets = 0;
-
-		// Output in a square based on table size
-		TUInt32 iBucket = 0;
-		while (iBucket != m_iSize)
+	// Ensure the table can hold the given number of keys without being resized
+	void Reserve( const TUInt32 iNumEntries )
+	{
+		TUInt32 iSize = m_Table.iSize;
+		while (iNumEntries > MaxEntries( iSize ))
 		{
-			TUInt32 iCollision = static_cast<TUInt32>(m_aBuckets[iBucket].size());
-			// Output a digit if less than 10 entries in a bucket
-			if (iCollision < 10)
-			{
-				cout << iCollision;
-			}
-			else
-			{
-				cout << '+'; // Output '+' for 10 or more entries
-			}
-			if (iCollision > 0)
+			iSize *= 2;
+		}
+		if (iSize != m_Table.iSize)
+		{
+			Resize( iSize );
+		}
+	}
+
+	// Reduce the size of the table to the smallest that holds the current keys without exceeding
+	// the maximum load factor (but no smaller than 8). The table is never reduced otherwise. In
+	// incremental mode the keys are moved into the smaller table over the following operations,
+	// so the table is sized to also hold the keys that may be added before the move finishes
+	void ShrinkToFit()
+	{
+		TUInt32 iNumEntries = GetNumEntries();
+		if (m_iMigrateSlotsPerOp > 0 && !IsResizing())
+		{
+			// Moving the keys visits each slot once, plus once more for each key moved
+			TUInt32 iMigrateSteps = m_Table.iSize + iNumEntries;
+			iNumEntries += (iMigrateSteps + m_iMigrateSlotsPerOp - 1) / m_iMigrateSlotsPerOp;
+		}
+		TUInt32 iSize = 8;
+		while (iNumEntries > MaxEntries( iSize ))
+		{
+			iSize *= 2;
+		}
+		if (iSize < m_Table.iSize)
+		{
+			Grow( iSize );
+		}
+	}
+
+
+	// Select incremental resizing (see notes above) by passing the number of slots of the old
+	// table to move into the new table on each add or remove. A few slots (e.g. 8) ensure a
+	// resize finishes before the new table is full - if not, the remaining keys are moved all at
+	// once. Pass 0 to resize all at once (the default)
+	void SetIncrementalResize( const TUInt32 iSlotsPerOperation )
+	{
+		m_iMigrateSlotsPerOp = iSlotsPerOperation;
+		if (iSlotsPerOperation == 0 && IsResizing())
+		{
+			Resize( m_Table.iSize );
+		}
+	}
+
+	// Return true if an incremental resize is in progress (keys are held in two tables)
+	bool IsResizing() const
+	{
+		return m_OldTable.aSlots != 0;
+	}
+
+
+	// Return the number of key/value pairs in the table
+	TUInt32 GetNumEntries() const
+	{
+		return m_Table.iNumEntries + m_OldTable.iNumEntries;
+	}
+
+	// Return the size of the table - the number of slots for key/value pairs. During an incremental
+	// resize this is the size of the new table
+	TUInt32 GetSize() const
+	{
+		return m_Table.iSize;
+	}
+
+
+	// Get statistics on the lengths of the probe sequences - that is the number of slots read
+	// to find each key in the table. Ideally every key would be in the slot given by its hash
+	// (probe length 1). Hash functions with a poor distribution of hash values, or a high load
+	// factor, give long probe sequences and slow look-ups. This function will show up good / bad
+	// hash functions. During an incremental resize, the keys in both tables are included
+	void GetProbeStatistics( SHashProbeStatistics* pStats ) const
+	{
+		pStats->numEntries = GetNumEntries();
+		pStats->size = m_Table.iSize;
+		pStats->loadFactor = static_cast<TFloat32>(m_Table.iNumEntries) / m_Table.iSize;
+		pStats->maxProbeLength = 0;
+		for (TUInt32 iLength = 0; iLength < 8; ++iLength)
+		{
+			pStats->probeLengthCounts[iLength] = 0;
+		}
+
+		TUInt32 iTotalProbeLength = 0;
+		const STable* apTables[2] = { &m_Table, &m_OldTable };
+		for (TUInt32 iTable = 0; iTable < 2; ++iTable)
+		{
+			for (TUInt32 iSlot = 0; iSlot < apTables[iTable]->iSize; ++iSlot)
 			{
-				iAverageBucketSize += iCollision;
-				++iUsedBuckets;
+				TUInt32 iProbeLength = apTables[iTable]->aProbeLengths[iSlot];
+				if (iProbeLength > 0)
+				{
+					iTotalProbeLength += iProbeLength;
+					if (iProbeLength > pStats->maxProbeLength)
+					{
+						pStats->maxProbeLength = iProbeLength;
+					}
+					++pStats->probeLengthCounts[(iProbeLength < 8 ? iProbeLength : 8) - 1];
+				}
 			}
-			++iBucket;
 		}
-		cout << endl << "% used buckets: " << 100.0f * static_cast<float>(iUsedBuckets) / m_iSize;
-		cout << endl << "Average (used) bucket size: " 
-		     << static_cast<float>(iAverageBucketSize) / iUsedBuckets << endl;
+		pStats->averageProbeLength = pStats->numEntries ?
+			static_cast<TFloat32>(iTotalProbeLength) / pStats->numEntries : 0.0f;
+	}
+
+	// Output the probe length statistics above
+	void OutputProbeStatistics() const
+	{
+		SHashProbeStatistics stats;
+		GetProbeStatistics( &stats );
+
+		cout << "Hash Table Probe Lengths:" << endl << endl;
+		cout << "Entries: " << stats.numEntries << " / " << stats.size
+		     << " (load factor " << stats.loadFactor << ")" << endl;
+		cout << "Average probe length: " << stats.averageProbeLength << endl;
+		cout << "Maximum probe length: " << stats.maxProbeLength << endl;
+		for (TUInt32 iLength = 0; iLength < 8; ++iLength)
+		{
+			cout << (iLength + 1) << (iLength == 7 ? "+" : "") << ": "
+			     << stats.probeLengthCounts[iLength] << endl;
+		}
 		cout << endl;
 	}
 
@@ -274,107 +500,309 @@ private:
 		TValueType       value;
 	};
 
-	// A bucket is a list of key/value pairs that have the same hash index. The list only has
-	// more than one entry if there has been a collision from the hashing function
-	// Define a couple of types to make for better readability
-	typedef list<TKeyValuePair>        TBucket;
-	typedef typename TBucket::iterator TKeyValuePairIter;
-	// Use of templates is powerful, but can cause syntax headaches - the need for "typename"
-	// here is an example
+	// Arrays of slots and their sizes. There are two of these during an incremental resize
+	struct STable
+	{
+		TKeyValuePair* aSlots;        // Dynamically allocated array of slots for key/value pairs
+		TUInt16*       aProbeLengths; // Probe length of each slot above (distance from hash slot
+		                              // + 1), 0 for an empty slot. Kept separately to be compact
+		TUInt32        iSize;         // Number of slots, a power of two (0 if not allocated)
+		TUInt32        iSlotMask;     // iSize - 1, to wrap slot indexes
+		TUInt32        iIndexShift;   // 32 - log2(iSize), to get slot index from top bits of hash
+		TUInt32        iNumEntries;   // Number of key/value pairs in the slots
+		TUInt32        iMaxEntries;   // Number of key/value pairs allowed before the table grows
+	};
 
 
 	/*---------------------------------------------------------------------------------------------
 		Support functions
 	---------------------------------------------------------------------------------------------*/
 
-	// Find the index of the bucket that should contain the given key
-	TUInt32 FindBucket(	const TKeyType& key	) const
+	// Find the index of the slot in the given table given by the hash of the key - the first slot
+	// to search for it
+	TUInt32 HashSlot
+	(
+		const STable&   table,
+		const TKeyType& key
+	) const
 	{
-		// Get a pointer to the key as raw bytes - this cast is OK for this kind of purpose
-		const TUInt8* pKeyData = reinterpret_cast<const TUInt8*>(&key);
+		// Use hash object to convert key to a single 4-byte integer
+		TUInt32 iHash = m_Hash( key );
 
-		// Use hashing function to convert key data to a single 4-byte integer
-		TUInt32 iIndex = m_kpfHashFunction( pKeyData, sizeof(TKeyType) );
-		
-		// Convert this 4-byte hash value to a bucket index. We have m_iSize buckets, so just
-		// use the integer modulus operator. Could use faster bitwise operator if number of
-		// buckets was a power of 2, but will deal with the general case here
-		iIndex %= m_iSize;
-
-		return iIndex;
+		// Convert this 4-byte hash value to a slot index. Multiplying by 2^32 / golden ratio mixes
+		// all the bits of the hash into the top bits, which are used as the index
+		return (iHash * 2654435769u) >> table.iIndexShift;
 	}
 
-
-	// Find the key/value pair associated with the given key in the given bucket
-	// Returns the end of list iterator if not found
-	TKeyValuePairIter FindKeyValuePair
+	// Find the slot in the given table holding the given key. Returns table.iSize if not found
+	TUInt32 FindSlot
 	(
-		const int       iBucket,
+		const STable&   table,
 		const TKeyType& key
 	) const
 	{
-		// Start at beginning of bucket and step through each key/value pair
-		TKeyValuePairIter itKeyValuePair = m_aBuckets[iBucket].begin();
-		while (itKeyValuePair != m_aBuckets[iBucket].end())
+		// Read slots from the hash slot until finding the key, or finding a slot with a shorter
+		// probe length than searched so far (an empty slot has 0), where the key would have been
+		// stored. Only pairs with the same probe length share the hash slot, so can match
+		TUInt32 iSlot = HashSlot( table, key );
+		TUInt32 iProbeLength = 1;
+		while (table.aProbeLengths[iSlot] >= iProbeLength)
+		{
+			if (table.aProbeLengths[iSlot] == iProbeLength && key == table.aSlots[iSlot].key)
+			{
+				return iSlot;
+			}
+			iSlot = (iSlot + 1) & table.iSlotMask;
+			++iProbeLength;
+		}
+		return table.iSize;
+	}
+
+	// Find the table and slot holding the given key, searching the old table as well during an
+	// incremental resize. Returns the slot index and sets *ppTable to the table, or to 0 if the
+	// key is not found
+	TUInt32 FindKey
+	(
+		const TKeyType& key,
+		const STable**  ppTable
+	) const
+	{
+		TUInt32 iSlot = FindSlot( m_Table, key );
+		if (iSlot != m_Table.iSize)
+		{
+			*ppTable = &m_Table;
+			return iSlot;
+		}
+		if (m_OldTable.iNumEntries)
 		{
-			// If we find a matching key, then quit loop
-			if (key == itKeyValuePair->key)
+			iSlot = FindSlot( m_OldTable, key );
+			if (iSlot != m_OldTable.iSize)
 			{
-				break;
+				*ppTable = &m_OldTable;
+				return iSlot;
 			}
-			++itKeyValuePair;
 		}
+		*ppTable = 0;
+		return 0;
+	}
 
-		// Return found key/value pair, or end of list iterator if not found
-		return itKeyValuePair;
+	// Insert a key/value pair whose key is not in the given table, which must have an empty slot
+	void InsertNew
+	(
+		STable*       pTable,
+		TKeyValuePair newPair
+	)
+	{
+		// Step through slots from the hash slot. Take the place of the first pair that is nearer
+		// to its hash slot, then continue to find a slot for that pair. Stop at an empty slot
+		TUInt32 iSlot = HashSlot( *pTable, newPair.key );
+		TUInt32 iProbeLength = 1;
+		while (pTable->aProbeLengths[iSlot] != 0)
+		{
+			if (pTable->aProbeLengths[iSlot] < iProbeLength)
+			{
+				TKeyValuePair tempPair = pTable->aSlots[iSlot];
+				pTable->aSlots[iSlot] = newPair;
+				newPair = tempPair;
+				TUInt32 iTempLength = pTable->aProbeLengths[iSlot];
+				pTable->aProbeLengths[iSlot] = static_cast<TUInt16>(iProbeLength);
+				iProbeLength = iTempLength;
+			}
+			iSlot = (iSlot + 1) & pTable->iSlotMask;
+			++iProbeLength;
+
+			// Probe lengths are stored in 2 bytes, if one gets too long (only likely with a very
+			// poor hash function) double the table size and insert the pair being moved. This
+			// resize is done all at once, moving any keys left in the old table too
+			if (iProbeLength > kiMaxHashProbeLength)
+			{
+				Resize( m_Table.iSize * 2 );
+				InsertNew( &m_Table, newPair );
+				return;
+			}
+		}
+		pTable->aSlots[iSlot] = newPair;
+		pTable->aProbeLengths[iSlot] = static_cast<TUInt16>(iProbeLength);
+		++pTable->iNumEntries;
 	}
 
-	// Resize the hash table - reinserts all keys
-	void Resize( const TUInt32 iNewSize )
+	// Empty the given slot in the given table
+	void RemoveSlot
+	(
+		STable* pTable,
+		TUInt32 iSlot
+	)
+	{
+		// Move following pairs back one slot, until reaching an empty slot or a pair already in
+		// its hash slot, then empty the last slot moved from
+		TUInt32 iNext = (iSlot + 1) & pTable->iSlotMask;
+		while (pTable->aProbeLengths[iNext] > 1)
+		{
+			pTable->aSlots[iSlot] = pTable->aSlots[iNext];
+			pTable->aProbeLengths[iSlot] = pTable->aProbeLengths[iNext] - 1;
+			iSlot = iNext;
+			iNext = (iNext + 1) & pTable->iSlotMask;
+		}
+		pTable->aSlots[iSlot] = TKeyValuePair(); // Release any resources held by the key or value
+		pTable->aProbeLengths[iSlot] = 0;
+
+		--pTable->iNumEntries;
+	}
+
+	// Return the number of entries allowed before a table of the given size must grow
+	TUInt32 MaxEntries( const TUInt32 iSize ) const
+	{
+		// Always leave at least one slot empty, so look-ups for missing keys terminate
+		TUInt32 iMaxEntries = static_cast<TUInt32>(iSize * m_kfMaxLoadFactor);
+		return (iMaxEntries < iSize - 1) ? iMaxEntries : iSize - 1;
+	}
+
+	// Allocate empty arrays for a table with at least the given number of slots (rounded up to a
+	// power of two)
+	void Allocate
+	(
+		STable*       pTable,
+		const TUInt32 iMinSize
+	)
+	{
+		pTable->iSize = 8;
+		pTable->iIndexShift = 29;
+		while (pTable->iSize < iMinSize)
+		{
+			pTable->iSize *= 2;
+			--pTable->iIndexShift;
+		}
+		pTable->iSlotMask = pTable->iSize - 1;
+		pTable->iNumEntries = 0;
+		pTable->iMaxEntries = MaxEntries( pTable->iSize );
+
+		pTable->aSlots = new TKeyValuePair[pTable->iSize];
+		pTable->aProbeLengths = new TUInt16[pTable->iSize];
+		GEN_ASSERT( pTable->aSlots && pTable->aProbeLengths, "Fatal memory error reserving hash table memory" );
+		memset( pTable->aProbeLengths, 0, pTable->iSize * sizeof(TUInt16) );
+	}
+
+	// Free the arrays of the given table, leaving it empty with size 0
+	void Free( STable* pTable )
+	{
+		delete[] pTable->aSlots;
+		delete[] pTable->aProbeLengths;
+		pTable->aSlots = 0;
+		pTable->aProbeLengths = 0;
+		pTable->iSize = 0;
+		pTable->iNumEntries = 0;
+	}
+
+
+	// Change the table to the given size, either all at once or starting an incremental resize
+	void Grow( const TUInt32 iNewSize )
+	{
+		if (m_iMigrateSlotsPerOp == 0)
+		{
+			Resize( iNewSize );
+			return;
+		}
+
+		// If an incremental resize is still in progress (the new table filled too quickly or after
+		// ShrinkToFit), resize all at once instead. Otherwise make the current table the old table
+		// and start moving keys out of it
+		if (IsResizing())
+		{
+			Resize( iNewSize );
+			return;
+		}
+		m_OldTable = m_Table;
+		Allocate( &m_Table, iNewSize );
+		m_iMigrateSlot = 0;
+	}
+
+	// Resize the hash table all at once - reinserts all keys. The size is increased if necessary
+	// to hold all keys
+	void Resize( TUInt32 iNewSize )
 	{
 		GEN_GUARD;
 
-		// Store old buckets and size
-		TUInt32 iOldSize = m_iSize;
-		TBucket* aOldBuckets = m_aBuckets;
+		// Store old table, along with the table being emptied by any incremental resize
+		STable aOldTables[2] = { m_Table, m_OldTable };
+		m_OldTable.aSlots = 0;
+		m_OldTable.aProbeLengths = 0;
+		m_OldTable.iSize = 0;
+		m_OldTable.iNumEntries = 0;
 
-		// Update size and create new set of buckets
-		m_iSize = iNewSize;
-		m_aBuckets = new TBucket[m_iSize];
-		GEN_ASSERT( m_aBuckets, "Fatal memory error reserving hash table memory" );
+		// Create new empty arrays
+		while (aOldTables[0].iNumEntries + aOldTables[1].iNumEntries > MaxEntries( iNewSize ))
+		{
+			iNewSize *= 2;
+		}
+		Allocate( &m_Table, iNewSize );
 
-		// Go through old buckets and set each key/value pair into new buckets
-		m_iNumEntries = 0;
-		for (TUInt32 iBucket = 0; iBucket < iOldSize; ++iBucket)
+		// Go through old slots and insert each key/value pair into new slots
+		for (TUInt32 iTable = 0; iTable < 2; ++iTable)
 		{
-			while (aOldBuckets[iBucket].size())
+			for (TUInt32 iSlot = 0; iSlot < aOldTables[iTable].iSize; ++iSlot)
 			{
-				SetKeyValue( aOldBuckets[iBucket].front().key, aOldBuckets[iBucket].front().value );
-				aOldBuckets[iBucket].pop_front(); // Delete each old key/value pair after it is copied
+				if (aOldTables[iTable].aProbeLengths[iSlot])
+				{
+					InsertNew( &m_Table, aOldTables[iTable].aSlots[iSlot] );
+				}
 			}
+			Free( &aOldTables[iTable] );
 		}
 
-		delete[] aOldBuckets;
-
 		GEN_ENDGUARD;
 	}
 
+	// Move keys from up to the given number of slots of the old table into the current table
+	// during an incremental resize. Slots are visited in order, removing a key pulls following
+	// keys back (see RemoveSlot), so the current slot is visited again until it is empty. If the
+	// current table fills before all keys are moved, the resize is finished all at once
+	void MigrateSlots( TUInt32 iNumSlots )
+	{
+		while (m_OldTable.iNumEntries > 0 && iNumSlots > 0)
+		{
+			if (m_Table.iNumEntries >= m_Table.iMaxEntries)
+			{
+				Resize( m_Table.iSize ); // Sizes up as necessary, discards old table
+				return;
+			}
+			if (m_OldTable.aProbeLengths[m_iMigrateSlot])
+			{
+				TKeyValuePair pair = m_OldTable.aSlots[m_iMigrateSlot];
+				RemoveSlot( &m_OldTable, m_iMigrateSlot );
+				InsertNew( &m_Table, pair );
+			}
+			else
+			{
+				m_iMigrateSlot = (m_iMigrateSlot + 1) & m_OldTable.iSlotMask;
+			}
+			--iNumSlots;
+		}
+
+		// Discard old table when all keys have been moved
+		if (IsResizing() && m_OldTable.iNumEntries == 0)
+		{
+			Free( &m_OldTable );
+		}
+	}
+
 
 	/*---------------------------------------------------------------------------------------------
 		Data
 	---------------------------------------------------------------------------------------------*/
 
-	TBucket* m_aBuckets;    // Dynamically allocated array of buckets of key/value pairs
-	TUInt32  m_iSize;       // Size (capacity) of the table - number of buckets
-	TUInt32  m_iNumEntries; // Number of key/value pairs in the table
+	// Current table, and during an incremental resize the previous table whose keys are being
+	// moved into the current one (the old table has no slots otherwise)
+	STable  m_Table;
+	STable  m_OldTable;
+	TUInt32 m_iMigrateSlot;       // Next slot of the old table to move into the current table
+	TUInt32 m_iMigrateSlotsPerOp; // Slots of the old table moved per add or remove, 0 if not incremental
 
-	// Hash function to use is stored as a function pointer - converts a key given as a
-	// sequence of bytes into a 4-byte unsigned integer
-	const THashFunction m_kpfHashFunction;
+	// Hash object to use - converts a key into a 4-byte unsigned integer
+	THash m_Hash;
 
-	// If table becomes too full, then it is increased in size to avoid hash collisions. The max
-	// load factor defines how full it needs to be before this happens. In this implementation, the
-	// table is never decreased in size
+	// If table becomes too full, then it is increased in size to keep probe sequences short. The
+	// max load factor defines how full it needs to be before this happens. The table is only
+	// decreased in size on request (ShrinkToFit)
 	const TFloat32 m_kfMaxLoadFactor;
 };
 
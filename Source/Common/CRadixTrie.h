@@ -0,0 +1,443 @@
+/**************************************************************************************************
+	Module:       CRadixTrie.h
+	Author:       agent
+
+	Radix trie (compressed prefix tree) holding values associated with string keys, supporting
+	quick look-up of all values whose keys begin with a given prefix or match a wildcard pattern
+
+	A key may have several values, e.g. entity names to entities where several entities may share
+	a name. This is a template class like CHashTable, see the notes in that file
+
+	Copyright 2026, agent
+**************************************************************************************************/
+
+#ifndef GEN_C_RADIX_TRIE_H_INCLUDED
+#define GEN_C_RADIX_TRIE_H_INCLUDED
+
+#include <string>
+#include <vector>
+#include <algorithm>
+using namespace std;
+
+#include "Defines.h"
+#include "Error.h"
+#include "Utility.h"
+
+namespace gen
+{
+
+/*---------------------------------------------------------------------------------------------
+	CRadixTrie class
+---------------------------------------------------------------------------------------------*/
+
+// Each node of the trie holds a fragment of a key, the key of a node is the fragments of all
+// the nodes on the path from the root down to it. Nodes with a single child and no values are
+// merged into the child, so the depth of the trie is limited by the number of distinct branches
+// in the keys rather than their length. All keys with a given prefix are in a single branch, so
+// finding them visits only that branch rather than every key
+//
+// The value type must have operator== and operator= defined, and a default constructor. Nodes
+// are held in a single array and refer to each other by index, so the trie can be copied
+template <class TValueType>
+class CRadixTrie
+{
+
+/*---------------------------------------------------------------------------------------------
+	Constructors / Destructors
+---------------------------------------------------------------------------------------------*/
+public:
+	// Construct an empty trie
+	CRadixTrie()
+	{
+		Clear();
+	}
+
+	// Default copy constructor, assignment operator and destructor are suitable
+
+
+/*---------------------------------------------------------------------------------------------
+	Public interface
+---------------------------------------------------------------------------------------------*/
+public:
+	// Add a value to the given key. A key may have several values, even equal ones
+	void Insert
+	(
+		const string&     key,
+		const TValueType& value
+	)
+	{
+		TUInt32 node = kiRoot;
+		string::size_type keyPos = 0;
+		while (keyPos < key.length())
+		{
+			// Find child node whose fragment begins with the next key character. If there is
+			// none, add a node with the rest of the key
+			TUInt32 childIndex = FindChild( node, key[keyPos] );
+			if (childIndex == kiNotFound)
+			{
+				TUInt32 newNode = NewNode( key.substr( keyPos ) );
+				m_Nodes[node].children.push_back( newNode );
+				node = newNode;
+				break;
+			}
+			TUInt32 child = m_Nodes[node].children[childIndex];
+
+			// If the child's fragment only partly matches the key, split the child in two at the
+			// point where they differ
+			string::size_type matchLength = MatchLength( m_Nodes[child].fragment, key, keyPos );
+			if (matchLength < m_Nodes[child].fragment.length())
+			{
+				TUInt32 splitNode = NewNode( m_Nodes[child].fragment.substr( 0, matchLength ) );
+				m_Nodes[child].fragment.erase( 0, matchLength );
+				m_Nodes[splitNode].children.push_back( child );
+				m_Nodes[node].children[childIndex] = splitNode;
+				child = splitNode;
+			}
+			node = child;
+			keyPos += matchLength;
+		}
+
+		m_Nodes[node].values.push_back( value );
+		++m_NumValues;
+	}
+
+	// Remove a value from the given key, returns false if the key does not have the value. If
+	// the key has several equal values, only one is removed
+	bool Remove
+	(
+		const string&     key,
+		const TValueType& value
+	)
+	{
+		// Find the node for the key, remembering the parent of each node on the way
+		m_Path.clear();
+		TUInt32 node = kiRoot;
+		string::size_type keyPos = 0;
+		while (keyPos < key.length())
+		{
+			TUInt32 childIndex = FindChild( node, key[keyPos] );
+			if (childIndex == kiNotFound)
+			{
+				return false;
+			}
+			TUInt32 child = m_Nodes[node].children[childIndex];
+			string::size_type matchLength = MatchLength( m_Nodes[child].fragment, key, keyPos );
+			if (matchLength < m_Nodes[child].fragment.length())
+			{
+				return false;
+			}
+			m_Path.push_back( node );
+			node = child;
+			keyPos += matchLength;
+		}
+
+		// Remove the value (order of values is not kept)
+		vector<TValueType>& values = m_Nodes[node].values;
+		typename vector<TValueType>::iterator found = find( values.begin(), values.end(), value );
+		if (found == values.end())
+		{
+			return false;
+		}
+		*found = values.back();
+		values.pop_back();
+		--m_NumValues;
+
+		// Tidy the trie: remove a node left with no values or children, and merge a node left
+		// with no values and one child into the child (a removal can leave a parent with one
+		// child, so repeat for the parent)
+		if (node != kiRoot && values.empty())
+		{
+			if (m_Nodes[node].children.empty())
+			{
+				TUInt32 parent = m_Path.back();
+				RemoveChild( parent, node );
+				FreeNode( node );
+				node = parent;
+			}
+			if (node != kiRoot && m_Nodes[node].values.empty() && m_Nodes[node].children.size() == 1)
+			{
+				MergeChild( node );
+			}
+		}
+		return true;
+	}
+
+	// Remove all keys and values
+	void Clear()
+	{
+		m_Nodes.clear();
+		m_FreeNodes.clear();
+		m_Nodes.push_back( SNode() ); // Root node, for the empty key
+		m_NumValues = 0;
+	}
+
+
+	// Return the total number of values held
+	TUInt32 NumValues() const
+	{
+		return m_NumValues;
+	}
+
+
+	// Add the values of the given key to the end of the given vector
+	void Find
+	(
+		const string&       key,
+		vector<TValueType>& values
+	) const
+	{
+		string::size_type fragmentPos;
+		TUInt32 node = FindPrefixNode( key, &fragmentPos );
+		if (node != kiNotFound && fragmentPos == m_Nodes[node].fragment.length())
+		{
+			values.insert( values.end(), m_Nodes[node].values.begin(), m_Nodes[node].values.end() );
+		}
+	}
+
+	// Add the values of all keys beginning with the given prefix to the end of the given vector
+	void FindPrefix
+	(
+		const string&       prefix,
+		vector<TValueType>& values
+	) const
+	{
+		string::size_type fragmentPos;
+		TUInt32 node = FindPrefixNode( prefix, &fragmentPos );
+		if (node != kiNotFound)
+		{
+			AddBranchValues( node, values );
+		}
+	}
+
+	// Add the values of all keys matching the given wildcard pattern (see WildcardMatch in
+	// Utility.h) to the end of the given vector. Only the branch of keys beginning with the part of
+	// the pattern before the first wildcard is visited
+	void FindMatching
+	(
+		const string&       pattern,
+		vector<TValueType>& values
+	) const
+	{
+		// Patterns that are a simple key or prefix don't need to match each key
+		string prefix = WildcardPrefix( pattern );
+		if (prefix.length() == pattern.length())
+		{
+			Find( pattern, values );
+			return;
+		}
+		if (pattern.length() == prefix.length() + 1 && pattern[prefix.length()] == '*')
+		{
+			FindPrefix( prefix, values );
+			return;
+		}
+
+		// Find the branch for the prefix then match the pattern against each key in the branch
+		string::size_type fragmentPos;
+		TUInt32 node = FindPrefixNode( prefix, &fragmentPos );
+		if (node != kiNotFound)
+		{
+			string key = prefix + m_Nodes[node].fragment.substr( fragmentPos );
+			AddMatchingValues( node, pattern, key, values );
+		}
+	}
+
+
+/*-----------------------------------------------------------------------------------------
+	Private interface
+-----------------------------------------------------------------------------------------*/
+private:
+
+	/*---------------------------------------------------------------------------------------------
+		Types and constants
+	---------------------------------------------------------------------------------------------*/
+
+	// A node in the trie
+	struct SNode
+	{
+		string             fragment; // Part of the key added by this node
+		vector<TUInt32>    children; // Indexes of child nodes, their fragments begin with different characters
+		vector<TValueType> values;   // Values of the key ending at this node
+	};
+
+	static const TUInt32 kiRoot = 0;
+	static const TUInt32 kiNotFound = 0xffffffff;
+
+
+	/*---------------------------------------------------------------------------------------------
+		Support functions
+	---------------------------------------------------------------------------------------------*/
+
+	// Return the number of characters of the given fragment that match the key from the given
+	// position
+	static string::size_type MatchLength
+	(
+		const string&           fragment,
+		const string&           key,
+		const string::size_type keyPos
+	)
+	{
+		string::size_type length = 0;
+		while (length < fragment.length() && keyPos + length < key.length() &&
+		       fragment[length] == key[keyPos + length])
+		{
+			++length;
+		}
+		return length;
+	}
+
+	// Return the position in the children of the given node of the child whose fragment begins
+	// with the given character, or kiNotFound if none
+	TUInt32 FindChild
+	(
+		const TUInt32 node,
+		const char    firstChar
+	) const
+	{
+		const vector<TUInt32>& children = m_Nodes[node].children;
+		for (TUInt32 child = 0; child < children.size(); ++child)
+		{
+			if (m_Nodes[children[child]].fragment[0] == firstChar)
+			{
+				return child;
+			}
+		}
+		return kiNotFound;
+	}
+
+	// Find the node whose branch holds all keys beginning with the given prefix, or kiNotFound
+	// if there are none. The prefix may end part way through the node's fragment, returns the
+	// position in the fragment where it ends
+	TUInt32 FindPrefixNode
+	(
+		const string&      prefix,
+		string::size_type* pFragmentPos
+	) const
+	{
+		TUInt32 node = kiRoot;
+		*pFragmentPos = 0;
+		string::size_type prefixPos = 0;
+		while (prefixPos < prefix.length())
+		{
+			TUInt32 childIndex = FindChild( node, prefix[prefixPos] );
+			if (childIndex == kiNotFound)
+			{
+				return kiNotFound;
+			}
+			node = m_Nodes[node].children[childIndex];
+			*pFragmentPos = MatchLength( m_Nodes[node].fragment, prefix, prefixPos );
+			prefixPos += *pFragmentPos;
+			if (prefixPos < prefix.length() && *pFragmentPos < m_Nodes[node].fragment.length())
+			{
+				return kiNotFound; // Prefix differs from fragment
+			}
+		}
+		return node;
+	}
+
+	// Add the values of all keys in the branch from the given node to the given vector
+	void AddBranchValues
+	(
+		const TUInt32       node,
+		vector<TValueType>& values
+	) const
+	{
+		values.insert( values.end(), m_Nodes[node].values.begin(), m_Nodes[node].values.end() );
+		for (TUInt32 child = 0; child < m_Nodes[node].children.size(); ++child)
+		{
+			AddBranchValues( m_Nodes[node].children[child], values );
+		}
+	}
+
+	// Add the values of keys matching the given pattern in the branch from the given node to the
+	// given vector. Pass the key of the node
+	void AddMatchingValues
+	(
+		const TUInt32       node,
+		const string&       pattern,
+		string&             key,
+		vector<TValueType>& values
+	) const
+	{
+		if (!m_Nodes[node].values.empty() && WildcardMatch( key, pattern ))
+		{
+			values.insert( values.end(), m_Nodes[node].values.begin(), m_Nodes[node].values.end() );
+		}
+		for (TUInt32 child = 0; child < m_Nodes[node].children.size(); ++child)
+		{
+			const string& fragment = m_Nodes[m_Nodes[node].children[child]].fragment;
+			key += fragment;
+			AddMatchingValues( m_Nodes[node].children[child], pattern, key, values );
+			key.erase( key.length() - fragment.length() );
+		}
+	}
+
+
+	// Remove the given child from the children of a node
+	void RemoveChild
+	(
+		const TUInt32 node,
+		const TUInt32 child
+	)
+	{
+		vector<TUInt32>& children = m_Nodes[node].children;
+		*find( children.begin(), children.end(), child ) = children.back();
+		children.pop_back();
+	}
+
+	// Merge the only child of the given node into the node
+	void MergeChild( const TUInt32 node )
+	{
+		TUInt32 child = m_Nodes[node].children[0];
+		m_Nodes[node].fragment += m_Nodes[child].fragment;
+		m_Nodes[node].children.swap( m_Nodes[child].children );
+		m_Nodes[node].values.swap( m_Nodes[child].values );
+		FreeNode( child );
+	}
+
+	// Return the index of an unused node with the given fragment
+	TUInt32 NewNode( const string& fragment )
+	{
+		TUInt32 node;
+		if (!m_FreeNodes.empty())
+		{
+			node = m_FreeNodes.back();
+			m_FreeNodes.pop_back();
+		}
+		else
+		{
+			node = static_cast<TUInt32>(m_Nodes.size());
+			m_Nodes.push_back( SNode() );
+		}
+		m_Nodes[node].fragment = fragment;
+		return node;
+	}
+
+	// Return the given node to the list of unused nodes
+	void FreeNode( const TUInt32 node )
+	{
+		m_Nodes[node].fragment.clear();
+		m_Nodes[node].children.clear();
+		m_Nodes[node].values.clear();
+		m_FreeNodes.push_back( node );
+	}
+
+
+	/*---------------------------------------------------------------------------------------------
+		Data
+	---------------------------------------------------------------------------------------------*/
+
+	// Nodes of the trie, the root (for the empty key) is the first. Indexes of unused nodes are
+	// kept for reuse
+	vector<SNode>   m_Nodes;
+	vector<TUInt32> m_FreeNodes;
+
+	TUInt32 m_NumValues;
+
+	// Path of nodes followed by Remove, kept to avoid reallocation
+	vector<TUInt32> m_Path;
+};
+
+
+} // namespace gen
+
+#endif // GEN_C_RADIX_TRIE_H_INCLUDED
@@ -0,0 +1,40 @@
+/**************************************************************************************************
+	Module:       GCCDefines.cpp
+	Author:       agent
+	Date created: 16/10/26
+
+	Utility functions for GCC and Clang on non-Windows platforms
+
+	Copyright 2026, agent
+
+	Change history:
+		V1.0    Created 16/10/26 - AG
+**************************************************************************************************/
+
+#include <cstdio>
+
+#include "Defines.h"
+#include "GCCDefines.h"
+
+namespace gen
+{
+
+/*------------------------------------------------------------------------------------------------
+	Console support
+ ------------------------------------------------------------------------------------------------*/
+
+// Equivalent of the system message box on Windows, writes the message to stderr instead. There
+// is no user to answer, so Yes/No questions return false (No)
+bool SystemMessageBox
+(
+	const string& sMessage, // Main message to display
+	const string& sCaption, // Caption to display before message
+	const bool    bYesNo    // Message is a Yes/No question
+)
+{
+	fprintf( stderr, "%s: %s\n", sCaption.c_str(), sMessage.c_str() );
+	return !bYesNo;
+}
+
+
+} // namespace gen
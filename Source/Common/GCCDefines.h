@@ -0,0 +1,99 @@
+/**************************************************************************************************
+	Module:       GCCDefines.h
+	Author:       agent
+	Date created: 16/10/26
+
+	Definitions for GCC and Clang on Linux and other non-Windows platforms. Only supports
+	headless code (the maths library, benchmarks etc.), the renderer requires Windows & D3D
+
+	Copyright 2026, agent
+
+	Change history:
+		V1.0    Created 16/10/26 - AG
+**************************************************************************************************/
+
+#ifndef GEN_GCC_DEFINES_H_INCLUDED
+#define GEN_GCC_DEFINES_H_INCLUDED
+
+#include <string>
+using namespace std;
+
+namespace gen
+{
+
+/*------------------------------------------------------------------------------------------------
+	Compiler settings
+ ------------------------------------------------------------------------------------------------*/
+
+// Check compiler version - C++11 is required (constexpr, delegating constructors)
+#if __cplusplus < 201103L
+	#error "Compiler version not supported - use GCC 4.8 / Clang 3.3 or better with -std=c++11"
+#endif
+
+// Check compiler options
+#if !defined(__EXCEPTIONS) && !defined(__cpp_exceptions)
+	#error "Bad compiler option: C++ exception handling must be enabled"
+#endif
+
+
+/*------------------------------------------------------------------------------------------------
+	Macros
+ ------------------------------------------------------------------------------------------------*/
+
+// Prefix to align a structure or class in memory to a multiple of the given amount
+#define GEN_ALIGN(a) __attribute__((aligned(a)))
+
+
+/*------------------------------------------------------------------------------------------------
+	Constants
+ ------------------------------------------------------------------------------------------------*/
+
+// Define compiler name
+#if defined(__clang__)
+	static const string ksCompiler = "Clang " __clang_version__;
+#else
+	static const string ksCompiler = "GCC " __VERSION__;
+#endif
+
+
+// String locale
+const string ksPathSeparator = "/";
+const string ksNewline = "\n";
+
+
+/*------------------------------------------------------------------------------------------------
+	Types
+ ------------------------------------------------------------------------------------------------*/
+
+// Typedefs for fixed size types
+typedef signed char        TInt8;
+typedef signed short       TInt16;
+typedef signed int         TInt32;
+typedef signed long long   TInt64;
+
+typedef unsigned char      TUInt8;
+typedef unsigned short     TUInt16;
+typedef unsigned int       TUInt32;
+typedef unsigned long long TUInt64;
+
+typedef float              TFloat32;
+typedef double             TFloat64;
+
+
+/*------------------------------------------------------------------------------------------------
+	Console support
+ ------------------------------------------------------------------------------------------------*/
+
+// Equivalent of the system message box on Windows, writes the message to stderr instead. There
+// is no user to answer, so Yes/No questions return false (No)
+bool SystemMessageBox
+(
+	const string& sMessage,                       // Main message to display
+	const string& sCaption = "TL-Engine Extreme", // Caption to display before message
+	const bool    bYesNo = false                  // Message is a Yes/No question
+);
+
+
+} // namespace gen
+
+#endif // GEN_GCC_DEFINES_H_INCLUDED
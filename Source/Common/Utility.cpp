@@ -57,4 +57,58 @@ string LastDelimitedSubstr
 }
 
 
+// Return true if a string matches a wildcard pattern, where '*' matches any sequence of
+// characters (including none) and '?' matches any single character
+bool WildcardMatch
+(
+	const string& sString,
+	const string& sPattern
+)
+{
+	// Match characters in turn. On a mismatch, return to the last '*' and let it match one more
+	// character. Only the last '*' needs to be retried, so this takes linear time in practice
+	string::size_type stringPos = 0, patternPos = 0;
+	string::size_type starPos = string::npos, starStringPos = 0;
+	while (stringPos < sString.length())
+	{
+		if (patternPos < sPattern.length() &&
+		    (sPattern[patternPos] == '?' || sPattern[patternPos] == sString[stringPos]))
+		{
+			++stringPos;
+			++patternPos;
+		}
+		else if (patternPos < sPattern.length() && sPattern[patternPos] == '*')
+		{
+			starPos = patternPos++;
+			starStringPos = stringPos;
+		}
+		else if (starPos != string::npos)
+		{
+			patternPos = starPos + 1;
+			stringPos = ++starStringPos;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	// String used up, only '*'s may remain in pattern
+	while (patternPos < sPattern.length() && sPattern[patternPos] == '*')
+	{
+		++patternPos;
+	}
+	return patternPos == sPattern.length();
+}
+
+// Return the part of a wildcard pattern before the first wildcard character
+string WildcardPrefix
+(
+	const string& sPattern
+)
+{
+	return sPattern.substr( 0, sPattern.find_first_of( "*?" ) );
+}
+
+
 } // namespace gen
@@ -97,6 +97,22 @@ string LastDelimitedSubstr
 	const string& sDelimiter
 );
 
+// Return true if a string matches a wildcard pattern, where '*' matches any sequence of
+// characters (including none) and '?' matches any single character. E.g. "Ship*" matches all
+// strings beginning with "Ship"
+bool WildcardMatch
+(
+	const string& sString,
+	const string& sPattern
+);
+
+// Return the part of a wildcard pattern before the first wildcard character - all strings that
+// match the pattern begin with this prefix
+string WildcardPrefix
+(
+	const string& sPattern
+);
+
 
 } // namespace gen
 
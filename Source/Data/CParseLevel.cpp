@@ -18,7 +18,11 @@ namespace gen
 ---------------------------------------------------------------------------------------------*/
 
 // Constructor initialises state variables
-CParseLevel::CParseLevel( CEntityManager* entityManager )
+CParseLevel::CParseLevel
+(
+	CEntityManager* entityManager,
+	const TUInt64   randomSeed /*= kiDefaultRandomSeed*/
+) : m_Random( randomSeed )
 {
 	// Take copy of entity manager for creation
 	m_EntityManager = entityManager;
@@ -30,6 +34,9 @@ CParseLevel::CParseLevel( CEntityManager* entityManager )
 	m_TemplateType = "";
 	m_TemplateName = "";
 	m_TemplateMesh = "";
+	m_TemplateOccluder = false;
+	m_TemplateLODMeshes = "";
+	m_TemplateCompactVertices = false;
 
 	// Entity state
 	m_EntityType = "";
@@ -58,6 +65,12 @@ void CParseLevel::StartElt( const string& eltName, SAttribute* attrs )
 	else if (eltName == "Entities")
 	{
 		m_CurrentSection = Entities;
+
+		// Optional seed for the level's random numbers
+		if (GetAttribute( attrs, "Seed" ) != "")
+		{
+			m_Random.Seed( static_cast<TUInt32>(GetAttributeInt( attrs, "Seed" )) );
+		}
 	}
 
 	// Different parsing depending on section currently being read
@@ -109,6 +122,15 @@ void CParseLevel::TemplatesStartElt( const string& eltName, SAttribute* attrs )
 		m_TemplateType = GetAttribute( attrs, "Type" );
 		m_TemplateName = GetAttribute( attrs, "Name" );
 		m_TemplateMesh = GetAttribute( attrs, "Mesh" );
+
+		// Optional flag to use entities of this template as occluders for occlusion culling
+		m_TemplateOccluder = (GetAttribute( attrs, "Occluder" ) == "True");
+
+		// Optional comma-separated list of lower detail meshes, in order of decreasing detail
+		m_TemplateLODMeshes = GetAttribute( attrs, "LODMeshes" );
+
+		// Optional flag to store the mesh vertices (including lower details) in compact format
+		m_TemplateCompactVertices = (GetAttribute( attrs, "CompactVertices" ) == "True");
 	}
 }
 
@@ -181,9 +203,9 @@ void CParseLevel::EntitiesStartElt( const string& eltName, SAttribute* attrs )
 		float randomX = GetAttributeFloat( attrs, "X" ) * 0.5f;
 		float randomY = GetAttributeFloat( attrs, "Y" ) * 0.5f;
 		float randomZ = GetAttributeFloat( attrs, "Z" ) * 0.5f;
-		m_Pos.x += Random( -randomX, randomX );
-		m_Pos.y += Random( -randomY, randomY );
-		m_Pos.z += Random( -randomZ, randomZ );
+		m_Pos.x += m_Random.Float( -randomX, randomX );
+		m_Pos.y += m_Random.Float( -randomY, randomY );
+		m_Pos.z += m_Random.Float( -randomZ, randomZ );
 	}
 }
 
@@ -208,7 +230,26 @@ void CParseLevel::CreateEntityTemplate()
 	// Initialise the template depending on its type
 
 	// Generic template
-	m_EntityManager->CreateTemplate( m_TemplateType, m_TemplateName, m_TemplateMesh );
+	CEntityTemplate* newTemplate =
+		m_EntityManager->CreateTemplate( m_TemplateType, m_TemplateName, m_TemplateMesh,
+		                                 m_TemplateCompactVertices );
+	newTemplate->SetOccluder( m_TemplateOccluder );
+
+	// Add each lower level of detail mesh from the comma-separated list
+	string::size_type start = 0;
+	while (start < m_TemplateLODMeshes.length())
+	{
+		string::size_type end = m_TemplateLODMeshes.find( ',', start );
+		if (end == string::npos)
+		{
+			end = m_TemplateLODMeshes.length();
+		}
+		if (end > start)
+		{
+			newTemplate->AddLODMesh( m_TemplateLODMeshes.substr( start, end - start ) );
+		}
+		start = end + 1;
+	}
 }
 
 // Create an entity using data collected from parsed XML elements
@@ -14,6 +14,7 @@ using namespace std;
 
 #include "Defines.h"
 #include "CVector3.h"
+#include "CRandom.h"
 #include "EntityManager.h"
 #include "CParseXML.h"
 
@@ -36,8 +37,10 @@ class CParseLevel : public CParseXML
 	Constructors / Destructors
 ---------------------------------------------------------------------------------------------*/
 public:
-	// Constructor gets a pointer to the entity manager and initialises state variables
-	CParseLevel( CEntityManager* entityManager );
+	// Constructor gets a pointer to the entity manager and initialises state variables. Optionally
+	// pass the seed for the random numbers used by the level (e.g. Randomise elements). A Seed
+	// attribute on the Entities element of the level file replaces this seed
+	CParseLevel( CEntityManager* entityManager, const TUInt64 randomSeed = kiDefaultRandomSeed );
 
 	
 /*-----------------------------------------------------------------------------------------
@@ -112,10 +115,16 @@ private:
 	// File state
 	EFileSection m_CurrentSection;
 
+	// Random numbers for the level, the same seed always gives the same level
+	CRandom m_Random;
+
 	// Current template state (i.e. latest values read during parsing)
 	string   m_TemplateType;
 	string   m_TemplateName;
 	string   m_TemplateMesh;
+	bool     m_TemplateOccluder;
+	string   m_TemplateLODMeshes;
+	bool     m_TemplateCompactVertices;
 	TUInt32  m_ShipHP;
 	TFloat32 m_ShipMaxSpeed;
 	TFloat32 m_ShipAcceleration;
@@ -20,6 +20,7 @@
 
 #include "Defines.h"
 #include "Error.h"
+#include "CRandom.h"
 
 //TODO
 // Vectors: Hermite / Catmull-Rom, Lerp, Barycentric
@@ -76,7 +77,11 @@ enum ERoundingMethod
 // Many versions provided here to allow mixing of parameter types for these basic functions
 
 inline TUInt32 Abs( const TInt32 x ) { return abs( static_cast<int>(x) ); }
+#if defined(_MSC_VER)
 inline TUInt64 Abs( const TInt64 x ) { return _abs64( x ); }
+#else
+inline TUInt64 Abs( const TInt64 x ) { return llabs( x ); }
+#endif
 inline TFloat32 Abs( const TFloat32 x ) { return fabsf( x ); }
 inline TFloat64 Abs( const TFloat64 x ) { return fabs( x ); }
 
@@ -470,31 +475,26 @@ template <class C>
 inline C Max( const C a, const C b ) { return (!(b < a) ? b : a); }
 
 
-// Return random integer from a to b (inclusive)
-// Can only return up to RAND_MAX different values, spread evenly across the given range
-// RAND_MAX is defined in stdlib.h and is compiler-specific (32767 on VS-2005, higher elsewhere)
+// Return random integer from a to b (inclusive), each equally likely
+// Uses the calling thread's default generator (see CRandom.h), so results are reproducible from
+// run to run. Use a separate CRandom object for sequences that must not depend on other code
 inline TInt32 Random( const TInt32 a, const TInt32 b )
 {
-	// Could just use a + rand() % (b-a), but using a more complex form to allow range
-	// to exceed RAND_MAX and still return values spread across the range
-	TInt32 t = (b - a + 1) * rand();
-	return t == 0 ? a : a + (t - 1) / RAND_MAX;
+	return ThreadRandom().Int( a, b );
 }
 
-// Return random 32-bit float from a to b (inclusive)
-// Can only return up to RAND_MAX different values, spread evenly across the given range
-// RAND_MAX is defined in stdlib.h and is compiler-specific (32767 on VS-2005, higher elsewhere)
+// Return random 32-bit float from a to b (excluding b)
+// Uses the calling thread's default generator (see CRandom.h)
 inline TFloat32 Random( const TFloat32 a, const TFloat32 b )
 {
-	return a + (b - a) * (static_cast<TFloat32>(rand()) / RAND_MAX);
+	return ThreadRandom().Float( a, b );
 }
 
-// Return random 64-bit float from a to b (inclusive)
-// Can only return up to RAND_MAX different values, spread evenly across the given range
-// RAND_MAX is defined in stdlib.h and is compiler-specific (32767 on VS-2005, higher elsewhere)
+// Return random 64-bit float from a to b (excluding b)
+// Uses the calling thread's default generator (see CRandom.h)
 inline TFloat64 Random( const TFloat64 a, const TFloat64 b )
 {
-	return a + (b - a) * (static_cast<TFloat64>(rand()) / RAND_MAX);
+	return ThreadRandom().Double( a, b );
 }
 
 
@@ -0,0 +1,608 @@
+/**************************************************************************************************
+	Module:       CAABBTree.cpp
+	Author:       agent
+	Date created: 16/10/26
+
+	Implementation of the concrete class CAABBTree, a dynamic bounding volume hierarchy of axis
+	aligned bounding boxes for fast spatial queries over many moving objects
+
+	Copyright 2026, agent
+
+	Change history:
+		V1.0    Created 16/10/26 - AG
+**************************************************************************************************/
+
+#include "CAABBTree.h"
+
+#include "BaseMath.h"
+#include "Error.h"
+
+namespace gen
+{
+
+/*-----------------------------------------------------------------------------------------
+	Box Helpers
+-----------------------------------------------------------------------------------------*/
+
+// Get the box containing two boxes
+inline void CombineBoxes
+(
+	const CVector3& min1,
+	const CVector3& max1,
+	const CVector3& min2,
+	const CVector3& max2,
+	CVector3*       pMin,
+	CVector3*       pMax
+)
+{
+	pMin->Set( Min( min1.x, min2.x ), Min( min1.y, min2.y ), Min( min1.z, min2.z ) );
+	pMax->Set( Max( max1.x, max2.x ), Max( max1.y, max2.y ), Max( max1.z, max2.z ) );
+}
+
+// Return half the surface area of a box - the cost of a box in the surface area heuristic
+inline TFloat32 BoxCost
+(
+	const CVector3& minBounds,
+	const CVector3& maxBounds
+)
+{
+	CVector3 size = maxBounds - minBounds;
+	return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+
+// Return half the surface area of the box containing two boxes
+inline TFloat32 CombinedBoxCost
+(
+	const CVector3& min1,
+	const CVector3& max1,
+	const CVector3& min2,
+	const CVector3& max2
+)
+{
+	CVector3 combinedMin, combinedMax;
+	CombineBoxes( min1, max1, min2, max2, &combinedMin, &combinedMax );
+	return BoxCost( combinedMin, combinedMax );
+}
+
+// Return true if the first box contains the second
+inline bool BoxContains
+(
+	const CVector3& outerMin,
+	const CVector3& outerMax,
+	const CVector3& innerMin,
+	const CVector3& innerMax
+)
+{
+	return outerMin.x <= innerMin.x && outerMin.y <= innerMin.y && outerMin.z <= innerMin.z &&
+	       innerMax.x <= outerMax.x && innerMax.y <= outerMax.y && innerMax.z <= outerMax.z;
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Constructors/Destructors
+-----------------------------------------------------------------------------------------*/
+
+// Construct an empty tree. Optionally pass the enlargement of leaf boxes as a fraction of the
+// largest dimension of each object's box
+CAABBTree::CAABBTree( const TFloat32 margin /*= kfAABBTreeDefaultMargin*/ )
+{
+	GEN_GUARD;
+
+	GEN_ASSERT( margin >= 0.0f, "Invalid parameter" );
+	m_Margin = margin;
+	m_Root = kiAABBTreeNull;
+	m_FreeList = kiAABBTreeNull;
+	m_NumLeaves = 0;
+
+	GEN_ENDGUARD;
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Objects
+-----------------------------------------------------------------------------------------*/
+
+// Add an object with the given bounding box and user value. Returns a proxy used to refer to
+// the object in the other functions
+TUInt32 CAABBTree::Insert
+(
+	const CVector3& minBounds,
+	const CVector3& maxBounds,
+	const TUInt32   userData
+)
+{
+	TUInt32 leaf = AllocateNode();
+	SNode& leafNode = m_Nodes[leaf];
+	leafNode.objectMin = minBounds;
+	leafNode.objectMax = maxBounds;
+	leafNode.child1 = kiAABBTreeNull;
+	leafNode.child2 = kiAABBTreeNull;
+	leafNode.height = 0;
+	leafNode.userData = userData;
+
+	// Enlarge box so small movements don't require reinsertion
+	CVector3 size = maxBounds - minBounds;
+	TFloat32 margin = m_Margin * Max( size.x, Max( size.y, size.z ) );
+	CVector3 marginVector( margin, margin, margin );
+	leafNode.minBounds = minBounds - marginVector;
+	leafNode.maxBounds = maxBounds + marginVector;
+
+	InsertLeaf( leaf );
+	++m_NumLeaves;
+	return leaf;
+}
+
+// Remove the object with the given proxy from the tree
+void CAABBTree::Remove( const TUInt32 proxy )
+{
+	GEN_ASSERT_OPT( proxy < m_Nodes.size() && m_Nodes[proxy].height == 0, "Invalid proxy" );
+
+	RemoveLeaf( proxy );
+	FreeNode( proxy );
+	--m_NumLeaves;
+}
+
+// Set a new bounding box for the object with the given proxy. Cheap if the new box is inside
+// the object's enlarged box in the tree, otherwise the object is reinserted. Returns true if
+// the object was reinserted
+bool CAABBTree::Move
+(
+	const TUInt32   proxy,
+	const CVector3& minBounds,
+	const CVector3& maxBounds
+)
+{
+	GEN_ASSERT_OPT( proxy < m_Nodes.size() && m_Nodes[proxy].height == 0, "Invalid proxy" );
+
+	SNode& leafNode = m_Nodes[proxy];
+	leafNode.objectMin = minBounds;
+	leafNode.objectMax = maxBounds;
+	if (BoxContains( leafNode.minBounds, leafNode.maxBounds, minBounds, maxBounds ))
+	{
+		return false;
+	}
+
+	// Reinsert with a new enlarged box
+	RemoveLeaf( proxy );
+	CVector3 size = maxBounds - minBounds;
+	TFloat32 margin = m_Margin * Max( size.x, Max( size.y, size.z ) );
+	CVector3 marginVector( margin, margin, margin );
+	leafNode.minBounds = minBounds - marginVector;
+	leafNode.maxBounds = maxBounds + marginVector;
+	InsertLeaf( proxy );
+	return true;
+}
+
+// Remove all objects
+void CAABBTree::Clear()
+{
+	m_Nodes.clear();
+	m_Root = kiAABBTreeNull;
+	m_FreeList = kiAABBTreeNull;
+	m_NumLeaves = 0;
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Queries
+-----------------------------------------------------------------------------------------*/
+
+// Find objects not outside any of a set of planes, e.g. the planes of a viewing frustum. Each
+// plane is given as a normal and a distance, so that points p on the plane have
+// Dot(p, normal) == distance, with the normal pointing away from the inside. A box is outside
+// if it is entirely in front of any plane. Branches entirely behind a plane are not tested
+// against that plane again
+void CAABBTree::QueryPlanes
+(
+	const CVector3*   pNormals,
+	const TFloat32*   pDistances,
+	const TUInt32     numPlanes,
+	vector<TUInt32>&  results
+)
+{
+	GEN_ASSERT_OPT( numPlanes <= kiAABBTreeMaxPlanes, "Too many planes" );
+	if (m_Root == kiAABBTreeNull)
+	{
+		return;
+	}
+
+	SQueryNode rootEntry = { m_Root, numPlanes == 32 ? 0xffffffff : (1u << numPlanes) - 1 };
+	m_QueryStack.push_back( rootEntry );
+	while (!m_QueryStack.empty())
+	{
+		SQueryNode entry = m_QueryStack.back();
+		m_QueryStack.pop_back();
+		const SNode& node = m_Nodes[entry.node];
+
+		// Test leaves with the exact object box
+		const CVector3& minBounds = node.IsLeaf() ? node.objectMin : node.minBounds;
+		const CVector3& maxBounds = node.IsLeaf() ? node.objectMax : node.maxBounds;
+
+		// Test the box against each plane that the parent was not entirely behind
+		bool isOutside = false;
+		for (TUInt32 plane = 0; plane < numPlanes && !isOutside; ++plane)
+		{
+			if (entry.planeMask & (1u << plane))
+			{
+				// Find the box corners nearest to and furthest from the outside of the plane
+				const CVector3& normal = pNormals[plane];
+				CVector3 insidePoint( normal.x >= 0.0f ? minBounds.x : maxBounds.x,
+				                      normal.y >= 0.0f ? minBounds.y : maxBounds.y,
+				                      normal.z >= 0.0f ? minBounds.z : maxBounds.z );
+				CVector3 outsidePoint( normal.x >= 0.0f ? maxBounds.x : minBounds.x,
+				                       normal.y >= 0.0f ? maxBounds.y : minBounds.y,
+				                       normal.z >= 0.0f ? maxBounds.z : minBounds.z );
+				if (Dot( insidePoint, normal ) > pDistances[plane])
+				{
+					isOutside = true;
+				}
+				else if (Dot( outsidePoint, normal ) <= pDistances[plane])
+				{
+					// Box entirely behind plane, so are its children
+					entry.planeMask &= ~(1u << plane);
+				}
+			}
+		}
+		if (isOutside)
+		{
+			continue;
+		}
+
+		if (node.IsLeaf())
+		{
+			results.push_back( node.userData );
+		}
+		else
+		{
+			SQueryNode child1Entry = { node.child1, entry.planeMask };
+			SQueryNode child2Entry = { node.child2, entry.planeMask };
+			m_QueryStack.push_back( child1Entry );
+			m_QueryStack.push_back( child2Entry );
+		}
+	}
+}
+
+// Find objects whose box is within the given radius of a point
+void CAABBTree::QueryRadius
+(
+	const CVector3&   centre,
+	const TFloat32    radius,
+	vector<TUInt32>&  results
+)
+{
+	if (m_Root == kiAABBTreeNull)
+	{
+		return;
+	}
+
+	TFloat32 radiusSq = radius * radius;
+	SQueryNode rootEntry = { m_Root, 0 };
+	m_QueryStack.push_back( rootEntry );
+	while (!m_QueryStack.empty())
+	{
+		const SNode& node = m_Nodes[m_QueryStack.back().node];
+		m_QueryStack.pop_back();
+		const CVector3& minBounds = node.IsLeaf() ? node.objectMin : node.minBounds;
+		const CVector3& maxBounds = node.IsLeaf() ? node.objectMax : node.maxBounds;
+
+		// Squared distance from the centre to the nearest point in the box
+		CVector3 nearestPoint( Max( minBounds.x, Min( centre.x, maxBounds.x ) ),
+		                       Max( minBounds.y, Min( centre.y, maxBounds.y ) ),
+		                       Max( minBounds.z, Min( centre.z, maxBounds.z ) ) );
+		if ((nearestPoint - centre).LengthSquared() > radiusSq)
+		{
+			continue;
+		}
+
+		if (node.IsLeaf())
+		{
+			results.push_back( node.userData );
+		}
+		else
+		{
+			SQueryNode child1Entry = { node.child1, 0 };
+			SQueryNode child2Entry = { node.child2, 0 };
+			m_QueryStack.push_back( child1Entry );
+			m_QueryStack.push_back( child2Entry );
+		}
+	}
+}
+
+// Find objects whose box is hit by a ray starting at the given point, within the given
+// distance along the ray. The direction need not be normalised, the distance is measured in
+// lengths of the direction vector
+void CAABBTree::QueryRay
+(
+	const CVector3&   origin,
+	const CVector3&   direction,
+	const TFloat32    maxDistance,
+	vector<TUInt32>&  results
+)
+{
+	if (m_Root == kiAABBTreeNull)
+	{
+		return;
+	}
+
+	// Ray is tested against the slabs between each pair of opposite box faces. Precalculate
+	// reciprocals of the direction, axes parallel to the ray are handled separately
+	const TFloat32 originCoords[3] = { origin.x, origin.y, origin.z };
+	const TFloat32 directionCoords[3] = { direction.x, direction.y, direction.z };
+	TFloat32 invDirection[3];
+	for (TUInt32 axis = 0; axis < 3; ++axis)
+	{
+		invDirection[axis] = directionCoords[axis] != 0.0f ? 1.0f / directionCoords[axis] : 0.0f;
+	}
+
+	SQueryNode rootEntry = { m_Root, 0 };
+	m_QueryStack.push_back( rootEntry );
+	while (!m_QueryStack.empty())
+	{
+		const SNode& node = m_Nodes[m_QueryStack.back().node];
+		m_QueryStack.pop_back();
+		const CVector3& minBounds = node.IsLeaf() ? node.objectMin : node.minBounds;
+		const CVector3& maxBounds = node.IsLeaf() ? node.objectMax : node.maxBounds;
+		const TFloat32 minCoords[3] = { minBounds.x, minBounds.y, minBounds.z };
+		const TFloat32 maxCoords[3] = { maxBounds.x, maxBounds.y, maxBounds.z };
+
+		// Narrow the range of distances along the ray inside each slab in turn
+		TFloat32 enter = 0.0f;
+		TFloat32 exit = maxDistance;
+		for (TUInt32 axis = 0; axis < 3 && enter <= exit; ++axis)
+		{
+			if (directionCoords[axis] == 0.0f)
+			{
+				// Parallel to slab - hits only if origin is inside it
+				if (originCoords[axis] < minCoords[axis] || originCoords[axis] > maxCoords[axis])
+				{
+					exit = -1.0f;
+				}
+			}
+			else
+			{
+				TFloat32 t1 = (minCoords[axis] - originCoords[axis]) * invDirection[axis];
+				TFloat32 t2 = (maxCoords[axis] - originCoords[axis]) * invDirection[axis];
+				enter = Max( enter, Min( t1, t2 ) );
+				exit = Min( exit, Max( t1, t2 ) );
+			}
+		}
+		if (enter > exit)
+		{
+			continue;
+		}
+
+		if (node.IsLeaf())
+		{
+			results.push_back( node.userData );
+		}
+		else
+		{
+			SQueryNode child1Entry = { node.child1, 0 };
+			SQueryNode child2Entry = { node.child2, 0 };
+			m_QueryStack.push_back( child1Entry );
+			m_QueryStack.push_back( child2Entry );
+		}
+	}
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Private interface
+-----------------------------------------------------------------------------------------*/
+
+// Get a node from the free list, or add a new node. Returns its index
+TUInt32 CAABBTree::AllocateNode()
+{
+	if (m_FreeList == kiAABBTreeNull)
+	{
+		m_Nodes.push_back( SNode() );
+		m_Nodes.back().height = -1;
+		m_FreeList = static_cast<TUInt32>(m_Nodes.size() - 1);
+		m_Nodes.back().parent = kiAABBTreeNull;
+	}
+
+	TUInt32 node = m_FreeList;
+	m_FreeList = m_Nodes[node].parent;
+	m_Nodes[node].parent = kiAABBTreeNull;
+	m_Nodes[node].child1 = kiAABBTreeNull;
+	m_Nodes[node].child2 = kiAABBTreeNull;
+	m_Nodes[node].height = 0;
+	return node;
+}
+
+// Return a node to the free list
+void CAABBTree::FreeNode( const TUInt32 node )
+{
+	m_Nodes[node].parent = m_FreeList;
+	m_Nodes[node].height = -1;
+	m_FreeList = node;
+}
+
+
+// Add a leaf to the tree, placed to minimise the surface area of the tree
+void CAABBTree::InsertLeaf( const TUInt32 leaf )
+{
+	if (m_Root == kiAABBTreeNull)
+	{
+		m_Root = leaf;
+		m_Nodes[leaf].parent = kiAABBTreeNull;
+		return;
+	}
+
+	// Find the best sibling for the leaf. Descend from the root, at each node compare the cost of
+	// pairing the leaf with the node itself, against the cost of descending into each child.
+	// Every ancestor of the new pair grows to contain the leaf, which is an extra cost
+	// ("inherited") for whichever choice is made below that ancestor
+	const CVector3 leafMin = m_Nodes[leaf].minBounds;
+	const CVector3 leafMax = m_Nodes[leaf].maxBounds;
+	TUInt32 sibling = m_Root;
+	while (!m_Nodes[sibling].IsLeaf())
+	{
+		const SNode& node = m_Nodes[sibling];
+		TFloat32 cost = BoxCost( node.minBounds, node.maxBounds );
+		TFloat32 combinedCost = CombinedBoxCost( node.minBounds, node.maxBounds, leafMin, leafMax );
+
+		// Cost of creating a new parent for this node and the leaf
+		TFloat32 pairCost = 2.0f * combinedCost;
+
+		// Minimum cost of pushing the leaf further down the tree
+		TFloat32 inheritedCost = 2.0f * (combinedCost - cost);
+		TFloat32 childCosts[2];
+		const TUInt32 children[2] = { node.child1, node.child2 };
+		for (TUInt32 i = 0; i < 2; ++i)
+		{
+			const SNode& child = m_Nodes[children[i]];
+			childCosts[i] = CombinedBoxCost( child.minBounds, child.maxBounds, leafMin, leafMax ) +
+			                inheritedCost;
+			if (!child.IsLeaf())
+			{
+				childCosts[i] -= BoxCost( child.minBounds, child.maxBounds );
+			}
+		}
+
+		// Pair with this node if that's cheapest, otherwise descend
+		if (pairCost < childCosts[0] && pairCost < childCosts[1])
+		{
+			break;
+		}
+		sibling = childCosts[0] < childCosts[1] ? children[0] : children[1];
+	}
+
+	// Create a new parent for the sibling and the leaf
+	TUInt32 oldParent = m_Nodes[sibling].parent;
+	TUInt32 newParent = AllocateNode(); // May reallocate nodes, so no node references held here
+	m_Nodes[newParent].parent = oldParent;
+	m_Nodes[newParent].child1 = sibling;
+	m_Nodes[newParent].child2 = leaf;
+	m_Nodes[sibling].parent = newParent;
+	m_Nodes[leaf].parent = newParent;
+	if (oldParent == kiAABBTreeNull)
+	{
+		m_Root = newParent;
+	}
+	else if (m_Nodes[oldParent].child1 == sibling)
+	{
+		m_Nodes[oldParent].child1 = newParent;
+	}
+	else
+	{
+		m_Nodes[oldParent].child2 = newParent;
+	}
+
+	RefitAncestors( newParent );
+}
+
+// Remove a leaf from the tree (the leaf node is not freed)
+void CAABBTree::RemoveLeaf( const TUInt32 leaf )
+{
+	if (leaf == m_Root)
+	{
+		m_Root = kiAABBTreeNull;
+		return;
+	}
+
+	// Replace the leaf's parent with the leaf's sibling
+	TUInt32 parent = m_Nodes[leaf].parent;
+	TUInt32 grandParent = m_Nodes[parent].parent;
+	TUInt32 sibling = m_Nodes[parent].child1 == leaf ? m_Nodes[parent].child2 : m_Nodes[parent].child1;
+	m_Nodes[sibling].parent = grandParent;
+	FreeNode( parent );
+	if (grandParent == kiAABBTreeNull)
+	{
+		m_Root = sibling;
+		return;
+	}
+	if (m_Nodes[grandParent].child1 == parent)
+	{
+		m_Nodes[grandParent].child1 = sibling;
+	}
+	else
+	{
+		m_Nodes[grandParent].child2 = sibling;
+	}
+
+	RefitAncestors( grandParent );
+}
+
+
+// Rotate the tree at the given node if its children's heights differ by more than one.
+// Returns the node now at the position of the given node. E.g. if child C of A is too high, C
+// takes the place of A, with A as one child. C's higher child F stays under C, its other child
+// G moves under A in place of C:
+//     A(B, C(F, G))  =>  C(A(B, G), F)
+TUInt32 CAABBTree::Balance( const TUInt32 a )
+{
+	if (m_Nodes[a].IsLeaf() || m_Nodes[a].height < 2)
+	{
+		return a;
+	}
+
+	TUInt32 b = m_Nodes[a].child1;
+	TUInt32 c = m_Nodes[a].child2;
+	TInt32 balance = m_Nodes[c].height - m_Nodes[b].height;
+	if (balance >= -1 && balance <= 1)
+	{
+		return a;
+	}
+
+	// Rotate the higher child up, the rotation is the same with the roles of the children swapped
+	bool rotateChild2 = balance > 1;
+	TUInt32 up = rotateChild2 ? c : b;     // Child moving up to replace a
+	TUInt32 other = rotateChild2 ? b : c;  // Child staying under a
+
+	// Replace a with the rising child in a's parent
+	TUInt32 f = m_Nodes[up].child1;
+	TUInt32 g = m_Nodes[up].child2;
+	m_Nodes[up].child1 = a;
+	m_Nodes[up].parent = m_Nodes[a].parent;
+	m_Nodes[a].parent = up;
+	if (m_Nodes[up].parent == kiAABBTreeNull)
+	{
+		m_Root = up;
+	}
+	else if (m_Nodes[m_Nodes[up].parent].child1 == a)
+	{
+		m_Nodes[m_Nodes[up].parent].child1 = up;
+	}
+	else
+	{
+		m_Nodes[m_Nodes[up].parent].child2 = up;
+	}
+
+	// The higher grandchild stays under the rising child, the lower moves under a
+	TUInt32 high = m_Nodes[f].height > m_Nodes[g].height ? f : g;
+	TUInt32 low = high == f ? g : f;
+	m_Nodes[up].child2 = high;
+	m_Nodes[a].child1 = rotateChild2 ? other : low;
+	m_Nodes[a].child2 = rotateChild2 ? low : other;
+	m_Nodes[low].parent = a;
+
+	Refit( a );
+	Refit( up );
+	return up;
+}
+
+// Recalculate the heights and boxes of the given node and its ancestors, balancing each
+void CAABBTree::RefitAncestors( TUInt32 node )
+{
+	while (node != kiAABBTreeNull)
+	{
+		node = Balance( node );
+		Refit( node );
+		node = m_Nodes[node].parent;
+	}
+}
+
+// Recalculate the height and box of an internal node from its children
+void CAABBTree::Refit( const TUInt32 node )
+{
+	SNode& parent = m_Nodes[node];
+	const SNode& child1 = m_Nodes[parent.child1];
+	const SNode& child2 = m_Nodes[parent.child2];
+	parent.height = 1 + Max( child1.height, child2.height );
+	CombineBoxes( child1.minBounds, child1.maxBounds, child2.minBounds, child2.maxBounds,
+	              &parent.minBounds, &parent.maxBounds );
+}
+
+
+} // namespace gen
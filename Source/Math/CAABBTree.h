@@ -0,0 +1,259 @@
+/**************************************************************************************************
+	Module:       CAABBTree.h
+	Author:       agent
+	Date created: 16/10/26
+
+	Definition of the concrete class CAABBTree, a dynamic bounding volume hierarchy of axis
+	aligned bounding boxes for fast spatial queries over many moving objects
+
+	Copyright 2026, agent
+
+	Change history:
+		V1.0    Created 16/10/26 - AG
+**************************************************************************************************/
+
+// Each object added to the tree is a leaf holding the object's bounding box (AABB) and a user
+// value (e.g. an index into an array of objects). Internal nodes hold the box around their two
+// children. Queries visit only the branches whose boxes pass the query, so their cost depends on
+// the number of objects found rather than the total number of objects
+//
+// Notes:
+// - Leaves are placed in the tree with a box enlarged beyond the object's box ("fat" box). An
+//   object that moves a little stays within its fat box and only needs its exact box updated,
+//   objects are only reinserted when they leave their fat box
+// - The tree is kept balanced with rotations as in an AVL tree, and new leaves are placed to
+//   minimise the total surface area of the boxes (the surface area heuristic), as in Box2D's
+//   b2DynamicTree
+// - Queries test the exact object boxes at the leaves, so only objects whose own box passes
+//   the query are returned
+// - Nodes are stored in a single array, so leaves are identified by index (a "proxy") which is
+//   unchanged for the life of the leaf
+
+#ifndef GEN_C_AABB_TREE_H_INCLUDED
+#define GEN_C_AABB_TREE_H_INCLUDED
+
+#include <vector>
+using namespace std;
+
+#include "Defines.h"
+#include "CVector3.h"
+
+namespace gen
+{
+
+/*-----------------------------------------------------------------------------------------
+	Constants
+-----------------------------------------------------------------------------------------*/
+
+// Value for a missing node / proxy
+const TUInt32 kiAABBTreeNull = 0xffffffff;
+
+// Default enlargement of leaf boxes, as a fraction of the largest dimension of the object's box
+const TFloat32 kfAABBTreeDefaultMargin = 0.25f;
+
+// Greatest number of planes passed to a plane query
+const TUInt32 kiAABBTreeMaxPlanes = 32;
+
+
+class CAABBTree
+{
+	GEN_CLASS( CAABBTree );
+
+/*-----------------------------------------------------------------------------------------
+	Constructors/Destructors
+-----------------------------------------------------------------------------------------*/
+public:
+
+	// Construct an empty tree. Optionally pass the enlargement of leaf boxes as a fraction of
+	// the largest dimension of each object's box
+	explicit CAABBTree( const TFloat32 margin = kfAABBTreeDefaultMargin );
+
+	// Default copy constructor, assignment operator and destructor are suitable
+
+
+/*-----------------------------------------------------------------------------------------
+	Objects
+-----------------------------------------------------------------------------------------*/
+
+	// Add an object with the given bounding box and user value. Returns a proxy used to refer to
+	// the object in the other functions
+	TUInt32 Insert
+	(
+		const CVector3& minBounds,
+		const CVector3& maxBounds,
+		const TUInt32   userData
+	);
+
+	// Remove the object with the given proxy from the tree
+	void Remove( const TUInt32 proxy );
+
+	// Set a new bounding box for the object with the given proxy. Cheap if the new box is inside
+	// the object's enlarged box in the tree, otherwise the object is reinserted. Returns true if
+	// the object was reinserted
+	bool Move
+	(
+		const TUInt32   proxy,
+		const CVector3& minBounds,
+		const CVector3& maxBounds
+	);
+
+	// Remove all objects
+	void Clear();
+
+
+	// Get / set the user value of the object with the given proxy
+	TUInt32 GetUserData( const TUInt32 proxy ) const
+	{
+		GEN_ASSERT_OPT( proxy < m_Nodes.size() && m_Nodes[proxy].height == 0, "Invalid proxy" );
+		return m_Nodes[proxy].userData;
+	}
+	void SetUserData
+	(
+		const TUInt32 proxy,
+		const TUInt32 userData
+	)
+	{
+		GEN_ASSERT_OPT( proxy < m_Nodes.size() && m_Nodes[proxy].height == 0, "Invalid proxy" );
+		m_Nodes[proxy].userData = userData;
+	}
+
+	// Return number of objects in the tree
+	TUInt32 NumObjects() const
+	{
+		return m_NumLeaves;
+	}
+
+	// Return height of the tree (0 for an empty tree, 1 for a single object)
+	TUInt32 Height() const
+	{
+		return m_Root == kiAABBTreeNull ? 0 : m_Nodes[m_Root].height + 1;
+	}
+
+
+/*-----------------------------------------------------------------------------------------
+	Queries
+-----------------------------------------------------------------------------------------*/
+// Queries append the user values of the objects found to the given vector (in no particular
+// order). Queries are not re-entrant - a tree cannot be queried by several threads at once
+
+	// Find objects not outside any of a set of planes, e.g. the planes of a viewing frustum. Each
+	// plane is given as a normal and a distance, so that points p on the plane have
+	// Dot(p, normal) == distance, with the normal pointing away from the inside. A box is outside
+	// if it is entirely in front of any plane. Branches entirely behind a plane are not tested
+	// against that plane again
+	void QueryPlanes
+	(
+		const CVector3*   pNormals,
+		const TFloat32*   pDistances,
+		const TUInt32     numPlanes,
+		vector<TUInt32>&  results
+	);
+
+	// Find objects whose box is within the given radius of a point
+	void QueryRadius
+	(
+		const CVector3&   centre,
+		const TFloat32    radius,
+		vector<TUInt32>&  results
+	);
+
+	// Find objects whose box is hit by a ray starting at the given point, within the given
+	// distance along the ray. The direction need not be normalised, the distance is measured in
+	// lengths of the direction vector
+	void QueryRay
+	(
+		const CVector3&   origin,
+		const CVector3&   direction,
+		const TFloat32    maxDistance,
+		vector<TUInt32>&  results
+	);
+
+
+/*-----------------------------------------------------------------------------------------
+	Private interface
+-----------------------------------------------------------------------------------------*/
+private:
+
+	// A node in the tree, either a leaf (one object) or an internal node with two children
+	struct SNode
+	{
+		// Box containing the node - the enlarged box for leaves, the box around both children for
+		// internal nodes
+		CVector3 minBounds;
+		CVector3 maxBounds;
+
+		// Exact box of the object (leaves only)
+		CVector3 objectMin;
+		CVector3 objectMax;
+
+		// Parent node, or the next free node for nodes in the free list
+		TUInt32  parent;
+
+		// Child nodes (kiAABBTreeNull for leaves)
+		TUInt32  child1;
+		TUInt32  child2;
+
+		// Height of the node above the leaves (0 for leaves, -1 for free nodes)
+		TInt32   height;
+
+		// User value (leaves only)
+		TUInt32  userData;
+
+		bool IsLeaf() const
+		{
+			return child1 == kiAABBTreeNull;
+		}
+	};
+
+	// A node waiting to be visited in a query, with the planes it still needs testing against
+	struct SQueryNode
+	{
+		TUInt32 node;
+		TUInt32 planeMask;
+	};
+
+
+	// Get a node from the free list, or add a new node. Returns its index
+	TUInt32 AllocateNode();
+
+	// Return a node to the free list
+	void FreeNode( const TUInt32 node );
+
+	// Add a leaf to the tree, placed to minimise the surface area of the tree
+	void InsertLeaf( const TUInt32 leaf );
+
+	// Remove a leaf from the tree (the leaf node is not freed)
+	void RemoveLeaf( const TUInt32 leaf );
+
+	// Rotate the tree at the given node if its children's heights differ by more than one.
+	// Returns the node now at the position of the given node
+	TUInt32 Balance( const TUInt32 node );
+
+	// Recalculate the heights and boxes of the given node and its ancestors, balancing each
+	void RefitAncestors( TUInt32 node );
+
+	// Recalculate the height and box of an internal node from its children
+	void Refit( const TUInt32 node );
+
+
+	// Enlargement of leaf boxes as a fraction of the object's size
+	TFloat32 m_Margin;
+
+	// All nodes in the tree and the free list
+	vector<SNode> m_Nodes;
+
+	// Root of the tree and start of the free list
+	TUInt32 m_Root;
+	TUInt32 m_FreeList;
+
+	// Number of leaves (objects)
+	TUInt32 m_NumLeaves;
+
+	// Stack of nodes to visit during queries, kept to avoid reallocation
+	vector<SQueryNode> m_QueryStack;
+};
+
+
+} // namespace gen
+
+#endif // GEN_C_AABB_TREE_H_INCLUDED
@@ -25,20 +25,6 @@ namespace gen
 	Constructors/Destructors
 -----------------------------------------------------------------------------------------*/
 
-// Construct by value
-CMatrix2x2::CMatrix2x2
-(
-	const TFloat32 elt00, const TFloat32 elt01,
-	const TFloat32 elt10, const TFloat32 elt11
-)
-{
-	e00 = elt00;
-	e01 = elt01;
-
-	e10 = elt10;
-	e11 = elt11;
-}
-
 // Construct through pointer to 4 floats, may specify row/column order of data
 CMatrix2x2::CMatrix2x2
 (
@@ -69,33 +55,6 @@ CMatrix2x2::CMatrix2x2
 	GEN_ENDGUARD_OPT;
 }
 
-// Construct by row or column using CVector2's, may specify if setting rows or columns
-CMatrix2x2::CMatrix2x2
-(
-	const CVector2& v0,
-	const CVector2& v1,
-	const bool      bRows /*= true*/
-)
-{
-	if (bRows)
-	{
-		e00 = v0.x;
-		e01 = v0.y;
-
-		e10 = v1.x;
-		e11 = v1.y;
-	}
-	else
-	{
-		e00 = v0.x;
-		e10 = v0.y;
-
-		e01 = v1.x;
-		e11 = v1.y;
-	}
-}
-
-
 // Construct matrix transformation from rotation angle and optional scaling. Matrix is
 // effectively built in this order: M = Scale*Rotation
 CMatrix2x2::CMatrix2x2
@@ -115,16 +74,6 @@ CMatrix2x2::CMatrix2x2
 }
 
 
-// Copy constructor
-CMatrix2x2::CMatrix2x2( const CMatrix2x2& m )
-{
-	e00 = m.e00;
-	e01 = m.e01;
-
-	e10 = m.e10;
-	e11 = m.e11;
-}
-
 // Assignment operator
 CMatrix2x2& CMatrix2x2::operator=( const CMatrix2x2& m )
 {
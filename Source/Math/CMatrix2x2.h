@@ -49,11 +49,13 @@ public:
 	CMatrix2x2() {}
 
 	// Construct by value
-	CMatrix2x2
+	constexpr CMatrix2x2
 	(
 		const TFloat32 elt00, const TFloat32 elt01,
 		const TFloat32 elt10, const TFloat32 elt11
-	);
+	) : e00( elt00 ), e01( elt01 ),
+	    e10( elt10 ), e11( elt11 )
+	{}
 
 	// Construct through pointer to 4 floats, may specify row/column order of data
 	explicit CMatrix2x2
@@ -66,12 +68,16 @@ public:
 	// Only applies to constructors that can take one parameter, used to avoid confusing code
 
 	// Construct by row or column using CVector2's, may specify if setting rows or columns
-    CMatrix2x2
+	constexpr CMatrix2x2
 	(
 		const CVector2& v0,
 		const CVector2& v1,
 		const bool      bRows = true
-	);
+	) : CMatrix2x2( bRows ? CMatrix2x2( v0.x, v0.y,
+	                                    v1.x, v1.y )
+	                      : CMatrix2x2( v0.x, v1.x,
+	                                    v0.y, v1.y ) )
+	{}
 
 
 	// Construct matrix transformation from rotation angle and optional scaling. Matrix is
@@ -85,7 +91,10 @@ public:
 
 
 	// Copy constructor
-    CMatrix2x2( const CMatrix2x2& m );
+    constexpr CMatrix2x2( const CMatrix2x2& m )
+	  : e00( m.e00 ), e01( m.e01 ),
+	    e10( m.e10 ), e11( m.e11 )
+	{}
 
 	// Assignment operator
     CMatrix2x2& operator=( const CMatrix2x2& m );
@@ -29,27 +29,6 @@ namespace gen
 	Constructors/Destructors
 -----------------------------------------------------------------------------------------*/
 
-// Construct by value
-CMatrix3x3::CMatrix3x3
-(
-	const TFloat32 elt00, const TFloat32 elt01, const TFloat32 elt02,
-	const TFloat32 elt10, const TFloat32 elt11, const TFloat32 elt12,
-	const TFloat32 elt20, const TFloat32 elt21, const TFloat32 elt22
-)
-{
-	e00 = elt00;
-	e01 = elt01;
-	e02 = elt02;
-
-	e10 = elt10;
-	e11 = elt11;
-	e12 = elt12;
-
-	e20 = elt20;
-	e21 = elt21;
-	e22 = elt22;
-}
-
 // Construct through pointer to 9 floats, may specify row/column order of data
 CMatrix3x3::CMatrix3x3
 (
@@ -92,87 +71,6 @@ CMatrix3x3::CMatrix3x3
 	GEN_ENDGUARD_OPT;
 }
 
-// Construct by row or column using CVector3's, may specify if setting rows or columns
-CMatrix3x3::CMatrix3x3
-(
-	const CVector3& v0,
-	const CVector3& v1,
-	const CVector3& v2,
-	const bool      bRows /*= true*/
-)
-{
-	if (bRows)
-	{
-		e00 = v0.x;
-		e01 = v0.y;
-		e02 = v0.z;
-
-		e10 = v1.x;
-		e11 = v1.y;
-		e12 = v1.z;
-
-		e20 = v2.x;
-		e21 = v2.y;
-		e22 = v2.z;
-	}
-	else
-	{
-		e00 = v0.x;
-		e10 = v0.y;
-		e20 = v0.z;
-
-		e01 = v1.x;
-		e11 = v1.y;
-		e21 = v1.z;
-
-		e02 = v2.x;
-		e12 = v2.y;
-		e22 = v2.z;
-	}
-}
-
-// Construct by row or column using CVector2's, remaining elements taken from identity matrix
-// May specify if setting rows or columns
-CMatrix3x3::CMatrix3x3
-(
-	const CVector2& v0,
-	const CVector2& v1,
-	const CVector2& v2,
-	const bool      bRows /*= true*/
-)
-{
-	if (bRows)
-	{
-		e00 = v0.x;
-		e01 = v0.y;
-		e02 = 0.0f;
-
-		e10 = v1.x;
-		e11 = v1.y;
-		e12 = 0.0f;
-
-		e20 = v2.x;
-		e21 = v2.y;
-		e22 = 0.0f;
-	}
-	else
-	{
-		e00 = v0.x;
-		e10 = v0.y;
-
-		e01 = v1.x;
-		e11 = v1.y;
-
-		e02 = v2.x;
-		e12 = v2.y;
-
-		e20 = 0.0f;
-		e21 = 0.0f;
-		e22 = 1.0f;
-	}
-}
- 
-
 // Construct matrix transformation from euler angles and optional scaling. Matrix is effectively
 // built in this order: M = Scale*Rotation
 CMatrix3x3::CMatrix3x3
@@ -262,24 +160,6 @@ CMatrix3x3::CMatrix3x3
 }
 
 
-// Construct 2D affine transformation from position (translation) only
-CMatrix3x3::CMatrix3x3( const CVector2& position )
-{
-	// Take most elements from identity
-	e00 = 1.0f;
-	e01 = 0.0f;
-	e02 = 0.0f;
-
-	e10 = 0.0f;
-	e11 = 1.0f;
-	e12 = 0.0f;
-
-	// Put position (translation) in bottom row
-	e20 = position.x;
-	e21 = position.y;
-	e22 = 1.0f;
-}
-
 // Construct 2D affine transformation from position, rotation angle and optional scaling, with 
 // remaining elements taken from the identity matrix. Matrix is effectively built in this
 // order: M = Scale*Rotation*Translation
@@ -331,22 +211,6 @@ CMatrix3x3::CMatrix3x3
 }
 
 
-// Copy constructor
-CMatrix3x3::CMatrix3x3( const CMatrix3x3& m )
-{
-	e00 = m.e00;
-	e01 = m.e01;
-	e02 = m.e02;
-
-	e10 = m.e10;
-	e11 = m.e11;
-	e12 = m.e12;
-
-	e20 = m.e20;
-	e21 = m.e21;
-	e22 = m.e22;
-}
-
 // Assignment operator
 CMatrix3x3& CMatrix3x3::operator=( const CMatrix3x3& m )
 {
@@ -84,12 +84,15 @@ public:
 	CMatrix3x3() {}
 
 	// Construct by value
-	CMatrix3x3
+	constexpr CMatrix3x3
 	(
 		const TFloat32 elt00, const TFloat32 elt01, const TFloat32 elt02,
 		const TFloat32 elt10, const TFloat32 elt11, const TFloat32 elt12,
 		const TFloat32 elt20, const TFloat32 elt21, const TFloat32 elt22
-	);
+	) : e00( elt00 ), e01( elt01 ), e02( elt02 ),
+	    e10( elt10 ), e11( elt11 ), e12( elt12 ),
+	    e20( elt20 ), e21( elt21 ), e22( elt22 )
+	{}
 
 	// Construct through pointer to 9 floats, may specify row/column order of data
 	explicit CMatrix3x3
@@ -102,23 +105,35 @@ public:
 	// Only applies to constructors that can take one parameter, used to avoid confusing code
 
 	// Construct by row or column using CVector3's, may specify if setting rows or columns
-    CMatrix3x3
+	constexpr CMatrix3x3
 	(
 		const CVector3& v0,
 		const CVector3& v1,
 		const CVector3& v2,
 		const bool      bRows = true
-	);
+	) : CMatrix3x3( bRows ? CMatrix3x3( v0.x, v0.y, v0.z,
+	                                    v1.x, v1.y, v1.z,
+	                                    v2.x, v2.y, v2.z )
+	                      : CMatrix3x3( v0.x, v1.x, v2.x,
+	                                    v0.y, v1.y, v2.y,
+	                                    v0.z, v1.z, v2.z ) )
+	{}
 
 	// Construct by row or column using CVector2's, remaining elements taken from identity matrix
 	// May specify if setting rows or columns
-	CMatrix3x3
+	constexpr CMatrix3x3
 	(
 		const CVector2& v0,
 		const CVector2& v1,
 		const CVector2& v2,
 		const bool      bRows = true
-	);
+	) : CMatrix3x3( bRows ? CMatrix3x3( v0.x, v0.y, 0.0f,
+	                                    v1.x, v1.y, 0.0f,
+	                                    v2.x, v2.y, 0.0f )
+	                      : CMatrix3x3( v0.x, v1.x, v2.x,
+	                                    v0.y, v1.y, v2.y,
+	                                    0.0f, 0.0f, 1.0f ) )
+	{}
 
 
 	// Construct matrix transformation from euler angles and optional scaling. Matrix is effectively
@@ -151,7 +166,11 @@ public:
 
 
 	// Construct 2D affine transformation from position (translation) only
-	explicit CMatrix3x3( const CVector2& position );
+	explicit constexpr CMatrix3x3( const CVector2& position )
+	  : CMatrix3x3( 1.0f,       0.0f,       0.0f,
+	                0.0f,       1.0f,       0.0f,
+	                position.x, position.y, 1.0f )
+	{}
 	// Require explicit conversion from position only (see above)
 
 	// Construct 2D affine transformation from position, rotation angle and optional scaling, with 
@@ -176,7 +195,11 @@ public:
 
 
 	// Copy constructor
-    CMatrix3x3( const CMatrix3x3& m );
+    constexpr CMatrix3x3( const CMatrix3x3& m )
+	  : e00( m.e00 ), e01( m.e01 ), e02( m.e02 ),
+	    e10( m.e10 ), e11( m.e11 ), e12( m.e12 ),
+	    e20( m.e20 ), e21( m.e21 ), e22( m.e22 )
+	{}
 
 	// Assignment operator
     CMatrix3x3& operator=( const CMatrix3x3& m );
@@ -23,6 +23,7 @@
 #include "CMatrix2x2.h"
 #include "CMatrix3x3.h"
 #include "CQuaternion.h"
+#include "MathSIMD.h"
 
 namespace gen
 {
@@ -31,36 +32,6 @@ namespace gen
 	Constructors/Destructors
 -----------------------------------------------------------------------------------------*/
 
-// Construct by value
-CMatrix4x4::CMatrix4x4
-(
-	const TFloat32 elt00, const TFloat32 elt01, const TFloat32 elt02, const TFloat32 elt03,
-	const TFloat32 elt10, const TFloat32 elt11, const TFloat32 elt12, const TFloat32 elt13,
-	const TFloat32 elt20, const TFloat32 elt21, const TFloat32 elt22, const TFloat32 elt23,
-	const TFloat32 elt30, const TFloat32 elt31, const TFloat32 elt32, const TFloat32 elt33
-)
-{
-	e00 = elt00;
-	e01 = elt01;
-	e02 = elt02;
-	e03 = elt03;
-
-	e10 = elt10;
-	e11 = elt11;
-	e12 = elt12;
-	e13 = elt13;
-
-	e20 = elt20;
-	e21 = elt21;
-	e22 = elt22;
-	e23 = elt23;
-
-	e30 = elt30;
-	e31 = elt31;
-	e32 = elt32;
-	e33 = elt33;
-}
-
 // Construct through pointer to 16 floats, may specify row/column order of data
 CMatrix4x4::CMatrix4x4
 (
@@ -119,146 +90,6 @@ CMatrix4x4::CMatrix4x4
 	GEN_ENDGUARD_OPT;
 }
 
-// Construct by row or column using CVector4's, may specify if setting rows or columns
-CMatrix4x4::CMatrix4x4
-(
-	const CVector4& v0,
-	const CVector4& v1,
-	const CVector4& v2,
-	const CVector4& v3,
-	const bool      bRows /*= true*/
-)
-{
-	if (bRows)
-	{
-		e00 = v0.x;
-		e01 = v0.y;
-		e02 = v0.z;
-		e03 = v0.w;
-
-		e10 = v1.x;
-		e11 = v1.y;
-		e12 = v1.z;
-		e13 = v1.w;
-
-		e20 = v2.x;
-		e21 = v2.y;
-		e22 = v2.z;
-		e23 = v2.w;
-
-		e30 = v3.x;
-		e31 = v3.y;
-		e32 = v3.z;
-		e33 = v3.w;
-	}
-	else
-	{
-		e00 = v0.x;
-		e10 = v0.y;
-		e20 = v0.z;
-		e30 = v0.w;
-
-		e01 = v1.x;
-		e11 = v1.y;
-		e21 = v1.z;
-		e31 = v1.w;
-
-		e02 = v2.x;
-		e12 = v2.y;
-		e22 = v2.z;
-		e32 = v2.w;
-
-		e03 = v3.x;
-		e13 = v3.y;
-		e23 = v3.z;
-		e33 = v3.w;
-	}
-}
-
-// Construct by row or column using CVector3's, remaining elements taken from identity matrix
-// May specify if setting rows or columns
-CMatrix4x4::CMatrix4x4
-(
-	const CVector3& v0,
-	const CVector3& v1,
-	const CVector3& v2,
-	const CVector3& v3,
-	const bool      bRows /*= true*/
-)
-{
-	if (bRows)
-	{
-		e00 = v0.x;
-		e01 = v0.y;
-		e02 = v0.z;
-		e03 = 0.0f;
-
-		e10 = v1.x;
-		e11 = v1.y;
-		e12 = v1.z;
-		e13 = 0.0f;
-
-		e20 = v2.x;
-		e21 = v2.y;
-		e22 = v2.z;
-		e23 = 0.0f;
-
-		e30 = v3.x;
-		e31 = v3.y;
-		e32 = v3.z;
-		e33 = 1.0f;
-	}
-	else
-	{
-		e00 = v0.x;
-		e10 = v0.y;
-		e20 = v0.z;
-
-		e01 = v1.x;
-		e11 = v1.y;
-		e21 = v1.z;
-
-		e02 = v2.x;
-		e12 = v2.y;
-		e22 = v2.z;
-
-		e03 = v3.x;
-		e13 = v3.y;
-		e23 = v3.z;
-
-		e30 = 0.0f;
-		e31 = 0.0f;
-		e32 = 0.0f;
-		e33 = 1.0f;
-	}
-}
- 
-// Construct affine transformation from position (translation) only
-CMatrix4x4::CMatrix4x4( const CVector3& position )
-{
-	// Take most elements from identity
-	e00 = 1.0f;
-	e01 = 0.0f;
-	e02 = 0.0f;
-	e03 = 0.0f;
-
-	e10 = 0.0f;
-	e11 = 1.0f;
-	e12 = 0.0f;
-	e13 = 0.0f;
-
-	e20 = 0.0f;
-	e21 = 0.0f;
-	e22 = 1.0f;
-	e23 = 0.0f;
-
-	// Put position (translation) in bottom row
-	e30 = position.x;
-	e31 = position.y;
-	e32 = position.z;
-	e33 = 1.0f;
-}
-
 // Construct affine transformation from position, Euler angles and optional scaling, with 
 // remaining elements taken from the identity matrix. May specify order to apply rotations
 // Matrix is effectively built in this order: M = Scale*Rotation*Translation
@@ -436,30 +267,6 @@ CMatrix4x4::CMatrix4x4
 }
 
 
-// Copy constructor
-CMatrix4x4::CMatrix4x4( const CMatrix4x4& m )
-{
-	e00 = m.e00;
-	e01 = m.e01;
-	e02 = m.e02;
-	e03 = m.e03;
-
-	e10 = m.e10;
-	e11 = m.e11;
-	e12 = m.e12;
-	e13 = m.e13;
-
-	e20 = m.e20;
-	e21 = m.e21;
-	e22 = m.e22;
-	e23 = m.e23;
-
-	e30 = m.e30;
-	e31 = m.e31;
-	e32 = m.e32;
-	e33 = m.e33;
-}
-
 // Assignment operator
 CMatrix4x4& CMatrix4x4::operator=( const CMatrix4x4& m )
 {
@@ -1652,6 +1459,243 @@ CMatrix4x4 Orthogonalise3x3
 	Inverse related
 -----------------------------------------------------------------------------------------*/
 
+#if defined(GEN_MATH_SSE)
+
+// SSE implementations of the inverse functions, shared by the single and batch versions. Each
+// reads the whole input matrix before writing the output, so the two may be the same matrix
+
+// Return elements x, y, z & w (each 0-3) of an SSE register
+#define GEN_SSE_SWIZZLE( v, x, y, z, w ) _mm_shuffle_ps( (v), (v), _MM_SHUFFLE(w, z, y, x) )
+
+// Return the affine translation row of an inverse given the rows of its upper-left 3x3 (c0-c2,
+// 4th elements 0) and the original translation t: -(t.x*c0 + t.y*c1 + t.z*c2) with w = 1
+inline __m128 SSEInverseTranslation
+(
+	const __m128 t,
+	const __m128 c0,
+	const __m128 c1,
+	const __m128 c2
+)
+{
+	__m128 tOut = SSETransform3( t, c0, c1, c2 );
+	return _mm_sub_ps( _mm_setr_ps( 0.0f, 0.0f, 0.0f, 1.0f ), tOut );
+}
+
+// Return the rows of the transpose of the upper-left 3x3 of the matrix with rows r0-r2 in
+// c0-c2, with 4th elements of 0
+inline void SSETranspose3x3
+(
+	__m128  r0,
+	__m128  r1,
+	__m128  r2,
+	__m128& c0,
+	__m128& c1,
+	__m128& c2
+)
+{
+	__m128 r3 = _mm_setzero_ps();
+	_MM_TRANSPOSE4_PS( r0, r1, r2, r3 );
+	c0 = r0;
+	c1 = r1;
+	c2 = r2;
+}
+
+// Inverse of a matrix with rotation and translation only
+inline void SSEInverseRotTrans
+(
+	CMatrix4x4&       mOut,
+	const CMatrix4x4& m
+)
+{
+	__m128 c0, c1, c2;
+	SSETranspose3x3( SSELoad( &m.e00 ), SSELoad( &m.e10 ), SSELoad( &m.e20 ), c0, c1, c2 );
+	__m128 t = SSEInverseTranslation( SSELoad( &m.e30 ), c0, c1, c2 );
+	SSEStore( &mOut.e00, c0 );
+	SSEStore( &mOut.e10, c1 );
+	SSEStore( &mOut.e20, c2 );
+	SSEStore( &mOut.e30, t );
+}
+
+// Inverse of a matrix with rotation, translation and scale only. Returns false without
+// writing the output if any scale is zero
+inline bool SSEInverseRotTransScale
+(
+	CMatrix4x4&       mOut,
+	const CMatrix4x4& m
+)
+{
+	// After transposing, the squared scales are the sums of squares of the new rows
+	__m128 c0, c1, c2;
+	SSETranspose3x3( SSELoad( &m.e00 ), SSELoad( &m.e10 ), SSELoad( &m.e20 ), c0, c1, c2 );
+	__m128 scaleSq = _mm_add_ps( _mm_add_ps( _mm_mul_ps( c0, c0 ), _mm_mul_ps( c1, c1 ) ),
+	                             _mm_mul_ps( c2, c2 ) );
+	GEN_ALIGN(16) TFloat32 afScaleSq[4];
+	_mm_store_ps( afScaleSq, scaleSq );
+	if (IsZero( afScaleSq[0] ) || IsZero( afScaleSq[1] ) || IsZero( afScaleSq[2] ))
+	{
+		return false;
+	}
+
+	// Scale transpose by inverse squared scales (using 1 for the 4th element)
+	__m128 invScale = _mm_div_ps( _mm_set1_ps( 1.0f ),
+	                       _mm_setr_ps( afScaleSq[0], afScaleSq[1], afScaleSq[2], 1.0f ) );
+	c0 = _mm_mul_ps( c0, invScale );
+	c1 = _mm_mul_ps( c1, invScale );
+	c2 = _mm_mul_ps( c2, invScale );
+	__m128 t = SSEInverseTranslation( SSELoad( &m.e30 ), c0, c1, c2 );
+	SSEStore( &mOut.e00, c0 );
+	SSEStore( &mOut.e10, c1 );
+	SSEStore( &mOut.e20, c2 );
+	SSEStore( &mOut.e30, t );
+	return true;
+}
+
+// Return the cross product of the x, y & z elements of two SSE registers, 4th element is 0
+inline __m128 SSECross3
+(
+	const __m128 a,
+	const __m128 b
+)
+{
+	__m128 aYZX = GEN_SSE_SWIZZLE( a, 1, 2, 0, 3 );
+	__m128 bYZX = GEN_SSE_SWIZZLE( b, 1, 2, 0, 3 );
+	__m128 c = _mm_sub_ps( _mm_mul_ps( a, bYZX ), _mm_mul_ps( aYZX, b ) );
+	return GEN_SSE_SWIZZLE( c, 1, 2, 0, 3 );
+}
+
+// Inverse of an affine matrix. Returns false without writing the output if the matrix is
+// singular
+inline bool SSEInverseAffine
+(
+	CMatrix4x4&       mOut,
+	const CMatrix4x4& m
+)
+{
+	// Inverse of 3x3 with rows a, b & c has columns b x c, c x a and a x b over the determinant
+	// The 4th elements of the rows only affect the unused 4th elements of the cross products
+	__m128 a = SSELoad( &m.e00 );
+	__m128 b = SSELoad( &m.e10 );
+	__m128 c = SSELoad( &m.e20 );
+	__m128 bc = SSECross3( b, c );
+	__m128 ca = SSECross3( c, a );
+	__m128 ab = SSECross3( a, b );
+
+	__m128 det = _mm_mul_ps( a, bc );
+	det = _mm_add_ss( _mm_add_ss( det, GEN_SSE_SWIZZLE( det, 1, 1, 1, 1 ) ),
+	                  GEN_SSE_SWIZZLE( det, 2, 2, 2, 2 ) );
+	TFloat32 fDet = _mm_cvtss_f32( det );
+	if (IsZero( fDet ))
+	{
+		return false;
+	}
+
+	__m128 invDet = _mm_set1_ps( 1.0f / fDet );
+	__m128 c0, c1, c2;
+	SSETranspose3x3( _mm_mul_ps( bc, invDet ), _mm_mul_ps( ca, invDet ), _mm_mul_ps( ab, invDet ),
+	                 c0, c1, c2 );
+	__m128 t = SSEInverseTranslation( SSELoad( &m.e30 ), c0, c1, c2 );
+	SSEStore( &mOut.e00, c0 );
+	SSEStore( &mOut.e10, c1 );
+	SSEStore( &mOut.e20, c2 );
+	SSEStore( &mOut.e30, t );
+	return true;
+}
+
+// 2x2 matrix operations used by the general inverse below. Each register holds a 2x2 matrix
+// in row order (e00, e01, e10, e11). A# is the adjugate of A
+
+// Return A*B
+inline __m128 SSEMul2x2( const __m128 a, const __m128 b )
+{
+	return _mm_add_ps( _mm_mul_ps( a, GEN_SSE_SWIZZLE( b, 0, 3, 0, 3 ) ),
+	                   _mm_mul_ps( GEN_SSE_SWIZZLE( a, 1, 0, 3, 2 ),
+	                               GEN_SSE_SWIZZLE( b, 2, 1, 2, 1 ) ) );
+}
+
+// Return A# * B
+inline __m128 SSEAdjMul2x2( const __m128 a, const __m128 b )
+{
+	return _mm_sub_ps( _mm_mul_ps( GEN_SSE_SWIZZLE( a, 3, 3, 0, 0 ), b ),
+	                   _mm_mul_ps( GEN_SSE_SWIZZLE( a, 1, 1, 2, 2 ),
+	                               GEN_SSE_SWIZZLE( b, 2, 3, 0, 1 ) ) );
+}
+
+// Return A * B#
+inline __m128 SSEMulAdj2x2( const __m128 a, const __m128 b )
+{
+	return _mm_sub_ps( _mm_mul_ps( a, GEN_SSE_SWIZZLE( b, 3, 0, 3, 0 ) ),
+	                   _mm_mul_ps( GEN_SSE_SWIZZLE( a, 1, 0, 3, 2 ),
+	                               GEN_SSE_SWIZZLE( b, 2, 1, 2, 1 ) ) );
+}
+
+// General inverse. Returns false without writing the output if the matrix is singular
+// Treats the matrix as four 2x2 blocks | A B |, the inverse is 1/|M| * | X# Y# |#, where:
+//                                      | C D |                        | Z# W# |
+//   X# = |D|A - B(D#C),  Y# = |B|C - D(A#B)#,  Z# = |C|B - A(D#C)#,  W# = |A|D - C(A#B)
+//   |M| = |A||D| + |B||C| - trace((A#B)(D#C))
+inline bool SSEInverse
+(
+	CMatrix4x4&       mOut,
+	const CMatrix4x4& m
+)
+{
+	__m128 r0 = SSELoad( &m.e00 );
+	__m128 r1 = SSELoad( &m.e10 );
+	__m128 r2 = SSELoad( &m.e20 );
+	__m128 r3 = SSELoad( &m.e30 );
+	__m128 A = _mm_movelh_ps( r0, r1 );
+	__m128 B = _mm_movehl_ps( r1, r0 );
+	__m128 C = _mm_movelh_ps( r2, r3 );
+	__m128 D = _mm_movehl_ps( r3, r2 );
+
+	// Determinants of the blocks (|A|, |B|, |C|, |D|)
+	__m128 detSub = _mm_sub_ps(
+		_mm_mul_ps( _mm_shuffle_ps( r0, r2, _MM_SHUFFLE(2, 0, 2, 0) ),
+		            _mm_shuffle_ps( r1, r3, _MM_SHUFFLE(3, 1, 3, 1) ) ),
+		_mm_mul_ps( _mm_shuffle_ps( r0, r2, _MM_SHUFFLE(3, 1, 3, 1) ),
+		            _mm_shuffle_ps( r1, r3, _MM_SHUFFLE(2, 0, 2, 0) ) ) );
+	__m128 detA = GEN_SSE_SPLAT( detSub, 0 );
+	__m128 detB = GEN_SSE_SPLAT( detSub, 1 );
+	__m128 detC = GEN_SSE_SPLAT( detSub, 2 );
+	__m128 detD = GEN_SSE_SPLAT( detSub, 3 );
+
+	__m128 DC = SSEAdjMul2x2( D, C );
+	__m128 AB = SSEAdjMul2x2( A, B );
+	__m128 X = _mm_sub_ps( _mm_mul_ps( detD, A ), SSEMul2x2( B, DC ) );
+	__m128 W = _mm_sub_ps( _mm_mul_ps( detA, D ), SSEMul2x2( C, AB ) );
+	__m128 Y = _mm_sub_ps( _mm_mul_ps( detB, C ), SSEMulAdj2x2( D, AB ) );
+	__m128 Z = _mm_sub_ps( _mm_mul_ps( detC, B ), SSEMulAdj2x2( A, DC ) );
+
+	// Determinant of whole matrix, horizontal sum for the trace
+	__m128 tr = _mm_mul_ps( AB, GEN_SSE_SWIZZLE( DC, 0, 2, 1, 3 ) );
+	tr = _mm_add_ps( tr, GEN_SSE_SWIZZLE( tr, 2, 3, 0, 1 ) );
+	tr = _mm_add_ps( tr, GEN_SSE_SWIZZLE( tr, 1, 0, 3, 2 ) );
+	__m128 det = _mm_sub_ps( _mm_add_ps( _mm_mul_ps( detA, detD ), _mm_mul_ps( detB, detC ) ),
+	                         tr );
+	TFloat32 fDet = _mm_cvtss_f32( det );
+	if (IsZero( fDet ))
+	{
+		return false;
+	}
+
+	// Scale by 1/|M| with the signs needed for the adjugates of each block, then take the
+	// adjugates while reassembling rows
+	TFloat32 fInvDet = 1.0f / fDet;
+	__m128 invDet = _mm_setr_ps( fInvDet, -fInvDet, -fInvDet, fInvDet );
+	X = _mm_mul_ps( X, invDet );
+	Y = _mm_mul_ps( Y, invDet );
+	Z = _mm_mul_ps( Z, invDet );
+	W = _mm_mul_ps( W, invDet );
+	SSEStore( &mOut.e00, _mm_shuffle_ps( X, Y, _MM_SHUFFLE(1, 3, 1, 3) ) );
+	SSEStore( &mOut.e10, _mm_shuffle_ps( X, Y, _MM_SHUFFLE(0, 2, 0, 2) ) );
+	SSEStore( &mOut.e20, _mm_shuffle_ps( Z, W, _MM_SHUFFLE(1, 3, 1, 3) ) );
+	SSEStore( &mOut.e30, _mm_shuffle_ps( Z, W, _MM_SHUFFLE(0, 2, 0, 2) ) );
+	return true;
+}
+
+#endif // GEN_MATH_SSE
+
+
 // Set this matrix to its transpose (matrix reflected through its diagonal)
 // This is also the (most efficient) inverse for a rotation matrix
 void CMatrix4x4::Transpose()
@@ -1718,6 +1762,9 @@ CMatrix4x4 Transpose( const CMatrix4x4& m )
 // Most efficient inverse for transformations containing rotation and translation only
 void CMatrix4x4::InvertRotTrans()
 {
+#if defined(GEN_MATH_SSE)
+	SSEInverseRotTrans( *this, *this );
+#else
 	// Inverse of upper left 3x3 is just the transpose
 	TFloat32 t1, t2;
 	t1  = e01;
@@ -1738,6 +1785,7 @@ void CMatrix4x4::InvertRotTrans()
 	e32 = -e30*e02 - e31*e12 - e32*e22;
 	e30 = t1;
 	e31 = t2;
+#endif
 }
 
 // Return the inverse of given matrix assuming it is affine with an orthogonal upper-left 3x3
@@ -1747,6 +1795,10 @@ CMatrix4x4 InverseRotTrans( const CMatrix4x4& m )
 {
 	CMatrix4x4 mOut;
 
+#if defined(GEN_MATH_SSE)
+	SSEInverseRotTrans( mOut, m );
+	return mOut;
+#else
 	// Inverse of upper left 3x3 is just the transpose
 	mOut.e00 = m.e00;
 	mOut.e01 = m.e10;
@@ -1770,6 +1822,7 @@ CMatrix4x4 InverseRotTrans( const CMatrix4x4& m )
 	mOut.e33 = 1.0f;
 
 	return mOut;
+#endif
 }
 
 
@@ -1780,6 +1833,10 @@ void CMatrix4x4::InvertRotTransScale()
 {
 	GEN_GUARD;
 
+#if defined(GEN_MATH_SSE)
+	bool bInvertible = SSEInverseRotTransScale( *this, *this );
+	GEN_ASSERT( bInvertible, "Singular matrix" );
+#else
 	// Get X, Y & Z scaling (squared)
 	TFloat32 scaleSqX = e00*e00 + e01*e01 + e02*e02;
 	TFloat32 scaleSqY = e10*e10 + e11*e11 + e12*e12;
@@ -1815,6 +1872,7 @@ void CMatrix4x4::InvertRotTransScale()
 	e32 = -e30*e02 - e31*e12 - e32*e22;
 	e30 = t1;
 	e31 = t2;
+#endif
 
 	GEN_ENDGUARD;
 }
@@ -1828,6 +1886,11 @@ CMatrix4x4 InverseRotTransScale( const CMatrix4x4& m )
 
 	CMatrix4x4 mOut;
 
+#if defined(GEN_MATH_SSE)
+	bool bInvertible = SSEInverseRotTransScale( mOut, m );
+	GEN_ASSERT( bInvertible, "Singular matrix" );
+	return mOut;
+#else
 	// Get X, Y & Z scaling (squared)
 	TFloat32 scaleSqX = m.e00*m.e00 + m.e01*m.e01 + m.e02*m.e02;
 	TFloat32 scaleSqY = m.e10*m.e10 + m.e11*m.e11 + m.e12*m.e12;
@@ -1862,6 +1925,7 @@ CMatrix4x4 InverseRotTransScale( const CMatrix4x4& m )
 	mOut.e33 = 1.0f;
 
 	return mOut;
+#endif
 
 	GEN_ENDGUARD;
 }
@@ -1880,6 +1944,11 @@ CMatrix4x4 InverseAffine( const CMatrix4x4& m )
 
 	CMatrix4x4 mOut;
 
+#if defined(GEN_MATH_SSE)
+	bool bInvertible = SSEInverseAffine( mOut, m );
+	GEN_ASSERT( bInvertible, "Singular matrix" );
+	return mOut;
+#else
 	// Calculate determinant of upper left 3x3
 	TFloat32 det0 = m.e11*m.e22 - m.e12*m.e21;
 	TFloat32 det1 = m.e12*m.e20 - m.e10*m.e22;
@@ -1913,6 +1982,7 @@ CMatrix4x4 InverseAffine( const CMatrix4x4& m )
 	mOut.e33 = 1.0f;
 
 	return mOut;
+#endif
 
 	GEN_ENDGUARD;
 }
@@ -1975,6 +2045,11 @@ CMatrix4x4 Inverse( const CMatrix4x4& m )
 
 	CMatrix4x4 mOut;
 
+#if defined(GEN_MATH_SSE)
+	bool bInvertible = SSEInverse( mOut, m );
+	GEN_ASSERT( bInvertible, "Singular matrix" );
+	return mOut;
+#else
 	// Calculate determinant
 	TFloat32 det = m.e00 * Cofactor( m, 0, 0 ) + m.e01 * Cofactor( m, 0, 1 ) + 
 	               m.e02 * Cofactor( m, 0, 2 ) + m.e03 * Cofactor( m, 0, 3 ); 
@@ -1991,6 +2066,7 @@ CMatrix4x4 Inverse( const CMatrix4x4& m )
 	}
 
 	return mOut;
+#endif
 
 	GEN_ENDGUARD;
 }
@@ -3115,13 +3191,7 @@ CVector4 operator*
 	const CMatrix4x4& m
 )
 {
-    CVector4 vOut;
-    vOut.x = v.x*m.e00 + v.y*m.e10 + v.z*m.e20 + v.w*m.e30;
-    vOut.y = v.x*m.e01 + v.y*m.e11 + v.z*m.e21 + v.w*m.e31;
-    vOut.z = v.x*m.e02 + v.y*m.e12 + v.z*m.e22 + v.w*m.e32;
-    vOut.w = v.x*m.e03 + v.y*m.e13 + v.z*m.e23 + v.w*m.e33;
-
-    return vOut;
+	return m.Transform( v );
 }
 
 // Matrix-vector multiplication (order is important - this is an unusual order for matrices
@@ -3146,10 +3216,15 @@ CVector4 operator*
 CVector4 CMatrix4x4::Transform(	const CVector4& v ) const
 {
 	CVector4 vOut;
+#if defined(GEN_MATH_SSE)
+	SSEStore( &vOut.x, SSETransform( SSELoad( &v.x ), SSELoad( &e00 ), SSELoad( &e10 ),
+	                                 SSELoad( &e20 ), SSELoad( &e30 ) ) );
+#else
 	vOut.x = v.x*e00 + v.y*e10 + v.z*e20 + v.w*e30;
 	vOut.y = v.x*e01 + v.y*e11 + v.z*e21 + v.w*e31;
 	vOut.z = v.x*e02 + v.y*e12 + v.z*e22 + v.w*e32;
 	vOut.w = v.x*e03 + v.y*e13 + v.z*e23 + v.w*e33;
+#endif
 
 	return vOut;
 }
@@ -3178,6 +3253,31 @@ CVector3 CMatrix4x4::TransformPoint( const CVector3& p ) const
 	return pOut;
 }
 
+// Get the axis aligned bounding box of the given axis aligned box transformed by this affine
+// matrix. The result contains the transformed box but is larger unless the matrix only scales
+// and translates (or rotates by multiples of 90 degrees)
+void CMatrix4x4::TransformAABB
+(
+	const CVector3& minBounds,
+	const CVector3& maxBounds,
+	CVector3*       pMinOut,
+	CVector3*       pMaxOut
+) const
+{
+	// Transform the box centre, then each output half-extent is the sum of the input half-extents
+	// scaled by the absolute values of the matrix elements (Arvo's method) - no need to
+	// transform all eight corners
+	CVector3 centre = TransformPoint( (minBounds + maxBounds) * 0.5f );
+	CVector3 extent = (maxBounds - minBounds) * 0.5f;
+	CVector3 extentOut;
+	extentOut.x = extent.x*Abs( e00 ) + extent.y*Abs( e10 ) + extent.z*Abs( e20 );
+	extentOut.y = extent.x*Abs( e01 ) + extent.y*Abs( e11 ) + extent.z*Abs( e21 );
+	extentOut.z = extent.x*Abs( e02 ) + extent.y*Abs( e12 ) + extent.z*Abs( e22 );
+
+	*pMinOut = centre - extentOut;
+	*pMaxOut = centre + extentOut;
+}
+
 
 ///////////////////////////////
 // Matrix multiplication
@@ -3192,6 +3292,17 @@ CMatrix4x4& CMatrix4x4::operator*=( const CMatrix4x4& m )
 	}
 	else
 	{
+#if defined(GEN_MATH_SSE)
+		// Rows of this matrix can be overwritten as they are calculated, each is only used once
+		__m128 r0 = SSELoad( &m.e00 );
+		__m128 r1 = SSELoad( &m.e10 );
+		__m128 r2 = SSELoad( &m.e20 );
+		__m128 r3 = SSELoad( &m.e30 );
+		SSEStore( &e00, SSETransform( SSELoad( &e00 ), r0, r1, r2, r3 ) );
+		SSEStore( &e10, SSETransform( SSELoad( &e10 ), r0, r1, r2, r3 ) );
+		SSEStore( &e20, SSETransform( SSELoad( &e20 ), r0, r1, r2, r3 ) );
+		SSEStore( &e30, SSETransform( SSELoad( &e30 ), r0, r1, r2, r3 ) );
+#else
 		TFloat32 t0, t1, t2;
 
 		t0  = e00*m.e00 + e01*m.e10 + e02*m.e20 + e03*m.e30;
@@ -3225,6 +3336,7 @@ CMatrix4x4& CMatrix4x4::operator*=( const CMatrix4x4& m )
 		e30 = t0;
 		e31 = t1;
 		e32 = t2;
+#endif
 	}
 	return *this;
 }
@@ -3239,6 +3351,16 @@ CMatrix4x4 operator*
 {
 	CMatrix4x4 mOut;
 
+#if defined(GEN_MATH_SSE)
+	__m128 r0 = SSELoad( &m2.e00 );
+	__m128 r1 = SSELoad( &m2.e10 );
+	__m128 r2 = SSELoad( &m2.e20 );
+	__m128 r3 = SSELoad( &m2.e30 );
+	SSEStore( &mOut.e00, SSETransform( SSELoad( &m1.e00 ), r0, r1, r2, r3 ) );
+	SSEStore( &mOut.e10, SSETransform( SSELoad( &m1.e10 ), r0, r1, r2, r3 ) );
+	SSEStore( &mOut.e20, SSETransform( SSELoad( &m1.e20 ), r0, r1, r2, r3 ) );
+	SSEStore( &mOut.e30, SSETransform( SSELoad( &m1.e30 ), r0, r1, r2, r3 ) );
+#else
 	mOut.e00 = m1.e00*m2.e00 + m1.e01*m2.e10 + m1.e02*m2.e20 + m1.e03*m2.e30;
 	mOut.e01 = m1.e00*m2.e01 + m1.e01*m2.e11 + m1.e02*m2.e21 + m1.e03*m2.e31;
 	mOut.e02 = m1.e00*m2.e02 + m1.e01*m2.e12 + m1.e02*m2.e22 + m1.e03*m2.e32;
@@ -3258,6 +3380,7 @@ CMatrix4x4 operator*
 	mOut.e31 = m1.e30*m2.e01 + m1.e31*m2.e11 + m1.e32*m2.e21 + m1.e33*m2.e31;
 	mOut.e32 = m1.e30*m2.e02 + m1.e31*m2.e12 + m1.e32*m2.e22 + m1.e33*m2.e32;
 	mOut.e33 = m1.e30*m2.e03 + m1.e31*m2.e13 + m1.e32*m2.e23 + m1.e33*m2.e33;
+#endif
 
 	return mOut;
 }
@@ -3273,6 +3396,17 @@ CMatrix4x4& CMatrix4x4::MultiplyAffine( const CMatrix4x4& m )
 	}
 	else
 	{
+#if defined(GEN_MATH_SSE)
+		// Rows of m have 0 in their w element (except the last), so the result rows do too
+		__m128 r0 = SSELoad( &m.e00 );
+		__m128 r1 = SSELoad( &m.e10 );
+		__m128 r2 = SSELoad( &m.e20 );
+		__m128 r3 = SSELoad( &m.e30 );
+		SSEStore( &e00, SSETransform3( SSELoad( &e00 ), r0, r1, r2 ) );
+		SSEStore( &e10, SSETransform3( SSELoad( &e10 ), r0, r1, r2 ) );
+		SSEStore( &e20, SSETransform3( SSELoad( &e20 ), r0, r1, r2 ) );
+		SSEStore( &e30, _mm_add_ps( SSETransform3( SSELoad( &e30 ), r0, r1, r2 ), r3 ) );
+#else
 		TFloat32 t0, t1;
 
 		t0  = e00*m.e00 + e01*m.e10 + e02*m.e20;
@@ -3298,6 +3432,7 @@ CMatrix4x4& CMatrix4x4::MultiplyAffine( const CMatrix4x4& m )
 		e32 = e30*m.e02 + e31*m.e12 + e32*m.e22 + m.e32;
 		e30 = t0;
 		e31 = t1;
+#endif
 	}
 
 	return *this;
@@ -3312,6 +3447,17 @@ CMatrix4x4 MultiplyAffine
 {
 	CMatrix4x4 mOut;
 
+#if defined(GEN_MATH_SSE)
+	// Rows of m2 have 0 in their w element (except the last), so the result rows do too
+	__m128 r0 = SSELoad( &m2.e00 );
+	__m128 r1 = SSELoad( &m2.e10 );
+	__m128 r2 = SSELoad( &m2.e20 );
+	__m128 r3 = SSELoad( &m2.e30 );
+	SSEStore( &mOut.e00, SSETransform3( SSELoad( &m1.e00 ), r0, r1, r2 ) );
+	SSEStore( &mOut.e10, SSETransform3( SSELoad( &m1.e10 ), r0, r1, r2 ) );
+	SSEStore( &mOut.e20, SSETransform3( SSELoad( &m1.e20 ), r0, r1, r2 ) );
+	SSEStore( &mOut.e30, _mm_add_ps( SSETransform3( SSELoad( &m1.e30 ), r0, r1, r2 ), r3 ) );
+#else
 	mOut.e00 = m1.e00*m2.e00 + m1.e01*m2.e10 + m1.e02*m2.e20;
 	mOut.e01 = m1.e00*m2.e01 + m1.e01*m2.e11 + m1.e02*m2.e21;
 	mOut.e02 = m1.e00*m2.e02 + m1.e01*m2.e12 + m1.e02*m2.e22;
@@ -3331,11 +3477,258 @@ CMatrix4x4 MultiplyAffine
 	mOut.e31 = m1.e30*m2.e01 + m1.e31*m2.e11 + m1.e32*m2.e21 + m2.e31;
 	mOut.e32 = m1.e30*m2.e02 + m1.e31*m2.e12 + m1.e32*m2.e22 + m2.e32;
 	mOut.e33 = 1.0f;
+#endif
 
 	return mOut;
 }
 
 
+/*-----------------------------------------------------------------------------------------
+	Batch Operations
+-----------------------------------------------------------------------------------------*/
+
+// Multiply each matrix in one array by the matching matrix in another: pOut[i] = pM1[i] * pM2[i]
+void MultiplyArray
+(
+	CMatrix4x4*       pOut,
+	const CMatrix4x4* pM1,
+	const CMatrix4x4* pM2,
+	const TUInt32     numMatrices
+)
+{
+	for (TUInt32 i = 0; i < numMatrices; ++i)
+	{
+#if defined(GEN_MATH_SSE)
+		// Load all input rows before storing any, output may be the same as either input
+		__m128 r0 = SSELoad( &pM2[i].e00 );
+		__m128 r1 = SSELoad( &pM2[i].e10 );
+		__m128 r2 = SSELoad( &pM2[i].e20 );
+		__m128 r3 = SSELoad( &pM2[i].e30 );
+		__m128 v0 = SSETransform( SSELoad( &pM1[i].e00 ), r0, r1, r2, r3 );
+		__m128 v1 = SSETransform( SSELoad( &pM1[i].e10 ), r0, r1, r2, r3 );
+		__m128 v2 = SSETransform( SSELoad( &pM1[i].e20 ), r0, r1, r2, r3 );
+		__m128 v3 = SSETransform( SSELoad( &pM1[i].e30 ), r0, r1, r2, r3 );
+		SSEStore( &pOut[i].e00, v0 );
+		SSEStore( &pOut[i].e10, v1 );
+		SSEStore( &pOut[i].e20, v2 );
+		SSEStore( &pOut[i].e30, v3 );
+#else
+		pOut[i] = pM1[i] * pM2[i];
+#endif
+	}
+}
+
+// Calculate absolute matrices for a hierarchy stored as a depth-first list. Each relative matrix
+// is multiplied by the absolute matrix of its parent: pOut[i] = pRel[i] * pOut[pParents[i]].
+// The first matrix is the root and is copied directly. Parents must precede their children in
+// the list (pParents[i] < i). pOut must not be the same as pRel
+void MultiplyByParents
+(
+	CMatrix4x4*       pOut,
+	const CMatrix4x4* pRel,
+	const TUInt32*    pParents,
+	const TUInt32     numMatrices
+)
+{
+	GEN_GUARD_OPT;
+	GEN_ASSERT_OPT( pOut != pRel, "Output and input arrays must differ" );
+
+	if (numMatrices == 0)
+	{
+		return;
+	}
+	pOut[0] = pRel[0];
+	for (TUInt32 i = 1; i < numMatrices; ++i)
+	{
+		GEN_ASSERT_OPT( pParents[i] < i, "Parent must precede child" );
+#if defined(GEN_MATH_SSE)
+		const CMatrix4x4& parent = pOut[pParents[i]];
+		__m128 r0 = SSELoad( &parent.e00 );
+		__m128 r1 = SSELoad( &parent.e10 );
+		__m128 r2 = SSELoad( &parent.e20 );
+		__m128 r3 = SSELoad( &parent.e30 );
+		SSEStore( &pOut[i].e00, SSETransform( SSELoad( &pRel[i].e00 ), r0, r1, r2, r3 ) );
+		SSEStore( &pOut[i].e10, SSETransform( SSELoad( &pRel[i].e10 ), r0, r1, r2, r3 ) );
+		SSEStore( &pOut[i].e20, SSETransform( SSELoad( &pRel[i].e20 ), r0, r1, r2, r3 ) );
+		SSEStore( &pOut[i].e30, SSETransform( SSELoad( &pRel[i].e30 ), r0, r1, r2, r3 ) );
+#else
+		pOut[i] = pRel[i] * pOut[pParents[i]];
+#endif
+	}
+
+	GEN_ENDGUARD_OPT;
+}
+
+// Transform an array of vectors by the given matrix (pre-multiplication: V' = V*M)
+void TransformArray
+(
+	CVector4*         pOut,
+	const CVector4*   pV,
+	const TUInt32     numVectors,
+	const CMatrix4x4& m
+)
+{
+#if defined(GEN_MATH_SSE)
+	__m128 r0 = SSELoad( &m.e00 );
+	__m128 r1 = SSELoad( &m.e10 );
+	__m128 r2 = SSELoad( &m.e20 );
+	__m128 r3 = SSELoad( &m.e30 );
+	for (TUInt32 i = 0; i < numVectors; ++i)
+	{
+		SSEStore( &pOut[i].x, SSETransform( SSELoad( &pV[i].x ), r0, r1, r2, r3 ) );
+	}
+#else
+	for (TUInt32 i = 0; i < numVectors; ++i)
+	{
+		pOut[i] = m.Transform( pV[i] );
+	}
+#endif
+}
+
+// Transform an array of points by the given matrix (pre-multiplication: P' = P*M), assuming
+// each point's 4th element is 1
+void TransformPoints
+(
+	CVector3*         pOut,
+	const CVector3*   pPoints,
+	const TUInt32     numPoints,
+	const CMatrix4x4& m
+)
+{
+#if defined(GEN_MATH_SSE)
+	__m128 r0 = SSELoad( &m.e00 );
+	__m128 r1 = SSELoad( &m.e10 );
+	__m128 r2 = SSELoad( &m.e20 );
+	__m128 r3 = SSELoad( &m.e30 );
+	for (TUInt32 i = 0; i < numPoints; ++i)
+	{
+		__m128 p = SSELoad3( &pPoints[i].x, 0.0f );
+		SSEStore3( &pOut[i].x, _mm_add_ps( SSETransform3( p, r0, r1, r2 ), r3 ) );
+	}
+#else
+	for (TUInt32 i = 0; i < numPoints; ++i)
+	{
+		pOut[i] = m.TransformPoint( pPoints[i] );
+	}
+#endif
+}
+
+// Transform an array of vectors by the given matrix (pre-multiplication: V' = V*M), assuming
+// each vector's 4th element is 0
+void TransformVectors
+(
+	CVector3*         pOut,
+	const CVector3*   pV,
+	const TUInt32     numVectors,
+	const CMatrix4x4& m
+)
+{
+#if defined(GEN_MATH_SSE)
+	__m128 r0 = SSELoad( &m.e00 );
+	__m128 r1 = SSELoad( &m.e10 );
+	__m128 r2 = SSELoad( &m.e20 );
+	for (TUInt32 i = 0; i < numVectors; ++i)
+	{
+		SSEStore3( &pOut[i].x, SSETransform3( SSELoad3( &pV[i].x, 0.0f ), r0, r1, r2 ) );
+	}
+#else
+	for (TUInt32 i = 0; i < numVectors; ++i)
+	{
+		pOut[i] = m.TransformVector( pV[i] );
+	}
+#endif
+}
+
+// Invert an array of matrices assuming each is affine with an orthogonal upper-left 3x3 matrix,
+// as InverseRotTrans
+void InverseRotTransArray
+(
+	CMatrix4x4*       pOut,
+	const CMatrix4x4* pM,
+	const TUInt32     numMatrices
+)
+{
+	for (TUInt32 i = 0; i < numMatrices; ++i)
+	{
+#if defined(GEN_MATH_SSE)
+		SSEInverseRotTrans( pOut[i], pM[i] );
+#else
+		pOut[i] = InverseRotTrans( pM[i] );
+#endif
+	}
+}
+
+// Invert an array of matrices assuming each is affine with orthogonal vectors in the upper-left
+// 3x3 matrix, as InverseRotTransScale
+void InverseRotTransScaleArray
+(
+	CMatrix4x4*       pOut,
+	const CMatrix4x4* pM,
+	const TUInt32     numMatrices
+)
+{
+	GEN_GUARD;
+
+	for (TUInt32 i = 0; i < numMatrices; ++i)
+	{
+#if defined(GEN_MATH_SSE)
+		bool bInvertible = SSEInverseRotTransScale( pOut[i], pM[i] );
+		GEN_ASSERT( bInvertible, "Singular matrix" );
+#else
+		pOut[i] = InverseRotTransScale( pM[i] );
+#endif
+	}
+
+	GEN_ENDGUARD;
+}
+
+// Invert an array of matrices assuming only that each is affine, as InverseAffine
+void InverseAffineArray
+(
+	CMatrix4x4*       pOut,
+	const CMatrix4x4* pM,
+	const TUInt32     numMatrices
+)
+{
+	GEN_GUARD;
+
+	for (TUInt32 i = 0; i < numMatrices; ++i)
+	{
+#if defined(GEN_MATH_SSE)
+		bool bInvertible = SSEInverseAffine( pOut[i], pM[i] );
+		GEN_ASSERT( bInvertible, "Singular matrix" );
+#else
+		pOut[i] = InverseAffine( pM[i] );
+#endif
+	}
+
+	GEN_ENDGUARD;
+}
+
+// Invert an array of general matrices, as Inverse
+void InverseArray
+(
+	CMatrix4x4*       pOut,
+	const CMatrix4x4* pM,
+	const TUInt32     numMatrices
+)
+{
+	GEN_GUARD;
+
+	for (TUInt32 i = 0; i < numMatrices; ++i)
+	{
+#if defined(GEN_MATH_SSE)
+		bool bInvertible = SSEInverse( pOut[i], pM[i] );
+		GEN_ASSERT( bInvertible, "Singular matrix" );
+#else
+		pOut[i] = Inverse( pM[i] );
+#endif
+	}
+
+	GEN_ENDGUARD;
+}
+
+
 /*---------------------------------------------------------------------------------------------
 	Static constants
 ---------------------------------------------------------------------------------------------*/
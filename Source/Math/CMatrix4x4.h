@@ -48,20 +48,23 @@
 // - As the matrix is stored in rows, the [] operator is provided to returns CVector4/CVector3
 //   references to the actual matrix data. This is highly convenient/efficient but non-portable,
 //   i.e. the [] operator is not guaranteed to work on all compilers (though it will on most)
+// - The incremental move and rotation methods (MoveLocal, RotateX etc.) are typically called for
+//   many matrices every frame, so they use the precise tier of approximations from MathApprox.h
 
 #ifndef GEN_C_MATRIX_4X4_H_INCLUDED
 #define GEN_C_MATRIX_4X4_H_INCLUDED
 
 #include "Defines.h"
 #include "BaseMath.h"
+#include "MathApprox.h"
 #include "CVector2.h"
 #include "CVector3.h"
+#include "CVector4.h"
 
 namespace gen
 {
 
 // Forward declaration of classes, where includes are only possible/necessary in the .cpp file
-class CVector4;
 class CMatrix2x2;
 class CMatrix3x3;
 class CQuaternion;
@@ -82,13 +85,17 @@ public:
 	CMatrix4x4() {}
 
 	// Construct by value
-	CMatrix4x4
+	constexpr CMatrix4x4
 	(
 		const TFloat32 elt00, const TFloat32 elt01, const TFloat32 elt02, const TFloat32 elt03,
 		const TFloat32 elt10, const TFloat32 elt11, const TFloat32 elt12, const TFloat32 elt13,
 		const TFloat32 elt20, const TFloat32 elt21, const TFloat32 elt22, const TFloat32 elt23,
 		const TFloat32 elt30, const TFloat32 elt31, const TFloat32 elt32, const TFloat32 elt33
-	);
+	) : e00( elt00 ), e01( elt01 ), e02( elt02 ), e03( elt03 ),
+	    e10( elt10 ), e11( elt11 ), e12( elt12 ), e13( elt13 ),
+	    e20( elt20 ), e21( elt21 ), e22( elt22 ), e23( elt23 ),
+	    e30( elt30 ), e31( elt31 ), e32( elt32 ), e33( elt33 )
+	{}
 
 	// Construct through pointer to 16 floats, may specify row/column order of data
 	explicit CMatrix4x4
@@ -101,29 +108,50 @@ public:
 	// Only applies to constructors that can take one parameter, used to avoid confusing code
 
 	// Construct by row or column using CVector4's, may specify if setting rows or columns
-    CMatrix4x4
+	constexpr CMatrix4x4
 	(
 		const CVector4& v0,
 		const CVector4& v1,
 		const CVector4& v2,
 		const CVector4& v3,
 		const bool      bRows = true
-	);
+	) : CMatrix4x4( bRows ? CMatrix4x4( v0.x, v0.y, v0.z, v0.w,
+	                                    v1.x, v1.y, v1.z, v1.w,
+	                                    v2.x, v2.y, v2.z, v2.w,
+	                                    v3.x, v3.y, v3.z, v3.w )
+	                      : CMatrix4x4( v0.x, v1.x, v2.x, v3.x,
+	                                    v0.y, v1.y, v2.y, v3.y,
+	                                    v0.z, v1.z, v2.z, v3.z,
+	                                    v0.w, v1.w, v2.w, v3.w ) )
+	{}
 
 	// Construct by row or column using CVector3's, remaining elements taken from identity matrix
 	// May specify if setting rows or columns
-	CMatrix4x4
+	constexpr CMatrix4x4
 	(
 		const CVector3& v0,
 		const CVector3& v1,
 		const CVector3& v2,
 		const CVector3& v3,
 		const bool      bRows = true
-	);
+	) : CMatrix4x4( bRows ? CMatrix4x4( v0.x, v0.y, v0.z, 0.0f,
+	                                    v1.x, v1.y, v1.z, 0.0f,
+	                                    v2.x, v2.y, v2.z, 0.0f,
+	                                    v3.x, v3.y, v3.z, 1.0f )
+	                      : CMatrix4x4( v0.x, v1.x, v2.x, v3.x,
+	                                    v0.y, v1.y, v2.y, v3.y,
+	                                    v0.z, v1.z, v2.z, v3.z,
+	                                    0.0f, 0.0f, 0.0f, 1.0f ) )
+	{}
 
 
 	// Construct affine transformation from position (translation) only
-	explicit CMatrix4x4( const CVector3& position );
+	explicit constexpr CMatrix4x4( const CVector3& position )
+	  : CMatrix4x4( 1.0f,       0.0f,       0.0f,       0.0f,
+	                0.0f,       1.0f,       0.0f,       0.0f,
+	                0.0f,       0.0f,       1.0f,       0.0f,
+	                position.x, position.y, position.z, 1.0f )
+	{}
 	// Require explicit conversion from position only (see above)
 
 	// Construct affine transformation from position, Euler angles and optional scaling, with 
@@ -180,7 +208,12 @@ public:
 
 
 	// Copy constructor
-    CMatrix4x4( const CMatrix4x4& m );
+    constexpr CMatrix4x4( const CMatrix4x4& m )
+	  : e00( m.e00 ), e01( m.e01 ), e02( m.e02 ), e03( m.e03 ),
+	    e10( m.e10 ), e11( m.e11 ), e12( m.e12 ), e13( m.e13 ),
+	    e20( m.e20 ), e21( m.e21 ), e22( m.e22 ), e23( m.e23 ),
+	    e30( m.e30 ), e31( m.e31 ), e32( m.e32 ), e33( m.e33 )
+	{}
 
 	// Assignment operator
     CMatrix4x4& operator=( const CMatrix4x4& m );
@@ -538,9 +571,9 @@ public:
 	void MoveLocal( const CVector3 v ) 
 	{
 		// Adjust for any scaling
-		TFloat32 scaledX = v.x * InvSqrt( e00*e00 + e01*e01 + e02*e02 );
-		TFloat32 scaledY = v.y * InvSqrt( e10*e10 + e11*e11 + e12*e12 );
-		TFloat32 scaledZ = v.z * InvSqrt( e20*e20 + e21*e21 + e22*e22 );
+		TFloat32 scaledX = v.x * InvSqrt<kMathPrecise>( e00*e00 + e01*e01 + e02*e02 );
+		TFloat32 scaledY = v.y * InvSqrt<kMathPrecise>( e10*e10 + e11*e11 + e12*e12 );
+		TFloat32 scaledZ = v.z * InvSqrt<kMathPrecise>( e20*e20 + e21*e21 + e22*e22 );
 		e30 += scaledX * e00 + scaledY * e10 + scaledZ * e20;
 		e31 += scaledX * e01 + scaledY * e11 + scaledZ * e21;
 		e32 += scaledX * e02 + scaledY * e12 + scaledZ * e22;
@@ -562,7 +595,7 @@ public:
 	void MoveLocalX( const TFloat32 x ) 
 	{
 		// Adjust for any x-scaling
-		TFloat32 scaledX = x * InvSqrt( e00*e00 + e01*e01 + e02*e02 );
+		TFloat32 scaledX = x * InvSqrt<kMathPrecise>( e00*e00 + e01*e01 + e02*e02 );
 		e30 += scaledX * e00;
 		e31 += scaledX * e01;
 		e32 += scaledX * e02;
@@ -583,7 +616,7 @@ public:
 	void MoveLocalY( const TFloat32 y ) 
 	{
 		// Adjust for any y-scaling
-		TFloat32 scaledY = y * InvSqrt( e10*e10 + e11*e11 + e12*e12 );
+		TFloat32 scaledY = y * InvSqrt<kMathPrecise>( e10*e10 + e11*e11 + e12*e12 );
 		e30 += y * e10;
 		e31 += y * e11;
 		e32 += y * e12;
@@ -604,7 +637,7 @@ public:
 	void MoveLocalZ( const TFloat32 z ) 
 	{
 		// Adjust for any z-scaling
-		TFloat32 scaledZ = z * InvSqrt( e20*e20 + e21*e21 + e22*e22 );
+		TFloat32 scaledZ = z * InvSqrt<kMathPrecise>( e20*e20 + e21*e21 + e22*e22 );
 		e30 += scaledZ * e20;
 		e31 += scaledZ * e21;
 		e32 += scaledZ * e22;
@@ -735,7 +768,7 @@ public:
 	{
 		// Perform minimum of calculations rather than use full matrix multiply
 		TFloat32 sX, cX;
-		SinCos( x, &sX, &cX );
+		SinCos<kMathPrecise>( x, &sX, &cX );
 		TFloat32 t;
 		t   = e01*sX + e02*cX;
 		e01 = e01*cX - e02*sX;
@@ -758,7 +791,7 @@ public:
 	{
 		// Perform minimum of calculations rather than use full matrix multiply
 		TFloat32 sY, cY;
-		SinCos( y, &sY, &cY );
+		SinCos<kMathPrecise>( y, &sY, &cY );
 		TFloat32 t;
 		t   = e00*cY + e02*sY;
 		e02 = e02*cY - e00*sY;
@@ -781,7 +814,7 @@ public:
 	{
 		// Perform minimum of calculations rather than use full matrix multiply
 		TFloat32 sZ, cZ;
-		SinCos( z, &sZ, &cZ );
+		SinCos<kMathPrecise>( z, &sZ, &cZ );
 		TFloat32 t;
 		t   = e00*sZ + e01*cZ;
 		e00 = e00*cZ - e01*sZ;
@@ -805,7 +838,7 @@ public:
 	{
 		// Perform minimum of calculations rather than use full matrix multiply
 		TFloat32 sX, cX;
-		SinCos( x, &sX, &cX );
+		SinCos<kMathPrecise>( x, &sX, &cX );
 		TFloat32 t;
 		t   = e01*sX + e02*cX;
 		e01 = e01*cX - e02*sX;
@@ -825,7 +858,7 @@ public:
 	{
 		// Perform minimum of calculations rather than use full matrix multiply
 		TFloat32 sY, cY;
-		SinCos( y, &sY, &cY );
+		SinCos<kMathPrecise>( y, &sY, &cY );
 		TFloat32 t;
 		t   = e00*cY + e02*sY;
 		e02 = e02*cY - e00*sY;
@@ -845,7 +878,7 @@ public:
 	{
 		// Perform minimum of calculations rather than use full matrix multiply
 		TFloat32 sZ, cZ;
-		SinCos( z, &sZ, &cZ );
+		SinCos<kMathPrecise>( z, &sZ, &cZ );
 		TFloat32 t;
 		t   = e00*sZ + e01*cZ;
 		e00 = e00*cZ - e01*sZ;
@@ -872,7 +905,7 @@ public:
 		TFloat32 scaleYZ = Sqrt( scaleSqY ) * InvSqrt( scaleSqZ );
 
 		TFloat32 sX, cX, sXY, sXZ;
-		SinCos( x, &sX, &cX );
+		SinCos<kMathPrecise>( x, &sX, &cX );
 		sXY = sX * scaleYZ;
 		sXZ = sX / scaleYZ;
 
@@ -897,7 +930,7 @@ public:
 	{
 		// Perform minimum of calculations rather than use full matrix multiply
 		TFloat32 sX, cX;
-		SinCos( x, &sX, &cX );
+		SinCos<kMathPrecise>( x, &sX, &cX );
 		TFloat32 t;
 		t   = e10*cX + e20*sX;
 		e20 = e20*cX - e10*sX;
@@ -923,7 +956,7 @@ public:
 		TFloat32 scaleZX = Sqrt( scaleSqZ ) * InvSqrt( scaleSqX );
 
 		TFloat32 sY, cY, sYZ, sYX;
-		SinCos( y, &sY, &cY );
+		SinCos<kMathPrecise>( y, &sY, &cY );
 		sYZ = sY * scaleZX;
 		sYX = sY / scaleZX;
 
@@ -947,7 +980,7 @@ public:
 	{
 		// Perform minimum of calculations rather than use full matrix multiply
 		TFloat32 sY, cY;
-		SinCos( y, &sY, &cY );
+		SinCos<kMathPrecise>( y, &sY, &cY );
 		TFloat32 t;
 		t   = e20*cY + e00*sY;
 		e00 = e00*cY - e20*sY;
@@ -973,7 +1006,7 @@ public:
 		TFloat32 scaleXY = Sqrt( scaleSqX ) * InvSqrt( scaleSqY );
 
 		TFloat32 sZ, cZ, sZX, sZY;
-		SinCos( z, &sZ, &cZ );
+		SinCos<kMathPrecise>( z, &sZ, &cZ );
 		sZX = sZ * scaleXY;
 		sZY = sZ / scaleXY;
 
@@ -997,7 +1030,7 @@ public:
 	{
 		// Perform minimum of calculations rather than use full matrix multiply
 		TFloat32 sZ, cZ;
-		SinCos( z, &sZ, &cZ );
+		SinCos<kMathPrecise>( z, &sZ, &cZ );
 		TFloat32 t;
 		t   = e00*cZ + e10*sZ;
 		e10 = e10*cZ - e00*sZ;
@@ -1185,6 +1218,17 @@ public:
 	// Assuming it is a point rather then a vector, i.e. assume the vector's 4th element is 1
     CVector3 TransformPoint( const CVector3& p ) const;
 
+	// Get the axis aligned bounding box of the given axis aligned box transformed by this affine
+	// matrix. The result contains the transformed box but is larger unless the matrix only scales
+	// and translates (or rotates by multiples of 90 degrees)
+	void TransformAABB
+	(
+		const CVector3& minBounds,
+		const CVector3& maxBounds,
+		CVector3*       pMinOut,
+		CVector3*       pMaxOut
+	) const;
+
 
 	///////////////////////////////
 	// Matrix multiplication
@@ -1300,6 +1344,92 @@ CMatrix4x4 MultiplyAffine
 );
 
 
+/*-----------------------------------------------------------------------------------------
+	Non-member Batch Operations
+-----------------------------------------------------------------------------------------*/
+// Operate on contiguous arrays of matrices or vectors, significantly faster than looping over
+// the single operations above when SIMD is available (see MathSIMD.h). Output arrays may be the
+// same as input arrays except where noted
+
+// Multiply each matrix in one array by the matching matrix in another: pOut[i] = pM1[i] * pM2[i]
+void MultiplyArray
+(
+	CMatrix4x4*       pOut,
+	const CMatrix4x4* pM1,
+	const CMatrix4x4* pM2,
+	const TUInt32     numMatrices
+);
+
+// Calculate absolute matrices for a hierarchy stored as a depth-first list. Each relative matrix
+// is multiplied by the absolute matrix of its parent: pOut[i] = pRel[i] * pOut[pParents[i]].
+// The first matrix is the root and is copied directly. Parents must precede their children in
+// the list (pParents[i] < i). pOut must not be the same as pRel
+void MultiplyByParents
+(
+	CMatrix4x4*       pOut,
+	const CMatrix4x4* pRel,
+	const TUInt32*    pParents,
+	const TUInt32     numMatrices
+);
+
+// Transform an array of vectors by the given matrix (pre-multiplication: V' = V*M)
+void TransformArray
+(
+	CVector4*         pOut,
+	const CVector4*   pV,
+	const TUInt32     numVectors,
+	const CMatrix4x4& m
+);
+
+// Transform an array of points by the given matrix (pre-multiplication: P' = P*M), assuming
+// each point's 4th element is 1
+void TransformPoints
+(
+	CVector3*         pOut,
+	const CVector3*   pPoints,
+	const TUInt32     numPoints,
+	const CMatrix4x4& m
+);
+
+// Transform an array of vectors by the given matrix (pre-multiplication: V' = V*M), assuming
+// each vector's 4th element is 0
+void TransformVectors
+(
+	CVector3*         pOut,
+	const CVector3*   pV,
+	const TUInt32     numVectors,
+	const CMatrix4x4& m
+);
+
+// Invert each matrix in an array using the matching single matrix function (see Non-member
+// Inverse Related below), e.g. to calculate inverse bind or view matrices. Singular matrices
+// are reported in the same way as by the single versions
+void InverseRotTransArray
+(
+	CMatrix4x4*       pOut,
+	const CMatrix4x4* pM,
+	const TUInt32     numMatrices
+);
+void InverseRotTransScaleArray
+(
+	CMatrix4x4*       pOut,
+	const CMatrix4x4* pM,
+	const TUInt32     numMatrices
+);
+void InverseAffineArray
+(
+	CMatrix4x4*       pOut,
+	const CMatrix4x4* pM,
+	const TUInt32     numMatrices
+);
+void InverseArray
+(
+	CMatrix4x4*       pOut,
+	const CMatrix4x4* pM,
+	const TUInt32     numMatrices
+);
+
+
 /*-----------------------------------------------------------------------------------------
 	Non-Member Othogonality
 -----------------------------------------------------------------------------------------*/
@@ -8,6 +8,10 @@
 
 #include "CQuatTransform.h"
 
+#include "Error.h"
+#include "MathApprox.h"
+#include "MathSIMD.h"
+
 namespace gen
 {
 
@@ -117,5 +121,278 @@ void Slerp
 }
 
 
-} // namespace gen
+/*---------------------------------------------------------------------------------------------
+	Batch Operations
+---------------------------------------------------------------------------------------------*/
+// Transforms are transposed into registers holding one member of kWidth transforms, then
+// processed together, finishing with single transforms as in MathApprox.cpp. Each helper
+// returns the index of the first transform it did not process
+
+// Offsets of the members of a quaternion-transform as an array of floats
+const TUInt32 kiQTPos   = 0;
+const TUInt32 kiQTQuat  = 3; // w, x, y, z
+const TUInt32 kiQTScale = 7;
+const TUInt32 kiQTFloats = 10;
+
+// Combine kWidth transforms held in registers: qr = q1 * q2, as operator* above
+template <class Ops>
+inline void MultiplyLanes
+(
+	typename Ops::TVec*       qr,
+	const typename Ops::TVec* q1,
+	const typename Ops::TVec* q2
+)
+{
+	typedef typename Ops::TVec TVec;
+
+	// Scale is product of scales, scale2 * pos1 is needed for the position
+	TVec scalePos[3];
+	for (TUInt32 e = 0; e < 3; ++e)
+	{
+		qr[kiQTScale + e] = Ops::Mul( q1[kiQTScale + e], q2[kiQTScale + e] );
+		scalePos[e] = Ops::Mul( q2[kiQTScale + e], q1[kiQTPos + e] );
+	}
+
+	// Quaternion product q1 * q2 = (w1*w2 - v1.v2, w1*v2 + w2*v1 + v2 x v1)
+	const TVec& w1 = q1[kiQTQuat];
+	const TVec* v1 = &q1[kiQTQuat + 1];
+	const TVec& w2 = q2[kiQTQuat];
+	const TVec* v2 = &q2[kiQTQuat + 1];
+	TVec dot = Ops::Add( Ops::Add( Ops::Mul( v1[0], v2[0] ), Ops::Mul( v1[1], v2[1] ) ),
+	                     Ops::Mul( v1[2], v2[2] ) );
+	TVec quat[4];
+	quat[0] = Ops::Sub( Ops::Mul( w1, w2 ), dot );
+	for (TUInt32 e = 0; e < 3; ++e)
+	{
+		TUInt32 e1 = (e + 1) % 3;
+		TUInt32 e2 = (e + 2) % 3;
+		TVec cross = Ops::Sub( Ops::Mul( v2[e1], v1[e2] ), Ops::Mul( v2[e2], v1[e1] ) );
+		quat[e + 1] = Ops::Add( Ops::Add( Ops::Mul( w1, v2[e] ), Ops::Mul( w2, v1[e] ) ), cross );
+	}
+
+	// Rotate scale2 * pos1 by quat2 (as CQuaternion::Rotate) and add pos2
+	TVec w2Twice = Ops::Add( w2, w2 );
+	TVec pScale = Ops::Sub( Ops::Mul( w2Twice, w2 ), Ops::Splat( 1.0f ) );
+	TVec vDotP = Ops::Add( Ops::Mul( v2[0], scalePos[0] ), Ops::Mul( v2[1], scalePos[1] ) );
+	vDotP = Ops::Add( vDotP, Ops::Mul( v2[2], scalePos[2] ) );
+	vDotP = Ops::Add( vDotP, vDotP );
+	for (TUInt32 e = 0; e < 3; ++e)
+	{
+		TUInt32 e1 = (e + 1) % 3;
+		TUInt32 e2 = (e + 2) % 3;
+		TVec cross = Ops::Sub( Ops::Mul( v2[e1], scalePos[e2] ), Ops::Mul( v2[e2], scalePos[e1] ) );
+		TVec pos = Ops::Add( Ops::Mul( pScale, scalePos[e] ), Ops::Mul( vDotP, v2[e] ) );
+		pos = Ops::Add( pos, Ops::Mul( w2Twice, cross ) );
+		qr[kiQTPos + e] = Ops::Add( pos, q2[kiQTPos + e] );
+	}
+
+	for (TUInt32 e = 0; e < 4; ++e)
+	{
+		qr[kiQTQuat + e] = quat[e];
+	}
+}
 
+template <class Ops>
+inline TUInt32 MultiplyValues
+(
+	CQuatTransform*       pOut,
+	const CQuatTransform* pQ1,
+	const CQuatTransform* pQ2,
+	const TUInt32         numTransforms,
+	TUInt32               i
+)
+{
+	typedef typename Ops::TVec TVec;
+
+	for (; i + Ops::kWidth <= numTransforms; i += Ops::kWidth)
+	{
+		TVec q1[kiQTFloats], q2[kiQTFloats], qr[kiQTFloats];
+		LoadLanes<Ops>( q1, &pQ1[i].pos.x, kiQTFloats, kiQTFloats );
+		LoadLanes<Ops>( q2, &pQ2[i].pos.x, kiQTFloats, kiQTFloats );
+		MultiplyLanes<Ops>( qr, q1, q2 );
+		StoreLanes<Ops>( &pOut[i].pos.x, kiQTFloats, qr, kiQTFloats );
+	}
+	return i;
+}
+
+// Process transforms i to i + kWidth - 1 of a hierarchy together if all their parents precede
+// transform i. Returns the index of the next transform to process
+template <class Ops>
+inline TUInt32 MultiplyByParentValues
+(
+	CQuatTransform*       pOut,
+	const CQuatTransform* pRel,
+	const TUInt32*        pParents,
+	const TUInt32         numTransforms,
+	TUInt32               i
+)
+{
+	typedef typename Ops::TVec TVec;
+
+	if (i + Ops::kWidth > numTransforms)
+	{
+		return i;
+	}
+	for (TUInt32 j = 0; j < Ops::kWidth; ++j)
+	{
+		if (pParents[i + j] >= i)
+		{
+			return i;
+		}
+	}
+
+	TVec rel[kiQTFloats], parent[kiQTFloats], qr[kiQTFloats];
+	LoadLanes<Ops>( rel, &pRel[i].pos.x, kiQTFloats, kiQTFloats );
+	LoadLanes<Ops>( parent, &pOut[0].pos.x, kiQTFloats, kiQTFloats, pParents + i );
+	MultiplyLanes<Ops>( qr, rel, parent );
+	StoreLanes<Ops>( &pOut[i].pos.x, kiQTFloats, qr, kiQTFloats );
+	return i + Ops::kWidth;
+}
+
+template <class Ops>
+inline TUInt32 GetMatrixValues
+(
+	CMatrix4x4*           pOut,
+	const CQuatTransform* pQT,
+	const TUInt32         numTransforms,
+	TUInt32               i
+)
+{
+	typedef typename Ops::TVec TVec;
+
+	for (; i + Ops::kWidth <= numTransforms; i += Ops::kWidth)
+	{
+		TVec qt[kiQTFloats];
+		LoadLanes<Ops>( qt, &pQT[i].pos.x, kiQTFloats, kiQTFloats );
+		const TVec& w = qt[kiQTQuat];
+		const TVec& x = qt[kiQTQuat + 1];
+		const TVec& y = qt[kiQTQuat + 2];
+		const TVec& z = qt[kiQTQuat + 3];
+
+		// Same calculation as the CMatrix4x4 constructor from a quaternion, position and scale
+		TVec xx = Ops::Add( x, x );
+		TVec yy = Ops::Add( y, y );
+		TVec zz = Ops::Add( z, z );
+		TVec xy = Ops::Mul( xx, y );
+		TVec yz = Ops::Mul( yy, z );
+		TVec zx = Ops::Mul( zz, x );
+		TVec wx = Ops::Mul( w, xx );
+		TVec wy = Ops::Mul( w, yy );
+		TVec wz = Ops::Mul( w, zz );
+		xx = Ops::Mul( xx, x );
+		yy = Ops::Mul( yy, y );
+		zz = Ops::Mul( zz, z );
+
+		const TVec one = Ops::Splat( 1.0f );
+		const TVec zero = Ops::Splat( 0.0f );
+		const TVec& scaleX = qt[kiQTScale];
+		const TVec& scaleY = qt[kiQTScale + 1];
+		const TVec& scaleZ = qt[kiQTScale + 2];
+		TVec m[16];
+		m[0]  = Ops::Mul( scaleX, Ops::Sub( Ops::Sub( one, yy ), zz ) );
+		m[1]  = Ops::Mul( scaleX, Ops::Add( xy, wz ) );
+		m[2]  = Ops::Mul( scaleX, Ops::Sub( zx, wy ) );
+		m[3]  = zero;
+		m[4]  = Ops::Mul( scaleY, Ops::Sub( xy, wz ) );
+		m[5]  = Ops::Mul( scaleY, Ops::Sub( Ops::Sub( one, xx ), zz ) );
+		m[6]  = Ops::Mul( scaleY, Ops::Add( yz, wx ) );
+		m[7]  = zero;
+		m[8]  = Ops::Mul( scaleZ, Ops::Add( zx, wy ) );
+		m[9]  = Ops::Mul( scaleZ, Ops::Sub( yz, wx ) );
+		m[10] = Ops::Mul( scaleZ, Ops::Sub( Ops::Sub( one, xx ), yy ) );
+		m[11] = zero;
+		m[12] = qt[kiQTPos];
+		m[13] = qt[kiQTPos + 1];
+		m[14] = qt[kiQTPos + 2];
+		m[15] = one;
+		StoreLanes<Ops>( &pOut[i].e00, 16, m, 16 );
+	}
+	return i;
+}
+
+
+// Combine each transform in one array with the matching transform in another:
+// pOut[i] = pQ1[i] * pQ2[i]
+void MultiplyArray
+(
+	CQuatTransform*       pOut,
+	const CQuatTransform* pQ1,
+	const CQuatTransform* pQ2,
+	const TUInt32         numTransforms
+)
+{
+	TUInt32 i = 0;
+#if defined(GEN_MATH_AVX)
+	i = MultiplyValues<SAVXOps>( pOut, pQ1, pQ2, numTransforms, i );
+#endif
+#if defined(GEN_MATH_SSE)
+	i = MultiplyValues<SSSEOps>( pOut, pQ1, pQ2, numTransforms, i );
+#endif
+	MultiplyValues<SScalarOps>( pOut, pQ1, pQ2, numTransforms, i );
+}
+
+// Calculate absolute transforms for a hierarchy: pOut[i] = pRel[i] * pOut[pParents[i]]. The
+// first transform is the root and is copied directly. Parents must precede their children in
+// the list (pParents[i] < i). pOut must not be the same as pRel
+void MultiplyByParents
+(
+	CQuatTransform*       pOut,
+	const CQuatTransform* pRel,
+	const TUInt32*        pParents,
+	const TUInt32         numTransforms
+)
+{
+	GEN_GUARD_OPT;
+	GEN_ASSERT_OPT( pOut != pRel, "Output and input arrays must differ" );
+
+	if (numTransforms == 0)
+	{
+		return;
+	}
+	pOut[0] = pRel[0];
+	TUInt32 i = 1;
+	while (i < numTransforms)
+	{
+		TUInt32 next = i;
+#if defined(GEN_MATH_AVX)
+		next = MultiplyByParentValues<SAVXOps>( pOut, pRel, pParents, numTransforms, next );
+#endif
+#if defined(GEN_MATH_SSE)
+		if (next == i)
+		{
+			next = MultiplyByParentValues<SSSEOps>( pOut, pRel, pParents, numTransforms, next );
+		}
+#endif
+		if (next == i)
+		{
+			// Parent is within the next few transforms (or too few remain), process this one alone
+			GEN_ASSERT_OPT( pParents[i] < i, "Parent must precede child" );
+			pOut[i] = pRel[i] * pOut[pParents[i]];
+			next = i + 1;
+		}
+		i = next;
+	}
+
+	GEN_ENDGUARD_OPT;
+}
+
+// Convert an array of transforms to matrices, as GetMatrix
+void GetMatrixArray
+(
+	CMatrix4x4*           pOut,
+	const CQuatTransform* pQT,
+	const TUInt32         numTransforms
+)
+{
+	TUInt32 i = 0;
+#if defined(GEN_MATH_AVX)
+	i = GetMatrixValues<SAVXOps>( pOut, pQT, numTransforms, i );
+#endif
+#if defined(GEN_MATH_SSE)
+	i = GetMatrixValues<SSSEOps>( pOut, pQT, numTransforms, i );
+#endif
+	GetMatrixValues<SScalarOps>( pOut, pQT, numTransforms, i );
+}
+
+
+} // namespace gen
@@ -331,6 +331,47 @@ inline CQuatTransform operator/
 }
 
 
+/*-----------------------------------------------------------------------------------------
+	Non-member Batch Operations
+-----------------------------------------------------------------------------------------*/
+// Operate on contiguous arrays of quaternion-transforms, processing several transforms at once
+// when SIMD is available (see MathSIMD.h). A quaternion-transform is 10 floats against 16 for a
+// matrix, so a hierarchy can be propagated in this form with less memory traffic, converting to
+// matrices only for rendering. Output arrays may be the same as input arrays except where noted
+
+// Combine each transform in one array with the matching transform in another:
+// pOut[i] = pQ1[i] * pQ2[i]
+void MultiplyArray
+(
+	CQuatTransform*       pOut,
+	const CQuatTransform* pQ1,
+	const CQuatTransform* pQ2,
+	const TUInt32         numTransforms
+);
+
+// Calculate absolute transforms for a hierarchy, as MultiplyByParents for matrices: each
+// relative transform is combined with the absolute transform of its parent,
+// pOut[i] = pRel[i] * pOut[pParents[i]]. The first transform is the root and is copied directly.
+// Parents must precede their children in the list (pParents[i] < i). Consecutive transforms
+// whose parents all come before the first of them are processed together, so lists in
+// breadth-first order gain most from SIMD. pOut must not be the same as pRel
+void MultiplyByParents
+(
+	CQuatTransform*       pOut,
+	const CQuatTransform* pRel,
+	const TUInt32*        pParents,
+	const TUInt32         numTransforms
+);
+
+// Convert an array of transforms to matrices, as GetMatrix
+void GetMatrixArray
+(
+	CMatrix4x4*           pOut,
+	const CQuatTransform* pQT,
+	const TUInt32         numTransforms
+);
+
+
 } // namespace gen
 
 #endif // GEN_C_QUATERNION_H_INCLUDED
@@ -13,6 +13,9 @@
 
 #include "CQuaternion.h"
 
+#include "MathApprox.h"
+#include "MathSIMD.h"
+
 namespace gen
 {
 
@@ -274,6 +277,179 @@ void Slerp
 }
 
 
+/*---------------------------------------------------------------------------------------------
+	Batch Interpolation
+---------------------------------------------------------------------------------------------*/
+// Quaternions are transposed into registers holding w, x, y or z of kWidth quaternions, then
+// interpolated together. As in MathApprox.cpp, the widest operations available are used first,
+// finishing with single quaternions. Each helper returns the index of the first quaternion it
+// did not process
+
+// Normalise kWidth quaternions held in registers, quaternions with (near) zero norm become zero
+// as in CQuaternion::Normalise
+template <class Ops>
+inline void NormaliseLanes( typename Ops::TVec* q )
+{
+	typedef typename Ops::TVec TVec;
+
+	TVec normSquared = Ops::Add( Ops::Add( Ops::Mul( q[0], q[0] ), Ops::Mul( q[1], q[1] ) ),
+	                             Ops::Add( Ops::Mul( q[2], q[2] ), Ops::Mul( q[3], q[3] ) ) );
+	TVec invLength = ApproxInvSqrt<Ops, kMathPrecise>( normSquared );
+	invLength = Ops::Select( Ops::Less( normSquared, Ops::Splat( kfEpsilon ) ),
+	                         Ops::Splat( 0.0f ), invLength );
+	for (TUInt32 e = 0; e < 4; ++e)
+	{
+		q[e] = Ops::Mul( q[e], invLength );
+	}
+}
+
+// Return acos(x) for 0 <= x <= 1, polynomial from Abramowitz & Stegun 4.4.46 (error < 2e-8)
+template <class Ops>
+inline typename Ops::TVec ACosPositive( const typename Ops::TVec x )
+{
+	typedef typename Ops::TVec TVec;
+
+	TVec p = Ops::Add( Ops::Mul( x, Ops::Splat( -0.0012624911f ) ), Ops::Splat( 0.0066700901f ) );
+	p = Ops::Add( Ops::Mul( p, x ), Ops::Splat( -0.0170881256f ) );
+	p = Ops::Add( Ops::Mul( p, x ), Ops::Splat( 0.0308918810f ) );
+	p = Ops::Add( Ops::Mul( p, x ), Ops::Splat( -0.0501743046f ) );
+	p = Ops::Add( Ops::Mul( p, x ), Ops::Splat( 0.0889789874f ) );
+	p = Ops::Add( Ops::Mul( p, x ), Ops::Splat( -0.2145988016f ) );
+	p = Ops::Add( Ops::Mul( p, x ), Ops::Splat( 1.5707963050f ) );
+
+	// Multiply by sqrt(1 - x) calculated as y * 1/sqrt(y), avoiding y = 0
+	TVec y = Ops::Max( Ops::Sub( Ops::Splat( 1.0f ), x ), Ops::Splat( 1e-30f ) );
+	return Ops::Mul( p, Ops::Mul( y, ApproxInvSqrt<Ops, kMathPrecise>( y ) ) );
+}
+
+template <class Ops>
+inline TUInt32 NLerpValues
+(
+	CQuaternion*       pOut,
+	const CQuaternion* pQ0,
+	const CQuaternion* pQ1,
+	const TFloat32*    pT,
+	const TUInt32      numQuats,
+	TUInt32            i
+)
+{
+	typedef typename Ops::TVec TVec;
+
+	for (; i + Ops::kWidth <= numQuats; i += Ops::kWidth)
+	{
+		TVec q0[4], q1[4];
+		LoadLanes<Ops>( q0, &pQ0[i].w, 4, 4 );
+		LoadLanes<Ops>( q1, &pQ1[i].w, 4, 4 );
+		TVec t = Ops::Load( pT + i );
+		TVec t0 = Ops::Sub( Ops::Splat( 1.0f ), t );
+
+		for (TUInt32 e = 0; e < 4; ++e)
+		{
+			q0[e] = Ops::Add( Ops::Mul( q0[e], t0 ), Ops::Mul( q1[e], t ) );
+		}
+		NormaliseLanes<Ops>( q0 );
+		StoreLanes<Ops>( &pOut[i].w, 4, q0, 4 );
+	}
+	return i;
+}
+
+template <class Ops>
+inline TUInt32 SlerpValues
+(
+	CQuaternion*       pOut,
+	const CQuaternion* pQ0,
+	const CQuaternion* pQ1,
+	const TFloat32*    pT,
+	const TUInt32      numQuats,
+	TUInt32            i
+)
+{
+	typedef typename Ops::TVec TVec;
+	typedef typename Ops::TMask TMask;
+
+	for (; i + Ops::kWidth <= numQuats; i += Ops::kWidth)
+	{
+		TVec q0[4], q1[4];
+		LoadLanes<Ops>( q0, &pQ0[i].w, 4, 4 );
+		LoadLanes<Ops>( q1, &pQ1[i].w, 4, 4 );
+		TVec t = Ops::Load( pT + i );
+		TVec t0 = Ops::Sub( Ops::Splat( 1.0f ), t );
+
+		// Cos of angle between quaternions, take the short route round the circle by negating
+		// the first quaternion's weight if it is negative (as Slerp)
+		TVec cosTheta = Ops::Add( Ops::Add( Ops::Mul( q0[0], q1[0] ), Ops::Mul( q0[1], q1[1] ) ),
+		                          Ops::Add( Ops::Mul( q0[2], q1[2] ), Ops::Mul( q0[3], q1[3] ) ) );
+		TMask opposite = Ops::Less( cosTheta, Ops::Splat( 0.0f ) );
+		cosTheta = Ops::Min( Ops::NegateIf( opposite, cosTheta ), Ops::Splat( 1.0f ) );
+
+		// Slerp weights sin((1-t)*theta) / sin(theta) and sin(t*theta) / sin(theta), where
+		// sin(theta) = sqrt((1 - cos) * (1 + cos)). Small angles use lerp weights instead
+		TVec theta = ACosPositive<Ops>( cosTheta );
+		TVec sinSquared = Ops::Mul( Ops::Sub( Ops::Splat( 1.0f ), cosTheta ),
+		                            Ops::Add( Ops::Splat( 1.0f ), cosTheta ) );
+		TVec invSinTheta = ApproxInvSqrt<Ops, kMathPrecise>( Ops::Max( sinSquared,
+		                                                               Ops::Splat( 1e-30f ) ) );
+		TVec sin0, sin1, unused;
+		ApproxSinCos<Ops, kMathPrecise>( Ops::Mul( t0, theta ), sin0, unused );
+		ApproxSinCos<Ops, kMathPrecise>( Ops::Mul( t, theta ), sin1, unused );
+
+		TMask smallAngle = Ops::Less( Ops::Splat( 0.9999995f ), cosTheta );
+		TVec w0 = Ops::Select( smallAngle, t0, Ops::Mul( sin0, invSinTheta ) );
+		TVec w1 = Ops::Select( smallAngle, t, Ops::Mul( sin1, invSinTheta ) );
+		w0 = Ops::NegateIf( opposite, w0 );
+
+		for (TUInt32 e = 0; e < 4; ++e)
+		{
+			q0[e] = Ops::Add( Ops::Mul( q0[e], w0 ), Ops::Mul( q1[e], w1 ) );
+		}
+		StoreLanes<Ops>( &pOut[i].w, 4, q0, 4 );
+	}
+	return i;
+}
+
+
+// Normalised linear interpolation of arrays of quaternions, as NLerp above
+void NLerpArray
+(
+	CQuaternion*       pOut,
+	const CQuaternion* pQ0,
+	const CQuaternion* pQ1,
+	const TFloat32*    pT,
+	const TUInt32      numQuats
+)
+{
+	TUInt32 i = 0;
+#if defined(GEN_MATH_AVX)
+	i = NLerpValues<SAVXOps>( pOut, pQ0, pQ1, pT, numQuats, i );
+#endif
+#if defined(GEN_MATH_SSE)
+	i = NLerpValues<SSSEOps>( pOut, pQ0, pQ1, pT, numQuats, i );
+#endif
+	NLerpValues<SScalarOps>( pOut, pQ0, pQ1, pT, numQuats, i );
+}
+
+// Spherical linear interpolation of arrays of quaternions, as Slerp above. Uses the precise
+// approximations from MathApprox.h, results differ from Slerp by less than 1e-6
+void SlerpArray
+(
+	CQuaternion*       pOut,
+	const CQuaternion* pQ0,
+	const CQuaternion* pQ1,
+	const TFloat32*    pT,
+	const TUInt32      numQuats
+)
+{
+	TUInt32 i = 0;
+#if defined(GEN_MATH_AVX)
+	i = SlerpValues<SAVXOps>( pOut, pQ0, pQ1, pT, numQuats, i );
+#endif
+#if defined(GEN_MATH_SSE)
+	i = SlerpValues<SSSEOps>( pOut, pQ0, pQ1, pT, numQuats, i );
+#endif
+	SlerpValues<SScalarOps>( pOut, pQ0, pQ1, pT, numQuats, i );
+}
+
+
 /*---------------------------------------------------------------------------------------------
 	Static constants
 ---------------------------------------------------------------------------------------------*/
@@ -36,7 +36,7 @@ public:
 	CQuaternion() {}
 
 	// Construct by value - four floats
-	CQuaternion
+	constexpr CQuaternion
 	(
 		const TFloat32 initW,
 		const TFloat32 initX,
@@ -45,7 +45,7 @@ public:
 	) : w( initW ), x( initX ), y( initY ), z( initZ ) {}
 
 	// Construct by value - float and CVector3
-	CQuaternion
+	constexpr CQuaternion
 	(
 		const TFloat32 initW,
 		const CVector3 initV
@@ -53,13 +53,13 @@ public:
 
 	// Construct through pointer to four floats
 	// Specifying explicit avoids defining an implicit conversion
-	explicit CQuaternion
+	explicit constexpr CQuaternion
 	(
 		const TFloat32* pWXYZ
 	) : w( pWXYZ[0] ), x( pWXYZ[1] ), y( pWXYZ[2] ), z( pWXYZ[3] ) {}
 
  	// Construct from a CVector3 - w value becomes 0
-	explicit CQuaternion
+	explicit constexpr CQuaternion
 	(
 		const CVector3& src
 	) : w( 0.0f ), x( src.x ), y( src.y ), z( src.z ) {};
@@ -72,7 +72,7 @@ public:
 
 
 	// Copy constructor
-    CQuaternion
+    constexpr CQuaternion
 	(
 		const CQuaternion& src
 	) : w( src.w ), x( src.x ), y( src.y ), z( src.z ) {}
@@ -93,8 +93,8 @@ public:
 		return *this;
 	}
 
-	// Destructor
-	~CQuaternion() {}
+	// Destructor - defaulted so it is trivial, as a literal type requires
+	~CQuaternion() = default;
 
 
 	/*-----------------------------------------------------------------------------------------
@@ -349,7 +349,7 @@ public:
 	}
 
 	// Return squared norm of this quaternion
-	TFloat32 NormSquared() const
+	constexpr TFloat32 NormSquared() const
 	{
 		return w*w + x*x + y*y + z*z;
 	}
@@ -371,7 +371,7 @@ public:
 	}
 
 	// Return the inverse of this quaternion
-	CQuaternion Inverse() const
+	constexpr CQuaternion Inverse() const
 	{
 		return CQuaternion( w, -x, -y, -z );
 	}
@@ -438,7 +438,7 @@ inline bool operator!=
 // Addition / subtraction
 
 // Quaternion addition
-inline CQuaternion operator+
+constexpr CQuaternion operator+
 (
 	const CQuaternion& quat1,
 	const CQuaternion& quat2
@@ -448,7 +448,7 @@ inline CQuaternion operator+
 }
 
 // Quaternion subtraction
-inline CQuaternion operator-
+constexpr CQuaternion operator-
 (
 	const CQuaternion& quat1,
 	const CQuaternion& quat2
@@ -458,7 +458,7 @@ inline CQuaternion operator-
 }
 
 // Unary positive (for completeness)
-inline CQuaternion operator+
+constexpr CQuaternion operator+
 (
 	const CQuaternion& quat
 )
@@ -467,7 +467,7 @@ inline CQuaternion operator+
 }
 
 // Unary negation
-inline CQuaternion operator-
+constexpr CQuaternion operator-
 (
 	const CQuaternion& quat
 )
@@ -480,7 +480,7 @@ inline CQuaternion operator-
 // Scalar multiplication & division
 
 // Quaternion multiplied by scalar
-inline CQuaternion operator*
+constexpr CQuaternion operator*
 (
 	const CQuaternion& quat,
 	const TFloat32     scalar
@@ -490,7 +490,7 @@ inline CQuaternion operator*
 }
 
 // Scalar multiplied by quaternion
-inline CQuaternion operator*
+constexpr CQuaternion operator*
 (
 	const TFloat32     scalar,
 	const CQuaternion& quat
@@ -500,7 +500,7 @@ inline CQuaternion operator*
 }
 
 // Quaternion divided by scalar
-inline CQuaternion operator/
+constexpr CQuaternion operator/
 (
 	const CQuaternion& quat,
 	const TFloat32     scalar
@@ -525,7 +525,7 @@ CQuaternion operator*
 // Other operations
 
 // Dot product of two given quaternions (order not important) - non-member version
-inline TFloat32 Dot
+constexpr TFloat32 Dot
 (
 	const CQuaternion& quat1,
 	const CQuaternion& quat2
@@ -549,7 +549,7 @@ inline TFloat32 Norm
 }
 
 // Return squared norm of a quaternion - non-member version
-inline TFloat32 NormSquared
+constexpr TFloat32 NormSquared
 (
 	const CQuaternion& quat
 )
@@ -598,6 +598,36 @@ void Slerp
 );
 
 
+/*---------------------------------------------------------------------------------------------
+	Batch Interpolation
+---------------------------------------------------------------------------------------------*/
+// Interpolate between matching quaternions in two arrays, each pair with its own parameter:
+// pOut[i] interpolates pQ0[i] and pQ1[i] with parameter pT[i]. Several pairs are processed at
+// once when SIMD is available (see MathSIMD.h). The output array may be the same as either
+// input array
+
+// Normalised linear interpolation of arrays of quaternions, as NLerp above
+void NLerpArray
+(
+	CQuaternion*       pOut,
+	const CQuaternion* pQ0,
+	const CQuaternion* pQ1,
+	const TFloat32*    pT,
+	const TUInt32      numQuats
+);
+
+// Spherical linear interpolation of arrays of quaternions, as Slerp above. Uses the precise
+// approximations from MathApprox.h, results differ from Slerp by less than 1e-6
+void SlerpArray
+(
+	CQuaternion*       pOut,
+	const CQuaternion* pQ0,
+	const CQuaternion* pQ1,
+	const TFloat32*    pT,
+	const TUInt32      numQuats
+);
+
+
 } // namespace gen
 
 #endif // GEN_C_QUATERNION_H_INCLUDED
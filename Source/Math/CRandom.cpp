@@ -0,0 +1,247 @@
+/**************************************************************************************************
+	Module:       CRandom.cpp
+	Author:       agent
+	Date created: 16/10/26
+
+	Implementation of the concrete class CRandom, a fast seedable pseudo-random number generator
+
+	Copyright 2026, agent
+
+	Change history:
+		V1.0    Created 16/10/26 - AG
+**************************************************************************************************/
+
+#include "CRandom.h"
+
+#include "MathSIMD.h"
+
+namespace gen
+{
+
+/*-----------------------------------------------------------------------------------------
+	Seeding
+-----------------------------------------------------------------------------------------*/
+
+// Return next value of the SplitMix64 generator with the given state, used to expand a seed
+// into well mixed generator states
+inline TUInt64 SplitMix64( TUInt64& state )
+{
+	TUInt64 z = (state += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+// Fill four 32-bit words of generator state from a SplitMix64 generator. The state must not be
+// all zero, although SplitMix64 is very unlikely to produce that
+inline void SeedState
+(
+	TUInt64&  splitMixState,
+	TUInt32*  pState,
+	TUInt32   stride
+)
+{
+	do
+	{
+		TUInt64 low = SplitMix64( splitMixState );
+		TUInt64 high = SplitMix64( splitMixState );
+		pState[0]          = static_cast<TUInt32>(low);
+		pState[stride]     = static_cast<TUInt32>(low >> 32);
+		pState[stride * 2] = static_cast<TUInt32>(high);
+		pState[stride * 3] = static_cast<TUInt32>(high >> 32);
+	}
+	while ((pState[0] | pState[stride] | pState[stride * 2] | pState[stride * 3]) == 0);
+}
+
+// Restart the generator with the given seed
+void CRandom::Seed( const TUInt64 seed )
+{
+	TUInt64 splitMixState = seed;
+	SeedState( splitMixState, m_State, 1 );
+	for (TUInt32 lane = 0; lane < 4; ++lane)
+	{
+		SeedState( splitMixState, &m_LaneState[0][lane], 4 );
+	}
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Single Values
+-----------------------------------------------------------------------------------------*/
+
+// Return random integer from a to b (inclusive), each equally likely
+// Uses Lemire's multiply and shift method, rejecting the few values that would bias the result
+TInt32 CRandom::Int
+(
+	const TInt32 a,
+	const TInt32 b
+)
+{
+	// Range wraps to 0 when a to b covers every 32-bit value
+	TUInt32 range = static_cast<TUInt32>(b) - static_cast<TUInt32>(a) + 1;
+	if (range == 0)
+	{
+		return static_cast<TInt32>(Next());
+	}
+
+	TUInt64 m = static_cast<TUInt64>(Next()) * range;
+	TUInt32 low = static_cast<TUInt32>(m);
+	if (low < range)
+	{
+		TUInt32 threshold = (0u - range) % range; // 2^32 mod range
+		while (low < threshold)
+		{
+			m = static_cast<TUInt64>(Next()) * range;
+			low = static_cast<TUInt32>(m);
+		}
+	}
+	return static_cast<TInt32>(static_cast<TUInt32>(a) + static_cast<TUInt32>(m >> 32));
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Arrays of Values
+-----------------------------------------------------------------------------------------*/
+// Value i of an array comes from generator i % 4, so whole groups of four step every generator
+// once. A final partial group only steps the first generators, the SIMD and scalar versions
+// step the generators in exactly the same way
+
+// Step one of the four array generators, returning its next value
+inline TUInt32 NextLane
+(
+	TUInt32       laneState[4][4],
+	const TUInt32 lane
+)
+{
+	TUInt32 s0 = laneState[0][lane];
+	TUInt32 s1 = laneState[1][lane];
+	TUInt32 s2 = laneState[2][lane];
+	TUInt32 s3 = laneState[3][lane];
+	TUInt32 sum = s0 + s3;
+	TUInt32 result = ((sum << 7) | (sum >> 25)) + s0;
+	TUInt32 t = s1 << 9;
+	s2 ^= s0;
+	s3 ^= s1;
+	s1 ^= s2;
+	s0 ^= s3;
+	s2 ^= t;
+	laneState[0][lane] = s0;
+	laneState[1][lane] = s1;
+	laneState[2][lane] = s2;
+	laneState[3][lane] = (s3 << 11) | (s3 >> 21);
+	return result;
+}
+
+#if defined(GEN_MATH_SSE2)
+
+// Rotate each 32-bit integer in an SSE register left by K bits
+template <int K>
+inline __m128i SSERotateLeft( const __m128i x )
+{
+	return _mm_or_si128( _mm_slli_epi32( x, K ), _mm_srli_epi32( x, 32 - K ) );
+}
+
+// Step all four array generators held in SSE registers, returning their next values
+inline __m128i SSENextLanes
+(
+	__m128i& s0,
+	__m128i& s1,
+	__m128i& s2,
+	__m128i& s3
+)
+{
+	__m128i result = _mm_add_epi32( SSERotateLeft<7>( _mm_add_epi32( s0, s3 ) ), s0 );
+	__m128i t = _mm_slli_epi32( s1, 9 );
+	s2 = _mm_xor_si128( s2, s0 );
+	s3 = _mm_xor_si128( s3, s1 );
+	s1 = _mm_xor_si128( s1, s2 );
+	s0 = _mm_xor_si128( s0, s3 );
+	s2 = _mm_xor_si128( s2, t );
+	s3 = SSERotateLeft<11>( s3 );
+	return result;
+}
+
+// State is loaded and stored unaligned, CRandom objects may be allocated without 16-byte
+// alignment
+#define GEN_RANDOM_LOAD_LANES(laneState)\
+	__m128i s0 = _mm_loadu_si128( reinterpret_cast<const __m128i*>(laneState[0]) );\
+	__m128i s1 = _mm_loadu_si128( reinterpret_cast<const __m128i*>(laneState[1]) );\
+	__m128i s2 = _mm_loadu_si128( reinterpret_cast<const __m128i*>(laneState[2]) );\
+	__m128i s3 = _mm_loadu_si128( reinterpret_cast<const __m128i*>(laneState[3]) );
+
+#define GEN_RANDOM_STORE_LANES(laneState)\
+	_mm_storeu_si128( reinterpret_cast<__m128i*>(laneState[0]), s0 );\
+	_mm_storeu_si128( reinterpret_cast<__m128i*>(laneState[1]), s1 );\
+	_mm_storeu_si128( reinterpret_cast<__m128i*>(laneState[2]), s2 );\
+	_mm_storeu_si128( reinterpret_cast<__m128i*>(laneState[3]), s3 );
+
+#endif
+
+
+// Fill an array with 32-bit random values
+void CRandom::Fill
+(
+	TUInt32*      pOut,
+	const TUInt32 numValues
+)
+{
+	TUInt32 i = 0;
+#if defined(GEN_MATH_SSE2)
+	GEN_RANDOM_LOAD_LANES( m_LaneState );
+	for (; i + 4 <= numValues; i += 4)
+	{
+		_mm_storeu_si128( reinterpret_cast<__m128i*>(pOut + i), SSENextLanes( s0, s1, s2, s3 ) );
+	}
+	GEN_RANDOM_STORE_LANES( m_LaneState );
+#endif
+	for (; i < numValues; ++i)
+	{
+		pOut[i] = NextLane( m_LaneState, i & 3 );
+	}
+}
+
+// Fill an array with random 32-bit floats from a to b (excluding b)
+void CRandom::Fill
+(
+	TFloat32*      pOut,
+	const TUInt32  numValues,
+	const TFloat32 a /*= 0.0f*/,
+	const TFloat32 b /*= 1.0f*/
+)
+{
+	// Convert the top 24 bits to a float as in Float(), with the scale to the range folded in
+	const TFloat32 scale = (b - a) * (1.0f / 16777216.0f);
+	TUInt32 i = 0;
+#if defined(GEN_MATH_SSE2)
+	const __m128 mmA = _mm_set1_ps( a );
+	const __m128 mmScale = _mm_set1_ps( scale );
+	GEN_RANDOM_LOAD_LANES( m_LaneState );
+	for (; i + 4 <= numValues; i += 4)
+	{
+		__m128 f = _mm_cvtepi32_ps( _mm_srli_epi32( SSENextLanes( s0, s1, s2, s3 ), 8 ) );
+		_mm_storeu_ps( pOut + i, _mm_add_ps( mmA, _mm_mul_ps( f, mmScale ) ) );
+	}
+	GEN_RANDOM_STORE_LANES( m_LaneState );
+#endif
+	for (; i < numValues; ++i)
+	{
+		pOut[i] = a + static_cast<TFloat32>(NextLane( m_LaneState, i & 3 ) >> 8) * scale;
+	}
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Thread Generators
+-----------------------------------------------------------------------------------------*/
+
+// Return the default generator for the calling thread. Each thread's generator starts with
+// kiDefaultRandomSeed, reseed with a different value on each thread if their sequences must
+// differ
+CRandom& ThreadRandom()
+{
+	static thread_local CRandom sThreadRandom;
+	return sThreadRandom;
+}
+
+
+} // namespace gen
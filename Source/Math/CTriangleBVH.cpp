@@ -0,0 +1,725 @@
+/**************************************************************************************************
+	Module:       CTriangleBVH.cpp
+	Author:       agent
+	Date created: 16/10/26
+
+	Implementation of the concrete class CTriangleBVH, a static bounding volume hierarchy over a
+	set of triangles for fast ray casting
+
+	Copyright 2026, agent
+
+	Change history:
+		V1.0    Created 16/10/26 - AG
+**************************************************************************************************/
+
+#include "CTriangleBVH.h"
+
+#include "BaseMath.h"
+#include "MathSIMD.h"
+#include "Error.h"
+
+namespace gen
+{
+
+/*-----------------------------------------------------------------------------------------
+	Constants
+-----------------------------------------------------------------------------------------*/
+
+// Number of bins along each axis when choosing where to split a node
+const TUInt32 kiTriangleBVHNumBins = 12;
+
+// Estimated cost of visiting a node, relative to testing a ray against a packet of triangles
+const TFloat32 kfTriangleBVHNodeCost = 1.0f;
+
+// Greatest number of triangles kept in a leaf because splitting was not worthwhile. Larger
+// nodes are split even if the surface area heuristic estimates no benefit
+const TUInt32 kiTriangleBVHMaxLeafTriangles = 16;
+
+// Reciprocal used for ray direction components of zero - gives very large but finite slab
+// distances, so the box test needs no special case for rays parallel to an axis
+const TFloat32 kfTriangleBVHLargeReciprocal = 1e30f;
+
+
+/*-----------------------------------------------------------------------------------------
+	Building Helpers
+-----------------------------------------------------------------------------------------*/
+
+// Return half the surface area of a box - the relative chance of a random ray hitting it
+inline TFloat32 BoxHalfArea
+(
+	const CVector3& minBounds,
+	const CVector3& maxBounds
+)
+{
+	CVector3 size = maxBounds - minBounds;
+	return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+
+// Enlarge a box to contain another box
+inline void ExpandBox
+(
+	CVector3*       pMin,
+	CVector3*       pMax,
+	const CVector3& minBounds,
+	const CVector3& maxBounds
+)
+{
+	pMin->Set( Min( pMin->x, minBounds.x ), Min( pMin->y, minBounds.y ), Min( pMin->z, minBounds.z ) );
+	pMax->Set( Max( pMax->x, maxBounds.x ), Max( pMax->y, maxBounds.y ), Max( pMax->z, maxBounds.z ) );
+}
+
+// Return the number of packets needed to hold the given number of triangles
+inline TUInt32 NumTrianglePackets( const TUInt32 numTriangles )
+{
+	return (numTriangles + kiTriangleBVHPacketSize - 1) / kiTriangleBVHPacketSize;
+}
+
+// Return the bin that a triangle centre coordinate falls in, given the least centre coordinate
+// and the number of bins per unit length
+inline TUInt32 TriangleBin
+(
+	const TFloat32 centre,
+	const TFloat32 minCentre,
+	const TFloat32 binScale
+)
+{
+	TUInt32 bin = static_cast<TUInt32>((centre - minCentre) * binScale);
+	return Min( bin, kiTriangleBVHNumBins - 1 );
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Ray Casting Helpers
+-----------------------------------------------------------------------------------------*/
+
+// A ray prepared for testing against node boxes and triangle packets
+struct STraceRay
+{
+#if defined(GEN_MATH_SSE)
+	// Origin and reciprocal of direction for box tests
+	__m128 origin;
+	__m128 invDirection;
+
+	// Each coordinate of the origin and direction in all four elements for packet tests
+	__m128 originX, originY, originZ;
+	__m128 directionX, directionY, directionZ;
+#else
+	TFloat32 origin[3];
+	TFloat32 direction[3];
+	TFloat32 invDirection[3];
+#endif
+};
+
+// Test a ray against a box, passing pointers to the minimum and maximum coordinates of the box.
+// Returns true if the ray passes through the box between distance 0 and maxDistance, filling
+// pEnter with the distance where the ray enters the box
+inline bool RayHitsNodeBox
+(
+	const STraceRay& ray,
+	const TFloat32*  pMin,
+	const TFloat32*  pMax,
+	const TFloat32   maxDistance,
+	TFloat32*        pEnter
+)
+{
+#if defined(GEN_MATH_SSE)
+	// Distances to the planes of each pair of opposite faces (slabs) along x, y & z together. The
+	// fourth float loaded with each box is not a coordinate, so its results are ignored
+	__m128 t1 = _mm_mul_ps( _mm_sub_ps( SSELoad( pMin ), ray.origin ), ray.invDirection );
+	__m128 t2 = _mm_mul_ps( _mm_sub_ps( SSELoad( pMax ), ray.origin ), ray.invDirection );
+	__m128 tNear = _mm_min_ps( t1, t2 );
+	__m128 tFar = _mm_max_ps( t1, t2 );
+
+	// Ray is inside the box after entering all slabs and before leaving any
+	__m128 enter = _mm_max_ss( _mm_max_ss( tNear, GEN_SSE_SPLAT( tNear, 1 ) ), GEN_SSE_SPLAT( tNear, 2 ) );
+	__m128 exit = _mm_min_ss( _mm_min_ss( tFar, GEN_SSE_SPLAT( tFar, 1 ) ), GEN_SSE_SPLAT( tFar, 2 ) );
+	enter = _mm_max_ss( enter, _mm_setzero_ps() );
+	exit = _mm_min_ss( exit, _mm_set_ss( maxDistance ) );
+	_mm_store_ss( pEnter, enter );
+	return _mm_comile_ss( enter, exit ) != 0;
+#else
+	TFloat32 enter = 0.0f;
+	TFloat32 exit = maxDistance;
+	for (TUInt32 axis = 0; axis < 3; ++axis)
+	{
+		TFloat32 t1 = (pMin[axis] - ray.origin[axis]) * ray.invDirection[axis];
+		TFloat32 t2 = (pMax[axis] - ray.origin[axis]) * ray.invDirection[axis];
+		enter = Max( enter, Min( t1, t2 ) );
+		exit = Min( exit, Max( t1, t2 ) );
+	}
+	*pEnter = enter;
+	return enter <= exit;
+#endif
+}
+
+// Test a ray against the four triangles of a packet, passing a pointer to the packet data (see
+// CTriangleBVH::SPacket). If any triangle is hit nearer than *pNearest, updates *pNearest and
+// returns the packet index (0-3) of the nearest triangle hit, otherwise returns kiTriangleBVHNull
+// Uses the Moller-Trumbore test: the hit point is found in terms of the triangle edges (u, v)
+// and the distance along the ray (t) with a few cross and dot products
+inline TUInt32 RayHitsTrianglePacket
+(
+	const STraceRay& ray,
+	const TFloat32*  pPacket,
+	TFloat32*        pNearest
+)
+{
+	const TUInt32 kiSize = kiTriangleBVHPacketSize;
+	TUInt32 nearestTriangle = kiTriangleBVHNull;
+
+#if defined(GEN_MATH_SSE)
+	__m128 edge1X = SSELoad( pPacket + 3 * kiSize );
+	__m128 edge1Y = SSELoad( pPacket + 4 * kiSize );
+	__m128 edge1Z = SSELoad( pPacket + 5 * kiSize );
+	__m128 edge2X = SSELoad( pPacket + 6 * kiSize );
+	__m128 edge2Y = SSELoad( pPacket + 7 * kiSize );
+	__m128 edge2Z = SSELoad( pPacket + 8 * kiSize );
+
+	// Cross product of ray direction and second edge, the determinant is zero for rays parallel
+	// to the triangle (and for unused triangles in the packet)
+	__m128 pX = _mm_sub_ps( _mm_mul_ps( ray.directionY, edge2Z ), _mm_mul_ps( ray.directionZ, edge2Y ) );
+	__m128 pY = _mm_sub_ps( _mm_mul_ps( ray.directionZ, edge2X ), _mm_mul_ps( ray.directionX, edge2Z ) );
+	__m128 pZ = _mm_sub_ps( _mm_mul_ps( ray.directionX, edge2Y ), _mm_mul_ps( ray.directionY, edge2X ) );
+	__m128 det = _mm_add_ps( _mm_add_ps( _mm_mul_ps( edge1X, pX ), _mm_mul_ps( edge1Y, pY ) ),
+	                         _mm_mul_ps( edge1Z, pZ ) );
+	__m128 invDet = _mm_div_ps( _mm_set1_ps( 1.0f ), det );
+
+	// Vector from first corner to ray origin, and its cross product with the first edge
+	__m128 sX = _mm_sub_ps( ray.originX, SSELoad( pPacket ) );
+	__m128 sY = _mm_sub_ps( ray.originY, SSELoad( pPacket + kiSize ) );
+	__m128 sZ = _mm_sub_ps( ray.originZ, SSELoad( pPacket + 2 * kiSize ) );
+	__m128 qX = _mm_sub_ps( _mm_mul_ps( sY, edge1Z ), _mm_mul_ps( sZ, edge1Y ) );
+	__m128 qY = _mm_sub_ps( _mm_mul_ps( sZ, edge1X ), _mm_mul_ps( sX, edge1Z ) );
+	__m128 qZ = _mm_sub_ps( _mm_mul_ps( sX, edge1Y ), _mm_mul_ps( sY, edge1X ) );
+
+	__m128 u = _mm_mul_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( sX, pX ), _mm_mul_ps( sY, pY ) ),
+	                                   _mm_mul_ps( sZ, pZ ) ), invDet );
+	__m128 v = _mm_mul_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( ray.directionX, qX ),
+	                                               _mm_mul_ps( ray.directionY, qY ) ),
+	                                   _mm_mul_ps( ray.directionZ, qZ ) ), invDet );
+	__m128 t = _mm_mul_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( edge2X, qX ), _mm_mul_ps( edge2Y, qY ) ),
+	                                   _mm_mul_ps( edge2Z, qZ ) ), invDet );
+
+	// Hit if inside the triangle and within the distance range
+	__m128 zero = _mm_setzero_ps();
+	__m128 hit = _mm_cmpneq_ps( det, zero );
+	hit = _mm_and_ps( hit, _mm_cmpge_ps( u, zero ) );
+	hit = _mm_and_ps( hit, _mm_cmpge_ps( v, zero ) );
+	hit = _mm_and_ps( hit, _mm_cmple_ps( _mm_add_ps( u, v ), _mm_set1_ps( 1.0f ) ) );
+	hit = _mm_and_ps( hit, _mm_cmpge_ps( t, zero ) );
+	hit = _mm_and_ps( hit, _mm_cmplt_ps( t, _mm_set1_ps( *pNearest ) ) );
+	int hitMask = _mm_movemask_ps( hit );
+	if (hitMask == 0)
+	{
+		return kiTriangleBVHNull;
+	}
+
+	// Select the nearest of the triangles hit
+	TFloat32 distances[kiSize];
+	SSEStore( distances, t );
+	for (TUInt32 triangle = 0; triangle < kiSize; ++triangle)
+	{
+		if ((hitMask & (1 << triangle)) && distances[triangle] < *pNearest)
+		{
+			*pNearest = distances[triangle];
+			nearestTriangle = triangle;
+		}
+	}
+#else
+	for (TUInt32 triangle = 0; triangle < kiSize; ++triangle)
+	{
+		const TFloat32 v0[3] = { pPacket[triangle], pPacket[kiSize + triangle],
+		                         pPacket[2 * kiSize + triangle] };
+		const TFloat32 edge1[3] = { pPacket[3 * kiSize + triangle], pPacket[4 * kiSize + triangle],
+		                            pPacket[5 * kiSize + triangle] };
+		const TFloat32 edge2[3] = { pPacket[6 * kiSize + triangle], pPacket[7 * kiSize + triangle],
+		                            pPacket[8 * kiSize + triangle] };
+
+		TFloat32 p[3];
+		p[0] = ray.direction[1] * edge2[2] - ray.direction[2] * edge2[1];
+		p[1] = ray.direction[2] * edge2[0] - ray.direction[0] * edge2[2];
+		p[2] = ray.direction[0] * edge2[1] - ray.direction[1] * edge2[0];
+		TFloat32 det = edge1[0] * p[0] + edge1[1] * p[1] + edge1[2] * p[2];
+		if (det == 0.0f)
+		{
+			continue;
+		}
+		TFloat32 invDet = 1.0f / det;
+
+		TFloat32 s[3] = { ray.origin[0] - v0[0], ray.origin[1] - v0[1], ray.origin[2] - v0[2] };
+		TFloat32 q[3];
+		q[0] = s[1] * edge1[2] - s[2] * edge1[1];
+		q[1] = s[2] * edge1[0] - s[0] * edge1[2];
+		q[2] = s[0] * edge1[1] - s[1] * edge1[0];
+
+		TFloat32 u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * invDet;
+		TFloat32 v = (ray.direction[0] * q[0] + ray.direction[1] * q[1] + ray.direction[2] * q[2]) * invDet;
+		TFloat32 t = (edge2[0] * q[0] + edge2[1] * q[1] + edge2[2] * q[2]) * invDet;
+		if (u >= 0.0f && v >= 0.0f && u + v <= 1.0f && t >= 0.0f && t < *pNearest)
+		{
+			*pNearest = t;
+			nearestTriangle = triangle;
+		}
+	}
+#endif
+
+	return nearestTriangle;
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Constructors/Destructors
+-----------------------------------------------------------------------------------------*/
+
+// Construct an empty hierarchy
+CTriangleBVH::CTriangleBVH()
+{
+	m_NumTriangles = 0;
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Building
+-----------------------------------------------------------------------------------------*/
+
+// Build the hierarchy over the given triangles, replacing any previous triangles. Pass three
+// vertices for each triangle, the vertices are copied
+void CTriangleBVH::Build
+(
+	const CVector3* pVertices,
+	const TUInt32   numTriangles
+)
+{
+	GEN_GUARD;
+
+	Clear();
+	if (numTriangles > 0)
+	{
+		GEN_ASSERT( pVertices, "Invalid parameter" );
+
+		// Get the bounds and centre of each triangle
+		m_NumTriangles = numTriangles;
+		m_BuildTriangles.resize( numTriangles );
+		m_BuildIndices.resize( numTriangles );
+		for (TUInt32 triangle = 0; triangle < numTriangles; ++triangle)
+		{
+			const CVector3* pTriangle = pVertices + 3 * triangle;
+			SBuildTriangle& buildTriangle = m_BuildTriangles[triangle];
+			buildTriangle.minBounds = buildTriangle.maxBounds = pTriangle[0];
+			ExpandBox( &buildTriangle.minBounds, &buildTriangle.maxBounds, pTriangle[1], pTriangle[1] );
+			ExpandBox( &buildTriangle.minBounds, &buildTriangle.maxBounds, pTriangle[2], pTriangle[2] );
+			buildTriangle.centre = (buildTriangle.minBounds + buildTriangle.maxBounds) * 0.5f;
+			m_BuildIndices[triangle] = triangle;
+		}
+
+		// A binary tree with at least one triangle in each leaf has fewer than twice as many nodes
+		// as triangles, reserve that many so the node array is not reallocated while building
+		m_Nodes.reserve( 2 * numTriangles - 1 );
+		m_Nodes.resize( 1 );
+		BuildNode( 0, 0, numTriangles, 0, pVertices );
+
+		// Release build data
+		vector<SBuildTriangle>().swap( m_BuildTriangles );
+		vector<TUInt32>().swap( m_BuildIndices );
+	}
+
+	GEN_ENDGUARD;
+}
+
+// Remove all triangles
+void CTriangleBVH::Clear()
+{
+	m_Nodes.clear();
+	m_Packets.clear();
+	m_PacketTriangles.clear();
+	m_NumTriangles = 0;
+}
+
+
+// Build the given node over a range of the triangles in m_BuildIndices, splitting it into
+// children if worthwhile
+void CTriangleBVH::BuildNode
+(
+	const TUInt32   node,
+	const TUInt32   first,
+	const TUInt32   numTriangles,
+	const TUInt32   depth,
+	const CVector3* pVertices
+)
+{
+	// Get bounds of the triangles and of their centres
+	const SBuildTriangle& firstTriangle = m_BuildTriangles[m_BuildIndices[first]];
+	CVector3 minBounds = firstTriangle.minBounds;
+	CVector3 maxBounds = firstTriangle.maxBounds;
+	CVector3 minCentre = firstTriangle.centre;
+	CVector3 maxCentre = firstTriangle.centre;
+	for (TUInt32 index = first + 1; index < first + numTriangles; ++index)
+	{
+		const SBuildTriangle& buildTriangle = m_BuildTriangles[m_BuildIndices[index]];
+		ExpandBox( &minBounds, &maxBounds, buildTriangle.minBounds, buildTriangle.maxBounds );
+		ExpandBox( &minCentre, &maxCentre, buildTriangle.centre, buildTriangle.centre );
+	}
+	m_Nodes[node].minBounds = minBounds;
+	m_Nodes[node].maxBounds = maxBounds;
+
+	if (numTriangles <= kiTriangleBVHPacketSize || depth >= kiTriangleBVHMaxDepth)
+	{
+		MakeLeaf( node, first, numTriangles, pVertices );
+		return;
+	}
+
+	// Find the cheapest split using the surface area heuristic: the cost of a node is the chance of
+	// a ray hitting each child (relative to the parent) multiplied by the cost of testing it. Sort
+	// triangle centres into bins along each axis, then consider splitting between each pair of bins
+	// (the chances are all relative to the same parent, so its area is left out)
+	struct SBin
+	{
+		CVector3 minBounds;
+		CVector3 maxBounds;
+		TUInt32  numTriangles;
+	};
+	TFloat32 nodeArea = BoxHalfArea( minBounds, maxBounds );
+	TFloat32 leafCost = nodeArea * NumTrianglePackets( numTriangles );
+	TFloat32 bestCost = 0.0f;
+	TUInt32 bestAxis = 3; // None
+	TUInt32 bestBin = 0;  // Last bin on the left of the split
+	for (TUInt32 axis = 0; axis < 3; ++axis)
+	{
+		TFloat32 extent = maxCentre[axis] - minCentre[axis];
+		if (extent <= 0.0f)
+		{
+			continue; // All centres at the same position on this axis, cannot split
+		}
+		TFloat32 binScale = kiTriangleBVHNumBins / extent;
+
+		SBin bins[kiTriangleBVHNumBins];
+		for (TUInt32 bin = 0; bin < kiTriangleBVHNumBins; ++bin)
+		{
+			bins[bin].numTriangles = 0;
+		}
+		for (TUInt32 index = first; index < first + numTriangles; ++index)
+		{
+			const SBuildTriangle& buildTriangle = m_BuildTriangles[m_BuildIndices[index]];
+			SBin& bin = bins[TriangleBin( buildTriangle.centre[axis], minCentre[axis], binScale )];
+			if (bin.numTriangles == 0)
+			{
+				bin.minBounds = buildTriangle.minBounds;
+				bin.maxBounds = buildTriangle.maxBounds;
+			}
+			else
+			{
+				ExpandBox( &bin.minBounds, &bin.maxBounds, buildTriangle.minBounds, buildTriangle.maxBounds );
+			}
+			++bin.numTriangles;
+		}
+
+		// Sweep from the right to get the cost and number of triangles of all bins right of each split
+		TFloat32 rightCosts[kiTriangleBVHNumBins];
+		TUInt32 rightCounts[kiTriangleBVHNumBins];
+		CVector3 sideMin, sideMax;
+		TUInt32 sideCount = 0;
+		for (TUInt32 bin = kiTriangleBVHNumBins - 1; bin > 0; --bin)
+		{
+			if (bins[bin].numTriangles > 0)
+			{
+				if (sideCount == 0)
+				{
+					sideMin = bins[bin].minBounds;
+					sideMax = bins[bin].maxBounds;
+				}
+				else
+				{
+					ExpandBox( &sideMin, &sideMax, bins[bin].minBounds, bins[bin].maxBounds );
+				}
+				sideCount += bins[bin].numTriangles;
+			}
+			rightCounts[bin] = sideCount;
+			rightCosts[bin] = sideCount > 0 ? BoxHalfArea( sideMin, sideMax ) * NumTrianglePackets( sideCount ) : 0.0f;
+		}
+
+		// Sweep from the left, comparing the cost of each split
+		sideCount = 0;
+		for (TUInt32 bin = 0; bin < kiTriangleBVHNumBins - 1; ++bin)
+		{
+			if (bins[bin].numTriangles > 0)
+			{
+				if (sideCount == 0)
+				{
+					sideMin = bins[bin].minBounds;
+					sideMax = bins[bin].maxBounds;
+				}
+				else
+				{
+					ExpandBox( &sideMin, &sideMax, bins[bin].minBounds, bins[bin].maxBounds );
+				}
+				sideCount += bins[bin].numTriangles;
+			}
+			if (sideCount == 0 || rightCounts[bin + 1] == 0)
+			{
+				continue;
+			}
+
+			TFloat32 cost = kfTriangleBVHNodeCost * nodeArea +
+			                BoxHalfArea( sideMin, sideMax ) * NumTrianglePackets( sideCount ) +
+			                rightCosts[bin + 1];
+			if (bestAxis == 3 || cost < bestCost)
+			{
+				bestCost = cost;
+				bestAxis = axis;
+				bestBin = bin;
+			}
+		}
+	}
+
+	// Keep as a leaf if the triangles cannot be split, or splitting does not reduce the cost and
+	// the leaf is not too large
+	if (bestAxis == 3 || (bestCost >= leafCost && numTriangles <= kiTriangleBVHMaxLeafTriangles))
+	{
+		MakeLeaf( node, first, numTriangles, pVertices );
+		return;
+	}
+
+	// Partition the triangles into those left and right of the split, using the same binning as
+	// above so each side gets the triangles counted for it
+	TFloat32 binScale = kiTriangleBVHNumBins / (maxCentre[bestAxis] - minCentre[bestAxis]);
+	TUInt32 left = first;
+	TUInt32 right = first + numTriangles;
+	while (left < right)
+	{
+		const SBuildTriangle& buildTriangle = m_BuildTriangles[m_BuildIndices[left]];
+		if (TriangleBin( buildTriangle.centre[bestAxis], minCentre[bestAxis], binScale ) <= bestBin)
+		{
+			++left;
+		}
+		else
+		{
+			--right;
+			TUInt32 temp = m_BuildIndices[left];
+			m_BuildIndices[left] = m_BuildIndices[right];
+			m_BuildIndices[right] = temp;
+		}
+	}
+	TUInt32 numLeft = left - first;
+
+	// Build the children, which are stored together
+	TUInt32 child = static_cast<TUInt32>(m_Nodes.size());
+	m_Nodes.resize( child + 2 );
+	m_Nodes[node].first = child;
+	m_Nodes[node].numPackets = 0;
+	BuildNode( child, first, numLeft, depth + 1, pVertices );
+	BuildNode( child + 1, first + numLeft, numTriangles - numLeft, depth + 1, pVertices );
+}
+
+// Make the given node a leaf holding a range of the triangles in m_BuildIndices
+void CTriangleBVH::MakeLeaf
+(
+	const TUInt32   node,
+	const TUInt32   first,
+	const TUInt32   numTriangles,
+	const CVector3* pVertices
+)
+{
+	TUInt32 numPackets = NumTrianglePackets( numTriangles );
+	m_Nodes[node].first = static_cast<TUInt32>(m_Packets.size());
+	m_Nodes[node].numPackets = numPackets;
+
+	for (TUInt32 packet = 0; packet < numPackets; ++packet)
+	{
+		SPacket newPacket = SPacket(); // Unused triangles are left with zero edges
+		for (TUInt32 slot = 0; slot < kiTriangleBVHPacketSize; ++slot)
+		{
+			TUInt32 index = packet * kiTriangleBVHPacketSize + slot;
+			if (index >= numTriangles)
+			{
+				m_PacketTriangles.push_back( kiTriangleBVHNull );
+				continue;
+			}
+
+			TUInt32 triangle = m_BuildIndices[first + index];
+			const CVector3* pTriangle = pVertices + 3 * triangle;
+			CVector3 edge1 = pTriangle[1] - pTriangle[0];
+			CVector3 edge2 = pTriangle[2] - pTriangle[0];
+			for (TUInt32 axis = 0; axis < 3; ++axis)
+			{
+				newPacket.v0[axis][slot] = pTriangle[0][axis];
+				newPacket.edge1[axis][slot] = edge1[axis];
+				newPacket.edge2[axis][slot] = edge2[axis];
+			}
+			m_PacketTriangles.push_back( triangle );
+		}
+		m_Packets.push_back( newPacket );
+	}
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Ray Casting
+-----------------------------------------------------------------------------------------*/
+
+// Find the nearest triangle hit by a ray within the given distance. Returns true if a triangle
+// was hit, filling pDistance with the distance to the hit and optionally pTriangle with the
+// index of the triangle hit (in the order passed to Build)
+bool CTriangleBVH::RayCast
+(
+	const CVector3& origin,
+	const CVector3& direction,
+	const TFloat32  maxDistance,
+	TFloat32*       pDistance,
+	TUInt32*        pTriangle /*= 0*/
+) const
+{
+	GEN_ASSERT_OPT( pDistance, "Invalid parameter" );
+	return Trace( origin, direction, maxDistance, false, pDistance, pTriangle );
+}
+
+// Return true if a ray hits any triangle within the given distance. Stops at the first hit found
+bool CTriangleBVH::RayHits
+(
+	const CVector3& origin,
+	const CVector3& direction,
+	const TFloat32  maxDistance
+) const
+{
+	TFloat32 distance;
+	return Trace( origin, direction, maxDistance, true, &distance, 0 );
+}
+
+
+// Cast a ray into the hierarchy, used for RayCast (nearest hit) and RayHits (any hit)
+bool CTriangleBVH::Trace
+(
+	const CVector3& origin,
+	const CVector3& direction,
+	const TFloat32  maxDistance,
+	const bool      anyHit,
+	TFloat32*       pDistance,
+	TUInt32*        pTriangle
+) const
+{
+	if (m_Nodes.empty())
+	{
+		return false;
+	}
+
+	// Prepare the ray for the tests
+	TFloat32 invDirection[3];
+	for (TUInt32 axis = 0; axis < 3; ++axis)
+	{
+		invDirection[axis] = direction[axis] != 0.0f ? 1.0f / direction[axis] : kfTriangleBVHLargeReciprocal;
+	}
+	STraceRay ray;
+#if defined(GEN_MATH_SSE)
+	ray.origin = _mm_setr_ps( origin.x, origin.y, origin.z, 0.0f );
+	ray.invDirection = _mm_setr_ps( invDirection[0], invDirection[1], invDirection[2], 0.0f );
+	ray.originX = _mm_set1_ps( origin.x );
+	ray.originY = _mm_set1_ps( origin.y );
+	ray.originZ = _mm_set1_ps( origin.z );
+	ray.directionX = _mm_set1_ps( direction.x );
+	ray.directionY = _mm_set1_ps( direction.y );
+	ray.directionZ = _mm_set1_ps( direction.z );
+#else
+	for (TUInt32 axis = 0; axis < 3; ++axis)
+	{
+		ray.origin[axis] = origin[axis];
+		ray.direction[axis] = direction[axis];
+		ray.invDirection[axis] = invDirection[axis];
+	}
+#endif
+
+	TFloat32 nearest = maxDistance;
+	TUInt32 nearestTriangle = kiTriangleBVHNull;
+	TFloat32 enter;
+	if (!RayHitsNodeBox( ray, &m_Nodes[0].minBounds.x, &m_Nodes[0].maxBounds.x, nearest, &enter ))
+	{
+		return false;
+	}
+
+	// Nodes still to visit, with the distance where the ray enters them. At most one node is
+	// waiting for each level above the current node
+	struct SStackEntry
+	{
+		TUInt32  node;
+		TFloat32 enter;
+	};
+	SStackEntry stack[kiTriangleBVHMaxDepth];
+	TUInt32 stackSize = 0;
+
+	TUInt32 node = 0;
+	while (true)
+	{
+		const SNode& current = m_Nodes[node];
+		if (current.numPackets > 0)
+		{
+			// Test triangles in leaf, narrowing the nearest distance
+			for (TUInt32 packet = current.first; packet < current.first + current.numPackets; ++packet)
+			{
+				TUInt32 hit = RayHitsTrianglePacket( ray, &m_Packets[packet].v0[0][0], &nearest );
+				if (hit != kiTriangleBVHNull)
+				{
+					nearestTriangle = m_PacketTriangles[packet * kiTriangleBVHPacketSize + hit];
+					if (anyHit)
+					{
+						*pDistance = nearest;
+						return true;
+					}
+				}
+			}
+		}
+		else
+		{
+			// Visit the nearer child hit first, and the other later unless a nearer hit is found
+			const SNode& child1 = m_Nodes[current.first];
+			const SNode& child2 = m_Nodes[current.first + 1];
+			TFloat32 enter1, enter2;
+			bool hit1 = RayHitsNodeBox( ray, &child1.minBounds.x, &child1.maxBounds.x, nearest, &enter1 );
+			bool hit2 = RayHitsNodeBox( ray, &child2.minBounds.x, &child2.maxBounds.x, nearest, &enter2 );
+			if (hit1 && hit2)
+			{
+				SStackEntry& later = stack[stackSize++];
+				if (enter1 <= enter2)
+				{
+					later.node = current.first + 1;
+					later.enter = enter2;
+					node = current.first;
+				}
+				else
+				{
+					later.node = current.first;
+					later.enter = enter1;
+					node = current.first + 1;
+				}
+				continue;
+			}
+			if (hit1 || hit2)
+			{
+				node = hit1 ? current.first : current.first + 1;
+				continue;
+			}
+		}
+
+		// Take the next waiting node, skipping any entered beyond the nearest hit
+		while (stackSize > 0 && stack[stackSize - 1].enter > nearest)
+		{
+			--stackSize;
+		}
+		if (stackSize == 0)
+		{
+			break;
+		}
+		node = stack[--stackSize].node;
+	}
+
+	if (nearestTriangle == kiTriangleBVHNull)
+	{
+		return false;
+	}
+	*pDistance = nearest;
+	if (pTriangle)
+	{
+		*pTriangle = nearestTriangle;
+	}
+	return true;
+}
+
+
+} // namespace gen
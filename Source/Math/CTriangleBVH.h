@@ -0,0 +1,220 @@
+/**************************************************************************************************
+	Module:       CTriangleBVH.h
+	Author:       agent
+	Date created: 16/10/26
+
+	Definition of the concrete class CTriangleBVH, a static bounding volume hierarchy over a set
+	of triangles for fast ray casting
+
+	Copyright 2026, agent
+
+	Change history:
+		V1.0    Created 16/10/26 - AG
+**************************************************************************************************/
+
+// The hierarchy is built once over a fixed set of triangles (e.g. a mesh when it is loaded), then
+// a ray cast visits only the boxes that the ray passes through, so its cost grows roughly with
+// the log of the number of triangles rather than the number of triangles
+//
+// Notes:
+// - The hierarchy is built top-down, splitting each box where the surface area heuristic (SAH)
+//   estimates the cheapest ray casts. Split positions are chosen from a fixed number of bins
+//   along each axis rather than from every triangle, which is much faster to build and almost
+//   as good
+// - Triangles are stored at the leaves in packets of four with each coordinate of the four
+//   triangles together, so a ray is tested against four triangles at once using SIMD
+// - Ray casts visit the nearer child box first and skip boxes beyond the nearest hit so far
+// - Ray casts do not modify the hierarchy, so several threads may cast rays at once
+
+#ifndef GEN_C_TRIANGLE_BVH_H_INCLUDED
+#define GEN_C_TRIANGLE_BVH_H_INCLUDED
+
+#include <vector>
+using namespace std;
+
+#include "Defines.h"
+#include "CVector3.h"
+
+namespace gen
+{
+
+/*-----------------------------------------------------------------------------------------
+	Constants
+-----------------------------------------------------------------------------------------*/
+
+// Value for a missing triangle
+const TUInt32 kiTriangleBVHNull = 0xffffffff;
+
+// Number of triangles in each packet at the leaves (tested together)
+const TUInt32 kiTriangleBVHPacketSize = 4;
+
+// Greatest depth of the hierarchy, deeper branches end in leaves with several packets
+const TUInt32 kiTriangleBVHMaxDepth = 48;
+
+
+class CTriangleBVH
+{
+	GEN_CLASS( CTriangleBVH );
+
+/*-----------------------------------------------------------------------------------------
+	Constructors/Destructors
+-----------------------------------------------------------------------------------------*/
+public:
+
+	// Construct an empty hierarchy
+	CTriangleBVH();
+
+	// Default copy constructor, assignment operator and destructor are suitable
+
+
+/*-----------------------------------------------------------------------------------------
+	Building
+-----------------------------------------------------------------------------------------*/
+
+	// Build the hierarchy over the given triangles, replacing any previous triangles. Pass three
+	// vertices for each triangle, the vertices are copied
+	void Build
+	(
+		const CVector3* pVertices,
+		const TUInt32   numTriangles
+	);
+
+	// Remove all triangles
+	void Clear();
+
+
+	// Return number of triangles in the hierarchy
+	TUInt32 NumTriangles() const
+	{
+		return m_NumTriangles;
+	}
+
+	// Return number of nodes (boxes) in the hierarchy
+	TUInt32 NumNodes() const
+	{
+		return static_cast<TUInt32>(m_Nodes.size());
+	}
+
+	// Get minimum and maximum bounds of all triangles. Undefined for an empty hierarchy
+	const CVector3& MinBounds() const
+	{
+		return m_Nodes[0].minBounds;
+	}
+	const CVector3& MaxBounds() const
+	{
+		return m_Nodes[0].maxBounds;
+	}
+
+
+/*-----------------------------------------------------------------------------------------
+	Ray Casting
+-----------------------------------------------------------------------------------------*/
+// Rays start at the given origin, distances along them are measured in lengths of the given
+// direction vector (which need not be normalised). Triangles are hit from either side
+
+	// Find the nearest triangle hit by a ray within the given distance. Returns true if a
+	// triangle was hit, filling pDistance with the distance to the hit and optionally pTriangle
+	// with the index of the triangle hit (in the order passed to Build)
+	bool RayCast
+	(
+		const CVector3& origin,
+		const CVector3& direction,
+		const TFloat32  maxDistance,
+		TFloat32*       pDistance,
+		TUInt32*        pTriangle = 0
+	) const;
+
+	// Return true if a ray hits any triangle within the given distance. Stops at the first hit
+	// found, so is faster than RayCast - use for line of sight tests
+	bool RayHits
+	(
+		const CVector3& origin,
+		const CVector3& direction,
+		const TFloat32  maxDistance
+	) const;
+
+
+/*-----------------------------------------------------------------------------------------
+	Private interface
+-----------------------------------------------------------------------------------------*/
+private:
+
+	// A node is a box holding either two child nodes (stored together) or a leaf of triangle
+	// packets. The box coordinates are followed by an integer so each can be loaded as 4 floats
+	struct SNode
+	{
+		CVector3 minBounds;
+		TUInt32  first;      // Index of first child node, or first packet for a leaf
+		CVector3 maxBounds;
+		TUInt32  numPackets; // Number of packets in a leaf, 0 for nodes with children
+	};
+
+	// Four triangles stored as a corner and two edges from it (v0, v1-v0, v2-v0), with each
+	// coordinate of the four triangles together. Unused triangles have zero edges
+	struct SPacket
+	{
+		TFloat32 v0[3][kiTriangleBVHPacketSize];
+		TFloat32 edge1[3][kiTriangleBVHPacketSize];
+		TFloat32 edge2[3][kiTriangleBVHPacketSize];
+	};
+
+	// Bounds and centre of a triangle, used while building
+	struct SBuildTriangle
+	{
+		CVector3 minBounds;
+		CVector3 maxBounds;
+		CVector3 centre;
+	};
+
+
+	// Build the given node over a range of the triangles in m_BuildIndices, splitting it into
+	// children if worthwhile
+	void BuildNode
+	(
+		const TUInt32   node,
+		const TUInt32   first,
+		const TUInt32   numTriangles,
+		const TUInt32   depth,
+		const CVector3* pVertices
+	);
+
+	// Make the given node a leaf holding a range of the triangles in m_BuildIndices
+	void MakeLeaf
+	(
+		const TUInt32   node,
+		const TUInt32   first,
+		const TUInt32   numTriangles,
+		const CVector3* pVertices
+	);
+
+	// Cast a ray into the hierarchy, used for RayCast (nearest hit) and RayHits (any hit)
+	bool Trace
+	(
+		const CVector3& origin,
+		const CVector3& direction,
+		const TFloat32  maxDistance,
+		const bool      anyHit,
+		TFloat32*       pDistance,
+		TUInt32*        pTriangle
+	) const;
+
+
+	// Nodes of the hierarchy, the root is the first
+	vector<SNode> m_Nodes;
+
+	// Triangle packets for the leaves, and the original index of each triangle in the packets
+	// (kiTriangleBVHNull for unused triangles)
+	vector<SPacket> m_Packets;
+	vector<TUInt32> m_PacketTriangles;
+
+	TUInt32 m_NumTriangles;
+
+	// Triangle data used while building
+	vector<SBuildTriangle> m_BuildTriangles;
+	vector<TUInt32>        m_BuildIndices;
+};
+
+
+} // namespace gen
+
+#endif // GEN_C_TRIANGLE_BVH_H_INCLUDED
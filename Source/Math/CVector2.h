@@ -42,7 +42,7 @@ public:
 	CVector2() {}
 
 	// Construct by value
-	CVector2
+	constexpr CVector2
 	(
 		const TFloat32 xIn,
 		const TFloat32 yIn
@@ -66,7 +66,7 @@ public:
 
 
 	// Construct as vector between two points (p1 to p2)
-	CVector2
+	constexpr CVector2
 	(
 		const CVector2& p1,
 		const CVector2& p2
@@ -84,7 +84,7 @@ public:
 
 
 	// Copy constructor
-    CVector2( const CVector2& v ) : x( v.x ), y( v.y )
+    constexpr CVector2( const CVector2& v ) : x( v.x ), y( v.y )
 	{}
 
 	// Assignment operator
@@ -245,7 +245,7 @@ public:
 
 
 	// Dot product of this with another vector
-    TFloat32 Dot( const CVector2& v ) const
+    constexpr TFloat32 Dot( const CVector2& v ) const
 	{
 	    return x*v.x + y*v.y;
 	}
@@ -253,7 +253,7 @@ public:
 	
 	// Cross product of this with another vector, both promoted to 3D with a z component of 0
 	// Result is positive if the other vector is counter-clockwise from this vector
-    CVector2 Cross3D( const CVector2& v ) const
+    constexpr CVector2 Cross3D( const CVector2& v ) const
 	{
 		return CVector2(y*v.x - x*v.y, x*v.y - y*v.x);
 	}
@@ -273,7 +273,7 @@ public:
 	// Return squared length of this vector
 	// More efficient than Length when exact value is not required (e.g. for comparisons)
 	// Use InvSqrt( LengthSquared(...) ) to calculate 1 / length more efficiently
-	TFloat32 LengthSquared() const
+	constexpr TFloat32 LengthSquared() const
 	{
 		return x*x + y*y;
 	}
@@ -347,7 +347,7 @@ inline bool operator!=
 // Addition / subtraction
 
 // Vector addition
-inline CVector2 operator+
+constexpr CVector2 operator+
 (
 	const CVector2& v1,
 	const CVector2& v2
@@ -357,7 +357,7 @@ inline CVector2 operator+
 }
 
 // Vector subtraction
-inline CVector2 operator-
+constexpr CVector2 operator-
 (
 	const CVector2& v1,
 	const CVector2& v2
@@ -367,13 +367,13 @@ inline CVector2 operator-
 }
 
 // Unary positive (i.e. a = +v, included for completeness)
-inline CVector2 operator+( const CVector2& v )
+constexpr CVector2 operator+( const CVector2& v )
 {
 	return v;
 }
 
 // Unary negation (i.e. a = -v)
-inline CVector2 operator-( const CVector2& v )
+constexpr CVector2 operator-( const CVector2& v )
 {
 	return CVector2(-v.x, -v.y);
 }
@@ -383,7 +383,7 @@ inline CVector2 operator-( const CVector2& v )
 // Scalar multiplication & division
 
 // Vector multiplied by scalar
-inline CVector2 operator*
+constexpr CVector2 operator*
 (
 	const CVector2& v,
 	const TFloat32  s
@@ -393,7 +393,7 @@ inline CVector2 operator*
 }
 
 // Scalar multiplied by vector
-inline CVector2 operator*
+constexpr CVector2 operator*
 (
 	const TFloat32  s,
 	const CVector2& v
@@ -422,14 +422,14 @@ inline CVector2 operator/
 // Other operations
 
 // Return a vector perpendicular to the given one, in a counter-clockwise direction
-inline CVector2 Perpendicular( const CVector2& v )
+constexpr CVector2 Perpendicular( const CVector2& v )
 {
 	return CVector2(-v.y, v.x);
 }
 
 
 // Dot product of two given vectors (order not important) - non-member version
-inline TFloat32 Dot
+constexpr TFloat32 Dot
 (
 	const CVector2& v1,
 	const CVector2& v2
@@ -441,7 +441,7 @@ inline TFloat32 Dot
 // Cross product of two given vectors (order is important), both promoted to 3D with a
 // z component of 0 - non-member version
 // Result is positive if the second vector is counter-clockwise from the first
-inline CVector2 Cross3D
+constexpr CVector2 Cross3D
 (
 	const CVector2& v1,
 	const CVector2& v2
@@ -463,7 +463,7 @@ inline TFloat32 Length( const CVector2& v )
 // Return squared length of given vector
 // More efficient than Length when exact value is not required (e.g. for comparisons)
 // Use InvSqrt( LengthSquared(...) ) to calculate 1 / length more efficiently
-inline TFloat32 LengthSquared( const CVector2& v )
+constexpr TFloat32 LengthSquared( const CVector2& v )
 {
 	return v.x*v.x + v.y*v.y;
 }
@@ -0,0 +1,725 @@
+/**************************************************************************************************
+	Module:       CVector3Stream.cpp
+	Author:       agent
+	Date created: 16/10/26
+
+	Implementation of the concrete class CVector3Stream, an array of 3D vectors/points stored as
+	three separate arrays of x, y & z components (structure of arrays) for bulk processing
+
+	Copyright 2026, agent
+
+	Change history:
+		V1.0    Created 16/10/26 - AG
+**************************************************************************************************/
+
+#include "CVector3Stream.h"
+
+#include <string.h>
+#include <new>
+
+#include "CMatrix4x4.h"
+#include "MathSIMD.h"
+#include "AlignedAlloc.h"
+
+namespace gen
+{
+
+/*-----------------------------------------------------------------------------------------
+	Constructors/Destructors
+-----------------------------------------------------------------------------------------*/
+
+// Default constructor - empty stream
+CVector3Stream::CVector3Stream()
+{
+	m_Size = 0;
+	m_Capacity = 0;
+	m_pMemory = 0;
+	m_X = m_Y = m_Z = 0;
+}
+
+// Construct a stream of the given size - leaves values uninitialised (for performance)
+CVector3Stream::CVector3Stream( const TUInt32 size )
+{
+	m_Size = 0;
+	m_Capacity = 0;
+	m_pMemory = 0;
+	m_X = m_Y = m_Z = 0;
+	Resize( size );
+}
+
+// Construct from an array of CVector3
+CVector3Stream::CVector3Stream
+(
+	const CVector3* pVectors,
+	const TUInt32   numVectors
+)
+{
+	m_Size = 0;
+	m_Capacity = 0;
+	m_pMemory = 0;
+	m_X = m_Y = m_Z = 0;
+	Load( pVectors, numVectors );
+}
+
+// Copy constructor
+CVector3Stream::CVector3Stream( const CVector3Stream& s )
+{
+	m_Size = 0;
+	m_Capacity = 0;
+	m_pMemory = 0;
+	m_X = m_Y = m_Z = 0;
+	*this = s;
+}
+
+// Assignment operator
+CVector3Stream& CVector3Stream::operator=( const CVector3Stream& s )
+{
+	if (this != &s)
+	{
+		Resize( s.m_Size );
+		memcpy( m_X, s.m_X, m_Size * sizeof(TFloat32) );
+		memcpy( m_Y, s.m_Y, m_Size * sizeof(TFloat32) );
+		memcpy( m_Z, s.m_Z, m_Size * sizeof(TFloat32) );
+	}
+	return *this;
+}
+
+// Destructor
+CVector3Stream::~CVector3Stream()
+{
+	AlignedFree( m_pMemory );
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Size
+-----------------------------------------------------------------------------------------*/
+
+// Set the number of vectors in the stream. Existing vectors are retained (up to the new size)
+// but any new vectors are uninitialised
+void CVector3Stream::Resize( const TUInt32 size )
+{
+	if (size > m_Capacity)
+	{
+		Reserve( size );
+	}
+	m_Size = size;
+}
+
+// Ensure the stream can hold the given number of vectors without further allocation
+void CVector3Stream::Reserve( const TUInt32 capacity )
+{
+	if (capacity <= m_Capacity)
+	{
+		return;
+	}
+
+	// Pad each component array to a multiple of 4 floats (16 bytes), then allocate all three
+	// arrays as one 16-byte aligned block so each array is aligned
+	TUInt32 newCapacity = (capacity + 3) & ~3u;
+	TFloat32* pNewMemory = static_cast<TFloat32*>(AlignedAlloc( newCapacity * 3 * sizeof(TFloat32) ));
+	if (!pNewMemory)
+	{
+		throw bad_alloc();
+	}
+	TFloat32* pNewX = pNewMemory;
+	TFloat32* pNewY = pNewX + newCapacity;
+	TFloat32* pNewZ = pNewY + newCapacity;
+
+	// Retain existing vectors
+	if (m_Size)
+	{
+		memcpy( pNewX, m_X, m_Size * sizeof(TFloat32) );
+		memcpy( pNewY, m_Y, m_Size * sizeof(TFloat32) );
+		memcpy( pNewZ, m_Z, m_Size * sizeof(TFloat32) );
+	}
+	AlignedFree( m_pMemory );
+
+	m_pMemory = pNewMemory;
+	m_X = pNewX;
+	m_Y = pNewY;
+	m_Z = pNewZ;
+	m_Capacity = newCapacity;
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Conversion
+-----------------------------------------------------------------------------------------*/
+
+// Set the stream from an array of CVector3 - resizes the stream to the array size
+void CVector3Stream::Load
+(
+	const CVector3* pVectors,
+	const TUInt32   numVectors
+)
+{
+	Load( &pVectors->x, numVectors, sizeof(CVector3) );
+}
+
+// Set the stream from an array of structures each containing three floats at the same offset,
+// e.g. the position in mesh vertex data. Pass a pointer to the first x component and the
+// distance in bytes from one structure to the next. Resizes the stream to the array size
+void CVector3Stream::Load
+(
+	const void*   pFirstX,
+	const TUInt32 numVectors,
+	const TUInt32 stride
+)
+{
+	Resize( numVectors );
+
+	const TUInt8* pSource = reinterpret_cast<const TUInt8*>(pFirstX);
+	for (TUInt32 i = 0; i < numVectors; ++i)
+	{
+		const TFloat32* pCoord = reinterpret_cast<const TFloat32*>(pSource);
+		m_X[i] = pCoord[0];
+		m_Y[i] = pCoord[1];
+		m_Z[i] = pCoord[2];
+		pSource += stride;
+	}
+}
+
+// Copy the stream into an array of CVector3, which must be at least Size() in length
+void CVector3Stream::Store( CVector3* pVectors ) const
+{
+	Store( &pVectors->x, sizeof(CVector3) );
+}
+
+// Copy the stream into an array of structures each containing three floats at the same offset
+// (see Load above)
+void CVector3Stream::Store
+(
+	void*         pFirstX,
+	const TUInt32 stride
+) const
+{
+	TUInt8* pDest = reinterpret_cast<TUInt8*>(pFirstX);
+	for (TUInt32 i = 0; i < m_Size; ++i)
+	{
+		TFloat32* pCoord = reinterpret_cast<TFloat32*>(pDest);
+		pCoord[0] = m_X[i];
+		pCoord[1] = m_Y[i];
+		pCoord[2] = m_Z[i];
+		pDest += stride;
+	}
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Non-member Batch Operations
+-----------------------------------------------------------------------------------------*/
+// The SIMD versions process four vectors at a time up to the last multiple of four, then finish
+// with the scalar code. Component arrays are aligned so can use aligned loads, float arrays
+// passed in by the caller may not be aligned
+
+// Dot product of matching vectors in two streams (which must be the same size)
+void Dot
+(
+	TFloat32*             pOut,
+	const CVector3Stream& v1,
+	const CVector3Stream& v2
+)
+{
+	GEN_GUARD_OPT;
+	GEN_ASSERT_OPT( v1.Size() == v2.Size(), "Mismatched stream sizes" );
+
+	TUInt32 i = 0;
+#if defined(GEN_MATH_SSE)
+	for (; i + 4 <= v1.Size(); i += 4)
+	{
+		__m128 dot = _mm_mul_ps( _mm_load_ps( v1.X() + i ), _mm_load_ps( v2.X() + i ) );
+		dot = _mm_add_ps( dot, _mm_mul_ps( _mm_load_ps( v1.Y() + i ), _mm_load_ps( v2.Y() + i ) ) );
+		dot = _mm_add_ps( dot, _mm_mul_ps( _mm_load_ps( v1.Z() + i ), _mm_load_ps( v2.Z() + i ) ) );
+		_mm_storeu_ps( pOut + i, dot );
+	}
+#endif
+	for (; i < v1.Size(); ++i)
+	{
+		pOut[i] = v1.X()[i] * v2.X()[i] + v1.Y()[i] * v2.Y()[i] + v1.Z()[i] * v2.Z()[i];
+	}
+
+	GEN_ENDGUARD_OPT;
+}
+
+// Dot product of each vector in a stream with a single vector
+void Dot
+(
+	TFloat32*             pOut,
+	const CVector3Stream& v1,
+	const CVector3&       v2
+)
+{
+	TUInt32 i = 0;
+#if defined(GEN_MATH_SSE)
+	__m128 x2 = _mm_set1_ps( v2.x );
+	__m128 y2 = _mm_set1_ps( v2.y );
+	__m128 z2 = _mm_set1_ps( v2.z );
+	for (; i + 4 <= v1.Size(); i += 4)
+	{
+		__m128 dot = _mm_mul_ps( _mm_load_ps( v1.X() + i ), x2 );
+		dot = _mm_add_ps( dot, _mm_mul_ps( _mm_load_ps( v1.Y() + i ), y2 ) );
+		dot = _mm_add_ps( dot, _mm_mul_ps( _mm_load_ps( v1.Z() + i ), z2 ) );
+		_mm_storeu_ps( pOut + i, dot );
+	}
+#endif
+	for (; i < v1.Size(); ++i)
+	{
+		pOut[i] = v1.X()[i] * v2.x + v1.Y()[i] * v2.y + v1.Z()[i] * v2.z;
+	}
+}
+
+// Cross product of matching vectors in two streams (which must be the same size)
+void Cross
+(
+	CVector3Stream&       out,
+	const CVector3Stream& v1,
+	const CVector3Stream& v2
+)
+{
+	GEN_GUARD_OPT;
+	GEN_ASSERT_OPT( v1.Size() == v2.Size(), "Mismatched stream sizes" );
+
+	out.Resize( v1.Size() );
+	TUInt32 i = 0;
+#if defined(GEN_MATH_SSE)
+	for (; i + 4 <= v1.Size(); i += 4)
+	{
+		__m128 x1 = _mm_load_ps( v1.X() + i );
+		__m128 y1 = _mm_load_ps( v1.Y() + i );
+		__m128 z1 = _mm_load_ps( v1.Z() + i );
+		__m128 x2 = _mm_load_ps( v2.X() + i );
+		__m128 y2 = _mm_load_ps( v2.Y() + i );
+		__m128 z2 = _mm_load_ps( v2.Z() + i );
+		_mm_store_ps( out.X() + i, _mm_sub_ps( _mm_mul_ps( y1, z2 ), _mm_mul_ps( z1, y2 ) ) );
+		_mm_store_ps( out.Y() + i, _mm_sub_ps( _mm_mul_ps( z1, x2 ), _mm_mul_ps( x1, z2 ) ) );
+		_mm_store_ps( out.Z() + i, _mm_sub_ps( _mm_mul_ps( x1, y2 ), _mm_mul_ps( y1, x2 ) ) );
+	}
+#endif
+	for (; i < v1.Size(); ++i)
+	{
+		out.Set( i, Cross( v1.Get( i ), v2.Get( i ) ) );
+	}
+
+	GEN_ENDGUARD_OPT;
+}
+
+// Length of each vector in a stream
+void Length
+(
+	TFloat32*             pOut,
+	const CVector3Stream& v
+)
+{
+	TUInt32 i = 0;
+#if defined(GEN_MATH_SSE)
+	for (; i + 4 <= v.Size(); i += 4)
+	{
+		__m128 x = _mm_load_ps( v.X() + i );
+		__m128 y = _mm_load_ps( v.Y() + i );
+		__m128 z = _mm_load_ps( v.Z() + i );
+		__m128 lengthSq = _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, x ), _mm_mul_ps( y, y ) ),
+		                              _mm_mul_ps( z, z ) );
+		_mm_storeu_ps( pOut + i, _mm_sqrt_ps( lengthSq ) );
+	}
+#endif
+	for (; i < v.Size(); ++i)
+	{
+		pOut[i] = Sqrt( v.X()[i] * v.X()[i] + v.Y()[i] * v.Y()[i] + v.Z()[i] * v.Z()[i] );
+	}
+}
+
+// Normalise each vector in a stream, zero length vectors are set to (0,0,0) as for CVector3
+void Normalise
+(
+	CVector3Stream&       out,
+	const CVector3Stream& v
+)
+{
+	out.Resize( v.Size() );
+	TUInt32 i = 0;
+#if defined(GEN_MATH_SSE)
+	__m128 epsilon = _mm_set1_ps( kfEpsilon );
+	__m128 one = _mm_set1_ps( 1.0f );
+	for (; i + 4 <= v.Size(); i += 4)
+	{
+		__m128 x = _mm_load_ps( v.X() + i );
+		__m128 y = _mm_load_ps( v.Y() + i );
+		__m128 z = _mm_load_ps( v.Z() + i );
+		__m128 lengthSq = _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, x ), _mm_mul_ps( y, y ) ),
+		                              _mm_mul_ps( z, z ) );
+
+		// Mask out zero length vectors (matching the IsZero test used by CVector3). Those lanes
+		// divide by zero, but the result is discarded by the mask
+		__m128 nonZero = _mm_cmpge_ps( lengthSq, epsilon );
+		__m128 invLength = _mm_and_ps( nonZero, _mm_div_ps( one, _mm_sqrt_ps( lengthSq ) ) );
+		_mm_store_ps( out.X() + i, _mm_mul_ps( x, invLength ) );
+		_mm_store_ps( out.Y() + i, _mm_mul_ps( y, invLength ) );
+		_mm_store_ps( out.Z() + i, _mm_mul_ps( z, invLength ) );
+	}
+#endif
+	for (; i < v.Size(); ++i)
+	{
+		out.Set( i, Normalise( v.Get( i ) ) );
+	}
+}
+
+// Get the minimum and maximum x, y & z over all vectors in a (non-empty) stream, i.e. the axis
+// aligned bounding box of a stream of points
+void MinMax
+(
+	const CVector3Stream& v,
+	CVector3*             pMin,
+	CVector3*             pMax
+)
+{
+	GEN_GUARD;
+	GEN_ASSERT( v.Size() > 0, "Empty stream" );
+
+	CVector3 minV = v.Get( 0 );
+	CVector3 maxV = minV;
+
+	TUInt32 i = 0;
+#if defined(GEN_MATH_SSE)
+	if (v.Size() >= 4)
+	{
+		// Keep four running minimums/maximums for each component, combine them at the end
+		__m128 minX = _mm_load_ps( v.X() );
+		__m128 minY = _mm_load_ps( v.Y() );
+		__m128 minZ = _mm_load_ps( v.Z() );
+		__m128 maxX = minX;
+		__m128 maxY = minY;
+		__m128 maxZ = minZ;
+		for (i = 4; i + 4 <= v.Size(); i += 4)
+		{
+			__m128 x = _mm_load_ps( v.X() + i );
+			__m128 y = _mm_load_ps( v.Y() + i );
+			__m128 z = _mm_load_ps( v.Z() + i );
+			minX = _mm_min_ps( minX, x );
+			minY = _mm_min_ps( minY, y );
+			minZ = _mm_min_ps( minZ, z );
+			maxX = _mm_max_ps( maxX, x );
+			maxY = _mm_max_ps( maxY, y );
+			maxZ = _mm_max_ps( maxZ, z );
+		}
+
+		GEN_ALIGN(16) TFloat32 lanes[6][4];
+		_mm_store_ps( lanes[0], minX );
+		_mm_store_ps( lanes[1], minY );
+		_mm_store_ps( lanes[2], minZ );
+		_mm_store_ps( lanes[3], maxX );
+		_mm_store_ps( lanes[4], maxY );
+		_mm_store_ps( lanes[5], maxZ );
+		for (TUInt32 lane = 0; lane < 4; ++lane)
+		{
+			minV.x = Min( minV.x, lanes[0][lane] );
+			minV.y = Min( minV.y, lanes[1][lane] );
+			minV.z = Min( minV.z, lanes[2][lane] );
+			maxV.x = Max( maxV.x, lanes[3][lane] );
+			maxV.y = Max( maxV.y, lanes[4][lane] );
+			maxV.z = Max( maxV.z, lanes[5][lane] );
+		}
+	}
+#endif
+	for (; i < v.Size(); ++i)
+	{
+		minV.x = Min( minV.x, v.X()[i] );
+		minV.y = Min( minV.y, v.Y()[i] );
+		minV.z = Min( minV.z, v.Z()[i] );
+		maxV.x = Max( maxV.x, v.X()[i] );
+		maxV.y = Max( maxV.y, v.Y()[i] );
+		maxV.z = Max( maxV.z, v.Z()[i] );
+	}
+
+	*pMin = minV;
+	*pMax = maxV;
+
+	GEN_ENDGUARD;
+}
+
+// Return the greatest length of any vector in a stream, 0 if the stream is empty
+TFloat32 MaxLength( const CVector3Stream& v )
+{
+	// Find greatest squared length, only one square root needed at the end
+	TFloat32 maxLengthSq = 0.0f;
+
+	TUInt32 i = 0;
+#if defined(GEN_MATH_SSE)
+	if (v.Size() >= 4)
+	{
+		__m128 maxSq = _mm_setzero_ps();
+		for (; i + 4 <= v.Size(); i += 4)
+		{
+			__m128 x = _mm_load_ps( v.X() + i );
+			__m128 y = _mm_load_ps( v.Y() + i );
+			__m128 z = _mm_load_ps( v.Z() + i );
+			__m128 lengthSq = _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, x ), _mm_mul_ps( y, y ) ),
+			                              _mm_mul_ps( z, z ) );
+			maxSq = _mm_max_ps( maxSq, lengthSq );
+		}
+		maxSq = _mm_max_ps( maxSq, _mm_movehl_ps( maxSq, maxSq ) );
+		maxSq = _mm_max_ss( maxSq, GEN_SSE_SPLAT( maxSq, 1 ) );
+		_mm_store_ss( &maxLengthSq, maxSq );
+	}
+#endif
+	for (; i < v.Size(); ++i)
+	{
+		maxLengthSq = Max( maxLengthSq, v.X()[i] * v.X()[i] + v.Y()[i] * v.Y()[i] +
+		                                v.Z()[i] * v.Z()[i] );
+	}
+
+	return Sqrt( maxLengthSq );
+}
+
+// Transform each point in a stream by the given matrix (pre-multiplication: P' = P*M), assuming
+// each point's 4th element is 1
+void TransformPoints
+(
+	CVector3Stream&       out,
+	const CVector3Stream& p,
+	const CMatrix4x4&     m
+)
+{
+	out.Resize( p.Size() );
+	TUInt32 i = 0;
+#if defined(GEN_MATH_SSE)
+	__m128 e00 = _mm_set1_ps( m.e00 ), e01 = _mm_set1_ps( m.e01 ), e02 = _mm_set1_ps( m.e02 );
+	__m128 e10 = _mm_set1_ps( m.e10 ), e11 = _mm_set1_ps( m.e11 ), e12 = _mm_set1_ps( m.e12 );
+	__m128 e20 = _mm_set1_ps( m.e20 ), e21 = _mm_set1_ps( m.e21 ), e22 = _mm_set1_ps( m.e22 );
+	__m128 e30 = _mm_set1_ps( m.e30 ), e31 = _mm_set1_ps( m.e31 ), e32 = _mm_set1_ps( m.e32 );
+	for (; i + 4 <= p.Size(); i += 4)
+	{
+		__m128 x = _mm_load_ps( p.X() + i );
+		__m128 y = _mm_load_ps( p.Y() + i );
+		__m128 z = _mm_load_ps( p.Z() + i );
+		__m128 outX = _mm_add_ps( _mm_mul_ps( x, e00 ), _mm_mul_ps( y, e10 ) );
+		outX = _mm_add_ps( _mm_add_ps( outX, _mm_mul_ps( z, e20 ) ), e30 );
+		__m128 outY = _mm_add_ps( _mm_mul_ps( x, e01 ), _mm_mul_ps( y, e11 ) );
+		outY = _mm_add_ps( _mm_add_ps( outY, _mm_mul_ps( z, e21 ) ), e31 );
+		__m128 outZ = _mm_add_ps( _mm_mul_ps( x, e02 ), _mm_mul_ps( y, e12 ) );
+		outZ = _mm_add_ps( _mm_add_ps( outZ, _mm_mul_ps( z, e22 ) ), e32 );
+		_mm_store_ps( out.X() + i, outX );
+		_mm_store_ps( out.Y() + i, outY );
+		_mm_store_ps( out.Z() + i, outZ );
+	}
+#endif
+	for (; i < p.Size(); ++i)
+	{
+		out.Set( i, m.TransformPoint( p.Get( i ) ) );
+	}
+}
+
+// Transform each vector in a stream by the given matrix (pre-multiplication: V' = V*M), assuming
+// each vector's 4th element is 0
+void TransformVectors
+(
+	CVector3Stream&       out,
+	const CVector3Stream& v,
+	const CMatrix4x4&     m
+)
+{
+	out.Resize( v.Size() );
+	TUInt32 i = 0;
+#if defined(GEN_MATH_SSE)
+	__m128 e00 = _mm_set1_ps( m.e00 ), e01 = _mm_set1_ps( m.e01 ), e02 = _mm_set1_ps( m.e02 );
+	__m128 e10 = _mm_set1_ps( m.e10 ), e11 = _mm_set1_ps( m.e11 ), e12 = _mm_set1_ps( m.e12 );
+	__m128 e20 = _mm_set1_ps( m.e20 ), e21 = _mm_set1_ps( m.e21 ), e22 = _mm_set1_ps( m.e22 );
+	for (; i + 4 <= v.Size(); i += 4)
+	{
+		__m128 x = _mm_load_ps( v.X() + i );
+		__m128 y = _mm_load_ps( v.Y() + i );
+		__m128 z = _mm_load_ps( v.Z() + i );
+		_mm_store_ps( out.X() + i, _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, e00 ), _mm_mul_ps( y, e10 ) ),
+		                                       _mm_mul_ps( z, e20 ) ) );
+		_mm_store_ps( out.Y() + i, _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, e01 ), _mm_mul_ps( y, e11 ) ),
+		                                       _mm_mul_ps( z, e21 ) ) );
+		_mm_store_ps( out.Z() + i, _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, e02 ), _mm_mul_ps( y, e12 ) ),
+		                                       _mm_mul_ps( z, e22 ) ) );
+	}
+#endif
+	for (; i < v.Size(); ++i)
+	{
+		out.Set( i, m.TransformVector( v.Get( i ) ) );
+	}
+}
+
+
+// Test spheres against a set of planes, e.g. the planes of a viewing frustum. Sphere centres are
+// passed as a stream and radii as an array of the same size. Each plane is given as a normal and
+// a distance, so that points p on the plane have Dot(p, normal) == distance, with the normal
+// pointing away from the inside. A sphere is outside if its centre is further than its radius in
+// front of any plane. Writes the indexes of the spheres that are not outside any plane to the
+// given array (in increasing order) and returns how many were written. The index array must be
+// at least the size of the stream
+TUInt32 SpheresInsidePlanes
+(
+	TUInt32*              pIndices,
+	const CVector3Stream& centres,
+	const TFloat32*       pRadii,
+	const CVector3*       pNormals,
+	const TFloat32*       pDistances,
+	const TUInt32         numPlanes
+)
+{
+	TUInt32 numInside = 0;
+	TUInt32 i = 0;
+#if defined(GEN_MATH_SSE)
+	// Splat the components of the first few planes (enough for a frustum) once, rather than for
+	// every group of spheres
+	const TUInt32 kiMaxSplatPlanes = 8;
+	__m128 planeSplats[kiMaxSplatPlanes][4];
+	TUInt32 numSplatPlanes = Min( numPlanes, kiMaxSplatPlanes );
+	for (TUInt32 plane = 0; plane < numSplatPlanes; ++plane)
+	{
+		planeSplats[plane][0] = _mm_set1_ps( pNormals[plane].x );
+		planeSplats[plane][1] = _mm_set1_ps( pNormals[plane].y );
+		planeSplats[plane][2] = _mm_set1_ps( pNormals[plane].z );
+		planeSplats[plane][3] = _mm_set1_ps( pDistances[plane] );
+	}
+
+	// Test four spheres at a time against every plane. Testing all planes is faster than
+	// stopping early when all four spheres are outside, which is hard to predict
+	__m128 allInside = _mm_cmpeq_ps( _mm_setzero_ps(), _mm_setzero_ps() );
+	for (; i + 4 <= centres.Size(); i += 4)
+	{
+		__m128 x = _mm_load_ps( centres.X() + i );
+		__m128 y = _mm_load_ps( centres.Y() + i );
+		__m128 z = _mm_load_ps( centres.Z() + i );
+		__m128 radius = _mm_loadu_ps( pRadii + i );
+		__m128 inside = allInside;
+		TUInt32 plane = 0;
+		for (; plane < numSplatPlanes; ++plane)
+		{
+			__m128 dist = _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, planeSplats[plane][0] ),
+			                                      _mm_mul_ps( y, planeSplats[plane][1] ) ),
+			                          _mm_mul_ps( z, planeSplats[plane][2] ) );
+			dist = _mm_sub_ps( dist, planeSplats[plane][3] );
+			inside = _mm_and_ps( inside, _mm_cmple_ps( dist, radius ) );
+		}
+		for (; plane < numPlanes; ++plane)
+		{
+			__m128 dist = _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, _mm_set1_ps( pNormals[plane].x ) ),
+			                                      _mm_mul_ps( y, _mm_set1_ps( pNormals[plane].y ) ) ),
+			                          _mm_mul_ps( z, _mm_set1_ps( pNormals[plane].z ) ) );
+			dist = _mm_sub_ps( dist, _mm_set1_ps( pDistances[plane] ) );
+			inside = _mm_and_ps( inside, _mm_cmple_ps( dist, radius ) );
+		}
+		TUInt32 insideMask = _mm_movemask_ps( inside );
+
+		// Append indexes of spheres still inside without branching. Each index is written to the
+		// next free slot, but the slot is only kept if the sphere is inside. Slots up to i + 3 may
+		// be written, which is within the array
+		pIndices[numInside] = i;
+		numInside += insideMask & 1;
+		pIndices[numInside] = i + 1;
+		numInside += (insideMask >> 1) & 1;
+		pIndices[numInside] = i + 2;
+		numInside += (insideMask >> 2) & 1;
+		pIndices[numInside] = i + 3;
+		numInside += insideMask >> 3;
+	}
+#endif
+	for (; i < centres.Size(); ++i)
+	{
+		TFloat32 x = centres.X()[i];
+		TFloat32 y = centres.Y()[i];
+		TFloat32 z = centres.Z()[i];
+		bool isInside = true;
+		for (TUInt32 plane = 0; plane < numPlanes && isInside; ++plane)
+		{
+			TFloat32 dist = x * pNormals[plane].x + y * pNormals[plane].y + z * pNormals[plane].z;
+			isInside = dist - pDistances[plane] <= pRadii[i];
+		}
+		if (isInside)
+		{
+			pIndices[numInside++] = i;
+		}
+	}
+
+	return numInside;
+}
+
+// Test spheres against several sets of planes at once, e.g. the frustums of several views,
+// writing a visibility bitset for each set of planes
+void SpheresInsideFrustums
+(
+	TUInt32*              pBitsets,
+	const CVector3Stream& centres,
+	const TFloat32*       pRadii,
+	const CVector3*       pNormals,
+	const TFloat32*       pDistances,
+	const TUInt32         numPlanes,
+	const TUInt32         numFrustums
+)
+{
+	GEN_GUARD_OPT;
+	GEN_ASSERT_OPT( numPlanes * numFrustums <= kiMaxMultiFrustumPlanes, "Too many planes" );
+
+	const TUInt32 numWords = NumBitsetWords( centres.Size() );
+	memset( pBitsets, 0, numWords * numFrustums * sizeof(TUInt32) );
+
+	TUInt32 i = 0;
+#if defined(GEN_MATH_SSE)
+	// Splat the components of all planes once, rather than for every group of spheres
+	__m128 planeSplats[kiMaxMultiFrustumPlanes][4];
+	for (TUInt32 plane = 0; plane < numPlanes * numFrustums; ++plane)
+	{
+		planeSplats[plane][0] = _mm_set1_ps( pNormals[plane].x );
+		planeSplats[plane][1] = _mm_set1_ps( pNormals[plane].y );
+		planeSplats[plane][2] = _mm_set1_ps( pNormals[plane].z );
+		planeSplats[plane][3] = _mm_set1_ps( pDistances[plane] );
+	}
+
+	// Load four spheres at a time and test them against every frustum. Groups start at multiples of
+	// four so the four results fit in one bitset word
+	__m128 allInside = _mm_cmpeq_ps( _mm_setzero_ps(), _mm_setzero_ps() );
+	for (; i + 4 <= centres.Size(); i += 4)
+	{
+		__m128 x = _mm_load_ps( centres.X() + i );
+		__m128 y = _mm_load_ps( centres.Y() + i );
+		__m128 z = _mm_load_ps( centres.Z() + i );
+		__m128 radius = _mm_loadu_ps( pRadii + i );
+		const __m128 (*pPlane)[4] = planeSplats;
+		TUInt32* pWord = pBitsets + i / 32;
+		for (TUInt32 frustum = 0; frustum < numFrustums; ++frustum)
+		{
+			__m128 inside = allInside;
+			for (TUInt32 plane = 0; plane < numPlanes; ++plane, ++pPlane)
+			{
+				__m128 dist = _mm_add_ps( _mm_add_ps( _mm_mul_ps( x, (*pPlane)[0] ),
+				                                      _mm_mul_ps( y, (*pPlane)[1] ) ),
+				                          _mm_mul_ps( z, (*pPlane)[2] ) );
+				dist = _mm_sub_ps( dist, (*pPlane)[3] );
+				inside = _mm_and_ps( inside, _mm_cmple_ps( dist, radius ) );
+			}
+			*pWord |= static_cast<TUInt32>(_mm_movemask_ps( inside )) << (i & 31);
+			pWord += numWords;
+		}
+	}
+#endif
+	for (; i < centres.Size(); ++i)
+	{
+		TFloat32 x = centres.X()[i];
+		TFloat32 y = centres.Y()[i];
+		TFloat32 z = centres.Z()[i];
+		TUInt32 plane = 0;
+		for (TUInt32 frustum = 0; frustum < numFrustums; ++frustum)
+		{
+			bool isInside = true;
+			for (TUInt32 lastPlane = plane + numPlanes; plane < lastPlane; ++plane)
+			{
+				TFloat32 dist = x * pNormals[plane].x + y * pNormals[plane].y + z * pNormals[plane].z;
+				isInside = isInside && dist - pDistances[plane] <= pRadii[i];
+			}
+			if (isInside)
+			{
+				pBitsets[frustum * numWords + i / 32] |= 1u << (i & 31);
+			}
+		}
+	}
+
+	GEN_ENDGUARD_OPT;
+}
+
+
+} // namespace gen
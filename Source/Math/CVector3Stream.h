@@ -0,0 +1,342 @@
+/**************************************************************************************************
+	Module:       CVector3Stream.h
+	Author:       agent
+	Date created: 16/10/26
+
+	Definition of the concrete class CVector3Stream, an array of 3D vectors/points stored as
+	three separate arrays of x, y & z components (structure of arrays) for bulk processing
+
+	Copyright 2026, agent
+
+	Change history:
+		V1.0    Created 16/10/26 - AG
+**************************************************************************************************/
+
+// A CVector3 array stores x,y,z,x,y,z,... (array of structures - AoS). This class stores
+// x,x,x,... y,y,y,... z,z,z,... instead (structure of arrays - SoA). Operations over many vectors
+// can then process four vectors at a time with SIMD instructions (see MathSIMD.h), e.g. four dot
+// products use three multiplies and two adds, with no shuffling of components required
+//
+// Notes:
+// - Each component array is 16-byte aligned and padded to a multiple of four elements. The padding
+//   elements are not initialised and are never included in results
+// - Use the Load / Store functions to convert to and from CVector3 arrays, or any array of
+//   structures containing a CVector3 at a fixed offset (e.g. mesh vertex data)
+// - Batch operations are provided as non-member functions after the class, the output stream or
+//   array may be the same as an input for all of them. Output streams are resized as necessary
+
+#ifndef GEN_C_VECTOR_3_STREAM_H_INCLUDED
+#define GEN_C_VECTOR_3_STREAM_H_INCLUDED
+
+#include "Defines.h"
+#include "Error.h"
+#include "CVector3.h"
+
+namespace gen
+{
+
+// Forward declaration of classes, where includes are only possible/necessary in the .cpp file
+class CMatrix4x4;
+
+
+class CVector3Stream
+{
+	GEN_CLASS( CVector3Stream );
+
+// Concrete class - public access
+public:
+
+	/*-----------------------------------------------------------------------------------------
+		Constructors/Destructors
+	-----------------------------------------------------------------------------------------*/
+
+	// Default constructor - empty stream
+	CVector3Stream();
+
+	// Construct a stream of the given size - leaves values uninitialised (for performance)
+	explicit CVector3Stream( const TUInt32 size );
+
+	// Construct from an array of CVector3
+	CVector3Stream
+	(
+		const CVector3* pVectors,
+		const TUInt32   numVectors
+	);
+
+	// Copy constructor
+	CVector3Stream( const CVector3Stream& s );
+
+	// Assignment operator
+	CVector3Stream& operator=( const CVector3Stream& s );
+
+	// Destructor
+	~CVector3Stream();
+
+
+	/*-----------------------------------------------------------------------------------------
+		Size
+	-----------------------------------------------------------------------------------------*/
+
+	// Return number of vectors in the stream
+	TUInt32 Size() const
+	{
+		return m_Size;
+	}
+
+	// Set the number of vectors in the stream. Existing vectors are retained (up to the new size)
+	// but any new vectors are uninitialised
+	void Resize( const TUInt32 size );
+
+	// Ensure the stream can hold the given number of vectors without further allocation
+	void Reserve( const TUInt32 capacity );
+
+	// Set number of vectors to 0, retaining allocated memory
+	void Clear()
+	{
+		m_Size = 0;
+	}
+
+
+	/*-----------------------------------------------------------------------------------------
+		Element Access
+	-----------------------------------------------------------------------------------------*/
+
+	// Direct access to the component arrays (16-byte aligned)
+	TFloat32* X()
+	{
+		return m_X;
+	}
+	TFloat32* Y()
+	{
+		return m_Y;
+	}
+	TFloat32* Z()
+	{
+		return m_Z;
+	}
+	const TFloat32* X() const
+	{
+		return m_X;
+	}
+	const TFloat32* Y() const
+	{
+		return m_Y;
+	}
+	const TFloat32* Z() const
+	{
+		return m_Z;
+	}
+
+	// Return the vector at the given index
+	CVector3 Get( const TUInt32 index ) const
+	{
+		GEN_GUARD_OPT;
+		GEN_ASSERT_OPT( index < m_Size, "Invalid parameter" );
+
+		return CVector3( m_X[index], m_Y[index], m_Z[index] );
+
+		GEN_ENDGUARD_OPT;
+	}
+
+	// Set the vector at the given index
+	void Set
+	(
+		const TUInt32   index,
+		const CVector3& v
+	)
+	{
+		GEN_GUARD_OPT;
+		GEN_ASSERT_OPT( index < m_Size, "Invalid parameter" );
+
+		m_X[index] = v.x;
+		m_Y[index] = v.y;
+		m_Z[index] = v.z;
+
+		GEN_ENDGUARD_OPT;
+	}
+
+	// Add a vector to the end of the stream
+	void PushBack( const CVector3& v )
+	{
+		if (m_Size == m_Capacity)
+		{
+			Reserve( m_Capacity * 2 + 4 );
+		}
+		m_X[m_Size] = v.x;
+		m_Y[m_Size] = v.y;
+		m_Z[m_Size] = v.z;
+		++m_Size;
+	}
+
+
+	/*-----------------------------------------------------------------------------------------
+		Conversion
+	-----------------------------------------------------------------------------------------*/
+
+	// Set the stream from an array of CVector3 - resizes the stream to the array size
+	void Load
+	(
+		const CVector3* pVectors,
+		const TUInt32   numVectors
+	);
+
+	// Set the stream from an array of structures each containing three floats at the same offset,
+	// e.g. the position in mesh vertex data. Pass a pointer to the first x component and the
+	// distance in bytes from one structure to the next. Resizes the stream to the array size
+	void Load
+	(
+		const void*   pFirstX,
+		const TUInt32 numVectors,
+		const TUInt32 stride
+	);
+
+	// Copy the stream into an array of CVector3, which must be at least Size() in length
+	void Store( CVector3* pVectors ) const;
+
+	// Copy the stream into an array of structures each containing three floats at the same offset
+	// (see Load above)
+	void Store
+	(
+		void*         pFirstX,
+		const TUInt32 stride
+	) const;
+
+
+	/*---------------------------------------------------------------------------------------------
+		Private interface
+	---------------------------------------------------------------------------------------------*/
+private:
+
+	// Number of vectors in use and allocated (allocated is always a multiple of 4)
+	TUInt32   m_Size;
+	TUInt32   m_Capacity;
+
+	// Single aligned allocation holding all three component arrays, and the arrays within it
+	TFloat32* m_pMemory;
+	TFloat32* m_X;
+	TFloat32* m_Y;
+	TFloat32* m_Z;
+};
+
+
+/*-----------------------------------------------------------------------------------------
+	Non-member Batch Operations
+-----------------------------------------------------------------------------------------*/
+// Arrays of floats passed or returned must be at least the size of the input stream(s)
+
+// Dot product of matching vectors in two streams (which must be the same size)
+void Dot
+(
+	TFloat32*             pOut,
+	const CVector3Stream& v1,
+	const CVector3Stream& v2
+);
+
+// Dot product of each vector in a stream with a single vector
+void Dot
+(
+	TFloat32*             pOut,
+	const CVector3Stream& v1,
+	const CVector3&       v2
+);
+
+// Cross product of matching vectors in two streams (which must be the same size)
+void Cross
+(
+	CVector3Stream&       out,
+	const CVector3Stream& v1,
+	const CVector3Stream& v2
+);
+
+// Length of each vector in a stream
+void Length
+(
+	TFloat32*             pOut,
+	const CVector3Stream& v
+);
+
+// Normalise each vector in a stream, zero length vectors are set to (0,0,0) as for CVector3
+void Normalise
+(
+	CVector3Stream&       out,
+	const CVector3Stream& v
+);
+
+// Get the minimum and maximum x, y & z over all vectors in a (non-empty) stream, i.e. the axis
+// aligned bounding box of a stream of points
+void MinMax
+(
+	const CVector3Stream& v,
+	CVector3*             pMin,
+	CVector3*             pMax
+);
+
+// Return the greatest length of any vector in a stream, 0 if the stream is empty
+TFloat32 MaxLength( const CVector3Stream& v );
+
+// Transform each point in a stream by the given matrix (pre-multiplication: P' = P*M), assuming
+// each point's 4th element is 1
+void TransformPoints
+(
+	CVector3Stream&       out,
+	const CVector3Stream& p,
+	const CMatrix4x4&     m
+);
+
+// Transform each vector in a stream by the given matrix (pre-multiplication: V' = V*M), assuming
+// each vector's 4th element is 0
+void TransformVectors
+(
+	CVector3Stream&       out,
+	const CVector3Stream& v,
+	const CMatrix4x4&     m
+);
+
+
+// Test spheres against a set of planes, e.g. the planes of a viewing frustum. Sphere centres are
+// passed as a stream and radii as an array of the same size. Each plane is given as a normal and
+// a distance, so that points p on the plane have Dot(p, normal) == distance, with the normal
+// pointing away from the inside. A sphere is outside if its centre is further than its radius in
+// front of any plane. Writes the indexes of the spheres that are not outside any plane to the
+// given array (in increasing order) and returns how many were written. The index array must be
+// at least the size of the stream
+TUInt32 SpheresInsidePlanes
+(
+	TUInt32*              pIndices,
+	const CVector3Stream& centres,
+	const TFloat32*       pRadii,
+	const CVector3*       pNormals,
+	const TFloat32*       pDistances,
+	const TUInt32         numPlanes
+);
+
+// Greatest total number of planes passed to SpheresInsideFrustums
+const TUInt32 kiMaxMultiFrustumPlanes = 96;
+
+// Test spheres against several sets of planes at once, e.g. the frustums of several views. Planes
+// are given as for SpheresInsidePlanes, with the planes of each frustum in turn (numFrustums
+// sets of numPlanes planes, at most kiMaxMultiFrustumPlanes in total). Each sphere is read once and
+// tested against every frustum. Writes a visibility bitset for each frustum: bit (i % 32) of word
+// (i / 32) is set if sphere i is not outside any plane of the frustum. The sets are written one
+// after another, each NumBitsetWords( centres.Size() ) words long
+void SpheresInsideFrustums
+(
+	TUInt32*              pBitsets,
+	const CVector3Stream& centres,
+	const TFloat32*       pRadii,
+	const CVector3*       pNormals,
+	const TFloat32*       pDistances,
+	const TUInt32         numPlanes,
+	const TUInt32         numFrustums
+);
+
+// Return the number of 32-bit words in a bitset with the given number of bits
+inline TUInt32 NumBitsetWords( const TUInt32 numBits )
+{
+	return (numBits + 31) / 32;
+}
+
+
+} // namespace gen
+
+#endif // GEN_C_VECTOR_3_STREAM_H_INCLUDED
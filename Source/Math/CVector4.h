@@ -39,7 +39,7 @@ public:
 	CVector4() {}
 
 	// Construct by value
-	CVector4
+	constexpr CVector4
 	(
 		const TFloat32 xIn,
 		const TFloat32 yIn,
@@ -67,7 +67,7 @@ public:
 
 
 	// Construct as vector between two 3D points (p1 to p2) and a w value (defaults to 0)
-	CVector4
+	constexpr CVector4
 	(
 		const CVector3& p1,
 		const CVector3& p2,
@@ -77,7 +77,7 @@ public:
 
 
 	// Construct from a CVector2 and z & w values (default to 0)
-	explicit CVector4
+	explicit constexpr CVector4
 	(
 		const CVector2& v,
 		const TFloat32 zIn = 0.0f,
@@ -87,7 +87,7 @@ public:
 	// Require explicit conversion from CVector2 (see above)
 
 	// Construct from a CVector3 and a w value (defaults to 0)
-	explicit CVector4
+	explicit constexpr CVector4
 	(
 		const CVector3& v,
 		const TFloat32 wIn = 0.0f
@@ -97,7 +97,7 @@ public:
 
 
 	// Copy constructor
-    CVector4( const CVector4& v ) : x( v.x ), y( v.y ), z( v.z ), w( v.w )
+    constexpr CVector4( const CVector4& v ) : x( v.x ), y( v.y ), z( v.z ), w( v.w )
 	{}
 
 	// Assignment operator
@@ -294,7 +294,7 @@ public:
 	// Other operations
 
 	// Dot product of this with another vector
-    TFloat32 Dot( const CVector4& v ) const
+    constexpr TFloat32 Dot( const CVector4& v ) const
 	{
 	    return x*v.x + y*v.y + z*v.z + w*v.w;
 	}
@@ -322,7 +322,7 @@ public:
 	// Return squared length of this vector
 	// More efficient than Length when exact value is not required (e.g. for comparisons)
 	// Use InvSqrt( LengthSquared(...) ) to calculate 1 / length more efficiently
-	TFloat32 LengthSquared() const
+	constexpr TFloat32 LengthSquared() const
 	{
 		return x*x + y*y + z*z + w*w;
 	}
@@ -388,7 +388,7 @@ inline bool operator!=
 // Addition / subtraction
 
 // Vector addition
-inline CVector4 operator+
+constexpr CVector4 operator+
 (
 	const CVector4& v1,
 	const CVector4& v2
@@ -398,7 +398,7 @@ inline CVector4 operator+
 }
 
 // Vector subtraction
-inline CVector4 operator-
+constexpr CVector4 operator-
 (
 	const CVector4& v1,
 	const CVector4& v2
@@ -408,13 +408,13 @@ inline CVector4 operator-
 }
 
 // Unary positive (i.e. a = +v, included for completeness)
-inline CVector4 operator+( const CVector4& v )
+constexpr CVector4 operator+( const CVector4& v )
 {
 	return v;
 }
 
 // Unary negation (i.e. a = -v)
-inline CVector4 operator-( const CVector4& v )
+constexpr CVector4 operator-( const CVector4& v )
 {
 	return CVector4(-v.x, -v.y, -v.z, -v.w);
 }
@@ -424,7 +424,7 @@ inline CVector4 operator-( const CVector4& v )
 // Scalar multiplication & division
 
 // Vector multiplied by scalar
-inline CVector4 operator*
+constexpr CVector4 operator*
 (
 	const CVector4& v,
 	const TFloat32  s
@@ -434,7 +434,7 @@ inline CVector4 operator*
 }
 
 // Scalar multiplied by vtor
-inline CVector4 operator*
+constexpr CVector4 operator*
 (
 	const TFloat32  s,
 	const CVector4& v
@@ -463,7 +463,7 @@ inline CVector4 operator/
 // Other operations
 
 // Dot product of two given vectors (order not important) - non-member version
-inline TFloat32 Dot
+constexpr TFloat32 Dot
 (
 	const CVector4& v1,
 	const CVector4& v2
@@ -473,7 +473,7 @@ inline TFloat32 Dot
 }
 
 // Cross product of two given vectors (order is important) - non-member version
-inline CVector4 Cross
+constexpr CVector4 Cross
 (
 	const CVector4& v1,
 	const CVector4& v2
@@ -497,7 +497,7 @@ inline TFloat32 Length( const CVector4& v )
 // Return squared length of given vector
 // More efficient than Length when exact value is not required (e.g. for comparisons)
 // Use InvSqrt( LengthSquared(...) ) to calculate 1 / length more efficiently
-inline TFloat32 LengthSquared( const CVector4& v )
+constexpr TFloat32 LengthSquared( const CVector4& v )
 {
 	return v.x*v.x + v.y*v.y + v.z*v.z + v.w*v.w;
 }
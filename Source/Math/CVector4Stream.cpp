@@ -0,0 +1,310 @@
+/**************************************************************************************************
+	Module:       CVector4Stream.cpp
+	Author:       agent
+	Date created: 16/10/26
+
+	Implementation of the concrete class CVector4Stream, an array of 4D vectors stored as four
+	separate arrays of x, y, z & w components (structure of arrays) for bulk processing
+
+	Copyright 2026, agent
+
+	Change history:
+		V1.0    Created 16/10/26 - AG
+**************************************************************************************************/
+
+#include "CVector4Stream.h"
+
+#include <string.h>
+#include <new>
+
+#include "CVector3Stream.h"
+#include "CMatrix4x4.h"
+#include "MathSIMD.h"
+#include "AlignedAlloc.h"
+
+namespace gen
+{
+
+/*-----------------------------------------------------------------------------------------
+	Constructors/Destructors
+-----------------------------------------------------------------------------------------*/
+
+// Default constructor - empty stream
+CVector4Stream::CVector4Stream()
+{
+	m_Size = 0;
+	m_Capacity = 0;
+	m_pMemory = 0;
+	m_X = m_Y = m_Z = m_W = 0;
+}
+
+// Construct a stream of the given size - leaves values uninitialised (for performance)
+CVector4Stream::CVector4Stream( const TUInt32 size )
+{
+	m_Size = 0;
+	m_Capacity = 0;
+	m_pMemory = 0;
+	m_X = m_Y = m_Z = m_W = 0;
+	Resize( size );
+}
+
+// Construct from an array of CVector4
+CVector4Stream::CVector4Stream
+(
+	const CVector4* pVectors,
+	const TUInt32   numVectors
+)
+{
+	m_Size = 0;
+	m_Capacity = 0;
+	m_pMemory = 0;
+	m_X = m_Y = m_Z = m_W = 0;
+	Load( pVectors, numVectors );
+}
+
+// Copy constructor
+CVector4Stream::CVector4Stream( const CVector4Stream& s )
+{
+	m_Size = 0;
+	m_Capacity = 0;
+	m_pMemory = 0;
+	m_X = m_Y = m_Z = m_W = 0;
+	*this = s;
+}
+
+// Assignment operator
+CVector4Stream& CVector4Stream::operator=( const CVector4Stream& s )
+{
+	if (this != &s)
+	{
+		Resize( s.m_Size );
+		memcpy( m_X, s.m_X, m_Size * sizeof(TFloat32) );
+		memcpy( m_Y, s.m_Y, m_Size * sizeof(TFloat32) );
+		memcpy( m_Z, s.m_Z, m_Size * sizeof(TFloat32) );
+		memcpy( m_W, s.m_W, m_Size * sizeof(TFloat32) );
+	}
+	return *this;
+}
+
+// Destructor
+CVector4Stream::~CVector4Stream()
+{
+	AlignedFree( m_pMemory );
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Size
+-----------------------------------------------------------------------------------------*/
+
+// Set the number of vectors in the stream. Existing vectors are retained (up to the new size)
+// but any new vectors are uninitialised
+void CVector4Stream::Resize( const TUInt32 size )
+{
+	if (size > m_Capacity)
+	{
+		Reserve( size );
+	}
+	m_Size = size;
+}
+
+// Ensure the stream can hold the given number of vectors without further allocation
+void CVector4Stream::Reserve( const TUInt32 capacity )
+{
+	if (capacity <= m_Capacity)
+	{
+		return;
+	}
+
+	// Same layout as CVector3Stream: padded component arrays in a single aligned allocation
+	TUInt32 newCapacity = (capacity + 3) & ~3u;
+	TFloat32* pNewMemory = static_cast<TFloat32*>(AlignedAlloc( newCapacity * 4 * sizeof(TFloat32) ));
+	if (!pNewMemory)
+	{
+		throw bad_alloc();
+	}
+	TFloat32* pNewX = pNewMemory;
+	TFloat32* pNewY = pNewX + newCapacity;
+	TFloat32* pNewZ = pNewY + newCapacity;
+	TFloat32* pNewW = pNewZ + newCapacity;
+
+	// Retain existing vectors
+	if (m_Size)
+	{
+		memcpy( pNewX, m_X, m_Size * sizeof(TFloat32) );
+		memcpy( pNewY, m_Y, m_Size * sizeof(TFloat32) );
+		memcpy( pNewZ, m_Z, m_Size * sizeof(TFloat32) );
+		memcpy( pNewW, m_W, m_Size * sizeof(TFloat32) );
+	}
+	AlignedFree( m_pMemory );
+
+	m_pMemory = pNewMemory;
+	m_X = pNewX;
+	m_Y = pNewY;
+	m_Z = pNewZ;
+	m_W = pNewW;
+	m_Capacity = newCapacity;
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Conversion
+-----------------------------------------------------------------------------------------*/
+
+// Set the stream from an array of CVector4 - resizes the stream to the array size
+void CVector4Stream::Load
+(
+	const CVector4* pVectors,
+	const TUInt32   numVectors
+)
+{
+	Resize( numVectors );
+	for (TUInt32 i = 0; i < numVectors; ++i)
+	{
+		m_X[i] = pVectors[i].x;
+		m_Y[i] = pVectors[i].y;
+		m_Z[i] = pVectors[i].z;
+		m_W[i] = pVectors[i].w;
+	}
+}
+
+// Set the stream from a stream of 3D vectors and a w value used for every vector, e.g. w = 1
+// to treat them as points. Resizes the stream to the size of the source stream
+void CVector4Stream::Load
+(
+	const CVector3Stream& v,
+	const TFloat32        w
+)
+{
+	Resize( v.Size() );
+	memcpy( m_X, v.X(), m_Size * sizeof(TFloat32) );
+	memcpy( m_Y, v.Y(), m_Size * sizeof(TFloat32) );
+	memcpy( m_Z, v.Z(), m_Size * sizeof(TFloat32) );
+	for (TUInt32 i = 0; i < m_Size; ++i)
+	{
+		m_W[i] = w;
+	}
+}
+
+// Copy the stream into an array of CVector4, which must be at least Size() in length
+void CVector4Stream::Store( CVector4* pVectors ) const
+{
+	for (TUInt32 i = 0; i < m_Size; ++i)
+	{
+		pVectors[i].x = m_X[i];
+		pVectors[i].y = m_Y[i];
+		pVectors[i].z = m_Z[i];
+		pVectors[i].w = m_W[i];
+	}
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Non-member Batch Operations
+-----------------------------------------------------------------------------------------*/
+// As CVector3Stream - SIMD versions process blocks of four, scalar code finishes the remainder
+
+// Dot product of matching vectors in two streams (which must be the same size)
+void Dot
+(
+	TFloat32*             pOut,
+	const CVector4Stream& v1,
+	const CVector4Stream& v2
+)
+{
+	GEN_GUARD_OPT;
+	GEN_ASSERT_OPT( v1.Size() == v2.Size(), "Mismatched stream sizes" );
+
+	TUInt32 i = 0;
+#if defined(GEN_MATH_SSE)
+	for (; i + 4 <= v1.Size(); i += 4)
+	{
+		__m128 dot = _mm_mul_ps( _mm_load_ps( v1.X() + i ), _mm_load_ps( v2.X() + i ) );
+		dot = _mm_add_ps( dot, _mm_mul_ps( _mm_load_ps( v1.Y() + i ), _mm_load_ps( v2.Y() + i ) ) );
+		dot = _mm_add_ps( dot, _mm_mul_ps( _mm_load_ps( v1.Z() + i ), _mm_load_ps( v2.Z() + i ) ) );
+		dot = _mm_add_ps( dot, _mm_mul_ps( _mm_load_ps( v1.W() + i ), _mm_load_ps( v2.W() + i ) ) );
+		_mm_storeu_ps( pOut + i, dot );
+	}
+#endif
+	for (; i < v1.Size(); ++i)
+	{
+		pOut[i] = v1.X()[i] * v2.X()[i] + v1.Y()[i] * v2.Y()[i] +
+		          v1.Z()[i] * v2.Z()[i] + v1.W()[i] * v2.W()[i];
+	}
+
+	GEN_ENDGUARD_OPT;
+}
+
+// Dot product of each vector in a stream with a single vector, e.g. distances of homogeneous
+// points from a plane (a,b,c,d)
+void Dot
+(
+	TFloat32*             pOut,
+	const CVector4Stream& v1,
+	const CVector4&       v2
+)
+{
+	TUInt32 i = 0;
+#if defined(GEN_MATH_SSE)
+	__m128 x2 = _mm_set1_ps( v2.x );
+	__m128 y2 = _mm_set1_ps( v2.y );
+	__m128 z2 = _mm_set1_ps( v2.z );
+	__m128 w2 = _mm_set1_ps( v2.w );
+	for (; i + 4 <= v1.Size(); i += 4)
+	{
+		__m128 dot = _mm_mul_ps( _mm_load_ps( v1.X() + i ), x2 );
+		dot = _mm_add_ps( dot, _mm_mul_ps( _mm_load_ps( v1.Y() + i ), y2 ) );
+		dot = _mm_add_ps( dot, _mm_mul_ps( _mm_load_ps( v1.Z() + i ), z2 ) );
+		dot = _mm_add_ps( dot, _mm_mul_ps( _mm_load_ps( v1.W() + i ), w2 ) );
+		_mm_storeu_ps( pOut + i, dot );
+	}
+#endif
+	for (; i < v1.Size(); ++i)
+	{
+		pOut[i] = v1.X()[i] * v2.x + v1.Y()[i] * v2.y + v1.Z()[i] * v2.z + v1.W()[i] * v2.w;
+	}
+}
+
+// Transform each vector in a stream by the given matrix (pre-multiplication: V' = V*M)
+void Transform
+(
+	CVector4Stream&       out,
+	const CVector4Stream& v,
+	const CMatrix4x4&     m
+)
+{
+	out.Resize( v.Size() );
+	TUInt32 i = 0;
+#if defined(GEN_MATH_SSE)
+	// Matrix columns broadcast, one output component calculated from each column
+	__m128 col[4][4];
+	for (TUInt32 c = 0; c < 4; ++c)
+	{
+		for (TUInt32 r = 0; r < 4; ++r)
+		{
+			col[c][r] = _mm_set1_ps( m[r][c] );
+		}
+	}
+	TFloat32* outComponents[4] = { out.X(), out.Y(), out.Z(), out.W() };
+	for (; i + 4 <= v.Size(); i += 4)
+	{
+		__m128 x = _mm_load_ps( v.X() + i );
+		__m128 y = _mm_load_ps( v.Y() + i );
+		__m128 z = _mm_load_ps( v.Z() + i );
+		__m128 w = _mm_load_ps( v.W() + i );
+		for (TUInt32 c = 0; c < 4; ++c)
+		{
+			__m128 result = _mm_add_ps( _mm_mul_ps( x, col[c][0] ), _mm_mul_ps( y, col[c][1] ) );
+			result = _mm_add_ps( result, _mm_mul_ps( z, col[c][2] ) );
+			_mm_store_ps( outComponents[c] + i, _mm_add_ps( result, _mm_mul_ps( w, col[c][3] ) ) );
+		}
+	}
+#endif
+	for (; i < v.Size(); ++i)
+	{
+		out.Set( i, m.Transform( v.Get( i ) ) );
+	}
+}
+
+
+} // namespace gen
@@ -0,0 +1,234 @@
+/**************************************************************************************************
+	Module:       CVector4Stream.h
+	Author:       agent
+	Date created: 16/10/26
+
+	Definition of the concrete class CVector4Stream, an array of 4D vectors stored as four separate
+	arrays of x, y, z & w components (structure of arrays) for bulk processing
+
+	Copyright 2026, agent
+
+	Change history:
+		V1.0    Created 16/10/26 - AG
+**************************************************************************************************/
+
+// The 4D equivalent of CVector3Stream - see the notes at the top of CVector3Stream.h. Mainly
+// used for homogeneous points, e.g. transforming many points by a view-projection matrix
+
+#ifndef GEN_C_VECTOR_4_STREAM_H_INCLUDED
+#define GEN_C_VECTOR_4_STREAM_H_INCLUDED
+
+#include "Defines.h"
+#include "Error.h"
+#include "CVector4.h"
+
+namespace gen
+{
+
+// Forward declaration of classes, where includes are only possible/necessary in the .cpp file
+class CMatrix4x4;
+class CVector3Stream;
+
+
+class CVector4Stream
+{
+	GEN_CLASS( CVector4Stream );
+
+// Concrete class - public access
+public:
+
+	/*-----------------------------------------------------------------------------------------
+		Constructors/Destructors
+	-----------------------------------------------------------------------------------------*/
+
+	// Default constructor - empty stream
+	CVector4Stream();
+
+	// Construct a stream of the given size - leaves values uninitialised (for performance)
+	explicit CVector4Stream( const TUInt32 size );
+
+	// Construct from an array of CVector4
+	CVector4Stream
+	(
+		const CVector4* pVectors,
+		const TUInt32   numVectors
+	);
+
+	// Copy constructor
+	CVector4Stream( const CVector4Stream& s );
+
+	// Assignment operator
+	CVector4Stream& operator=( const CVector4Stream& s );
+
+	// Destructor
+	~CVector4Stream();
+
+
+	/*-----------------------------------------------------------------------------------------
+		Size
+	-----------------------------------------------------------------------------------------*/
+
+	// Return number of vectors in the stream
+	TUInt32 Size() const
+	{
+		return m_Size;
+	}
+
+	// Set the number of vectors in the stream. Existing vectors are retained (up to the new size)
+	// but any new vectors are uninitialised
+	void Resize( const TUInt32 size );
+
+	// Ensure the stream can hold the given number of vectors without further allocation
+	void Reserve( const TUInt32 capacity );
+
+	// Set number of vectors to 0, retaining allocated memory
+	void Clear()
+	{
+		m_Size = 0;
+	}
+
+
+	/*-----------------------------------------------------------------------------------------
+		Element Access
+	-----------------------------------------------------------------------------------------*/
+
+	// Direct access to the component arrays (16-byte aligned)
+	TFloat32* X()
+	{
+		return m_X;
+	}
+	TFloat32* Y()
+	{
+		return m_Y;
+	}
+	TFloat32* Z()
+	{
+		return m_Z;
+	}
+	TFloat32* W()
+	{
+		return m_W;
+	}
+	const TFloat32* X() const
+	{
+		return m_X;
+	}
+	const TFloat32* Y() const
+	{
+		return m_Y;
+	}
+	const TFloat32* Z() const
+	{
+		return m_Z;
+	}
+	const TFloat32* W() const
+	{
+		return m_W;
+	}
+
+	// Return the vector at the given index
+	CVector4 Get( const TUInt32 index ) const
+	{
+		GEN_GUARD_OPT;
+		GEN_ASSERT_OPT( index < m_Size, "Invalid parameter" );
+
+		return CVector4( m_X[index], m_Y[index], m_Z[index], m_W[index] );
+
+		GEN_ENDGUARD_OPT;
+	}
+
+	// Set the vector at the given index
+	void Set
+	(
+		const TUInt32   index,
+		const CVector4& v
+	)
+	{
+		GEN_GUARD_OPT;
+		GEN_ASSERT_OPT( index < m_Size, "Invalid parameter" );
+
+		m_X[index] = v.x;
+		m_Y[index] = v.y;
+		m_Z[index] = v.z;
+		m_W[index] = v.w;
+
+		GEN_ENDGUARD_OPT;
+	}
+
+
+	/*-----------------------------------------------------------------------------------------
+		Conversion
+	-----------------------------------------------------------------------------------------*/
+
+	// Set the stream from an array of CVector4 - resizes the stream to the array size
+	void Load
+	(
+		const CVector4* pVectors,
+		const TUInt32   numVectors
+	);
+
+	// Set the stream from a stream of 3D vectors and a w value used for every vector, e.g. w = 1
+	// to treat them as points. Resizes the stream to the size of the source stream
+	void Load
+	(
+		const CVector3Stream& v,
+		const TFloat32        w
+	);
+
+	// Copy the stream into an array of CVector4, which must be at least Size() in length
+	void Store( CVector4* pVectors ) const;
+
+
+	/*---------------------------------------------------------------------------------------------
+		Private interface
+	---------------------------------------------------------------------------------------------*/
+private:
+
+	// Number of vectors in use and allocated (allocated is always a multiple of 4)
+	TUInt32   m_Size;
+	TUInt32   m_Capacity;
+
+	// Single aligned allocation holding all four component arrays, and the arrays within it
+	TFloat32* m_pMemory;
+	TFloat32* m_X;
+	TFloat32* m_Y;
+	TFloat32* m_Z;
+	TFloat32* m_W;
+};
+
+
+/*-----------------------------------------------------------------------------------------
+	Non-member Batch Operations
+-----------------------------------------------------------------------------------------*/
+// Arrays of floats passed or returned must be at least the size of the input stream(s). The
+// output stream may be the same as an input stream
+
+// Dot product of matching vectors in two streams (which must be the same size)
+void Dot
+(
+	TFloat32*             pOut,
+	const CVector4Stream& v1,
+	const CVector4Stream& v2
+);
+
+// Dot product of each vector in a stream with a single vector, e.g. distances of homogeneous
+// points from a plane (a,b,c,d)
+void Dot
+(
+	TFloat32*             pOut,
+	const CVector4Stream& v1,
+	const CVector4&       v2
+);
+
+// Transform each vector in a stream by the given matrix (pre-multiplication: V' = V*M)
+void Transform
+(
+	CVector4Stream&       out,
+	const CVector4Stream& v,
+	const CMatrix4x4&     m
+);
+
+
+} // namespace gen
+
+#endif // GEN_C_VECTOR_4_STREAM_H_INCLUDED
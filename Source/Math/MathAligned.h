@@ -0,0 +1,56 @@
+/**************************************************************************************************
+	Module:       MathAligned.h
+	Author:       agent
+	Date created: 16/10/26
+
+	Container types for arrays of matrices and vectors with SIMD-friendly alignment
+
+	Copyright 2026, agent
+
+	Change history:
+		V1.0    Created 16/10/26 - AG
+**************************************************************************************************/
+
+// The maths classes themselves are not declared aligned, so they can still be passed by value and
+// stored anywhere. Instead, arrays of them are aligned when allocated: use these container types
+// in place of vector<CMatrix4x4> etc., or AlignedNew / AlignedDelete (AlignedAlloc.h) in place of
+// new[] / delete[]. Each element of a 16-byte aligned CMatrix4x4 or CVector4 array is then also
+// aligned, so rows never straddle cache lines. The 32-byte versions align matrices to half a
+// (64-byte) cache line, which suits AVX code
+//
+// For a structure containing a matrix member, declare the member GEN_ALIGN(16) and store the
+// structures with CAlignedAllocator (see SXFileFrame in CImportXFile.h for an example)
+
+#ifndef GEN_MATH_ALIGNED_H_INCLUDED
+#define GEN_MATH_ALIGNED_H_INCLUDED
+
+#include <vector>
+using namespace std;
+
+#include "Defines.h"
+#include "AlignedAlloc.h"
+#include "CVector3.h"
+#include "CVector4.h"
+#include "CMatrix4x4.h"
+
+namespace gen
+{
+
+/*-----------------------------------------------------------------------------------------
+	Aligned container types
+-----------------------------------------------------------------------------------------*/
+
+typedef vector< CMatrix4x4, CAlignedAllocator<CMatrix4x4, kiSSEAlignment> > TMatrix4x4Array;
+typedef vector< CMatrix4x4, CAlignedAllocator<CMatrix4x4, kiAVXAlignment> > TMatrix4x4Array32;
+
+typedef vector< CVector4, CAlignedAllocator<CVector4, kiSSEAlignment> > TVector4Array;
+typedef vector< CVector4, CAlignedAllocator<CVector4, kiAVXAlignment> > TVector4Array32;
+
+// Only the first element of a CVector3 array can be aligned, but aligning it avoids an
+// unnecessary cache line split at the start of small arrays
+typedef vector< CVector3, CAlignedAllocator<CVector3, kiSSEAlignment> > TVector3Array;
+
+
+} // namespace gen
+
+#endif // GEN_MATH_ALIGNED_H_INCLUDED
@@ -0,0 +1,154 @@
+/**************************************************************************************************
+	Module:       MathApprox.cpp
+	Author:       agent
+	Date created: 16/10/26
+
+	Array versions of the approximation functions in MathApprox.h, using SIMD instructions where
+	available
+
+	Copyright 2026, agent
+
+	Change history:
+		V1.0    Created 16/10/26 - AG
+**************************************************************************************************/
+
+#include "MathApprox.h"
+
+#include "MathSIMD.h"
+
+namespace gen
+{
+
+/*-----------------------------------------------------------------------------------------
+	Array Processing
+-----------------------------------------------------------------------------------------*/
+// Each function processes as many values as possible with the widest operations available,
+// then passes the remainder on to narrower ones, finishing with single values. Each helper
+// returns the index of the first value it did not process
+
+template <class Ops, EMathAccuracy Accuracy>
+inline TUInt32 SinCosValues
+(
+	TFloat32*       pSin,
+	TFloat32*       pCos,
+	const TFloat32* pX,
+	const TUInt32   numValues,
+	TUInt32         i
+)
+{
+	for (; i + Ops::kWidth <= numValues; i += Ops::kWidth)
+	{
+		typename Ops::TVec s, c;
+		ApproxSinCos<Ops, Accuracy>( Ops::Load( pX + i ), s, c );
+		Ops::Store( pSin + i, s );
+		Ops::Store( pCos + i, c );
+	}
+	return i;
+}
+
+template <class Ops, EMathAccuracy Accuracy>
+inline TUInt32 InvSqrtValues
+(
+	TFloat32*       pOut,
+	const TFloat32* pX,
+	const TUInt32   numValues,
+	TUInt32         i
+)
+{
+	for (; i + Ops::kWidth <= numValues; i += Ops::kWidth)
+	{
+		Ops::Store( pOut + i, ApproxInvSqrt<Ops, Accuracy>( Ops::Load( pX + i ) ) );
+	}
+	return i;
+}
+
+template <class Ops, EMathAccuracy Accuracy>
+inline TUInt32 ExpValues
+(
+	TFloat32*       pOut,
+	const TFloat32* pX,
+	const TUInt32   numValues,
+	TUInt32         i
+)
+{
+	for (; i + Ops::kWidth <= numValues; i += Ops::kWidth)
+	{
+		Ops::Store( pOut + i, ApproxExp<Ops, Accuracy>( Ops::Load( pX + i ) ) );
+	}
+	return i;
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Array Functions
+-----------------------------------------------------------------------------------------*/
+
+// Get sin and cos of each value in an array using the given accuracy tier
+template <EMathAccuracy Accuracy>
+void SinCosArray
+(
+	TFloat32*       pSin,
+	TFloat32*       pCos,
+	const TFloat32* pX,
+	const TUInt32   numValues
+)
+{
+	TUInt32 i = 0;
+#if defined(GEN_MATH_AVX)
+	i = SinCosValues<SAVXOps, Accuracy>( pSin, pCos, pX, numValues, i );
+#endif
+#if defined(GEN_MATH_SSE)
+	i = SinCosValues<SSSEOps, Accuracy>( pSin, pCos, pX, numValues, i );
+#endif
+	SinCosValues<SScalarOps, Accuracy>( pSin, pCos, pX, numValues, i );
+}
+
+// 1 / Sqrt of each value in an array using the given accuracy tier
+template <EMathAccuracy Accuracy>
+void InvSqrtArray
+(
+	TFloat32*       pOut,
+	const TFloat32* pX,
+	const TUInt32   numValues
+)
+{
+	TUInt32 i = 0;
+#if defined(GEN_MATH_AVX)
+	i = InvSqrtValues<SAVXOps, Accuracy>( pOut, pX, numValues, i );
+#endif
+#if defined(GEN_MATH_SSE)
+	i = InvSqrtValues<SSSEOps, Accuracy>( pOut, pX, numValues, i );
+#endif
+	InvSqrtValues<SScalarOps, Accuracy>( pOut, pX, numValues, i );
+}
+
+// e^x for each value in an array using the given accuracy tier
+template <EMathAccuracy Accuracy>
+void ExpArray
+(
+	TFloat32*       pOut,
+	const TFloat32* pX,
+	const TUInt32   numValues
+)
+{
+	TUInt32 i = 0;
+#if defined(GEN_MATH_AVX)
+	i = ExpValues<SAVXOps, Accuracy>( pOut, pX, numValues, i );
+#endif
+#if defined(GEN_MATH_SSE2) // Building the power of 2 needs SSE2
+	i = ExpValues<SSSEOps, Accuracy>( pOut, pX, numValues, i );
+#endif
+	ExpValues<SScalarOps, Accuracy>( pOut, pX, numValues, i );
+}
+
+
+// Instantiate array functions for each accuracy tier
+template void SinCosArray<kMathFast>( TFloat32*, TFloat32*, const TFloat32*, const TUInt32 );
+template void SinCosArray<kMathPrecise>( TFloat32*, TFloat32*, const TFloat32*, const TUInt32 );
+template void InvSqrtArray<kMathFast>( TFloat32*, const TFloat32*, const TUInt32 );
+template void InvSqrtArray<kMathPrecise>( TFloat32*, const TFloat32*, const TUInt32 );
+template void ExpArray<kMathFast>( TFloat32*, const TFloat32*, const TUInt32 );
+template void ExpArray<kMathPrecise>( TFloat32*, const TFloat32*, const TUInt32 );
+
+
+} // namespace gen
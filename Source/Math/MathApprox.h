@@ -0,0 +1,317 @@
+/**************************************************************************************************
+	Module:       MathApprox.h
+	Author:       agent
+	Date created: 16/10/26
+
+	Polynomial approximations of sin/cos, 1/sqrt and exp, in "fast" and "precise" accuracy tiers,
+	for single values and for arrays (using SIMD instructions where available)
+
+	Copyright 2026, agent
+
+	Change history:
+		V1.0    Created 16/10/26 - AG
+**************************************************************************************************/
+
+// The functions in BaseMath.h call the standard library, which is accurate but relatively slow
+// and handles one value at a time. The versions here trade a little accuracy for speed, and the
+// array versions process 4 values at a time with SSE (8 with AVX). The tier is selected with a
+// template parameter, e.g.
+//     SinCos<kMathFast>( angle, &s, &c );
+//     ExpArray<kMathPrecise>( weights, exponents, numWeights );
+//
+// Maximum errors (measured over the given input range against the double precision library):
+//
+//   Function       Range             kMathFast               kMathPrecise
+//   SinCos         |x| <= 8192       absolute 1.3e-5         absolute 8.0e-8
+//   InvSqrt        2^-60 - 2^60      relative 1.8e-3 (*)     relative 2.5e-7
+//   Exp            -87 <= x <= 88    relative 1.3e-4         relative 8.0e-8
+//
+//   (*) relative 3.7e-4 for values processed by SSE or AVX in the array version
+//
+// Notes:
+// - SinCos range reduction loses accuracy steadily beyond the range given
+// - Exp clamps x to the range given, InvSqrt does not check for x <= 0
+// - The same code is used for single values, for SIMD lanes and for the remainder of arrays, so
+//   results do not depend on array length or position (other than InvSqrt as noted above)
+
+#ifndef GEN_MATH_APPROX_H_INCLUDED
+#define GEN_MATH_APPROX_H_INCLUDED
+
+#include "Defines.h"
+#include "BaseMath.h"
+
+namespace gen
+{
+
+/*-----------------------------------------------------------------------------------------
+	Support types
+-----------------------------------------------------------------------------------------*/
+
+// Accuracy tiers for approximation functions, see table above
+enum EMathAccuracy
+{
+	kMathFast = 0,
+	kMathPrecise,
+};
+
+
+/*-----------------------------------------------------------------------------------------
+	Approximation kernels
+-----------------------------------------------------------------------------------------*/
+// Each kernel is written once for a generic "operations" type providing a value type (TVec), a
+// comparison result type (TMask) and the basic operations on them. SScalarOps below works on
+// single floats, MathSIMD.h provides SSE and AVX equivalents working on 4 or 8 floats
+
+// Basic operations on single floats for use with the kernels below
+struct SScalarOps
+{
+	typedef TFloat32 TVec;
+	typedef bool     TMask;
+
+	static const TUInt32 kWidth = 1;
+
+	static TVec Load( const TFloat32* p ) { return *p; }
+	static void Store( TFloat32* p, const TVec v ) { *p = v; }
+
+	static TVec Gather( const TFloat32* const* ppLanes, const TUInt32 offset )
+	{
+		return ppLanes[0][offset];
+	}
+	static void Scatter( TFloat32* const* ppLanes, const TUInt32 offset, const TVec v )
+	{
+		ppLanes[0][offset] = v;
+	}
+
+	static TVec Splat( const TFloat32 f ) { return f; }
+	static TVec Add( const TVec a, const TVec b ) { return a + b; }
+	static TVec Sub( const TVec a, const TVec b ) { return a - b; }
+	static TVec Mul( const TVec a, const TVec b ) { return a * b; }
+	static TVec Min( const TVec a, const TVec b ) { return b < a ? b : a; }
+	static TVec Max( const TVec a, const TVec b ) { return a < b ? b : a; }
+
+	static TMask Less( const TVec a, const TVec b ) { return a < b; }
+	static TMask Equal( const TVec a, const TVec b ) { return a == b; }
+	static TMask Or( const TMask a, const TMask b ) { return a || b; }
+	static TMask And( const TMask a, const TMask b ) { return a && b; }
+
+	// Return a where mask is set, b otherwise
+	static TVec Select( const TMask mask, const TVec a, const TVec b ) { return mask ? a : b; }
+
+	// Return -v where mask is set, v otherwise
+	static TVec NegateIf( const TMask mask, const TVec v ) { return mask ? -v : v; }
+
+	// Estimate of 1/sqrt(x) with relative error < 3.5e-2 (integer approximation of the log), the
+	// number of accurate bits determines the refinement needed for each accuracy tier
+	static const TUInt32 kInvSqrtEstimateBits = 5;
+	static TVec InvSqrtEstimate( const TVec x )
+	{
+		union { TFloat32 f; TUInt32 i; } bits;
+		bits.f = x;
+		bits.i = 0x5f375a86 - (bits.i >> 1);
+		return bits.f;
+	}
+
+	// Return 2^n for an integer n (stored in a float) from -126 to 127
+	static TVec Pow2( const TVec n )
+	{
+		union { TFloat32 f; TUInt32 i; } bits;
+		bits.i = static_cast<TUInt32>(static_cast<TInt32>(n) + 127) << 23;
+		return bits.f;
+	}
+};
+
+
+// Round to nearest integer for |x| < 2^22, by adding and removing a value large enough that
+// the float has no fractional bits. Relies on precise floating point (the default on VS)
+template <class Ops>
+inline typename Ops::TVec ApproxRound( const typename Ops::TVec x )
+{
+	const typename Ops::TVec kMagic = Ops::Splat( 12582912.0f ); // 1.5 * 2^23
+	return Ops::Sub( Ops::Add( x, kMagic ), kMagic );
+}
+
+// Calculate sin and cos of x. Reduces x to the range -pi/4 to pi/4 by subtracting the nearest
+// multiple of pi/2 (in two or three parts to retain precision), then uses minimax polynomials
+template <class Ops, EMathAccuracy Accuracy>
+inline void ApproxSinCos
+(
+	const typename Ops::TVec x,
+	typename Ops::TVec&      s,
+	typename Ops::TVec&      c
+)
+{
+	typedef typename Ops::TVec TVec;
+	typedef typename Ops::TMask TMask;
+
+	// Quadrant q (0-3) from nearest multiple of pi/2: y = q + 4k
+	TVec y = ApproxRound<Ops>( Ops::Mul( x, Ops::Splat( 0.636619772f ) ) );
+	TVec q = Ops::Sub( y, Ops::Mul( ApproxRound<Ops>( Ops::Mul( Ops::Sub( y, Ops::Splat( 1.5f ) ),
+	                                                            Ops::Splat( 0.25f ) ) ),
+	                                Ops::Splat( 4.0f ) ) );
+
+	// Remainder r in -pi/4 to pi/4. First part of pi/2 has few significant bits so y*part is exact
+	TVec r = Ops::Sub( x, Ops::Mul( y, Ops::Splat( 1.5703125f ) ) );
+	TVec r2;
+	TVec sinR;
+	TVec cosR;
+	if (Accuracy == kMathPrecise)
+	{
+		r = Ops::Sub( r, Ops::Mul( y, Ops::Splat( 4.837512969970703125e-4f ) ) );
+		r = Ops::Sub( r, Ops::Mul( y, Ops::Splat( 7.54978995489188216e-8f ) ) );
+		r2 = Ops::Mul( r, r );
+
+		TVec p = Ops::Add( Ops::Mul( r2, Ops::Splat( -1.9515295891e-4f ) ),
+		                   Ops::Splat( 8.3321608736e-3f ) );
+		p = Ops::Add( Ops::Mul( p, r2 ), Ops::Splat( -1.6666654611e-1f ) );
+		sinR = Ops::Add( Ops::Mul( Ops::Mul( p, r2 ), r ), r );
+
+		p = Ops::Add( Ops::Mul( r2, Ops::Splat( 2.443315711809948e-5f ) ),
+		              Ops::Splat( -1.388731625493765e-3f ) );
+		p = Ops::Add( Ops::Mul( p, r2 ), Ops::Splat( 4.166664568298827e-2f ) );
+		cosR = Ops::Sub( Ops::Mul( Ops::Mul( p, r2 ), r2 ), Ops::Mul( r2, Ops::Splat( 0.5f ) ) );
+		cosR = Ops::Add( cosR, Ops::Splat( 1.0f ) );
+	}
+	else
+	{
+		r = Ops::Sub( r, Ops::Mul( y, Ops::Splat( 4.83826794897e-4f ) ) );
+		r2 = Ops::Mul( r, r );
+
+		TVec p = Ops::Add( Ops::Mul( r2, Ops::Splat( 8.153027129e-3f ) ),
+		                   Ops::Splat( -1.666283529e-1f ) );
+		sinR = Ops::Add( Ops::Mul( Ops::Mul( p, r2 ), r ), r );
+
+		p = Ops::Add( Ops::Mul( r2, Ops::Splat( 4.048916508e-2f ) ), Ops::Splat( -4.997763949e-1f ) );
+		cosR = Ops::Add( Ops::Mul( p, r2 ), Ops::Splat( 1.0f ) );
+	}
+
+	// Odd quadrants swap sin and cos, then sin is negative in quadrants 2 & 3, cos in 1 & 2
+	TMask swap = Ops::Or( Ops::Equal( q, Ops::Splat( 1.0f ) ), Ops::Equal( q, Ops::Splat( 3.0f ) ) );
+	TMask sinNeg = Ops::Less( Ops::Splat( 1.5f ), q );
+	TMask cosNeg = Ops::And( Ops::Less( Ops::Splat( 0.5f ), q ), Ops::Less( q, Ops::Splat( 2.5f ) ) );
+	s = Ops::NegateIf( sinNeg, Ops::Select( swap, cosR, sinR ) );
+	c = Ops::NegateIf( cosNeg, Ops::Select( swap, sinR, cosR ) );
+}
+
+// Calculate 1/sqrt(x) from an estimate, refined by Newton-Raphson steps. Each step roughly
+// doubles the number of accurate bits, steps are taken until there are ~10 accurate bits for the
+// fast tier or ~22 for the precise tier
+template <class Ops, EMathAccuracy Accuracy>
+inline typename Ops::TVec ApproxInvSqrt( const typename Ops::TVec x )
+{
+	typedef typename Ops::TVec TVec;
+
+	const TUInt32 kTargetBits = (Accuracy == kMathPrecise) ? 22 : 10;
+	TVec halfX = Ops::Mul( x, Ops::Splat( 0.5f ) );
+	TVec y = Ops::InvSqrtEstimate( x );
+	for (TUInt32 bits = Ops::kInvSqrtEstimateBits; bits < kTargetBits; bits *= 2)
+	{
+		// y' = y * (1.5 - 0.5*x*y*y)
+		y = Ops::Mul( y, Ops::Sub( Ops::Splat( 1.5f ), Ops::Mul( halfX, Ops::Mul( y, y ) ) ) );
+	}
+	return y;
+}
+
+// Calculate exp(x). Splits x into n*ln(2) + r, with integer n and |r| <= ln(2)/2 so that
+// exp(x) = 2^n * exp(r). Uses a polynomial for exp(r) and builds 2^n directly as a float
+template <class Ops, EMathAccuracy Accuracy>
+inline typename Ops::TVec ApproxExp( const typename Ops::TVec x )
+{
+	typedef typename Ops::TVec TVec;
+
+	// Clamp so 2^n is a normal float
+	TVec xc = Ops::Min( Ops::Max( x, Ops::Splat( -87.0f ) ), Ops::Splat( 88.0f ) );
+
+	// Remainder, subtracting ln(2) in two parts to retain precision
+	TVec n = ApproxRound<Ops>( Ops::Mul( xc, Ops::Splat( 1.44269504089f ) ) );
+	TVec r = Ops::Sub( xc, Ops::Mul( n, Ops::Splat( 0.693359375f ) ) );
+	r = Ops::Add( r, Ops::Mul( n, Ops::Splat( 2.12194440e-4f ) ) );
+
+	// exp(r) = 1 + r + r^2 * p(r)
+	TVec p;
+	if (Accuracy == kMathPrecise)
+	{
+		p = Ops::Add( Ops::Mul( r, Ops::Splat( 1.9875691500e-4f ) ), Ops::Splat( 1.3981999507e-3f ) );
+		p = Ops::Add( Ops::Mul( p, r ), Ops::Splat( 8.3334519073e-3f ) );
+		p = Ops::Add( Ops::Mul( p, r ), Ops::Splat( 4.1665795894e-2f ) );
+		p = Ops::Add( Ops::Mul( p, r ), Ops::Splat( 1.6666665459e-1f ) );
+		p = Ops::Add( Ops::Mul( p, r ), Ops::Splat( 5.0000001201e-1f ) );
+	}
+	else
+	{
+		p = Ops::Add( Ops::Mul( r, Ops::Splat( 1.666274922e-1f ) ), Ops::Splat( 5.039392970e-1f ) );
+	}
+	TVec expR = Ops::Add( Ops::Add( Ops::Mul( Ops::Mul( r, r ), p ), r ), Ops::Splat( 1.0f ) );
+	return Ops::Mul( expR, Ops::Pow2( n ) );
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Single value functions
+-----------------------------------------------------------------------------------------*/
+// Overloads of the BaseMath.h functions, the accuracy tier must be given explicitly, e.g.
+// InvSqrt<kMathFast>( x )
+
+// Get both sin and cos of x using the given accuracy tier
+template <EMathAccuracy Accuracy>
+inline void SinCos
+(
+	const TFloat32 x,
+	TFloat32*      pSin,
+	TFloat32*      pCos
+)
+{
+	ApproxSinCos<SScalarOps, Accuracy>( x, *pSin, *pCos );
+}
+
+// 1 / Sqrt using the given accuracy tier, x must be > 0
+template <EMathAccuracy Accuracy>
+inline TFloat32 InvSqrt( const TFloat32 x )
+{
+	return ApproxInvSqrt<SScalarOps, Accuracy>( x );
+}
+
+// e^x using the given accuracy tier
+template <EMathAccuracy Accuracy>
+inline TFloat32 Exp( const TFloat32 x )
+{
+	return ApproxExp<SScalarOps, Accuracy>( x );
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Array functions
+-----------------------------------------------------------------------------------------*/
+// The output arrays may be the same as the input array
+
+// Get sin and cos of each value in an array using the given accuracy tier
+template <EMathAccuracy Accuracy>
+void SinCosArray
+(
+	TFloat32*       pSin,
+	TFloat32*       pCos,
+	const TFloat32* pX,
+	const TUInt32   numValues
+);
+
+// 1 / Sqrt of each value in an array using the given accuracy tier
+template <EMathAccuracy Accuracy>
+void InvSqrtArray
+(
+	TFloat32*       pOut,
+	const TFloat32* pX,
+	const TUInt32   numValues
+);
+
+// e^x for each value in an array using the given accuracy tier
+template <EMathAccuracy Accuracy>
+void ExpArray
+(
+	TFloat32*       pOut,
+	const TFloat32* pX,
+	const TUInt32   numValues
+);
+
+
+} // namespace gen
+
+#endif // GEN_MATH_APPROX_H_INCLUDED
@@ -0,0 +1,311 @@
+/**************************************************************************************************
+	Module:       MathPacking.cpp
+	Author:       agent
+	Date created: 16/10/26
+
+	Compact encodings of floats, unit vectors and positions: 16-bit half floats, 16-bit
+	normalised integers (snorm / unorm), octahedral unit vectors and quantised positions
+
+	Copyright 2026, agent
+
+	Change history:
+		V1.0    Created 16/10/26 - AG
+**************************************************************************************************/
+
+#include "MathPacking.h"
+
+#include <string.h>
+
+#include "BaseMath.h"
+
+namespace gen
+{
+
+/*-----------------------------------------------------------------------------------------
+	Scalar Encodings
+-----------------------------------------------------------------------------------------*/
+
+// Shift an integer right, rounding to nearest with ties to even
+inline TUInt32 ShiftRightRoundEven
+(
+	const TUInt32 value,
+	const TUInt32 shift
+)
+{
+	TUInt32 result = value >> shift;
+	TUInt32 remainder = value & ((1u << shift) - 1);
+	TUInt32 half = 1u << (shift - 1);
+	if (remainder > half || (remainder == half && (result & 1)))
+	{
+		++result;
+	}
+	return result;
+}
+
+// Convert a float to the nearest 16-bit half float (IEEE 754 binary16), rounding ties to even.
+// Values too large for a half become infinity, NaNs remain NaNs
+TUInt16 FloatToHalf( const TFloat32 f )
+{
+	union { TFloat32 f; TUInt32 i; } bits;
+	bits.f = f;
+	TUInt32 sign = (bits.i >> 16) & 0x8000;
+	TUInt32 absBits = bits.i & 0x7fffffff;
+
+	// Infinity or NaN (keep NaNs quiet)
+	if (absBits >= 0x7f800000)
+	{
+		return static_cast<TUInt16>(sign | 0x7c00 | (absBits > 0x7f800000 ? 0x200 : 0));
+	}
+
+	// Values that round to 65520 or above overflow to infinity
+	if (absBits >= 0x477ff000)
+	{
+		return static_cast<TUInt16>(sign | 0x7c00);
+	}
+
+	// Normal halves: rebias exponent (127 -> 15) and round away 13 bits of mantissa. A mantissa
+	// that rounds up carries correctly into the exponent
+	if (absBits >= 0x38800000) // 2^-14, smallest normal half
+	{
+		return static_cast<TUInt16>(sign | ShiftRightRoundEven( absBits - 0x38000000, 13 ));
+	}
+
+	// Denormal halves (multiples of 2^-24), values below 2^-25 round to zero
+	if (absBits < 0x33000000)
+	{
+		return static_cast<TUInt16>(sign);
+	}
+	TUInt32 exponent = absBits >> 23;
+	TUInt32 mantissa = (absBits & 0x7fffff) | 0x800000;
+	return static_cast<TUInt16>(sign | ShiftRightRoundEven( mantissa, 126 - exponent ));
+}
+
+// Convert a 16-bit half float to a float (exact)
+TFloat32 HalfToFloat( const TUInt16 h )
+{
+	union { TFloat32 f; TUInt32 i; } bits;
+	TUInt32 sign = static_cast<TUInt32>(h & 0x8000) << 16;
+	TUInt32 exponent = (h >> 10) & 0x1f;
+	TUInt32 mantissa = h & 0x3ff;
+
+	if (exponent == 0x1f) // Infinity or NaN
+	{
+		bits.i = sign | 0x7f800000 | (mantissa << 13);
+	}
+	else if (exponent == 0) // Zero or denormal
+	{
+		bits.f = static_cast<TFloat32>(mantissa) * 5.9604644775390625e-8f; // 2^-24
+		bits.i |= sign;
+	}
+	else
+	{
+		bits.i = sign | ((exponent + 112) << 23) | (mantissa << 13);
+	}
+	return bits.f;
+}
+
+
+// Convert a float from -1 to 1 to the nearest 16-bit signed normalised integer. Values outside
+// the range are clamped
+TInt16 FloatToSnorm16( const TFloat32 f )
+{
+	TFloat32 clamped = Max( -1.0f, Min( 1.0f, f ) );
+	return static_cast<TInt16>(Round( clamped * 32767.0f ));
+}
+
+// Convert a float from 0 to 1 to the nearest 16-bit unsigned normalised integer. Values outside
+// the range are clamped
+TUInt16 FloatToUnorm16( const TFloat32 f )
+{
+	TFloat32 clamped = Max( 0.0f, Min( 1.0f, f ) );
+	return static_cast<TUInt16>(clamped * 65535.0f + 0.5f);
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Vector Encodings
+-----------------------------------------------------------------------------------------*/
+
+// Map octahedral coordinates x,y (each -1 to 1) back to a (non-normalised) vector
+inline CVector3 OctahedralToVector
+(
+	const TFloat32 x,
+	const TFloat32 y
+)
+{
+	// Upper half of octahedron maps to the inner diamond of the square, the lower half is folded
+	// out into the corners
+	TFloat32 z = 1.0f - Abs( x ) - Abs( y );
+	if (z >= 0.0f)
+	{
+		return CVector3( x, y, z );
+	}
+	return CVector3( (1.0f - Abs( y )) * (x < 0.0f ? -1.0f : 1.0f),
+	                 (1.0f - Abs( x )) * (y < 0.0f ? -1.0f : 1.0f), z );
+}
+
+// Encode a unit vector as two 16-bit signed normalised integers using an octahedral mapping
+// (the unit sphere is projected onto an octahedron, which is unfolded into a square). Chooses
+// the rounding of each coordinate that best preserves the direction. Vector need not be
+// normalised, a zero length vector is encoded as (0,0,1)
+void EncodeOctahedral
+(
+	const CVector3& v,
+	TInt16*         pOct
+)
+{
+	// Project onto octahedron |x| + |y| + |z| = 1, then fold lower half out to corners
+	TFloat32 l1Norm = Abs( v.x ) + Abs( v.y ) + Abs( v.z );
+	if (l1Norm == 0.0f)
+	{
+		pOct[0] = pOct[1] = 0; // Decodes to (0,0,1)
+		return;
+	}
+	TFloat32 x = v.x / l1Norm;
+	TFloat32 y = v.y / l1Norm;
+	if (v.z < 0.0f)
+	{
+		TFloat32 foldX = (1.0f - Abs( y )) * (x < 0.0f ? -1.0f : 1.0f);
+		y = (1.0f - Abs( x )) * (y < 0.0f ? -1.0f : 1.0f);
+		x = foldX;
+	}
+
+	// Try rounding each coordinate down and up, keep the pair closest in direction to v. Nearest
+	// rounding of each coordinate separately is not always the closest direction
+	TFloat32 fx = Floor( Max( -1.0f, Min( 1.0f, x ) ) * 32767.0f );
+	TFloat32 fy = Floor( Max( -1.0f, Min( 1.0f, y ) ) * 32767.0f );
+	TFloat32 bestDot = -2.0f;
+	for (TUInt32 i = 0; i < 4; ++i)
+	{
+		TFloat32 tx = Min( 32767.0f, fx + static_cast<TFloat32>(i & 1) );
+		TFloat32 ty = Min( 32767.0f, fy + static_cast<TFloat32>(i >> 1) );
+		CVector3 decoded = OctahedralToVector( tx * (1.0f / 32767.0f), ty * (1.0f / 32767.0f) );
+		TFloat32 dot = Dot( decoded, v ) / decoded.Length();
+		if (dot > bestDot)
+		{
+			bestDot = dot;
+			pOct[0] = static_cast<TInt16>(tx);
+			pOct[1] = static_cast<TInt16>(ty);
+		}
+	}
+}
+
+// Decode a unit vector encoded by EncodeOctahedral. The result is normalised
+CVector3 DecodeOctahedral( const TInt16* pOct )
+{
+	return Normalise( OctahedralToVector( Snorm16ToFloat( pOct[0] ), Snorm16ToFloat( pOct[1] ) ) );
+}
+
+
+// Quantise a position to three 16-bit unsigned normalised integers relative to the given
+// bounds (usually the bounds of the mesh or sub-mesh containing the position). Positions
+// outside the bounds are clamped to them
+void EncodeQuantisedPosition
+(
+	const CVector3& position,
+	const CVector3& minBounds,
+	const CVector3& maxBounds,
+	TUInt16*        pQuant
+)
+{
+	// Flat bounds on any axis quantise to 0 on that axis
+	CVector3 extent = maxBounds - minBounds;
+	pQuant[0] = extent.x > 0.0f ? FloatToUnorm16( (position.x - minBounds.x) / extent.x ) : 0;
+	pQuant[1] = extent.y > 0.0f ? FloatToUnorm16( (position.y - minBounds.y) / extent.y ) : 0;
+	pQuant[2] = extent.z > 0.0f ? FloatToUnorm16( (position.z - minBounds.z) / extent.z ) : 0;
+}
+
+// Decode a position quantised by EncodeQuantisedPosition with the same bounds
+CVector3 DecodeQuantisedPosition
+(
+	const TUInt16*  pQuant,
+	const CVector3& minBounds,
+	const CVector3& maxBounds
+)
+{
+	CVector3 extent = maxBounds - minBounds;
+	return CVector3( Unorm16ToFloat( pQuant[0] ) * extent.x + minBounds.x,
+	                 Unorm16ToFloat( pQuant[1] ) * extent.y + minBounds.y,
+	                 Unorm16ToFloat( pQuant[2] ) * extent.z + minBounds.z );
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Array Encodings
+-----------------------------------------------------------------------------------------*/
+// Values are copied to and from local variables with memcpy, since strided vertex data is not
+// necessarily aligned for floats
+
+// Convert numValues groups of numFloats floats to half floats
+void FloatToHalfArray
+(
+	TUInt8*         pHalves,
+	const TUInt32   halfStride,
+	const TUInt8*   pFloats,
+	const TUInt32   floatStride,
+	const TUInt32   numFloats,
+	const TUInt32   numValues
+)
+{
+	for (TUInt32 i = 0; i < numValues; ++i)
+	{
+		for (TUInt32 f = 0; f < numFloats; ++f)
+		{
+			TFloat32 value;
+			memcpy( &value, pFloats + f * sizeof(TFloat32), sizeof(TFloat32) );
+			TUInt16 half = FloatToHalf( value );
+			memcpy( pHalves + f * sizeof(TUInt16), &half, sizeof(TUInt16) );
+		}
+		pHalves += halfStride;
+		pFloats += floatStride;
+	}
+}
+
+// Encode an array of unit vectors with EncodeOctahedral
+void EncodeOctahedralArray
+(
+	TUInt8*         pOct,
+	const TUInt32   octStride,
+	const TUInt8*   pVectors,
+	const TUInt32   vectorStride,
+	const TUInt32   numVectors
+)
+{
+	for (TUInt32 i = 0; i < numVectors; ++i)
+	{
+		TFloat32 coords[3];
+		memcpy( coords, pVectors, sizeof(coords) );
+		TInt16 oct[2];
+		EncodeOctahedral( CVector3( coords ), oct );
+		memcpy( pOct, oct, sizeof(oct) );
+		pOct += octStride;
+		pVectors += vectorStride;
+	}
+}
+
+// Quantise an array of positions with EncodeQuantisedPosition
+void EncodeQuantisedPositionArray
+(
+	TUInt8*         pQuant,
+	const TUInt32   quantStride,
+	const TUInt8*   pPositions,
+	const TUInt32   positionStride,
+	const TUInt32   numPositions,
+	const CVector3& minBounds,
+	const CVector3& maxBounds
+)
+{
+	for (TUInt32 i = 0; i < numPositions; ++i)
+	{
+		TFloat32 coords[3];
+		memcpy( coords, pPositions, sizeof(coords) );
+		TUInt16 quant[3];
+		EncodeQuantisedPosition( CVector3( coords ), minBounds, maxBounds, quant );
+		memcpy( pQuant, quant, sizeof(quant) );
+		pQuant += quantStride;
+		pPositions += positionStride;
+	}
+}
+
+
+} // namespace gen
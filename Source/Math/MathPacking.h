@@ -0,0 +1,159 @@
+/**************************************************************************************************
+	Module:       MathPacking.h
+	Author:       agent
+	Date created: 16/10/26
+
+	Compact encodings of floats, unit vectors and positions: 16-bit half floats, 16-bit
+	normalised integers (snorm / unorm), octahedral unit vectors and quantised positions
+
+	Copyright 2026, agent
+
+	Change history:
+		V1.0    Created 16/10/26 - AG
+**************************************************************************************************/
+
+// These encodings match the DXGI vertex formats that the GPU decodes when reading a vertex, so
+// vertex data packed with them needs no conversion on load:
+//
+//   Encoding              Size        DXGI format             Shader receives
+//   Half                  2 bytes     R16_FLOAT etc.          the float
+//   Snorm16               2 bytes     R16_SNORM etc.          -1 to 1
+//   Unorm16               2 bytes     R16_UNORM etc.          0 to 1
+//   Octahedral            2 x Snorm16 R16G16_SNORM            2D octahedral coordinates, decode
+//                                                             with DecodeOctahedral (in HLSL too)
+//   Quantised position    3 x Unorm16 R16G16B16A16_UNORM      0 to 1 within bounds, decode with
+//                                                             p * (max - min) + min
+//
+// Maximum errors:
+// - Half: relative 4.9e-4 (round to nearest), values beyond +-65504 become infinity
+// - Snorm16 / Unorm16: absolute 1.5e-5 / 7.6e-6
+// - Octahedral: angle 1.3e-4 radians (0.0075 degrees) to the original unit vector
+// - Quantised position: about (max - min) / 131070 on each axis
+
+#ifndef GEN_MATH_PACKING_H_INCLUDED
+#define GEN_MATH_PACKING_H_INCLUDED
+
+#include "Defines.h"
+#include "CVector3.h"
+
+namespace gen
+{
+
+/*-----------------------------------------------------------------------------------------
+	Scalar Encodings
+-----------------------------------------------------------------------------------------*/
+
+// Convert a float to the nearest 16-bit half float (IEEE 754 binary16), rounding ties to even.
+// Values too large for a half become infinity, NaNs remain NaNs
+TUInt16 FloatToHalf( const TFloat32 f );
+
+// Convert a 16-bit half float to a float (exact)
+TFloat32 HalfToFloat( const TUInt16 h );
+
+
+// Convert a float from -1 to 1 to the nearest 16-bit signed normalised integer. Values outside
+// the range are clamped
+TInt16 FloatToSnorm16( const TFloat32 f );
+
+// Convert a 16-bit signed normalised integer to a float from -1 to 1 (-32768 and -32767 both
+// convert to -1, as on the GPU)
+inline TFloat32 Snorm16ToFloat( const TInt16 s )
+{
+	TFloat32 f = static_cast<TFloat32>(s) * (1.0f / 32767.0f);
+	return f < -1.0f ? -1.0f : f;
+}
+
+
+// Convert a float from 0 to 1 to the nearest 16-bit unsigned normalised integer. Values outside
+// the range are clamped
+TUInt16 FloatToUnorm16( const TFloat32 f );
+
+// Convert a 16-bit unsigned normalised integer to a float from 0 to 1
+inline TFloat32 Unorm16ToFloat( const TUInt16 u )
+{
+	return static_cast<TFloat32>(u) * (1.0f / 65535.0f);
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Vector Encodings
+-----------------------------------------------------------------------------------------*/
+
+// Encode a unit vector as two 16-bit signed normalised integers using an octahedral mapping
+// (the unit sphere is projected onto an octahedron, which is unfolded into a square). Chooses
+// the rounding of each coordinate that best preserves the direction. Vector need not be
+// normalised, a zero length vector is encoded as (0,0,1)
+void EncodeOctahedral
+(
+	const CVector3& v,
+	TInt16*         pOct
+);
+
+// Decode a unit vector encoded by EncodeOctahedral. The result is normalised
+CVector3 DecodeOctahedral( const TInt16* pOct );
+
+
+// Quantise a position to three 16-bit unsigned normalised integers relative to the given
+// bounds (usually the bounds of the mesh or sub-mesh containing the position). Positions
+// outside the bounds are clamped to them
+void EncodeQuantisedPosition
+(
+	const CVector3& position,
+	const CVector3& minBounds,
+	const CVector3& maxBounds,
+	TUInt16*        pQuant
+);
+
+// Decode a position quantised by EncodeQuantisedPosition with the same bounds
+CVector3 DecodeQuantisedPosition
+(
+	const TUInt16*  pQuant,
+	const CVector3& minBounds,
+	const CVector3& maxBounds
+);
+
+
+/*-----------------------------------------------------------------------------------------
+	Array Encodings
+-----------------------------------------------------------------------------------------*/
+// Process arrays of values with a stride between each (in bytes), so they can read from and
+// write directly into interleaved vertex data. The stride of packed values is often different
+// from the unpacked values, e.g. when packing one vertex format into another
+
+// Convert numValues groups of numFloats floats to half floats
+void FloatToHalfArray
+(
+	TUInt8*         pHalves,
+	const TUInt32   halfStride,
+	const TUInt8*   pFloats,
+	const TUInt32   floatStride,
+	const TUInt32   numFloats,
+	const TUInt32   numValues
+);
+
+// Encode an array of unit vectors with EncodeOctahedral
+void EncodeOctahedralArray
+(
+	TUInt8*         pOct,
+	const TUInt32   octStride,
+	const TUInt8*   pVectors,
+	const TUInt32   vectorStride,
+	const TUInt32   numVectors
+);
+
+// Quantise an array of positions with EncodeQuantisedPosition
+void EncodeQuantisedPositionArray
+(
+	TUInt8*         pQuant,
+	const TUInt32   quantStride,
+	const TUInt8*   pPositions,
+	const TUInt32   positionStride,
+	const TUInt32   numPositions,
+	const CVector3& minBounds,
+	const CVector3& maxBounds
+);
+
+
+} // namespace gen
+
+#endif // GEN_MATH_PACKING_H_INCLUDED
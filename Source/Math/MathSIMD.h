@@ -0,0 +1,346 @@
+/**************************************************************************************************
+	Module:       MathSIMD.h
+	Author:       agent
+	Date created: 16/10/26
+
+	Compile-time selection of SIMD (SSE) code paths for the maths classes, along with a small set
+	of inline helpers shared by the SIMD implementations. Include only from maths .cpp files - the
+	public maths headers do not depend on the SIMD types
+
+	Copyright 2026, agent
+
+	Change history:
+		V1.0    Created 16/10/26 - AG
+**************************************************************************************************/
+
+// SSE code paths are used when the compiler targets SSE (Visual Studio /arch:SSE or better,
+// which is the default from VS2012, all x64 builds, or GCC/Clang with -msse). The original
+// scalar code is retained for all functions and can be forced by defining GEN_MATH_NO_SIMD in
+// the project settings, e.g. to compare results or timings against the SIMD versions
+//
+// Notes:
+// - The maths types are not guaranteed to be 16-byte aligned, so the SIMD code uses unaligned
+//   loads and stores throughout. These are as fast as aligned ones on recent hardware provided
+//   the data is in fact aligned - allocate arrays of matrices and vectors with the types in
+//   MathAligned.h to avoid loads split across cache lines
+// - Mostly SSE1 instructions are used. A few functions also need SSE2 (GEN_MATH_SSE2, the default
+//   for VS2012 or later) and array functions process 8 values at a time if the compiler targets
+//   AVX (GEN_MATH_AVX, /arch:AVX on Visual Studio), otherwise they fall back to 4 or 1 at a time
+
+#ifndef GEN_MATH_SIMD_H_INCLUDED
+#define GEN_MATH_SIMD_H_INCLUDED
+
+#include "Defines.h"
+
+// Select SIMD code paths
+#if !defined(GEN_MATH_NO_SIMD)
+	#if (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(_M_X64) || defined(__SSE__)
+		#define GEN_MATH_SSE
+	#endif
+	#if (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(_M_X64) || defined(__SSE2__)
+		#define GEN_MATH_SSE2
+	#endif
+	#if defined(__AVX__)
+		#define GEN_MATH_AVX
+	#endif
+#endif
+
+#if defined(GEN_MATH_SSE)
+
+#include <xmmintrin.h>
+#if defined(GEN_MATH_SSE2)
+	#include <emmintrin.h>
+#endif
+#if defined(GEN_MATH_AVX)
+	#include <immintrin.h>
+#endif
+
+namespace gen
+{
+
+/*-----------------------------------------------------------------------------------------
+	SSE Helpers
+-----------------------------------------------------------------------------------------*/
+
+// Broadcast element i of an SSE register to all four elements
+#define GEN_SSE_SPLAT( v, i ) _mm_shuffle_ps( (v), (v), _MM_SHUFFLE(i, i, i, i) )
+
+// Return the four floats starting at the given address (need not be aligned)
+inline __m128 SSELoad( const TFloat32* p )
+{
+	return _mm_loadu_ps( p );
+}
+
+// Store four floats at the given address (need not be aligned)
+inline void SSEStore
+(
+	TFloat32*    p,
+	const __m128 v
+)
+{
+	_mm_storeu_ps( p, v );
+}
+
+// Return three floats from the given address in x, y & z, w is set to the given value. Does not
+// read beyond the third float, so is safe to use on arrays of 3-float types
+inline __m128 SSELoad3
+(
+	const TFloat32* p,
+	const TFloat32  w
+)
+{
+	return _mm_setr_ps( p[0], p[1], p[2], w );
+}
+
+// Store the x, y & z elements of an SSE register at the given address. Does not write beyond
+// the third float, so is safe to use on arrays of 3-float types
+inline void SSEStore3
+(
+	TFloat32*    p,
+	const __m128 v
+)
+{
+	_mm_storel_pi( reinterpret_cast<__m64*>(p), v );
+	_mm_store_ss( p + 2, _mm_movehl_ps( v, v ) );
+}
+
+// Return the row vector v (4 floats) multiplied by the matrix with rows r0-r3, i.e. V' = V*M
+inline __m128 SSETransform
+(
+	const __m128 v,
+	const __m128 r0,
+	const __m128 r1,
+	const __m128 r2,
+	const __m128 r3
+)
+{
+	__m128 vOut = _mm_mul_ps( GEN_SSE_SPLAT( v, 0 ), r0 );
+	vOut = _mm_add_ps( vOut, _mm_mul_ps( GEN_SSE_SPLAT( v, 1 ), r1 ) );
+	vOut = _mm_add_ps( vOut, _mm_mul_ps( GEN_SSE_SPLAT( v, 2 ), r2 ) );
+	return _mm_add_ps( vOut, _mm_mul_ps( GEN_SSE_SPLAT( v, 3 ), r3 ) );
+}
+
+// Return the row vector v multiplied by the upper-left 3x3 of the matrix with rows r0-r2, the
+// w element of v is ignored
+inline __m128 SSETransform3
+(
+	const __m128 v,
+	const __m128 r0,
+	const __m128 r1,
+	const __m128 r2
+)
+{
+	__m128 vOut = _mm_mul_ps( GEN_SSE_SPLAT( v, 0 ), r0 );
+	vOut = _mm_add_ps( vOut, _mm_mul_ps( GEN_SSE_SPLAT( v, 1 ), r1 ) );
+	return _mm_add_ps( vOut, _mm_mul_ps( GEN_SSE_SPLAT( v, 2 ), r2 ) );
+}
+
+
+/*-----------------------------------------------------------------------------------------
+	Operation Types
+-----------------------------------------------------------------------------------------*/
+// Basic operations on 4 or 8 floats at a time, used to instantiate the generic approximation
+// kernels in MathApprox.h (see SScalarOps there for the equivalent on single floats)
+
+// Operations on 4 floats with SSE
+struct SSSEOps
+{
+	typedef __m128 TVec;
+	typedef __m128 TMask;
+
+	static const TUInt32 kWidth = 4;
+
+	static TVec Load( const TFloat32* p ) { return _mm_loadu_ps( p ); }
+	static void Store( TFloat32* p, const TVec v ) { _mm_storeu_ps( p, v ); }
+
+	// Load or store one float for each element from a separate address: element j is at
+	// ppLanes[j] + offset. Used to transpose arrays of structures (see LoadLanes below)
+	static TVec Gather( const TFloat32* const* ppLanes, const TUInt32 offset )
+	{
+		return _mm_setr_ps( ppLanes[0][offset], ppLanes[1][offset],
+		                    ppLanes[2][offset], ppLanes[3][offset] );
+	}
+	static void Scatter( TFloat32* const* ppLanes, const TUInt32 offset, const TVec v )
+	{
+		GEN_ALIGN(16) TFloat32 afLanes[4];
+		_mm_store_ps( afLanes, v );
+		for (TUInt32 j = 0; j < 4; ++j)
+		{
+			ppLanes[j][offset] = afLanes[j];
+		}
+	}
+
+	static TVec Splat( const TFloat32 f ) { return _mm_set1_ps( f ); }
+	static TVec Add( const TVec a, const TVec b ) { return _mm_add_ps( a, b ); }
+	static TVec Sub( const TVec a, const TVec b ) { return _mm_sub_ps( a, b ); }
+	static TVec Mul( const TVec a, const TVec b ) { return _mm_mul_ps( a, b ); }
+	static TVec Min( const TVec a, const TVec b ) { return _mm_min_ps( a, b ); }
+	static TVec Max( const TVec a, const TVec b ) { return _mm_max_ps( a, b ); }
+
+	static TMask Less( const TVec a, const TVec b ) { return _mm_cmplt_ps( a, b ); }
+	static TMask Equal( const TVec a, const TVec b ) { return _mm_cmpeq_ps( a, b ); }
+	static TMask Or( const TMask a, const TMask b ) { return _mm_or_ps( a, b ); }
+	static TMask And( const TMask a, const TMask b ) { return _mm_and_ps( a, b ); }
+
+	// Return a where mask is set, b otherwise
+	static TVec Select( const TMask mask, const TVec a, const TVec b )
+	{
+		return _mm_or_ps( _mm_and_ps( mask, a ), _mm_andnot_ps( mask, b ) );
+	}
+
+	// Return -v where mask is set, v otherwise
+	static TVec NegateIf( const TMask mask, const TVec v )
+	{
+		return _mm_xor_ps( v, _mm_and_ps( mask, _mm_set1_ps( -0.0f ) ) );
+	}
+
+	// Return a bit for each element where the mask is set
+	static TUInt32 MaskBits( const TMask mask ) { return _mm_movemask_ps( mask ); }
+
+	// Hardware estimate of 1/sqrt(x) with relative error < 1.5 * 2^-12
+	static const TUInt32 kInvSqrtEstimateBits = 12;
+	static TVec InvSqrtEstimate( const TVec x ) { return _mm_rsqrt_ps( x ); }
+
+#if defined(GEN_MATH_SSE2)
+	// Return 2^n for integers n (stored in floats) from -126 to 127. Converts (n + 127) * 2^23
+	// to integer to give the bits of the result directly
+	static TVec Pow2( const TVec n )
+	{
+		TVec bits = _mm_mul_ps( _mm_add_ps( n, _mm_set1_ps( 127.0f ) ), _mm_set1_ps( 8388608.0f ) );
+		return _mm_castsi128_ps( _mm_cvtps_epi32( bits ) );
+	}
+#endif
+};
+
+#if defined(GEN_MATH_AVX)
+
+// Operations on 8 floats with AVX - see SSSEOps for comments
+struct SAVXOps
+{
+	typedef __m256 TVec;
+	typedef __m256 TMask;
+
+	static const TUInt32 kWidth = 8;
+
+	static TVec Load( const TFloat32* p ) { return _mm256_loadu_ps( p ); }
+	static void Store( TFloat32* p, const TVec v ) { _mm256_storeu_ps( p, v ); }
+
+	static TVec Gather( const TFloat32* const* ppLanes, const TUInt32 offset )
+	{
+		return _mm256_setr_ps( ppLanes[0][offset], ppLanes[1][offset],
+		                       ppLanes[2][offset], ppLanes[3][offset],
+		                       ppLanes[4][offset], ppLanes[5][offset],
+		                       ppLanes[6][offset], ppLanes[7][offset] );
+	}
+	static void Scatter( TFloat32* const* ppLanes, const TUInt32 offset, const TVec v )
+	{
+		GEN_ALIGN(32) TFloat32 afLanes[8];
+		_mm256_store_ps( afLanes, v );
+		for (TUInt32 j = 0; j < 8; ++j)
+		{
+			ppLanes[j][offset] = afLanes[j];
+		}
+	}
+
+	static TVec Splat( const TFloat32 f ) { return _mm256_set1_ps( f ); }
+	static TVec Add( const TVec a, const TVec b ) { return _mm256_add_ps( a, b ); }
+	static TVec Sub( const TVec a, const TVec b ) { return _mm256_sub_ps( a, b ); }
+	static TVec Mul( const TVec a, const TVec b ) { return _mm256_mul_ps( a, b ); }
+	static TVec Min( const TVec a, const TVec b ) { return _mm256_min_ps( a, b ); }
+	static TVec Max( const TVec a, const TVec b ) { return _mm256_max_ps( a, b ); }
+
+	static TMask Less( const TVec a, const TVec b ) { return _mm256_cmp_ps( a, b, _CMP_LT_OQ ); }
+	static TMask Equal( const TVec a, const TVec b ) { return _mm256_cmp_ps( a, b, _CMP_EQ_OQ ); }
+	static TMask Or( const TMask a, const TMask b ) { return _mm256_or_ps( a, b ); }
+	static TMask And( const TMask a, const TMask b ) { return _mm256_and_ps( a, b ); }
+
+	static TVec Select( const TMask mask, const TVec a, const TVec b )
+	{
+		return _mm256_blendv_ps( b, a, mask );
+	}
+
+	static TVec NegateIf( const TMask mask, const TVec v )
+	{
+		return _mm256_xor_ps( v, _mm256_and_ps( mask, _mm256_set1_ps( -0.0f ) ) );
+	}
+
+	static TUInt32 MaskBits( const TMask mask ) { return _mm256_movemask_ps( mask ); }
+
+	static const TUInt32 kInvSqrtEstimateBits = 12;
+	static TVec InvSqrtEstimate( const TVec x ) { return _mm256_rsqrt_ps( x ); }
+
+	static TVec Pow2( const TVec n )
+	{
+		TVec bits = _mm256_mul_ps( _mm256_add_ps( n, _mm256_set1_ps( 127.0f ) ),
+		                           _mm256_set1_ps( 8388608.0f ) );
+		return _mm256_castsi256_ps( _mm256_cvtps_epi32( bits ) );
+	}
+};
+
+#endif // GEN_MATH_AVX
+
+
+} // namespace gen
+
+#endif // GEN_MATH_SSE
+
+
+namespace gen
+{
+
+/*-----------------------------------------------------------------------------------------
+	Lane Transfer
+-----------------------------------------------------------------------------------------*/
+// Convert between arrays of structures (e.g. quaternions) and SIMD registers holding the same
+// member of several structures, so that code can operate on kWidth structures at once. Work
+// with any operation type, including SScalarOps in MathApprox.h for the remainder of an array
+
+// Load the first numFloats floats of kWidth structures into pLanes, one register per float.
+// Structure j starts at pData + j*stride, or at pData + pIndices[j]*stride if indices are given
+template <class Ops>
+inline void LoadLanes
+(
+	typename Ops::TVec* pLanes,
+	const TFloat32*     pData,
+	const TUInt32       stride,
+	const TUInt32       numFloats,
+	const TUInt32*      pIndices = 0
+)
+{
+	const TFloat32* apLanes[Ops::kWidth];
+	for (TUInt32 j = 0; j < Ops::kWidth; ++j)
+	{
+		apLanes[j] = pData + (pIndices ? pIndices[j] : j) * stride;
+	}
+	for (TUInt32 f = 0; f < numFloats; ++f)
+	{
+		pLanes[f] = Ops::Gather( apLanes, f );
+	}
+}
+
+// Store numFloats registers from pLanes into the first floats of kWidth structures, the
+// reverse of LoadLanes. Structure j starts at pData + j*stride
+template <class Ops>
+inline void StoreLanes
+(
+	TFloat32*                 pData,
+	const TUInt32             stride,
+	const typename Ops::TVec* pLanes,
+	const TUInt32             numFloats
+)
+{
+	TFloat32* apLanes[Ops::kWidth];
+	for (TUInt32 j = 0; j < Ops::kWidth; ++j)
+	{
+		apLanes[j] = pData + j * stride;
+	}
+	for (TUInt32 f = 0; f < numFloats; ++f)
+	{
+		Ops::Scatter( apLanes, f, pLanes[f] );
+	}
+}
+
+
+} // namespace gen
+
+#endif // GEN_MATH_SIMD_H_INCLUDED
@@ -15,6 +15,7 @@ using namespace std;
 #include "Defines.h"
 #include "CVector3.h"
 #include "CVector4.h"
+#include "MathApprox.h"
 #include "Camera.h"
 #include "Light.h"
 #include "EntityManager.h"
@@ -407,7 +408,7 @@ namespace gen
 		else if (PostProcessStates[Shockwave])
 		{
 			static float ShockLevel = 0.3f;
-			float offset = rand() % 360;
+			float offset = static_cast<float>(Random( 0, 359 ));
 
 			CVector2 RandomUVs = CVector2(ShockLevel* Sin(offset), ShockLevel* Cos(offset));
 
@@ -757,14 +758,16 @@ namespace gen
 		MainCamera->SetAspect(static_cast<TFloat32>(BackBufferWidth) / BackBufferHeight);
 		MainCamera->CalculateMatrices();
 		MainCamera->CalculateFrustrumPlanes();
+		EntityManager.SetViewportHeight(BackBufferHeight);
 
 		// Set camera and light data in shaders
 		SetCamera(MainCamera);
 		SetAmbientLight(AmbientColour);
 		SetLights(&Lights[0]);
 
-		// Render entities
-		EntityManager.RenderAllEntities(MainCamera);
+		// Cull entities once for both the normal and post-processed passes, then render them
+		EntityManager.CullEntities(MainCamera);
+		EntityManager.RenderVisibleEntities(MainCamera);
 
 		//------------------------------------------------
 
@@ -783,15 +786,15 @@ namespace gen
 		// again, but only the post-processed materials. These are rendered to the back-buffer in the correct places in the scene, but most importantly their shaders will
 		// have the scene texture available to them. So these polygons can distort or affect the scene behind them (e.g. distortion through cut glass). Note that this also
 		// means we can do blending (additive, multiplicative etc.) in the shader. The post-processed materials are identified with a boolean (RenderMethod.cpp). This entire
-		// approach works even better with "bucket" rendering, where post-process shaders are held in a separate bucket - making it unnecessary to "RenderAllEntities" as 
+		// approach works even better with "bucket" rendering, where post-process shaders are held in a separate bucket - making it unnecessary to "RenderVisibleEntities" again as 
 		// we are doing here.
 
 		// NOTE: Post-processing - need to set the back buffer as a render target. Relying on the fact that the section above already did that
 		// Polygon post-processing occurs in the scene rendering code (RenderMethod.cpp) - so pass over the scene texture and viewport dimensions for the scene post-processing materials/shaders
 		SetSceneTexture(SceneShaderResource, BackBufferWidth, BackBufferHeight);
 
-		// Render all entities again, but flag that we only want the post-processed polygons
-		EntityManager.RenderAllEntities(MainCamera, true);
+		// Render the visible entities again, but flag that we only want the post-processed polygons
+		EntityManager.RenderVisibleEntities(MainCamera, true);
 
 		//************************************************
 
@@ -962,10 +965,17 @@ namespace gen
 			mBlurWeights[i] = 0.0f;
 		}
 
+		// Calculate the exponent for each sample, then the exponentials all at once
 		for (int i = 0; i < samples; i++)
 		{
 			float r = (samples / 2) - i;
-			mBlurWeights[i] = BlurMean * exp(-(r*r) / (2 * sigma * sigma));
+			mBlurWeights[i] = -(r*r) / (2 * sigma * sigma);
+		}
+		ExpArray<kMathPrecise>(mBlurWeights, mBlurWeights, samples);
+
+		for (int i = 0; i < samples; i++)
+		{
+			mBlurWeights[i] *= BlurMean;
 			//mBlurWeights[i] /= (2 * sigma * sigma);
 		}
 
@@ -19,6 +19,7 @@ using namespace std;
 #include <d3d9.h>
 #include <d3dx9.h>
 
+#include "AlignedAlloc.h"
 #include "CVector3.h"
 #include "CMatrix4x4.h"
 #include "Mesh.h"
@@ -243,10 +244,10 @@ private:
 		string            sFrameName;   // Name of the frame that drives this bone
 		TUInt32           iFrame;       // Index of the frame that drives this bone
 		TXFileBoneWeights weights;
-		CMatrix4x4        offsetMatrix; // TODO: Would like aligned matrices - but vector can't do it
+		GEN_ALIGN(16) CMatrix4x4 offsetMatrix;
 
 	};
-	typedef vector<SXFileBone>       TXFileBones;
+	typedef vector< SXFileBone, CAlignedAllocator<SXFileBone> > TXFileBones;
 
 
 	// Frame in an X-file hierarchy
@@ -256,10 +257,10 @@ private:
 		TUInt32    iDepth;
 		TUInt32    iParentIndex;
 		TUInt32    iNumChildren;
-		CMatrix4x4 defaultMatrix; // TODO: Would like aligned matrices - but vector can't do it
-		CMatrix4x4 offsetMatrix;
+		GEN_ALIGN(16) CMatrix4x4 defaultMatrix; // Aligned matrices - lists of these structures must
+		GEN_ALIGN(16) CMatrix4x4 offsetMatrix;  // use CAlignedAllocator to keep the alignment
 	};
-	typedef vector<SXFileFrame> TXFileFrames;
+	typedef vector< SXFileFrame, CAlignedAllocator<SXFileFrame> > TXFileFrames;
 
 
 	// A single mesh in an X-File
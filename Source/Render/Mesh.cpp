@@ -4,11 +4,15 @@
 	Mesh class implementation
 ********************************************/
 
+#include <string.h>
 #include <d3d10.h>
 #include <d3dx10.h>
 #include "Mesh.h"
 #include "CImportXFile.h"
 #include "RenderMethod.h"
+#include "CVector3Stream.h"
+#include "MathPacking.h"
+#include "AlignedAlloc.h"
 
 namespace gen
 {
@@ -33,6 +37,8 @@ CMesh::CMesh()
 
 	m_NumNodes = 0;
 	m_Nodes = 0;
+	m_NodeParents = 0;
+	m_NodeBVHs = 0;
 
 	m_NumSubMeshes = 0;
 	m_SubMeshes = 0;
@@ -40,6 +46,8 @@ CMesh::CMesh()
 
 	m_NumMaterials = 0;
 	m_Materials = 0;
+
+	m_NextLOD = 0;
 }
 
 // Model destructor
@@ -75,10 +83,17 @@ void CMesh::ReleaseResources()
 	m_SubMeshes = 0;
 	m_NumSubMeshes = 0;
 
-	delete[] m_Nodes;
+	delete[] m_NodeBVHs;
+	delete[] m_NodeParents;
+	AlignedDelete( m_Nodes );
+	m_NodeBVHs = 0;
+	m_NodeParents = 0;
 	m_Nodes = 0;
 	m_NumNodes = 0;
 
+	delete m_NextLOD;
+	m_NextLOD = 0;
+
 	m_HasGeometry = false;
 }
 
@@ -110,9 +125,10 @@ void CMesh::BeginEnumTriangles()
 }
 
 // Get the next triangle in the mesh, used after BeginEnumTriangles. Fills the supplied
-// CVector3 pointers with the three vertex coordinates of the triangle. Returns true if a
-// triangle was successfully returned, false if there are no more triangles to enumerate
-bool CMesh::GetTriangle( CVector3* pVertex1, CVector3* pVertex2, CVector3* pVertex3 )
+// CVector3 pointers with the three vertex coordinates of the triangle, relative to the node
+// controlling the triangle's sub-mesh. Optionally fills pNode with that node's index. Returns
+// true if a triangle was successfully returned, false if there are no more triangles to enumerate
+bool CMesh::GetTriangle( CVector3* pVertex1, CVector3* pVertex2, CVector3* pVertex3, TUInt32* pNode /*= 0*/ )
 {
 	// If enumerated all meshes then finished
 	if (m_EnumTriMesh >= m_NumSubMeshes)
@@ -120,8 +136,8 @@ bool CMesh::GetTriangle( CVector3* pVertex1, CVector3* pVertex2, CVector3* pVert
 		return false;
 	}
 
-	// If enumerated all triangles in current mesh...
-	if (m_EnumTri >= m_SubMeshes[m_EnumTriMesh].numFaces)
+	// If enumerated all triangles in current mesh (skipping any meshes without triangles)...
+	while (m_EnumTri >= m_SubMeshes[m_EnumTriMesh].numFaces)
 	{
 		// Move to next mesh - finished if no more meshes
 		++m_EnumTriMesh;
@@ -132,8 +148,13 @@ bool CMesh::GetTriangle( CVector3* pVertex1, CVector3* pVertex2, CVector3* pVert
 		m_EnumTri = 0; // Start at first triangle of next mesh
 	}
 
-	// Get current face from submesh
+	// Get current face from submesh and step to the next
 	SMeshFace face = m_SubMeshes[m_EnumTriMesh].faces[m_EnumTri];
+	++m_EnumTri;
+	if (pNode)
+	{
+		*pNode = m_SubMeshes[m_EnumTriMesh].node;
+	}
 
 	// Get pointer to vertex refered to by first face index - deal with flexible vertex size
 	TUInt8* pVertexData = m_SubMeshes[m_EnumTriMesh].vertices + 
@@ -226,12 +247,82 @@ bool CMesh::GetVertex( CVector3* pVertex )
 }
 
 
+//-----------------------------------------------------------------------------
+// Ray casting
+//-----------------------------------------------------------------------------
+
+// Find the nearest point where a ray hits the mesh within the given distance, using the given
+// world matrix for each node. Returns true if the mesh was hit, filling pDistance with the distance
+// to the hit and optionally pNode with the node controlling the triangle hit
+bool CMesh::RayCast( const CMatrix4x4* matrices, const CVector3& origin, const CVector3& direction,
+                     TFloat32 maxDistance, TFloat32* pDistance, TUInt32* pNode /*= 0*/ )
+{
+	if (!m_HasGeometry) return false;
+
+	// Test the ray against the triangles of each node in the node's space. The direction is
+	// transformed along with the origin, so distances along the ray are the same in any space
+	bool hit = false;
+	TFloat32 nearest = maxDistance;
+	for (TUInt32 node = 0; node < m_NumNodes; ++node)
+	{
+		if (m_NodeBVHs[node].NumTriangles() == 0)
+		{
+			continue;
+		}
+
+		CMatrix4x4 worldToNode = InverseAffine( matrices[node] );
+		TFloat32 distance;
+		if (m_NodeBVHs[node].RayCast( worldToNode.TransformPoint( origin ),
+		                              worldToNode.TransformVector( direction ), nearest, &distance ))
+		{
+			hit = true;
+			nearest = distance;
+			if (pNode)
+			{
+				*pNode = node;
+			}
+		}
+	}
+
+	if (hit)
+	{
+		*pDistance = nearest;
+	}
+	return hit;
+}
+
+// Return true if a ray hits the mesh within the given distance, using the given world matrix for
+// each node. Stops at the first hit found
+bool CMesh::RayHits( const CMatrix4x4* matrices, const CVector3& origin, const CVector3& direction,
+                     TFloat32 maxDistance )
+{
+	if (!m_HasGeometry) return false;
+
+	for (TUInt32 node = 0; node < m_NumNodes; ++node)
+	{
+		if (m_NodeBVHs[node].NumTriangles() == 0)
+		{
+			continue;
+		}
+
+		CMatrix4x4 worldToNode = InverseAffine( matrices[node] );
+		if (m_NodeBVHs[node].RayHits( worldToNode.TransformPoint( origin ),
+		                              worldToNode.TransformVector( direction ), maxDistance ))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+
 //-----------------------------------------------------------------------------
 // Creation
 //-----------------------------------------------------------------------------
 
-// Create the model from an X-File, returns true on success
-bool CMesh::Load( const string& fileName )
+// Create the model from an X-File, returns true on success. Optionally store vertices on the GPU
+// in a compact format (see CreateSubMeshDX)
+bool CMesh::Load( const string& fileName, bool compactVertices /*= false*/ )
 {
 	// Create a X-File import helper class
 	CImportXFile importFile;
@@ -265,14 +356,17 @@ bool CMesh::Load( const string& fileName )
 
 	// Get node data from import class
 	m_NumNodes = importFile.GetNumNodes();
-	m_Nodes = new SMeshNode[m_NumNodes];
-	if (!m_Nodes)
+	m_Nodes = AlignedNew<SMeshNode>( m_NumNodes ); // Node matrices are aligned
+	m_NodeParents = new TUInt32[m_NumNodes];
+	if (!m_Nodes || !m_NodeParents)
 	{
+		ReleaseResources();
 		return false;
 	}
 	for (TUInt32 node = 0; node < m_NumNodes; ++node)
 	{
 		importFile.GetNode( node, &m_Nodes[node] );
+		m_NodeParents[node] = m_Nodes[node].parent;
 	}
 
 	// Get material data from import class, also load textures
@@ -311,7 +405,7 @@ bool CMesh::Load( const string& fileName )
 		bool needTangents = RenderMethodUsesTangents( meshMethod );
 
 		importFile.GetSubMesh( m_NumSubMeshes, &m_SubMeshes[m_NumSubMeshes], needTangents );
-		if (!CreateSubMeshDX( m_SubMeshes[m_NumSubMeshes], &m_SubMeshesDX[m_NumSubMeshes] ))
+		if (!CreateSubMeshDX( m_SubMeshes[m_NumSubMeshes], &m_SubMeshesDX[m_NumSubMeshes], compactVertices ))
 		{
 			ReleaseResources();
 			return false;
@@ -324,16 +418,23 @@ bool CMesh::Load( const string& fileName )
 		ReleaseResources();
 		return false;
 	}
+	BuildRayCastHierarchies();
 
 	m_HasGeometry = true;
 	return true;
 }
 
 // Creates a DirectX specific sub-mesh from an imported sub-mesh (mesh materials must already have been prepared as we need to know render method to setup vertex data)
+//
+// Compact vertices use formats that the GPU converts back to floats as it reads them (see MathPacking.h):
+// positions quantised to 16-bit unorm within the sub-mesh bounds (rescaled in the vertex shader), octahedral
+// normals and tangents in 2 x 16-bit snorm (decoded in the vertex shader) and half float UVs. A normal mapped
+// vertex is 20 bytes rather than 44. The original float vertices are kept in the imported sub-mesh
 bool CMesh::CreateSubMeshDX
 (
 	const SSubMesh& subMesh,
-	SSubMeshDX*     subMeshDX
+	SSubMeshDX*     subMeshDX,
+	bool            compactVertices
 )
 {
 	// Copy node and material
@@ -351,12 +452,12 @@ bool CMesh::CreateSubMeshDX
 	// Position is always required
 	subMeshDX->vertexElts[numElts].SemanticName = "POSITION";   // Semantic in HLSL (what is this data for)
 	subMeshDX->vertexElts[numElts].SemanticIndex = 0;           // Index to add to semantic (a count for this kind of data, when using multiple of the same type, e.g. TEXCOORD0, TEXCOORD1)
-	subMeshDX->vertexElts[numElts].Format = DXGI_FORMAT_R32G32B32_FLOAT; // Type of data - this one will be a float3 in the shader. Most data communicated as though it were colours
+	subMeshDX->vertexElts[numElts].Format = compactVertices ? DXGI_FORMAT_R16G16B16A16_UNORM : DXGI_FORMAT_R32G32B32_FLOAT; // Type of data - this one will be a float3 in the shader. Most data communicated as though it were colours
 	subMeshDX->vertexElts[numElts].AlignedByteOffset = offset;  // Offset of element from start of vertex data (e.g. if we have position (float3), uv (float2) then normal, the normal's offset is 5 floats = 5*4 = 20)
 	subMeshDX->vertexElts[numElts].InputSlot = 0;               // For when using multiple vertex buffers (e.g. instancing - an advanced topic)
 	subMeshDX->vertexElts[numElts].InputSlotClass = D3D10_INPUT_PER_VERTEX_DATA; // Use this value for most cases (only changed for instancing)
 	subMeshDX->vertexElts[numElts].InstanceDataStepRate = 0;                     // --"--
-	offset += 12;
+	offset += compactVertices ? 8 : 12;
 	++numElts;
 
 	// Repeat for each kind of vertex data
@@ -385,36 +486,36 @@ bool CMesh::CreateSubMeshDX
 	{
 		subMeshDX->vertexElts[numElts].SemanticName = "NORMAL";
 		subMeshDX->vertexElts[numElts].SemanticIndex = 0;
-		subMeshDX->vertexElts[numElts].Format = DXGI_FORMAT_R32G32B32_FLOAT;
+		subMeshDX->vertexElts[numElts].Format = compactVertices ? DXGI_FORMAT_R16G16_SNORM : DXGI_FORMAT_R32G32B32_FLOAT;
 		subMeshDX->vertexElts[numElts].AlignedByteOffset = offset;
 		subMeshDX->vertexElts[numElts].InputSlot = 0;
 		subMeshDX->vertexElts[numElts].InputSlotClass = D3D10_INPUT_PER_VERTEX_DATA;
 		subMeshDX->vertexElts[numElts].InstanceDataStepRate = 0;
-		offset += 12;
+		offset += compactVertices ? 4 : 12;
 		++numElts;
 	}
 	if (subMesh.hasTangents)
 	{
 		subMeshDX->vertexElts[numElts].SemanticName = "TANGENT";
 		subMeshDX->vertexElts[numElts].SemanticIndex = 0;
-		subMeshDX->vertexElts[numElts].Format = DXGI_FORMAT_R32G32B32_FLOAT;
+		subMeshDX->vertexElts[numElts].Format = compactVertices ? DXGI_FORMAT_R16G16_SNORM : DXGI_FORMAT_R32G32B32_FLOAT;
 		subMeshDX->vertexElts[numElts].AlignedByteOffset = offset;
 		subMeshDX->vertexElts[numElts].InputSlot = 0;
 		subMeshDX->vertexElts[numElts].InputSlotClass = D3D10_INPUT_PER_VERTEX_DATA;
 		subMeshDX->vertexElts[numElts].InstanceDataStepRate = 0;
-		offset += 12;
+		offset += compactVertices ? 4 : 12;
 		++numElts;
 	}
 	if (subMesh.hasTextureCoords)
 	{
 		subMeshDX->vertexElts[numElts].SemanticName = "TEXCOORD";
 		subMeshDX->vertexElts[numElts].SemanticIndex = 0;
-		subMeshDX->vertexElts[numElts].Format = DXGI_FORMAT_R32G32_FLOAT;
+		subMeshDX->vertexElts[numElts].Format = compactVertices ? DXGI_FORMAT_R16G16_FLOAT : DXGI_FORMAT_R32G32_FLOAT;
 		subMeshDX->vertexElts[numElts].AlignedByteOffset = offset;
 		subMeshDX->vertexElts[numElts].InputSlot = 0;
 		subMeshDX->vertexElts[numElts].InputSlotClass = D3D10_INPUT_PER_VERTEX_DATA;
 		subMeshDX->vertexElts[numElts].InstanceDataStepRate = 0;
-		offset += 8;
+		offset += compactVertices ? 4 : 8;
 		++numElts;
 	}
 	if (subMesh.hasVertexColours)
@@ -439,6 +540,66 @@ bool CMesh::CreateSubMeshDX
 	g_pd3dDevice->CreateInputLayout( subMeshDX->vertexElts, numElts, PassDesc.pIAInputSignature, PassDesc.IAInputSignatureSize, &subMeshDX->vertexLayout );
 
 
+	// Convert vertex data to compact format if required, element by element in the same order as above
+	subMeshDX->compactVertices = compactVertices;
+	subMeshDX->positionScale = CVector3::kOne;
+	subMeshDX->positionOffset = CVector3::kZero;
+	TUInt8* compactData = 0;
+	if (compactVertices && subMesh.numVertices > 0) // Empty sub-meshes are rejected later in PreProcess
+	{
+		compactData = new TUInt8[subMeshDX->numVertices * subMeshDX->vertexSize];
+		memset( compactData, 0, subMeshDX->numVertices * subMeshDX->vertexSize ); // Clears unused 4th position component
+		const TUInt8* srcData = subMesh.vertices;
+		TUInt8* dstData = compactData;
+
+		// Quantise positions within the sub-mesh bounds, the vertex shader rescales them
+		CVector3Stream positions;
+		positions.Load( subMesh.vertices, subMesh.numVertices, subMesh.vertexSize );
+		CVector3 minBounds, maxBounds;
+		MinMax( positions, &minBounds, &maxBounds );
+		subMeshDX->positionScale = maxBounds - minBounds;
+		subMeshDX->positionOffset = minBounds;
+		EncodeQuantisedPositionArray( dstData, subMeshDX->vertexSize, srcData, subMesh.vertexSize, subMesh.numVertices,
+		                              minBounds, maxBounds );
+		srcData += 12;
+		dstData += 8;
+
+		if (subMesh.hasSkinningData) // Blend weights and indices copied unchanged
+		{
+			for (TUInt32 vertex = 0; vertex < subMesh.numVertices; ++vertex)
+			{
+				memcpy( dstData + vertex * subMeshDX->vertexSize, srcData + vertex * subMesh.vertexSize, 20 );
+			}
+			srcData += 20;
+			dstData += 20;
+		}
+		if (subMesh.hasNormals)
+		{
+			EncodeOctahedralArray( dstData, subMeshDX->vertexSize, srcData, subMesh.vertexSize, subMesh.numVertices );
+			srcData += 12;
+			dstData += 4;
+		}
+		if (subMesh.hasTangents)
+		{
+			EncodeOctahedralArray( dstData, subMeshDX->vertexSize, srcData, subMesh.vertexSize, subMesh.numVertices );
+			srcData += 12;
+			dstData += 4;
+		}
+		if (subMesh.hasTextureCoords)
+		{
+			FloatToHalfArray( dstData, subMeshDX->vertexSize, srcData, subMesh.vertexSize, 2, subMesh.numVertices );
+			srcData += 8;
+			dstData += 4;
+		}
+		if (subMesh.hasVertexColours)
+		{
+			for (TUInt32 vertex = 0; vertex < subMesh.numVertices; ++vertex)
+			{
+				memcpy( dstData + vertex * subMeshDX->vertexSize, srcData + vertex * subMesh.vertexSize, 4 );
+			}
+		}
+	}
+
 	// Create the vertex buffer and fill it with the sub-mesh vertex data
 	D3D10_BUFFER_DESC bufferDesc;
 	bufferDesc.BindFlags = D3D10_BIND_VERTEX_BUFFER;
@@ -447,8 +608,10 @@ bool CMesh::CreateSubMeshDX
 	bufferDesc.CPUAccessFlags = 0;   // Indicates that CPU won't access this buffer at all after creation
 	bufferDesc.MiscFlags = 0;
 	D3D10_SUBRESOURCE_DATA initData; // Initial data
-	initData.pSysMem = subMesh.vertices;   
-	if (FAILED( g_pd3dDevice->CreateBuffer( &bufferDesc, &initData, &subMeshDX->vertexBuffer )))
+	initData.pSysMem = compactVertices ? compactData : subMesh.vertices;
+	HRESULT result = g_pd3dDevice->CreateBuffer( &bufferDesc, &initData, &subMeshDX->vertexBuffer );
+	delete[] compactData;
+	if (FAILED( result ))
 	{
 		return false;
 	}
@@ -526,6 +689,7 @@ bool CMesh::PreProcess()
 	m_BoundingRadius = m_MinBounds.Length();
 
 	// Go through all submeshes ...
+	CVector3Stream positions;
 	for (TUInt32 subMesh = 0; subMesh < m_NumSubMeshes; ++subMesh)
 	{
 		// Reject mesh if it contains empty sub-meshes
@@ -534,58 +698,103 @@ bool CMesh::PreProcess()
 			return false;
 		}
 
-		// Go through all vertices
-		TUInt8* pVertex = m_SubMeshes[subMesh].vertices;
-		for (TUInt32 vert = 0; vert < m_SubMeshes[subMesh].numVertices; ++vert)
+		// Gather vertex coords into a stream (assume float x,y,z coord again, with flexible
+		// vertex size), then get bounds and radius of all of them in one batch
+		positions.Load( m_SubMeshes[subMesh].vertices, m_SubMeshes[subMesh].numVertices,
+		                m_SubMeshes[subMesh].vertexSize );
+		CVector3 subMeshMin, subMeshMax;
+		MinMax( positions, &subMeshMin, &subMeshMax );
+		TFloat32 subMeshRadius = MaxLength( positions );
+
+		// Merge with current bounds
+		m_MinBounds.x = Min( m_MinBounds.x, subMeshMin.x );
+		m_MinBounds.y = Min( m_MinBounds.y, subMeshMin.y );
+		m_MinBounds.z = Min( m_MinBounds.z, subMeshMin.z );
+		m_MaxBounds.x = Max( m_MaxBounds.x, subMeshMax.x );
+		m_MaxBounds.y = Max( m_MaxBounds.y, subMeshMax.y );
+		m_MaxBounds.z = Max( m_MaxBounds.z, subMeshMax.z );
+		m_BoundingRadius = Max( m_BoundingRadius, subMeshRadius );
+
+		// Keep sub-mesh bounds for culling sub-meshes individually
+		m_SubMeshesDX[subMesh].minBounds = subMeshMin;
+		m_SubMeshesDX[subMesh].maxBounds = subMeshMax;
+	}
+
+	return true;
+}
+
+// Build the triangle hierarchy of each node for ray casting, from the triangles of the sub-meshes
+// controlled by the node (in the node's space)
+void CMesh::BuildRayCastHierarchies()
+{
+	m_NodeBVHs = new CTriangleBVH[m_NumNodes];
+
+	vector<CVector3> vertices;
+	for (TUInt32 node = 0; node < m_NumNodes; ++node)
+	{
+		vertices.clear();
+		for (TUInt32 subMesh = 0; subMesh < m_NumSubMeshes; ++subMesh)
 		{
-			// Get vertex coord as vector
-			pVertexCoord = reinterpret_cast<TFloat32*>(pVertex); // Assume float x,y,z coord again
-			CVector3 vertex;
-			vertex.x = *pVertexCoord++;
-			vertex.y = *pVertexCoord++;
-			vertex.z = *pVertexCoord;
-			
-			// Compare vertex against current bounds, updating bounds where necessary
-			if (vertex.x < m_MinBounds.x)
+			const SSubMesh& subMeshData = m_SubMeshes[subMesh];
+			if (subMeshData.node != node)
 			{
-				m_MinBounds.x = vertex.x;
+				continue;
 			}
-			if (vertex.x > m_MaxBounds.x)
-			{
-				m_MaxBounds.x = vertex.x;
-			}
-			++pVertexCoord;
 
-			if (vertex.y < m_MinBounds.y)
+			// Assume float x,y,z coord at start of each vertex again (see PreProcess)
+			for (TUInt32 face = 0; face < subMeshData.numFaces; ++face)
 			{
-				m_MinBounds.y = vertex.y;
+				for (TUInt32 corner = 0; corner < 3; ++corner)
+				{
+					const TFloat32* pVertexCoord = reinterpret_cast<const TFloat32*>(subMeshData.vertices +
+					                               subMeshData.faces[face].aiVertex[corner] * subMeshData.vertexSize);
+					vertices.push_back( CVector3( pVertexCoord[0], pVertexCoord[1], pVertexCoord[2] ) );
+				}
 			}
-			if (vertex.y > m_MaxBounds.y)
-			{
-				m_MaxBounds.y = vertex.y;
-			}
-			++pVertexCoord;
+		}
+		if (!vertices.empty())
+		{
+			m_NodeBVHs[node].Build( &vertices[0], static_cast<TUInt32>(vertices.size() / 3) );
+		}
+	}
+}
 
-			if (vertex.z < m_MinBounds.z)
-			{
-				m_MinBounds.z = vertex.z;
-			}
-			if (vertex.z > m_MaxBounds.z)
-			{
-				m_MaxBounds.z = vertex.z;
-			}
 
-			TFloat32 length = vertex.Length();
-			if (length > m_BoundingRadius)
-			{
-				m_BoundingRadius = length;
-			}
+// Load a lower level of detail for the mesh from an X-File, added after any levels already loaded.
+// The file must have the same node hierarchy as this mesh. Returns true on success
+bool CMesh::LoadLOD( const string& fileName, bool compactVertices /*= false*/ )
+{
+	if (!m_HasGeometry) return false;
 
-			// Step to next vertex (flexible vertex size)
-			pVertex += m_SubMeshes[subMesh].vertexSize;
+	// Add to the end of the list of levels
+	if (m_NextLOD)
+	{
+		return m_NextLOD->LoadLOD( fileName, compactVertices );
+	}
+
+	CMesh* lodMesh = new CMesh;
+	if (!lodMesh->Load( fileName, compactVertices ))
+	{
+		delete lodMesh;
+		return false;
+	}
+
+	// Entities render all levels with the same matrices, so the hierarchies must match
+	if (lodMesh->m_NumNodes != m_NumNodes)
+	{
+		delete lodMesh;
+		return false;
+	}
+	for (TUInt32 node = 0; node < m_NumNodes; ++node)
+	{
+		if (lodMesh->m_NodeParents[node] != m_NodeParents[node])
+		{
+			delete lodMesh;
+			return false;
 		}
 	}
 
+	m_NextLOD = lodMesh;
 	return true;
 }
 
@@ -595,18 +804,37 @@ bool CMesh::PreProcess()
 //-----------------------------------------------------------------------------
 
 // Render the model from the given camera using the given matrix list as a hierarchy (must be one matrix per node)
-void CMesh::Render(	CMatrix4x4* matrices, CCamera* camera, bool postProcess /*= false*/ )
+// Optionally pass a frustum plane cache kept by the caller for this model instance (see CCamera::SphereInFrustum)
+// and the level of detail to render (0 is full detail, levels beyond those loaded use the lowest detail)
+void CMesh::Render(	CMatrix4x4* matrices, CCamera* camera, bool postProcess /*= false*/, TUInt32* cullPlane /*= 0*/,
+                    TUInt32 lod /*= 0*/ )
 {
 	if (!m_HasGeometry) return;
 
 	// Test if mesh is visible - test the mesh's bounding sphere against the camera frustum
-	CVector3 scale = matrices[0].GetScale();
-	TFloat32 scaledRadius = m_BoundingRadius * Max(scale.x, Max(scale.y, scale.z) ); // Scale bounding sphere by largest dimension of mesh scale
-	if (!camera->SphereInFrustum( matrices->Position(), scaledRadius ))
+	if (!camera->SphereInFrustum( matrices->Position(), BoundingRadius( matrices[0] ), cullPlane ))
 	{
 		return;
 	}
 
+	RenderVisible( matrices, camera, postProcess, lod, cullPlane );
+}
+
+// Render the model as above without testing if its bounding sphere is visible, for callers that have already culled it
+// Sub-meshes are still culled individually against the camera frustum, optionally pass a frustum plane cache kept by the
+// caller for this model instance to test first
+void CMesh::RenderVisible( CMatrix4x4* matrices, CCamera* camera, bool postProcess /*= false*/, TUInt32 lod /*= 0*/,
+                           TUInt32* cullPlane /*= 0*/ )
+{
+	if (!m_HasGeometry) return;
+
+	// Pass lower levels of detail down the list, stopping at the last level
+	if (lod > 0 && m_NextLOD)
+	{
+		m_NextLOD->RenderVisible( matrices, camera, postProcess, lod - 1, cullPlane );
+		return;
+	}
+
 	// Render each sub-mesh
 	for (TUInt32 subMesh = 0; subMesh < m_NumSubMeshes; ++subMesh)
 	{
@@ -621,7 +849,17 @@ void CMesh::Render(	CMatrix4x4* matrices, CCamera* camera, bool postProcess /*=
 		// Check that material type (normal or post-processed) matches request passed as parameter before rendering
 		if (RenderMethodIsPostProcess( material.renderMethod ) == postProcess)
 		{
+			// Skip sub-meshes outside the camera frustum, large multi-part meshes are often only partly visible. Sub-mesh bounds
+			// are in the space of its node, so transform them by the node's matrix to get world space bounds
+			CVector3 worldMin, worldMax;
+			matrices[subMeshDX.node].TransformAABB( subMeshDX.minBounds, subMeshDX.maxBounds, &worldMin, &worldMax );
+			if (!camera->AABBInFrustum( worldMin, worldMax, cullPlane ))
+			{
+				continue;
+			}
+
 			// Set up render method passing material colours & textures and the sub-mesh's world matrix, also get back the fx file technique to use
+			SetVertexDecoding( subMeshDX.positionScale, subMeshDX.positionOffset, subMeshDX.compactVertices );
 			SetRenderMethod( material.renderMethod, &material.diffuseColour, &material.specularColour, material.specularPower, material.textures, &matrices[subMeshDX.node] );
 			ID3D10EffectTechnique* technique = GetRenderMethodTechnique( material.renderMethod );
 
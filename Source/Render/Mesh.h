@@ -14,6 +14,7 @@ using namespace std;
 #include "Defines.h"
 #include "CVector3.h"
 #include "CMatrix4x4.h"
+#include "CTriangleBVH.h"
 #include "MeshData.h"
 #include "Camera.h"
 
@@ -63,6 +64,14 @@ public:
 		return m_BoundingRadius;
 	}
 
+	// Get radius of bounding sphere in world space when the model's root node has the given world
+	// matrix - scales the model space radius by the largest dimension of the matrix scale
+	TFloat32 BoundingRadius( const CMatrix4x4& rootMatrix )
+	{
+		CVector3 scale = rootMatrix.GetScale();
+		return m_BoundingRadius * Max( scale.x, Max( scale.y, scale.z ) );
+	}
+
 
 	// Return total number of triangles in the mesh
 	TUInt32 GetNumTriangles();
@@ -72,9 +81,10 @@ public:
 	void BeginEnumTriangles();
 
 	// Get the next triangle in the mesh, used after BeginEnumTriangles. Fills the supplied
-	// CVector3 pointers with the three vertex coordinates of the triangle. Returns true if a
-	// triangle was successfully returned, false if there are no more triangles to enumerate
-	bool GetTriangle( CVector3* pVertex1, CVector3* pVertex2, CVector3* pVertex3 );
+	// CVector3 pointers with the three vertex coordinates of the triangle, relative to the node
+	// controlling the triangle's sub-mesh. Optionally fills pNode with that node's index. Returns
+	// true if a triangle was successfully returned, false if there are no more triangles to enumerate
+	bool GetTriangle( CVector3* pVertex1, CVector3* pVertex2, CVector3* pVertex3, TUInt32* pNode = 0 );
 
 
 	// Return total number of vertices in the mesh
@@ -90,6 +100,25 @@ public:
 	bool GetVertex( CVector3* pVertex );
 
 
+	/////////////////////////////////////
+	// Ray casting
+	// Rays start at the given world space origin, distances along them are measured in lengths of
+	// the given direction vector. Pass the world matrix of each node of the mesh, as for Render.
+	// Triangles are hit from either side. Each node's triangles are held in a bounding volume
+	// hierarchy built when the mesh is loaded, so a ray only tests the triangles near it
+
+	// Find the nearest point where a ray hits the mesh within the given distance. Returns true if
+	// the mesh was hit, filling pDistance with the distance to the hit and optionally pNode with the
+	// node controlling the triangle hit
+	bool RayCast( const CMatrix4x4* matrices, const CVector3& origin, const CVector3& direction,
+	              TFloat32 maxDistance, TFloat32* pDistance, TUInt32* pNode = 0 );
+
+	// Return true if a ray hits the mesh within the given distance. Stops at the first hit found,
+	// so is faster than RayCast - use for line of sight tests
+	bool RayHits( const CMatrix4x4* matrices, const CVector3& origin, const CVector3& direction,
+	              TFloat32 maxDistance );
+
+
 	/////////////////////////////////////
 	// Hierarchy access
 
@@ -103,19 +132,47 @@ public:
 		return m_Nodes[node];
 	}
 
+	// Get the parent index of every node as a contiguous array (one entry per node), for use
+	// with batch hierarchy functions such as MultiplyByParents
+	const TUInt32* GetNodeParents()
+	{
+		return m_NodeParents;
+	}
+
 
 	/////////////////////////////////////
 	// Creation
 
-	// Load the mesh from an X-File
-	bool Load( const string& fileName );
+	// Load the mesh from an X-File. Optionally store vertices on the GPU in a compact format
+	// (see CreateSubMeshDX), roughly halving their size at a small cost in precision
+	bool Load( const string& fileName, bool compactVertices = false );
+
+	// Load a lower level of detail for the mesh from an X-File, added after any levels already
+	// loaded. The file must have the same node hierarchy as this mesh so the same matrices can be
+	// used to render it. Returns true on success
+	bool LoadLOD( const string& fileName, bool compactVertices = false );
+
+	// Return the number of levels of detail, including this mesh (level 0)
+	TUInt32 GetNumLODs()
+	{
+		return 1 + (m_NextLOD ? m_NextLOD->GetNumLODs() : 0);
+	}
 
 
 	/////////////////////////////////////
 	// Rendering
 
 	// Render the model from the given camera using the given matrix list as a hierarchy (must be one matrix per node)
-	void Render( CMatrix4x4* matrices, CCamera* camera, bool postProcess = false );
+	// Optionally pass a frustum plane cache kept by the caller for this model instance (see CCamera::SphereInFrustum)
+	// and the level of detail to render (0 is full detail, levels beyond those loaded use the lowest detail)
+	void Render( CMatrix4x4* matrices, CCamera* camera, bool postProcess = false, TUInt32* cullPlane = 0,
+	             TUInt32 lod = 0 );
+
+	// Render the model as above without testing if its bounding sphere is visible, for callers that have already culled it
+	// Sub-meshes are still culled individually against the camera frustum, optionally pass a frustum plane cache kept by the
+	// caller for this model instance to test first (sub-meshes of a model are often rejected by the same plane)
+	void RenderVisible( CMatrix4x4* matrices, CCamera* camera, bool postProcess = false, TUInt32 lod = 0,
+	                    TUInt32* cullPlane = 0 );
 
 
 /*-----------------------------------------------------------------------------------------
@@ -144,9 +201,21 @@ private:
 		ID3D10InputLayout*       vertexLayout; // Layout of a vertex (derived from above array)
 		unsigned int             vertexSize;   // Size of vertex calculated from contained elements
 
+		// Compact vertices store positions quantised within the sub-mesh bounds, and octahedral
+		// normals / tangents. The vertex shader rescales positions with these values (which are
+		// (1,1,1) and (0,0,0) for standard vertices) - see SetVertexDecoding in RenderMethod.h
+		bool                     compactVertices;
+		CVector3                 positionScale;
+		CVector3                 positionOffset;
+
 		// Index data for the sub-mesh stored in a index buffer and the number of indices in the buffer
 		ID3D10Buffer*            indexBuffer;
 		TUInt32                  numIndices;
+
+		// Bounding box of the sub-mesh in the space of its node (calculated in PreProcess) - the
+		// minimum and maximum x,y & z values
+		CVector3                 minBounds;
+		CVector3                 maxBounds;
 	};
 
 
@@ -181,13 +250,17 @@ private:
 	bool CreateSubMeshDX
 	(
 		const SSubMesh& subMesh,
-		SSubMeshDX*     subMeshDX
+		SSubMeshDX*     subMeshDX,
+		bool            compactVertices
 	);
 
 
 	// Pre-processing after loading
 	bool PreProcess();
 
+	// Build the triangle hierarchy of each node for ray casting
+	void BuildRayCastHierarchies();
+
 
 	/*---------------------------------------------------------------------------------------------
 		Data
@@ -199,6 +272,11 @@ private:
 	// Hierarchy for mesh - stored as a depth-first list of nodes, see SMeshNode defn in MeshData.h
 	TUInt32          m_NumNodes;
 	SMeshNode*       m_Nodes;        // Dynamically allocated array
+	TUInt32*         m_NodeParents;  // Copy of parent index from each node above, packed together
+
+	// Triangle hierarchy for ray casting for each node, holding the triangles of the sub-meshes
+	// controlled by the node in the node's space (dynamically allocated array, one per node)
+	CTriangleBVH*    m_NodeBVHs;
 
 	// Sub-meshes for mesh - each uses a single material
 	TUInt32          m_NumSubMeshes;
@@ -216,6 +294,9 @@ private:
 	// Bounding sphere radius (from (0,0,0) in model space)
 	TFloat32         m_BoundingRadius;
 
+	// Next lower level of detail, 0 if none. Each level owns the next, forming a list
+	CMesh*           m_NextLOD;
+
 	// Data to support vertex / triangle enumeration
 	TUInt32          m_EnumTriMesh;  // Current mesh being enumerated for triangles
 	TUInt32          m_EnumTri;      // Current triangle (within above mesh) being enumerated
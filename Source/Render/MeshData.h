@@ -24,6 +24,7 @@ namespace gen
 // Mesh definitions
 
 // A single node in the hierarchy of a mesh. The hierarchy is flattened (depth-first) into a list
+// The matrices are aligned, so allocate lists of nodes with AlignedNew (see AlignedAlloc.h)
 struct SMeshNode
 { 
 	string     name;           // Name for the node
@@ -31,8 +32,9 @@ struct SMeshNode
 	TUInt32    parent;         // Index in hierarchy list of parent node
 	TUInt32    numChildren;    // Number of children of this node - the next node in the list will
 	                           // be the first child
-	CMatrix4x4 positionMatrix; // Default matrix of this node in parent space
-	CMatrix4x4 invMeshOffset;  // Inverse of the matrix of this node in mesh's root space
+	GEN_ALIGN(16) CMatrix4x4 positionMatrix; // Default matrix of this node in parent space
+	GEN_ALIGN(16) CMatrix4x4 invMeshOffset;  // Inverse of the matrix of this node in mesh's
+	                                         // root space
 };
 
 
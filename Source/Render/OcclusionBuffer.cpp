@@ -0,0 +1,503 @@
+/*******************************************
+	OcclusionBuffer.cpp
+
+	Software depth buffer for occlusion
+	culling, class implementation
+********************************************/
+
+#include "OcclusionBuffer.h"
+
+#include "BaseMath.h"
+#include "MathSIMD.h"
+
+namespace gen
+{
+
+//-----------------------------------------------------------------------------
+// Constructors/Destructors
+//-----------------------------------------------------------------------------
+
+// Constructor creates an empty buffer. Pass number of threads used to rasterise, including the
+// calling thread, or 0 to use one per processor core (at most one per tile)
+COcclusionBuffer::COcclusionBuffer( TUInt32 numThreads /*= 0*/ )
+{
+	if (numThreads == 0)
+	{
+		numThreads = thread::hardware_concurrency(); // May return 0 if unknown
+	}
+	m_NumThreads = Max( 1u, Min( numThreads, kiOcclusionNumTiles ) );
+
+	m_Depth.resize( kiOcclusionWidth * kiOcclusionHeight, 1.0f );
+	for (TUInt32 block = 0; block < kiOcclusionBlocksX * kiOcclusionBlocksY; ++block)
+	{
+		m_HiZ[block] = 1.0f;
+	}
+
+	m_NextTile = kiOcclusionNumTiles;
+	m_WorkGeneration = 0;
+	m_NumBusyWorkers = 0;
+	m_StopWorkers = false;
+}
+
+// Destructor stops any threads
+COcclusionBuffer::~COcclusionBuffer()
+{
+	{
+		unique_lock<mutex> lock( m_WorkMutex );
+		m_StopWorkers = true;
+	}
+	m_StartWork.notify_all();
+	for (TUInt32 worker = 0; worker < m_Workers.size(); ++worker)
+	{
+		m_Workers[worker].join();
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Rendering
+//-----------------------------------------------------------------------------
+
+// Begin a new frame viewed with the given combined view/projection matrix, removing all
+// occluders from the previous frame
+void COcclusionBuffer::Begin( const CMatrix4x4& viewProj )
+{
+	m_ViewProj = viewProj;
+	m_Triangles.clear();
+	for (TUInt32 tile = 0; tile < kiOcclusionNumTiles; ++tile)
+	{
+		m_TileTriangles[tile].clear();
+	}
+}
+
+// Add occluder triangles to the frame. Pass three vertices per triangle, each triangle's node
+// index and the world matrix of each node - the vertices are relative to the node given
+void COcclusionBuffer::AddOccluder
+(
+	const CVector3*   pVertices,
+	const TUInt32*    pNodes,
+	TUInt32           numTriangles,
+	const CMatrix4x4* pMatrices
+)
+{
+	// Triangles of each node are usually together, so only recalculate the matrix from node space
+	// to clip space when the node changes
+	TUInt32 currentNode = 0xffffffff;
+	CMatrix4x4 nodeToClip;
+	for (TUInt32 triangle = 0; triangle < numTriangles; ++triangle)
+	{
+		if (pNodes[triangle] != currentNode)
+		{
+			currentNode = pNodes[triangle];
+			nodeToClip = pMatrices[currentNode] * m_ViewProj;
+		}
+
+		CVector4 clip[3];
+		for (TUInt32 vertex = 0; vertex < 3; ++vertex)
+		{
+			const CVector3& v = pVertices[triangle * 3 + vertex];
+			clip[vertex] = CVector4( v.x, v.y, v.z, 1.0f ) * nodeToClip;
+		}
+
+		// Discard triangles entirely outside one side of the view frustum (other than the near
+		// clip plane, which is handled by clipping)
+		if ((clip[0].x >  clip[0].w && clip[1].x >  clip[1].w && clip[2].x >  clip[2].w) ||
+		    (clip[0].x < -clip[0].w && clip[1].x < -clip[1].w && clip[2].x < -clip[2].w) ||
+		    (clip[0].y >  clip[0].w && clip[1].y >  clip[1].w && clip[2].y >  clip[2].w) ||
+		    (clip[0].y < -clip[0].w && clip[1].y < -clip[1].w && clip[2].y < -clip[2].w) ||
+		    (clip[0].z >  clip[0].w && clip[1].z >  clip[1].w && clip[2].z >  clip[2].w))
+		{
+			continue;
+		}
+		AddClipTriangle( clip[0], clip[1], clip[2] );
+	}
+}
+
+// Render all occluders added since Begin into the depth buffer and build the hierarchical Z
+// buffer. Tiles are shared between this thread and any others
+void COcclusionBuffer::Rasterise()
+{
+	m_NextTile = 0;
+
+	// Start threads on first use, the workers begin by waiting for work
+	if (m_NumThreads > 1 && m_Workers.empty())
+	{
+		for (TUInt32 worker = 1; worker < m_NumThreads; ++worker)
+		{
+			m_Workers.push_back( thread( &COcclusionBuffer::WorkerThread, this ) );
+		}
+	}
+
+	if (!m_Workers.empty())
+	{
+		{
+			unique_lock<mutex> lock( m_WorkMutex );
+			m_NumBusyWorkers = static_cast<TUInt32>(m_Workers.size());
+			++m_WorkGeneration;
+		}
+		m_StartWork.notify_all();
+	}
+
+	RasteriseTiles();
+
+	// Wait for workers to finish their last tiles
+	if (!m_Workers.empty())
+	{
+		unique_lock<mutex> lock( m_WorkMutex );
+		while (m_NumBusyWorkers > 0)
+		{
+			m_WorkDone.wait( lock );
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// Testing
+//-----------------------------------------------------------------------------
+
+// Test if a world space axis-aligned bounding box may be visible - returns false if it is
+// hidden behind the occluders, true otherwise
+bool COcclusionBuffer::IsAABBVisible( const CVector3& minBounds, const CVector3& maxBounds )
+{
+	if (m_Triangles.empty())
+	{
+		return true;
+	}
+
+	// Project the box corners to find the rectangle covered on screen and the nearest depth
+	TFloat32 x[8], y[8], z[8];
+	for (TUInt32 corner = 0; corner < 8; ++corner)
+	{
+		CVector4 clip = CVector4( (corner & 1) ? maxBounds.x : minBounds.x,
+		                          (corner & 2) ? maxBounds.y : minBounds.y,
+		                          (corner & 4) ? maxBounds.z : minBounds.z, 1.0f ) * m_ViewProj;
+		if (clip.z < 0.0f)
+		{
+			return true; // In front of near clip plane, so box crosses it
+		}
+		TFloat32 invW = 1.0f / clip.w;
+		x[corner] = (clip.x * invW * 0.5f + 0.5f) * kiOcclusionWidth;
+		y[corner] = (0.5f - clip.y * invW * 0.5f) * kiOcclusionHeight;
+		z[corner] = clip.z * invW;
+	}
+	TFloat32 minX = x[0], maxX = x[0];
+	TFloat32 minY = y[0], maxY = y[0];
+	TFloat32 minZ = z[0];
+	for (TUInt32 corner = 1; corner < 8; ++corner)
+	{
+		minX = Min( minX, x[corner] );
+		maxX = Max( maxX, x[corner] );
+		minY = Min( minY, y[corner] );
+		maxY = Max( maxY, y[corner] );
+		minZ = Min( minZ, z[corner] );
+	}
+
+	// Every pixel touched by the rectangle is tested
+	if (maxX < 0.0f || minX >= kiOcclusionWidth || maxY < 0.0f || minY >= kiOcclusionHeight)
+	{
+		return false; // Off-screen
+	}
+	TInt32 pixelMinX = static_cast<TInt32>(Max( 0.0f, minX ));
+	TInt32 pixelMaxX = static_cast<TInt32>(Min( kiOcclusionWidth - 1.0f, maxX ));
+	TInt32 pixelMinY = static_cast<TInt32>(Max( 0.0f, minY ));
+	TInt32 pixelMaxY = static_cast<TInt32>(Min( kiOcclusionHeight - 1.0f, maxY ));
+
+	// Test against the greatest depth of each block covered. Only look at individual pixels in
+	// blocks that may have something behind the box and are not entirely covered
+	TInt32 blockMinX = pixelMinX / kiOcclusionBlockSize;
+	TInt32 blockMaxX = pixelMaxX / kiOcclusionBlockSize;
+	TInt32 blockMinY = pixelMinY / kiOcclusionBlockSize;
+	TInt32 blockMaxY = pixelMaxY / kiOcclusionBlockSize;
+	for (TInt32 blockY = blockMinY; blockY <= blockMaxY; ++blockY)
+	{
+		for (TInt32 blockX = blockMinX; blockX <= blockMaxX; ++blockX)
+		{
+			if (minZ > m_HiZ[blockY * kiOcclusionBlocksX + blockX])
+			{
+				continue; // Whole block is in front of the box
+			}
+
+			TInt32 x0 = Max<TInt32>( pixelMinX, blockX * kiOcclusionBlockSize );
+			TInt32 x1 = Min<TInt32>( pixelMaxX, (blockX + 1) * kiOcclusionBlockSize - 1 );
+			TInt32 y0 = Max<TInt32>( pixelMinY, blockY * kiOcclusionBlockSize );
+			TInt32 y1 = Min<TInt32>( pixelMaxY, (blockY + 1) * kiOcclusionBlockSize - 1 );
+			if (x1 - x0 == kiOcclusionBlockSize - 1 && y1 - y0 == kiOcclusionBlockSize - 1)
+			{
+				return true; // Whole block covered by box, so the furthest pixel is behind it
+			}
+			for (TInt32 y = y0; y <= y1; ++y)
+			{
+				const TFloat32* pDepth = &m_Depth[y * kiOcclusionWidth];
+				for (TInt32 x = x0; x <= x1; ++x)
+				{
+					if (minZ <= pDepth[x])
+					{
+						return true;
+					}
+				}
+			}
+		}
+	}
+	return false;
+}
+
+
+//-----------------------------------------------------------------------------
+// Private functions
+//-----------------------------------------------------------------------------
+
+// Add a triangle given in clip space, clipping it to the near clip plane if necessary
+void COcclusionBuffer::AddClipTriangle( const CVector4& v0, const CVector4& v1, const CVector4& v2 )
+{
+	if (v0.z >= 0.0f && v1.z >= 0.0f && v2.z >= 0.0f)
+	{
+		AddTriangle( v0, v1, v2 );
+		return;
+	}
+
+	// Clip to near plane (z = 0 in clip space), leaving a polygon of up to 4 vertices. Points
+	// behind the near plane have w > 0, so no other clipping is needed before projection
+	const CVector4* inVertices[3] = { &v0, &v1, &v2 };
+	CVector4 outVertices[4];
+	TUInt32 numOut = 0;
+	for (TUInt32 vertex = 0; vertex < 3; ++vertex)
+	{
+		const CVector4& a = *inVertices[vertex];
+		const CVector4& b = *inVertices[(vertex + 1) % 3];
+		if (a.z >= 0.0f)
+		{
+			outVertices[numOut++] = a;
+		}
+		if ((a.z >= 0.0f) != (b.z >= 0.0f))
+		{
+			TFloat32 t = a.z / (a.z - b.z);
+			outVertices[numOut++] = a + (b - a) * t;
+		}
+	}
+
+	// Render polygon as a fan of triangles
+	for (TUInt32 vertex = 2; vertex < numOut; ++vertex)
+	{
+		AddTriangle( outVertices[0], outVertices[vertex - 1], outVertices[vertex] );
+	}
+}
+
+// Add a triangle that is not in front of the near clip plane, given in clip space
+void COcclusionBuffer::AddTriangle( const CVector4& v0, const CVector4& v1, const CVector4& v2 )
+{
+	// Project to pixel coordinates and depth
+	const CVector4* clip[3] = { &v0, &v1, &v2 };
+	TFloat32 x[3], y[3], z[3];
+	for (TUInt32 vertex = 0; vertex < 3; ++vertex)
+	{
+		TFloat32 invW = 1.0f / clip[vertex]->w;
+		x[vertex] = (clip[vertex]->x * invW * 0.5f + 0.5f) * kiOcclusionWidth;
+		y[vertex] = (0.5f - clip[vertex]->y * invW * 0.5f) * kiOcclusionHeight;
+		z[vertex] = clip[vertex]->z * invW;
+	}
+
+	// Find pixels whose centres may be covered, discard triangles that cover none
+	TFloat32 minX = Max( 0.0f, Min( x[0], Min( x[1], x[2] ) ) - 0.5f );
+	TFloat32 maxX = Min( kiOcclusionWidth - 1.0f, Max( x[0], Max( x[1], x[2] ) ) - 0.5f );
+	TFloat32 minY = Max( 0.0f, Min( y[0], Min( y[1], y[2] ) ) - 0.5f );
+	TFloat32 maxY = Min( kiOcclusionHeight - 1.0f, Max( y[0], Max( y[1], y[2] ) ) - 0.5f );
+	if (minX > maxX || minY > maxY)
+	{
+		return;
+	}
+
+	// Twice the signed area, discard degenerate triangles. Triangles facing either way are used,
+	// edge functions are flipped so they are positive inside the triangle
+	TFloat32 area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+	if (area == 0.0f)
+	{
+		return;
+	}
+	TFloat32 sign = area > 0.0f ? 1.0f : -1.0f;
+
+	STriangle triangle;
+	for (TUInt32 edge = 0; edge < 3; ++edge)
+	{
+		TUInt32 a = edge;
+		TUInt32 b = (edge + 1) % 3;
+		triangle.edgeA[edge] = (y[a] - y[b]) * sign;
+		triangle.edgeB[edge] = (x[b] - x[a]) * sign;
+		triangle.edgeC[edge] = -(triangle.edgeA[edge] * x[a] + triangle.edgeB[edge] * y[a]);
+	}
+
+	// Depth is linear in pixel coordinates after projection
+	triangle.depthA = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) / area;
+	triangle.depthB = ((x[1] - x[0]) * (z[2] - z[0]) - (x[2] - x[0]) * (z[1] - z[0])) / area;
+	triangle.depthC = z[0] - triangle.depthA * x[0] - triangle.depthB * y[0];
+
+	triangle.minX = static_cast<TInt32>(Ceil( minX ));
+	triangle.maxX = static_cast<TInt32>(Floor( maxX ));
+	triangle.minY = static_cast<TInt32>(Ceil( minY ));
+	triangle.maxY = static_cast<TInt32>(Floor( maxY ));
+	if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+	{
+		return;
+	}
+
+	// Add triangle to each tile it overlaps
+	TUInt32 index = static_cast<TUInt32>(m_Triangles.size());
+	m_Triangles.push_back( triangle );
+	for (TInt32 tileY = triangle.minY / kiOcclusionTileHeight;
+	     tileY <= triangle.maxY / static_cast<TInt32>(kiOcclusionTileHeight); ++tileY)
+	{
+		for (TInt32 tileX = triangle.minX / kiOcclusionTileWidth;
+		     tileX <= triangle.maxX / static_cast<TInt32>(kiOcclusionTileWidth); ++tileX)
+		{
+			m_TileTriangles[tileY * kiOcclusionTilesX + tileX].push_back( index );
+		}
+	}
+}
+
+
+// Rasterise tiles until all have been taken (by this thread or others)
+void COcclusionBuffer::RasteriseTiles()
+{
+	TUInt32 tile;
+	while ((tile = m_NextTile++) < kiOcclusionNumTiles)
+	{
+		RasteriseTile( tile );
+	}
+}
+
+// Clear the given tile, render its triangles and build its part of the hierarchical Z buffer
+void COcclusionBuffer::RasteriseTile( TUInt32 tile )
+{
+	const TInt32 tileX = (tile % kiOcclusionTilesX) * kiOcclusionTileWidth;
+	const TInt32 tileY = (tile / kiOcclusionTilesX) * kiOcclusionTileHeight;
+
+	for (TInt32 y = tileY; y < tileY + static_cast<TInt32>(kiOcclusionTileHeight); ++y)
+	{
+		TFloat32* pDepth = &m_Depth[y * kiOcclusionWidth + tileX];
+		for (TUInt32 x = 0; x < kiOcclusionTileWidth; ++x)
+		{
+			pDepth[x] = 1.0f;
+		}
+	}
+
+	// Render each triangle within the tile, testing pixel centres against the edge functions and
+	// keeping the nearest depth. Rows are processed in groups of four pixels (aligned to four)
+	const vector<TUInt32>& triangles = m_TileTriangles[tile];
+	for (TUInt32 i = 0; i < triangles.size(); ++i)
+	{
+		const STriangle& triangle = m_Triangles[triangles[i]];
+		TInt32 x0 = Max( triangle.minX, tileX ) & ~3;
+		TInt32 x1 = Min( triangle.maxX, tileX + static_cast<TInt32>(kiOcclusionTileWidth) - 1 );
+		TInt32 y0 = Max( triangle.minY, tileY );
+		TInt32 y1 = Min( triangle.maxY, tileY + static_cast<TInt32>(kiOcclusionTileHeight) - 1 );
+
+#if defined(GEN_MATH_SSE)
+		const __m128 mmEdgeA0 = _mm_set1_ps( triangle.edgeA[0] );
+		const __m128 mmEdgeA1 = _mm_set1_ps( triangle.edgeA[1] );
+		const __m128 mmEdgeA2 = _mm_set1_ps( triangle.edgeA[2] );
+		const __m128 mmDepthA = _mm_set1_ps( triangle.depthA );
+		const __m128 mmZero = _mm_setzero_ps();
+		const __m128 mmFourA0 = _mm_set1_ps( triangle.edgeA[0] * 4.0f );
+		const __m128 mmFourA1 = _mm_set1_ps( triangle.edgeA[1] * 4.0f );
+		const __m128 mmFourA2 = _mm_set1_ps( triangle.edgeA[2] * 4.0f );
+		const __m128 mmFourDepthA = _mm_set1_ps( triangle.depthA * 4.0f );
+		const __m128 mmStartX = _mm_add_ps( _mm_set1_ps( static_cast<TFloat32>(x0) ),
+		                                    _mm_setr_ps( 0.5f, 1.5f, 2.5f, 3.5f ) );
+		for (TInt32 y = y0; y <= y1; ++y)
+		{
+			// Values at the first four pixel centres of the row, then stepped four pixels at a time
+			TFloat32 centreY = y + 0.5f;
+			__m128 e0 = _mm_add_ps( _mm_mul_ps( mmEdgeA0, mmStartX ),
+			                        _mm_set1_ps( triangle.edgeB[0] * centreY + triangle.edgeC[0] ) );
+			__m128 e1 = _mm_add_ps( _mm_mul_ps( mmEdgeA1, mmStartX ),
+			                        _mm_set1_ps( triangle.edgeB[1] * centreY + triangle.edgeC[1] ) );
+			__m128 e2 = _mm_add_ps( _mm_mul_ps( mmEdgeA2, mmStartX ),
+			                        _mm_set1_ps( triangle.edgeB[2] * centreY + triangle.edgeC[2] ) );
+			__m128 depth = _mm_add_ps( _mm_mul_ps( mmDepthA, mmStartX ),
+			                           _mm_set1_ps( triangle.depthB * centreY + triangle.depthC ) );
+			TFloat32* pDepth = &m_Depth[y * kiOcclusionWidth];
+			for (TInt32 x = x0; x <= x1; x += 4)
+			{
+				__m128 inside = _mm_and_ps( _mm_and_ps( _mm_cmpge_ps( e0, mmZero ), _mm_cmpge_ps( e1, mmZero ) ),
+				                            _mm_cmpge_ps( e2, mmZero ) );
+				__m128 oldDepth = _mm_load_ps( pDepth + x );
+				__m128 newDepth = _mm_min_ps( oldDepth, depth );
+				_mm_store_ps( pDepth + x, _mm_or_ps( _mm_and_ps( inside, newDepth ),
+				                                     _mm_andnot_ps( inside, oldDepth ) ) );
+				e0 = _mm_add_ps( e0, mmFourA0 );
+				e1 = _mm_add_ps( e1, mmFourA1 );
+				e2 = _mm_add_ps( e2, mmFourA2 );
+				depth = _mm_add_ps( depth, mmFourDepthA );
+			}
+		}
+#else
+		for (TInt32 y = y0; y <= y1; ++y)
+		{
+			TFloat32 centreY = y + 0.5f;
+			TFloat32* pDepth = &m_Depth[y * kiOcclusionWidth];
+			for (TInt32 x = x0; x <= x1; ++x)
+			{
+				TFloat32 centreX = x + 0.5f;
+				if (triangle.edgeA[0] * centreX + triangle.edgeB[0] * centreY + triangle.edgeC[0] >= 0.0f &&
+				    triangle.edgeA[1] * centreX + triangle.edgeB[1] * centreY + triangle.edgeC[1] >= 0.0f &&
+				    triangle.edgeA[2] * centreX + triangle.edgeB[2] * centreY + triangle.edgeC[2] >= 0.0f)
+				{
+					TFloat32 depth = triangle.depthA * centreX + triangle.depthB * centreY + triangle.depthC;
+					pDepth[x] = Min( pDepth[x], depth );
+				}
+			}
+		}
+#endif
+	}
+
+	// Find greatest depth in each block of the tile
+	for (TInt32 blockY = tileY; blockY < tileY + static_cast<TInt32>(kiOcclusionTileHeight);
+	     blockY += kiOcclusionBlockSize)
+	{
+		for (TInt32 blockX = tileX; blockX < tileX + static_cast<TInt32>(kiOcclusionTileWidth);
+		     blockX += kiOcclusionBlockSize)
+		{
+			TFloat32 maxDepth = 0.0f;
+			for (TInt32 y = blockY; y < blockY + static_cast<TInt32>(kiOcclusionBlockSize); ++y)
+			{
+				const TFloat32* pDepth = &m_Depth[y * kiOcclusionWidth + blockX];
+				for (TUInt32 x = 0; x < kiOcclusionBlockSize; ++x)
+				{
+					maxDepth = Max( maxDepth, pDepth[x] );
+				}
+			}
+			m_HiZ[(blockY / kiOcclusionBlockSize) * kiOcclusionBlocksX + blockX / kiOcclusionBlockSize] = maxDepth;
+		}
+	}
+}
+
+// Function run by each extra thread, rasterises tiles whenever Rasterise is called
+void COcclusionBuffer::WorkerThread()
+{
+	TUInt32 generation = 0;
+	unique_lock<mutex> lock( m_WorkMutex );
+	while (true)
+	{
+		while (!m_StopWorkers && m_WorkGeneration == generation)
+		{
+			m_StartWork.wait( lock );
+		}
+		if (m_StopWorkers)
+		{
+			return;
+		}
+		generation = m_WorkGeneration;
+
+		lock.unlock();
+		RasteriseTiles();
+		lock.lock();
+
+		if (--m_NumBusyWorkers == 0)
+		{
+			m_WorkDone.notify_one();
+		}
+	}
+}
+
+
+} // namespace gen
@@ -0,0 +1,196 @@
+/*******************************************
+	OcclusionBuffer.h
+
+	Software depth buffer for occlusion
+	culling, class declaration
+********************************************/
+
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+using namespace std;
+
+#include "Defines.h"
+#include "AlignedAlloc.h"
+#include "CVector3.h"
+#include "CVector4.h"
+#include "CMatrix4x4.h"
+
+namespace gen
+{
+
+// Size of the occlusion depth buffer in pixels
+const TUInt32 kiOcclusionWidth = 256;
+const TUInt32 kiOcclusionHeight = 128;
+
+// The buffer is rendered in tiles, each tile on any thread. Tile width must be a multiple of 4
+const TUInt32 kiOcclusionTileWidth = 64;
+const TUInt32 kiOcclusionTileHeight = 32;
+const TUInt32 kiOcclusionTilesX = kiOcclusionWidth / kiOcclusionTileWidth;
+const TUInt32 kiOcclusionTilesY = kiOcclusionHeight / kiOcclusionTileHeight;
+const TUInt32 kiOcclusionNumTiles = kiOcclusionTilesX * kiOcclusionTilesY;
+
+// Size of the blocks of pixels in the hierarchical Z buffer (must divide the tile size)
+const TUInt32 kiOcclusionBlockSize = 8;
+const TUInt32 kiOcclusionBlocksX = kiOcclusionWidth / kiOcclusionBlockSize;
+const TUInt32 kiOcclusionBlocksY = kiOcclusionHeight / kiOcclusionBlockSize;
+
+
+// A small depth buffer rendered on the CPU, used to find objects hidden behind large occluders
+// (walls, buildings etc.) before they are submitted for rendering. Usage each frame:
+//   - Begin with the camera's view/projection matrix
+//   - AddOccluder for each visible occluder (low-poly geometry is best)
+//   - Rasterise to render the occluders, which is split into tiles over several threads
+//   - IsAABBVisible for each object to test
+// Only depth is rendered (the nearest occluder at each pixel), then the furthest depth in each
+// block of pixels is stored in a second, coarser level (hierarchical Z). An object is hidden if
+// its nearest depth is behind the buffer everywhere it covers on screen, most objects are
+// accepted or rejected using the coarse level alone
+class COcclusionBuffer
+{
+/*-----------------------------------------------------------------------------------------
+	Constructors/Destructors
+-----------------------------------------------------------------------------------------*/
+public:
+	// Constructor creates an empty buffer. Pass number of threads used to rasterise, including
+	// the calling thread, or 0 to use one per processor core (at most one per tile). Extra
+	// threads are started on first use
+	COcclusionBuffer( TUInt32 numThreads = 0 );
+
+	// Destructor stops any threads
+	~COcclusionBuffer();
+
+private:
+	// Disallow use of copy constructor and assignment operator (private and not defined)
+	COcclusionBuffer( const COcclusionBuffer& );
+	COcclusionBuffer& operator=( const COcclusionBuffer& );
+
+
+/*-----------------------------------------------------------------------------------------
+	Public interface
+-----------------------------------------------------------------------------------------*/
+public:
+
+	/////////////////////////////////////
+	// Rendering
+
+	// Begin a new frame viewed with the given combined view/projection matrix, removing all
+	// occluders from the previous frame
+	void Begin( const CMatrix4x4& viewProj );
+
+	// Add occluder triangles to the frame. Pass three vertices per triangle, each triangle's node
+	// index and the world matrix of each node - the vertices are relative to the node given (as
+	// returned by CMesh::GetTriangle). Triangles are rendered from both sides
+	void AddOccluder
+	(
+		const CVector3*   pVertices,
+		const TUInt32*    pNodes,
+		TUInt32           numTriangles,
+		const CMatrix4x4* pMatrices
+	);
+
+	// Render all occluders added since Begin into the depth buffer and build the hierarchical Z
+	// buffer. Must be called before testing objects
+	void Rasterise();
+
+
+	/////////////////////////////////////
+	// Testing
+
+	// Test if a world space axis-aligned bounding box may be visible - returns false if it is
+	// hidden behind the occluders, true otherwise. Boxes crossing the near clip plane are always
+	// visible, boxes off-screen are not
+	bool IsAABBVisible( const CVector3& minBounds, const CVector3& maxBounds );
+
+	// Return the number of occluder triangles rendered (after clipping) since Begin
+	TUInt32 GetNumTriangles()
+	{
+		return static_cast<TUInt32>(m_Triangles.size());
+	}
+
+	// Return the depth buffer (post-projection z, 0 at near clip plane to 1 at far clip plane),
+	// kiOcclusionWidth x kiOcclusionHeight floats in rows from the top of the viewport
+	const TFloat32* GetDepth()
+	{
+		return &m_Depth[0];
+	}
+
+
+/*-----------------------------------------------------------------------------------------
+	Private interface
+-----------------------------------------------------------------------------------------*/
+private:
+
+	// A triangle ready for rasterising, after clipping and projection to pixel coordinates
+	struct STriangle
+	{
+		// Edge functions a*x + b*y + c for each edge, >= 0 on the inside of the triangle
+		TFloat32 edgeA[3];
+		TFloat32 edgeB[3];
+		TFloat32 edgeC[3];
+
+		// Depth as a function of pixel position: a*x + b*y + c
+		TFloat32 depthA, depthB, depthC;
+
+		// Range of pixels that may be covered (inclusive, within the buffer)
+		TInt32   minX, maxX, minY, maxY;
+	};
+
+	// Add a triangle given in clip space, clipping it to the near clip plane if necessary
+	void AddClipTriangle( const CVector4& v0, const CVector4& v1, const CVector4& v2 );
+
+	// Add a triangle that is not in front of the near clip plane, given in clip space
+	void AddTriangle( const CVector4& v0, const CVector4& v1, const CVector4& v2 );
+
+	// Rasterise tiles until all have been taken (by this thread or others)
+	void RasteriseTiles();
+
+	// Clear the given tile, render its triangles and build its part of the hierarchical Z buffer
+	void RasteriseTile( TUInt32 tile );
+
+	// Function run by each extra thread, rasterises tiles whenever Rasterise is called
+	void WorkerThread();
+
+
+	/////////////////////////////////////
+	// Frame data
+
+	// View/projection matrix for the frame
+	CMatrix4x4 m_ViewProj;
+
+	// Triangles added this frame, and the triangles overlapping each tile
+	vector<STriangle> m_Triangles;
+	vector<TUInt32>   m_TileTriangles[kiOcclusionNumTiles];
+
+	// Depth buffer and hierarchical Z buffer (greatest depth in each block)
+	vector< TFloat32, CAlignedAllocator<TFloat32> > m_Depth;
+	TFloat32 m_HiZ[kiOcclusionBlocksX * kiOcclusionBlocksY];
+
+
+	/////////////////////////////////////
+	// Threads
+
+	// Number of threads used to rasterise (including the thread calling Rasterise), and the
+	// extra threads once started
+	TUInt32        m_NumThreads;
+	vector<thread> m_Workers;
+
+	// Next tile to rasterise, taken by each thread in turn
+	atomic<TUInt32> m_NextTile;
+
+	// Workers wait for a change of generation to start rasterising, and the number of workers
+	// still busy is counted down to signal when they have finished
+	mutex              m_WorkMutex;
+	condition_variable m_StartWork;
+	condition_variable m_WorkDone;
+	TUInt32            m_WorkGeneration;
+	TUInt32            m_NumBusyWorkers;
+	bool               m_StopWorkers;
+};
+
+
+} // namespace gen
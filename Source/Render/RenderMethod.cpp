@@ -61,6 +61,11 @@ ID3D10EffectShaderResourceVariable* SceneTexturePolyVar = NULL;
 ID3D10EffectScalarVariable* ViewportWidthVar = NULL; // Dimensions of the viewport needed to help access the scene texture (see poly post-processing shaders)
 ID3D10EffectScalarVariable* ViewportHeightVar = NULL;
 
+// Compact vertex decoding
+ID3D10EffectVectorVariable* PositionScaleVar = NULL;
+ID3D10EffectVectorVariable* PositionOffsetVar = NULL;
+ID3D10EffectScalarVariable* OctahedralNormalsVar = NULL;
+
 // Other
 ID3D10EffectScalarVariable* ParallaxDepthVar = NULL;
 
@@ -255,6 +260,11 @@ bool InitialiseMethods()
 	ViewportWidthVar    = Effect->GetVariableByName( "ViewportWidth" )->AsScalar();
 	ViewportHeightVar   = Effect->GetVariableByName( "ViewportHeight" )->AsScalar();
 
+	// Compact vertex decoding variables
+	PositionScaleVar     = Effect->GetVariableByName( "PositionScale" )->AsVector();
+	PositionOffsetVar    = Effect->GetVariableByName( "PositionOffset" )->AsVector();
+	OctahedralNormalsVar = Effect->GetVariableByName( "OctahedralNormals" )->AsScalar();
+
 	// Access to other shader variables
 	ParallaxDepthVar = Effect->GetVariableByName( "ParallaxDepth" )->AsScalar();
 
@@ -316,6 +326,18 @@ void SetCamera( CCamera* camera )
 	CameraPosVar->SetRawValue( &camera->Position(), 0, 12 );
 }
 
+// Set how vertex shaders decode positions and normals for the next sub-mesh rendered. Positions are
+// multiplied by the scale then added to the offset, normals and tangents are octahedral encoded if
+// the flag is set. Use scale (1,1,1), offset (0,0,0) and false for standard float vertices
+void SetVertexDecoding( const CVector3& positionScale, const CVector3& positionOffset, bool octahedralNormals )
+{
+	CVector3 scale = positionScale; // Can't pass constant parameter to SetRawValue function
+	CVector3 offset = positionOffset;
+	PositionScaleVar->SetRawValue( &scale, 0, 12 );
+	PositionOffsetVar->SetRawValue( &offset, 0, 12 );
+	OctahedralNormalsVar->SetBool( octahedralNormals );
+}
+
 // Set the scene texture / viewport dimensions used for post-processing material shaders - called from post-processing code
 void SetSceneTexture( ID3D10ShaderResourceView* sceneShaderResource, int ViewportWidth, int ViewportHeight )
 {
@@ -125,6 +125,11 @@ void SetLights( CLight** lights );
 // Set the camera to use for all methods
 void SetCamera( CCamera* camera );
 
+// Set how vertex shaders decode positions and normals for the next sub-mesh rendered. Positions are
+// multiplied by the scale then added to the offset, normals and tangents are octahedral encoded if
+// the flag is set. Use scale (1,1,1), offset (0,0,0) and false for standard float vertices
+void SetVertexDecoding( const CVector3& positionScale, const CVector3& positionOffset, bool octahedralNormals );
+
 // Set the scene texture / viewport dimensions used for post-processing material shaders - called from post-processing code
 void SetSceneTexture( ID3D10ShaderResourceView* sceneShaderResource, int ViewportWidth, int ViewportHeight );
 
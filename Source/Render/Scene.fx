@@ -32,6 +32,13 @@ float4 DiffuseColour;
 float4 SpecularColour;
 float  SpecularPower;
 
+// Compact vertex decoding (see CMesh::CreateSubMeshDX). Compact vertices store positions quantised
+// to 0->1 within the sub-mesh bounds, which are rescaled by these values, and normals / tangents
+// as 2D octahedral coordinates. The defaults leave standard float vertices unchanged
+float3 PositionScale  = { 1.0f, 1.0f, 1.0f };
+float3 PositionOffset = { 0.0f, 0.0f, 0.0f };
+bool   OctahedralNormals = false;
+
 // Other
 float ParallaxDepth; // A factor to strengthen/weaken the parallax effect. Cannot exaggerate it too much or will get distortion
 
@@ -130,6 +137,30 @@ struct VS_NORMALMAP_OUTPUT
 // Vertex Shaders
 //--------------------------------------------------------------------------------------
 
+// Decode vertex position, rescaling compact (quantised) positions to model space
+//
+float3 DecodePosition( float3 pos )
+{
+	return pos * PositionScale + PositionOffset;
+}
+
+// Decode vertex normal or tangent. Compact vertices hold 2D octahedral coordinates in x & y
+// (see MathPacking.h), the lower half of the octahedron is folded out to the corners
+//
+float3 DecodeNormal( float3 normal )
+{
+	if (OctahedralNormals)
+	{
+		float3 n = float3( normal.xy, 1.0f - abs( normal.x ) - abs( normal.y ) );
+		if (n.z < 0.0f)
+		{
+			n.xy = (1.0f - abs( n.yx )) * (n.xy >= 0.0f ? 1.0f : -1.0f);
+		}
+		return normalize( n );
+	}
+	return normal;
+}
+
 // Basic vertex shader to transform 3D model vertices to 2D only
 //
 VS_BASIC_OUTPUT VSTransformOnly( VS_INPUT vIn )
@@ -137,7 +168,7 @@ VS_BASIC_OUTPUT VSTransformOnly( VS_INPUT vIn )
 	VS_BASIC_OUTPUT vOut;
 	
 	// Transform the input model vertex position into world space, then view space, then 2D projection space
-	float4 modelPos = float4(vIn.Pos, 1.0f); // Promote to 1x4 so we can multiply by 4x4 matrix, put 1.0 in 4th element for a point (0.0 for a vector)
+	float4 modelPos = float4(DecodePosition( vIn.Pos ), 1.0f); // Promote to 1x4 so we can multiply by 4x4 matrix, put 1.0 in 4th element for a point (0.0 for a vector)
 	float4 worldPos = mul( modelPos, WorldMatrix );
 	float4 viewPos  = mul( worldPos, ViewMatrix );
 	vOut.ProjPos    = mul( viewPos,  ProjMatrix );
@@ -153,7 +184,7 @@ VS_TEX_OUTPUT VSTransformTex( VS_INPUT vIn )
 	VS_TEX_OUTPUT vOut;
 	
 	// Transform the input model vertex position into world space, then view space, then 2D projection space
-	float4 modelPos = float4(vIn.Pos, 1.0f); // Promote to 1x4 so we can multiply by 4x4 matrix, put 1.0 in 4th element for a point (0.0 for a vector)
+	float4 modelPos = float4(DecodePosition( vIn.Pos ), 1.0f); // Promote to 1x4 so we can multiply by 4x4 matrix, put 1.0 in 4th element for a point (0.0 for a vector)
 	float4 worldPos = mul( modelPos, WorldMatrix );
 	float4 viewPos  = mul( worldPos, ViewMatrix );
 	vOut.ProjPos    = mul( viewPos,  ProjMatrix );
@@ -172,8 +203,8 @@ VS_LIGHTING_OUTPUT VSPixelLit( VS_INPUT vIn )
 	VS_LIGHTING_OUTPUT vOut;
 
 	// Add 4th element to position and normal (needed to multiply by 4x4 matrix. Recall lectures - set 1 for position, 0 for vector)
-	float4 modelPos = float4(vIn.Pos, 1.0f);
-	float4 modelNormal = float4(vIn.Normal, 0.0f);
+	float4 modelPos = float4(DecodePosition( vIn.Pos ), 1.0f);
+	float4 modelNormal = float4(DecodeNormal( vIn.Normal ), 0.0f);
 
 	// Transform model vertex position and normal to world space
 	float4 worldPos    = mul( modelPos,    WorldMatrix );
@@ -197,8 +228,8 @@ VS_LIGHTINGTEX_OUTPUT VSPixelLitTex( VS_INPUT vIn )
 	VS_LIGHTINGTEX_OUTPUT vOut;
 
 	// Add 4th element to position and normal (needed to multiply by 4x4 matrix. Recall lectures - set 1 for position, 0 for vector)
-	float4 modelPos = float4(vIn.Pos, 1.0f);
-	float4 modelNormal = float4(vIn.Normal, 0.0f);
+	float4 modelPos = float4(DecodePosition( vIn.Pos ), 1.0f);
+	float4 modelNormal = float4(DecodeNormal( vIn.Normal ), 0.0f);
 
 	// Transform model vertex position and normal to world space
 	float4 worldPos    = mul( modelPos,    WorldMatrix );
@@ -226,7 +257,7 @@ VS_NORMALMAP_OUTPUT VSNormalMap( VS_NORMALMAP_INPUT vIn )
 	VS_NORMALMAP_OUTPUT vOut;
 
 	//Transform the input model vertex position into world space
-	float4 modelPos = float4(vIn.Pos, 1.0f); // Promote to 1x4 so we can multiply by 4x4 matrix, put 1.0 in 4th element for a point (0.0 for a vector)
+	float4 modelPos = float4(DecodePosition( vIn.Pos ), 1.0f); // Promote to 1x4 so we can multiply by 4x4 matrix, put 1.0 in 4th element for a point (0.0 for a vector)
 	float4 worldPos = mul( modelPos, WorldMatrix );
 	vOut.WorldPos = worldPos.xyz;
 
@@ -235,8 +266,8 @@ VS_NORMALMAP_OUTPUT VSNormalMap( VS_NORMALMAP_INPUT vIn )
 	vOut.ProjPos   = mul( viewPos,  ProjMatrix );
 
 	// Just send the model's normal and tangent untransformed (in model space). The pixel shader will do the matrix work on normals
-	vOut.ModelNormal  = vIn.Normal;
-	vOut.ModelTangent = vIn.Tangent;
+	vOut.ModelNormal  = DecodeNormal( vIn.Normal );
+	vOut.ModelTangent = DecodeNormal( vIn.Tangent );
 
 	// Pass texture coordinates (UVs) on to the pixel shader, the vertex shader doesn't need them
 	vOut.UV = vIn.UV;
@@ -145,105 +145,182 @@ CVector3 CCamera::WorldPtFromPixel( CVector2 pixelPt, TUInt32 viewportWidth, TUI
 	return CVector3(worldPt);
 }
 
+// Calculate the approximate radius in pixels of a world space sphere when viewed from this camera,
+// pass the viewport height. Uses the depth of the sphere's centre, so is exact for spheres in the
+// centre of the view and a little small towards the edges. Returns the viewport height if the
+// camera is inside or very near the sphere
+TFloat32 CCamera::PixelRadius( const CVector3& centre, TFloat32 radius, TUInt32 viewportHeight )
+{
+	TFloat32 depth = m_MatView.TransformPoint( centre ).z;
+	if (depth <= radius)
+	{
+		return static_cast<TFloat32>(viewportHeight);
+	}
+
+	// The projection matrix y scale is 1 / tan(fovY / 2), which maps view space height at depth 1
+	// to the viewport height (-1 to 1)
+	return radius * m_MatProj.e11 * viewportHeight * 0.5f / depth;
+}
+
 
 //-----------------------------------------------------------------------------
 // Frustrum planes
 //-----------------------------------------------------------------------------
 
-// Calculate the 6 planes of the camera's viewing frustum. Store each plane as a point (on the
-// plane) and a vector (pointing away from the frustum)
+// Calculate the 6 planes of the camera's viewing frustum from the combined view/projection
+// matrix, so call after CalculateMatrices. Store each plane as a unit normal (pointing away from
+// the frustum) and a distance, so that points p on the plane have Dot(p, normal) == distance
 //   Four frustum planes:  _________
 //   Near, far, left and   \       /
 //   right. Top and bottom  \     /
 //   not shown               \   /
 //                            \_/
 //                             ^ Camera
-// See http://www.lighthouse3d.com/opengl/viewfrustum/index.php for an extensive discussion of
-// view frustum clipping
+// See "Fast Extraction of Viewing Frustum Planes from the World-View-Projection Matrix" (Gribb &
+// Hartmann) for the method used here
 void CCamera::CalculateFrustrumPlanes()
 {
-	// Position and local direction m_FrustumVecs for camera
-	CVector3 cameraRight = m_Matrix.XAxis();
-	CVector3 cameraUp = m_Matrix.YAxis();
-	CVector3 cameraForward = m_Matrix.ZAxis();
-	CVector3 cameraPos = m_Matrix.Position();
-
-	// Near clip plane
-	m_FrustumVecs[0] = -cameraForward; // m_FrustumPts back towards camera (-ve camera local Z)
-	m_FrustumVecs[0].Normalise();      // Probably don't need to normalise (scaled camera?), but safe
-	m_FrustumPts[0] = cameraPos - m_NearClip * m_FrustumVecs[0];  // Point is along camera z-axis on plane
-
-	// Far clip plane - similar process to above
-	m_FrustumVecs[1] = cameraForward;
-	m_FrustumVecs[1].Normalise();
-	m_FrustumPts[1] = cameraPos + m_FarClip * m_FrustumVecs[1];
-
-	// All the remaining planes have their point as the camera position. This is *behind* the
-	// near clip plane, but it doesn't matter when defining the plane (which extends to infinity)
-	m_FrustumPts[2] = m_FrustumPts[3] = m_FrustumPts[4] = m_FrustumPts[5] = cameraPos; 
-
-	// Get (half) width and height of viewport in camera space (the aperture)
-	TFloat32 apertureHalfHeight = Tan( m_FOV * 0.5f ) * m_NearClip;
-	TFloat32 apertureHalfWidth = apertureHalfHeight * m_Aspect;
-	
-	// Left plane vector
-	// Point on left of aperture - step left from centre of aperture calculated for near clip plane
-	CVector3 leftPoint = m_FrustumPts[0] - cameraRight * apertureHalfWidth; 
-	// Get vector from camera to left of aperture, cross product with camera up for vector
-	m_FrustumVecs[2] = Cross( leftPoint - cameraPos, cameraUp ); // Order important
-	m_FrustumVecs[2].Normalise();
-
-	// Right plane vector - similar
-	CVector3 rightPoint = m_FrustumPts[0] + cameraRight * apertureHalfWidth; 
-	m_FrustumVecs[3] = Cross( cameraUp, rightPoint - cameraPos ); // Order important
-	m_FrustumVecs[3].Normalise();
-
-	// Top plane vector - similar
-	CVector3 topPoint = m_FrustumPts[0] + cameraUp * apertureHalfHeight; 
-	m_FrustumVecs[4] = Cross( topPoint - cameraPos, cameraRight );
-	m_FrustumVecs[4].Normalise();
-
-	// Bottom plane vector - similar
-	CVector3 bottomPoint = m_FrustumPts[0] - cameraUp * apertureHalfHeight; 
-	m_FrustumVecs[5] = Cross( cameraRight, bottomPoint - cameraPos );
-	m_FrustumVecs[5].Normalise();
+	// A point p is transformed to clip space by (p,1) * m_MatViewProj, so each clip space
+	// coordinate is the dot product of (p,1) with one column of the matrix. The point is inside
+	// the frustum if 0 <= z <= w, -w <= x <= w and -w <= y <= w. Each of these six conditions
+	// has the form Dot(p, abc) + d >= 0, a plane equation made from the sum or difference of two
+	// columns. Order of planes is near, far, left, right, top, bottom
+	CVector4 colX = m_MatViewProj.GetColumn( 0 );
+	CVector4 colY = m_MatViewProj.GetColumn( 1 );
+	CVector4 colZ = m_MatViewProj.GetColumn( 2 );
+	CVector4 colW = m_MatViewProj.GetColumn( 3 );
+	CVector4 planes[6] = { colZ, colW - colZ, colW + colX, colW - colX, colW - colY, colW + colY };
+
+	for (int plane = 0; plane < 6; ++plane)
+	{
+		// Normalise plane and flip it so the normal points away from the frustum
+		CVector3 planeNormal( planes[plane] );
+		TFloat32 invLength = 1.0f / planeNormal.Length();
+		m_FrustumNormals[plane] = planeNormal * -invLength;
+		m_FrustumDists[plane] = planes[plane].w * invLength;
+
+		m_FrustumOctants[plane] = (m_FrustumNormals[plane].x < 0.0f ? 1 : 0) |
+		                          (m_FrustumNormals[plane].y < 0.0f ? 2 : 0) |
+		                          (m_FrustumNormals[plane].z < 0.0f ? 4 : 0);
+	}
 }
 
 
 // Test if a sphere is visible in the viewing frustum. Tests the sphere against each plane.
 // See http://www.lighthouse3d.com/opengl/viewfrustum/index.php for an extensive discussion
 // of view frustum clipping including the method used here
-bool CCamera::SphereInFrustum( const CVector3& Centre, TFloat32 Radius )
+// Optionally pass a plane index stored with the object being tested, which is tested first and
+// updated to any plane that rejects the object
+bool CCamera::SphereInFrustum( const CVector3& Centre, TFloat32 Radius, TUInt32* PlaneCache /*= 0*/ )
 {
-	// Check the sphere against each frustum plane
-	for (int plane = 0; plane < 6; ++plane)
+	// Check the sphere against each frustum plane, starting with any cached plane
+	TUInt32 firstPlane = PlaneCache ? *PlaneCache : 0;
+	for (TUInt32 i = 0; i < 6; ++i)
 	{
+		TUInt32 plane = (firstPlane + i) % 6;
+
 		// Test if sphere centre is further away than its radius - outside the frustum
-		if (Dot( Centre - m_FrustumPts[plane], m_FrustumVecs[plane] ) > Radius)
+		if (Dot( Centre, m_FrustumNormals[plane] ) - m_FrustumDists[plane] > Radius)
 		{
+			if (PlaneCache)
+			{
+				*PlaneCache = plane;
+			}
 			return false;
 		}
 	}
 	return true;
 }
 
+// Test a batch of spheres against the viewing frustum, using the same test as above. Sphere
+// centres are passed as a stream and radii as an array of the same size. Fills the given
+// array with true for each visible sphere, false otherwise
+void CCamera::SpheresInFrustum( const CVector3Stream& Centres, const TFloat32* Radii, bool* Visible )
+{
+	TUInt32 numSpheres = Centres.Size();
+	if (numSpheres == 0)
+	{
+		return;
+	}
+	if (m_PlaneDists.size() < numSpheres)
+	{
+		m_PlaneDists.resize( numSpheres );
+	}
+
+	for (TUInt32 sphere = 0; sphere < numSpheres; ++sphere)
+	{
+		Visible[sphere] = true;
+	}
+
+	// Check all spheres against each frustum plane in turn, using the batch dot product
+	for (int plane = 0; plane < 6; ++plane)
+	{
+		Dot( &m_PlaneDists[0], Centres, m_FrustumNormals[plane] );
+		for (TUInt32 sphere = 0; sphere < numSpheres; ++sphere)
+		{
+			if (m_PlaneDists[sphere] - m_FrustumDists[plane] > Radii[sphere])
+			{
+				Visible[sphere] = false;
+			}
+		}
+	}
+}
+
+// Cull a batch of spheres against the viewing frustum in a single pass, using the same test as
+// above. Sphere centres are passed as a stream and radii as an array of the same size. Writes
+// the indexes of the visible spheres to the given array (at least the size of the stream), in
+// increasing order, and returns the number of visible spheres
+TUInt32 CCamera::CullSpheres( const CVector3Stream& Centres, const TFloat32* Radii, TUInt32* VisibleIndices )
+{
+	return SpheresInsidePlanes( VisibleIndices, Centres, Radii, m_FrustumNormals, m_FrustumDists, 6 );
+}
+
+// Cull a batch of spheres against the viewing frustums of several cameras in a single pass,
+// writing a visibility bitset for each camera in turn
+void CCamera::CullSpheres( CCamera* const* Cameras, TUInt32 NumCameras, const CVector3Stream& Centres,
+                           const TFloat32* Radii, TUInt32* VisibleBits )
+{
+	// Gather the planes of all the frustums together
+	CVector3 normals[kiMaxCullCameras * 6];
+	TFloat32 dists[kiMaxCullCameras * 6];
+	GEN_ASSERT_OPT( NumCameras <= kiMaxCullCameras, "Too many cameras" );
+	for (TUInt32 camera = 0; camera < NumCameras; ++camera)
+	{
+		for (TUInt32 plane = 0; plane < 6; ++plane)
+		{
+			normals[camera * 6 + plane] = Cameras[camera]->m_FrustumNormals[plane];
+			dists[camera * 6 + plane] = Cameras[camera]->m_FrustumDists[plane];
+		}
+	}
+
+	SpheresInsideFrustums( VisibleBits, Centres, Radii, normals, dists, 6, NumCameras );
+}
+
 // Test if a bounding box is visible in the viewing frustum. Tests one point of the bounding
 // box against each plane. See http://www.lighthouse3d.com/opengl/viewfrustum/index.php for
 // an extensive discussion of view frustum clipping including the method used here
-bool CCamera::AABBInFrustum( const CVector3& AABBMin, const CVector3& AABBMax )
+// May pass a plane index to cache the rejecting plane as for SphereInFrustum
+bool CCamera::AABBInFrustum( const CVector3& AABBMin, const CVector3& AABBMax, TUInt32* PlaneCache /*= 0*/ )
 {
-	// Check the bounding box against each frustum plane
-	for (int plane = 0; plane < 6; ++plane)
+	// Check the bounding box against each frustum plane, starting with any cached plane
+	const CVector3* corners[2] = { &AABBMin, &AABBMax };
+	TUInt32 firstPlane = PlaneCache ? *PlaneCache : 0;
+	for (TUInt32 i = 0; i < 6; ++i)
 	{
-		// Get point of bounding box nearest the plane - use plane normal to find which point
-		CVector3 nearPoint;
-		nearPoint.x = (m_FrustumVecs[plane].x >= 0) ? AABBMin.x : AABBMax.x;
-		nearPoint.y = (m_FrustumVecs[plane].y >= 0) ? AABBMin.y : AABBMax.y;
-		nearPoint.z = (m_FrustumVecs[plane].z >= 0) ? AABBMin.z : AABBMax.z;
+		TUInt32 plane = (firstPlane + i) % 6;
+
+		// Get point of bounding box furthest inside the plane - the octant of the plane normal
+		// selects the minimum or maximum of each coordinate
+		TUInt32 octant = m_FrustumOctants[plane];
+		CVector3 nearPoint( corners[octant & 1]->x, corners[(octant >> 1) & 1]->y, corners[octant >> 2]->z );
 
 		// If point outside plane then box is outside the frustum - no need to test other planes
-		if (Dot( nearPoint - m_FrustumPts[plane], m_FrustumVecs[plane] ) > 0)
+		if (Dot( nearPoint, m_FrustumNormals[plane] ) > m_FrustumDists[plane])
 		{
+			if (PlaneCache)
+			{
+				*PlaneCache = plane;
+			}
 			return false;
 		}
 	}
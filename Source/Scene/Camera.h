@@ -6,14 +6,21 @@
 
 #pragma once
 
+#include <vector>
+using namespace std;
+
 #include "Defines.h"
 #include "CVector3.h"
+#include "CVector3Stream.h"
 #include "CMatrix4x4.h"
 #include "Input.h"
 
 namespace gen
 {
 
+// Greatest number of cameras culled together by CCamera::CullSpheres (six planes each)
+const TUInt32 kiMaxCullCameras = kiMaxMultiFrustumPlanes / 6;
+
 class CCamera
 {
 public:
@@ -115,12 +122,17 @@ public:
 	// pixel coordinates when viewing from this camera. Pass the viewport width and height
 	CVector3 WorldPtFromPixel( CVector2 pixelPt, TUInt32 ViewportWidth, TUInt32 ViewportHeight );
 
+	// Calculate the approximate radius in pixels of a world space sphere when viewed from this camera,
+	// pass the viewport height. Returns the viewport height if the camera is inside or very near the sphere
+	TFloat32 PixelRadius( const CVector3& centre, TFloat32 radius, TUInt32 ViewportHeight );
+
 
 	///////////////////////////
 	// Frustrum testing
 
-	// Calculate the 6 planes of the camera's viewing frustum. Store each plane as a point (on the
-	// plane) and a vector (pointing away from the frustum)
+	// Calculate the 6 planes of the camera's viewing frustum from the combined view/projection
+	// matrix, so call after CalculateMatrices. Store each plane as a unit normal (pointing away
+	// from the frustum) and a distance, so that points p on the plane have Dot(p, normal) == distance
 	// Order of planes is near, far, left, right, top, bottom
 	//   Four frustum planes:  _________
 	//   Near, far, left and   \       /
@@ -133,12 +145,47 @@ public:
 	// Test if a sphere is visible in the viewing frustum. Tests the sphere against each plane.
 	// See http://www.lighthouse3d.com/tutorials/view-frustum-culling/ for an extensive discussion
 	// of view frustum clipping including the method used here
-	bool SphereInFrustum( const CVector3& Centre, TFloat32 Radius );
+	// Optionally pass a plane index stored with the object being tested (initialised to 0). That
+	// plane is tested first and the index is updated to any plane that rejects the object. An
+	// object outside the frustum is usually rejected by the same plane as in the previous frame,
+	// so with a slowly moving camera most tests of unseen objects stop after one plane
+	bool SphereInFrustum( const CVector3& Centre, TFloat32 Radius, TUInt32* PlaneCache = 0 );
+
+	// Test a batch of spheres against the viewing frustum, using the same test as above. Sphere
+	// centres are passed as a stream and radii as an array of the same size. Fills the given
+	// array with true for each visible sphere, false otherwise
+	void SpheresInFrustum( const CVector3Stream& Centres, const TFloat32* Radii, bool* Visible );
+
+	// Cull a batch of spheres against the viewing frustum in a single pass, using the same test as
+	// above. Sphere centres are passed as a stream and radii as an array of the same size. Writes
+	// the indexes of the visible spheres to the given array (at least the size of the stream), in
+	// increasing order, and returns the number of visible spheres
+	TUInt32 CullSpheres( const CVector3Stream& Centres, const TFloat32* Radii, TUInt32* VisibleIndices );
+
+	// Cull a batch of spheres against the viewing frustums of several cameras in a single pass
+	// (e.g. main, shadow and reflection views), reading each sphere once. Pass up to
+	// kiMaxCullCameras cameras, whose frustum planes must be up to date. Writes a visibility bitset
+	// for each camera in turn, each NumBitsetWords( Centres.Size() ) words long - bit (i % 32) of
+	// word (i / 32) is set if sphere i is visible (see SpheresInsideFrustums)
+	static void CullSpheres( CCamera* const* Cameras, TUInt32 NumCameras, const CVector3Stream& Centres,
+	                         const TFloat32* Radii, TUInt32* VisibleBits );
 
 	// Test if a bounding box is visible in the viewing frustum. Tests one point of the bounding
 	// box against each plane. See http://www.lighthouse3d.com/tutorials/view-frustum-culling/ for
 	// an extensive discussion of view frustum clipping including the method used here
-	bool AABBInFrustum( const CVector3& AABBMin, const CVector3& AABBMax );
+	// May pass a plane index to cache the rejecting plane as for SphereInFrustum
+	bool AABBInFrustum( const CVector3& AABBMin, const CVector3& AABBMax, TUInt32* PlaneCache = 0 );
+
+	// Get the frustum planes calculated by CalculateFrustrumPlanes, as arrays of 6 unit normals
+	// and 6 distances, e.g. to query a spatial index. Order of planes is as above
+	const CVector3* GetFrustumNormals()
+	{
+		return m_FrustumNormals;
+	}
+	const TFloat32* GetFrustumDists()
+	{
+		return m_FrustumDists;
+	}
 
 
 private:
@@ -160,10 +207,18 @@ private:
 	CMatrix4x4 m_MatProj;
 	CMatrix4x4 m_MatViewProj; // Combined view/projection matrix
 
-	// The six planes of the camera viewing frustum, stored as six points and vectors
+	// The six planes of the camera viewing frustum, stored as unit normals (pointing away from the
+	// frustum) and distances from the origin along the normals
 	// Order of planes is near, far, left, right, top, bottom
-	CVector3 m_FrustumPts[6];
-	CVector3 m_FrustumVecs[6];
+	CVector3 m_FrustumNormals[6];
+	TFloat32 m_FrustumDists[6];
+
+	// Octant of each plane normal - bits 0, 1 and 2 are set for a negative x, y and z. Selects
+	// which corner of a bounding box is furthest inside the plane
+	TUInt32  m_FrustumOctants[6];
+
+	// Working space for batch frustum tests, kept to avoid reallocation each frame
+	vector<TFloat32> m_PlaneDists;
 };
 
 
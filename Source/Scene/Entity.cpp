@@ -9,18 +9,58 @@
 namespace gen
 {
 
+/*-----------------------------------------------------------------------------------------
+-------------------------------------------------------------------------------------------
+	Entity Template Base Class
+-------------------------------------------------------------------------------------------
+-----------------------------------------------------------------------------------------*/
+
+// Set whether entities of this template hide other entities for occlusion culling. The mesh
+// triangles are copied when first set
+void CEntityTemplate::SetOccluder( bool isOccluder )
+{
+	m_IsOccluder = isOccluder;
+	if (isOccluder && m_OccluderNodes.empty())
+	{
+		CVector3 vertices[3];
+		TUInt32 node;
+		m_Mesh->BeginEnumTriangles();
+		while (m_Mesh->GetTriangle( &vertices[0], &vertices[1], &vertices[2], &node ))
+		{
+			m_OccluderVertices.insert( m_OccluderVertices.end(), vertices, vertices + 3 );
+			m_OccluderNodes.push_back( node );
+		}
+	}
+}
+
+// Load a lower level of detail for the template's mesh. Returns false (after displaying an error)
+// on failure
+bool CEntityTemplate::AddLODMesh( const string& meshFilename )
+{
+	if (!m_Mesh->LoadLOD( meshFilename, m_CompactVertices ))
+	{
+		string errorMsg = "Error loading level of detail mesh " + meshFilename;
+		SystemMessageBox( errorMsg.c_str(), "Mesh Error" );
+		return false;
+	}
+	return true;
+}
+
+
 /*-----------------------------------------------------------------------------------------
 -------------------------------------------------------------------------------------------
 	Base Entity Class
 -------------------------------------------------------------------------------------------
 -----------------------------------------------------------------------------------------*/
 
-// Base entity constructor, needs pointer to common template data and UID, may also pass 
-// name, initial position, rotation and scaling. Set up positional matrices for the entity
+// Base entity constructor, needs pointer to common template data, UID and the transform store
+// to hold the entity's matrices, may also pass name, initial position, rotation and scaling.
+// Set up positional matrices for the entity
 CEntity::CEntity
 (
 	CEntityTemplate* entityTemplate,
 	TEntityUID       UID,
+	CTransformStore* transforms,
 	const string&    name /*=""*/,
 	const CVector3&  position /*= CVector3::kOrigin*/, 
 	const CVector3&  rotation /*= CVector3( 0.0f, 0.0f, 0.0f )*/,
@@ -29,43 +69,82 @@ CEntity::CEntity
 {
 	m_Template = entityTemplate;
 	m_UID = UID;
+	m_Transforms = transforms;
 	m_Name = name;
+	m_CullPlane = 0;
+	m_LOD = 0;
+	m_Moved = false;
 
-	// Allocate space for matrices
+	// Allocate space for matrices in the transform store
 	TUInt32 numNodes = m_Template->Mesh()->GetNumNodes();
-	m_RelMatrices = new CMatrix4x4[numNodes];
-	m_Matrices = new CMatrix4x4[numNodes];
+	m_Transforms->Allocate( EntityUIDSlot( m_UID ), numNodes );
 
 	// Set initial matrices from mesh defaults
+	CMatrix4x4* relMatrices = RelMatrices();
 	for (TUInt32 node = 0; node < numNodes; ++node)
 	{
-		m_RelMatrices[node] = m_Template->Mesh()->GetNode( node ).positionMatrix;
+		relMatrices[node] = m_Template->Mesh()->GetNode( node ).positionMatrix;
 	}
 
 	// Override root matrix with constructor parameters
-	m_RelMatrices[0] = CMatrix4x4( position, rotation, kZXY, scale );
+	relMatrices[0] = CMatrix4x4( position, rotation, kZXY, scale );
 }
 
 
 // Render the model from the given camera
 // May request to render either normal or post-processed materials in the entity (defaults to normal)
 void CEntity::Render( CCamera* camera, bool postProcess /*= false*/ )
+{
+	CalculateMatrices();
+
+	// Render with absolute matrices
+	m_Template->Mesh()->Render( Matrices(), camera, postProcess, &m_CullPlane, m_LOD );
+}
+
+// Calculate the absolute world matrices for each node from the relative matrices and the
+// node hierarchy
+void CEntity::CalculateMatrices()
 {
 	// Get pointer to mesh to simplify code
 	CMesh* Mesh = m_Template->Mesh();
 
 	// Calculate absolute matrices from relative node matrices & node heirarchy
-	m_Matrices[0] = m_RelMatrices[0];
-	TUInt32 numNodes = Mesh->GetNumNodes();
-	for (TUInt32 node = 1; node < numNodes; ++node)
-	{
-		m_Matrices[node] = m_RelMatrices[node] * m_Matrices[Mesh->GetNode( node ).parent];
-	}
+	MultiplyByParents( Matrices(), RelMatrices(), Mesh->GetNodeParents(), Mesh->GetNumNodes() );
 	// Incorporate any bone<->mesh offsets (only relevant for skinning)
 	// Don't need this step for this exercise
+}
 
-	// Render with absolute matrices
-	Mesh->Render( m_Matrices, camera, postProcess );
+// Get the world space bounding sphere of the entity. Uses the root matrix only, so is up to
+// date without calling CalculateMatrices (the root's absolute matrix is its relative matrix)
+void CEntity::GetBoundingSphere( CVector3* centre, TFloat32* radius )
+{
+	const CMatrix4x4& rootMatrix = RelMatrices()[0];
+	*centre = rootMatrix.Position();
+	*radius = m_Template->Mesh()->BoundingRadius( rootMatrix );
+}
+
+// Render the entity from the given camera, without calculating matrices or testing visibility
+// May request to render either normal or post-processed materials in the entity (defaults to normal)
+void CEntity::RenderVisible( CCamera* camera, bool postProcess /*= false*/ )
+{
+	m_Template->Mesh()->RenderVisible( Matrices(), camera, postProcess, m_LOD, &m_CullPlane );
+}
+
+
+// Find the nearest point where a world space ray hits the entity's mesh within the given distance.
+// Returns true if hit, filling pDistance with the distance to the hit
+bool CEntity::RayCast( const CVector3& origin, const CVector3& direction, TFloat32 maxDistance,
+                       TFloat32* pDistance )
+{
+	CalculateMatrices();
+	return m_Template->Mesh()->RayCast( Matrices(), origin, direction, maxDistance, pDistance );
+}
+
+// Return true if a world space ray hits the entity's mesh within the given distance
+bool CEntity::RayHits( const CVector3& origin, const CVector3& direction, TFloat32 maxDistance )
+{
+	CalculateMatrices();
+	return m_Template->Mesh()->RayHits( Matrices(), origin, direction, maxDistance );
 }
 
 
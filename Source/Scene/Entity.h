@@ -7,13 +7,16 @@
 #pragma once
 
 #include <string>
+#include <vector>
 using namespace std;
 
 #include "Defines.h"
+#include "AlignedAlloc.h"
 #include "CVector3.h"
 #include "CMatrix4x4.h"
 #include "Camera.h"
 #include "Mesh.h"
+#include "TransformStore.h"
 
 namespace gen
 {
@@ -21,10 +24,38 @@ namespace gen
 /////////////////////////////////////
 //	Public types
 
-// An entity UID is just a 32 bit value
+// An entity UID is a 32 bit handle into the entity manager's slot map. The low bits hold the
+// index of the entity's slot, the high bits hold the generation of the slot - increased each
+// time an entity in that slot is destroyed, so UIDs of destroyed entities can be detected
 typedef TUInt32 TEntityUID;
 const TEntityUID SystemUID = 0xffffffff;
 
+// Number of bits in a UID for the slot index and the generation
+const TUInt32 kiEntitySlotBits = 20;
+const TUInt32 kiEntityGenerationBits = 32 - kiEntitySlotBits;
+
+// Masks for slot index and generation (after shifting down). The last slot index is never used,
+// so no entity UID can equal SystemUID
+const TUInt32 kiEntitySlotMask = (1u << kiEntitySlotBits) - 1;
+const TUInt32 kiEntityGenerationMask = (1u << kiEntityGenerationBits) - 1;
+const TUInt32 kiMaxEntitySlots = kiEntitySlotMask;
+
+// Build an entity UID from slot index and generation
+inline TEntityUID MakeEntityUID( TUInt32 slot, TUInt32 generation )
+{
+	return (generation << kiEntitySlotBits) | slot;
+}
+
+// Return the slot index / generation held in an entity UID
+inline TUInt32 EntityUIDSlot( TEntityUID UID )
+{
+	return UID & kiEntitySlotMask;
+}
+inline TUInt32 EntityUIDGeneration( TEntityUID UID )
+{
+	return UID >> kiEntitySlotBits;
+}
+
 
 /*-----------------------------------------------------------------------------------------
 -------------------------------------------------------------------------------------------
@@ -41,15 +72,19 @@ class CEntityTemplate
 //	Constructors/Destructors
 public:
 	// Base entity template constructor needs template type (e.g. "Car"), name (e.g. "Fiat Panda")
-	// and the associated mesh (e.g. "panda.x")
-	CEntityTemplate( const string& type, const string& name, const string& meshFilename )
+	// and the associated mesh (e.g. "panda.x"). Optionally store the mesh vertices (and those of
+	// any lower levels of detail) in a compact format (see CMesh::Load)
+	CEntityTemplate( const string& type, const string& name, const string& meshFilename,
+	                 bool compactVertices = false )
 	{
 		m_Type = type;
 		m_Name = name;
+		m_IsOccluder = false;
+		m_CompactVertices = compactVertices;
 
 		// Load mesh
 		m_Mesh = new CMesh();
-		if (!m_Mesh->Load( meshFilename ))
+		if (!m_Mesh->Load( meshFilename, m_CompactVertices ))
 		{
 			string errorMsg = "Error loading mesh " + meshFilename;
 			SystemMessageBox( errorMsg.c_str(), "Mesh Error" );
@@ -92,6 +127,43 @@ public:
 	}
 
 
+	/////////////////////////////////////
+	//	Level of Detail
+
+	// Load a lower level of detail for the template's mesh (see CMesh::LoadLOD), levels are added
+	// in order of decreasing detail. Returns false (after displaying an error) on failure, the
+	// template is still usable with the levels already loaded
+	bool AddLODMesh( const string& meshFilename );
+
+
+	/////////////////////////////////////
+	//	Occlusion
+
+	// Set whether entities of this template hide other entities for occlusion culling (see
+	// COcclusionBuffer). Occluders should be large, and ideally have few triangles. The mesh
+	// triangles are copied when first set
+	void SetOccluder( bool isOccluder );
+
+	bool IsOccluder()
+	{
+		return m_IsOccluder;
+	}
+
+	// Occluder triangles, three vertices per triangle relative to the node given for the triangle
+	const CVector3* OccluderVertices()
+	{
+		return &m_OccluderVertices[0];
+	}
+	const TUInt32* OccluderNodes()
+	{
+		return &m_OccluderNodes[0];
+	}
+	TUInt32 NumOccluderTriangles()
+	{
+		return static_cast<TUInt32>(m_OccluderNodes.size());
+	}
+
+
 /////////////////////////////////////
 //	Private interface
 private:
@@ -102,6 +174,14 @@ private:
 
 	// The mesh representing this entity
 	CMesh* m_Mesh;
+
+	// Whether the mesh vertices are stored in compact format
+	bool             m_CompactVertices;
+
+	// Whether entities of this template are occluders, and the occluder triangles
+	bool             m_IsOccluder;
+	vector<CVector3> m_OccluderVertices;
+	vector<TUInt32>  m_OccluderNodes;
 };
 
 
@@ -113,19 +193,22 @@ private:
 -----------------------------------------------------------------------------------------*/
 
 // Base entity holds a pointer to its template data and the current position as a set of
-// matrices. The entity can be rendered but its update function does nothing - base class
+// matrices. The matrices are held in a transform store shared by all entities, found from the
+// entity's UID slot. The entity can be rendered but its update function does nothing - base class
 // entities are assumed to be static scene elements
 class CEntity
 {
 /////////////////////////////////////
 //	Constructors/Destructors
 public:
-	// Base entity constructor, needs pointer to common template data and UID, may also pass 
-	// name, initial position, rotation and scaling. Set up positional matrices for the entity
+	// Base entity constructor, needs pointer to common template data, UID and the transform store
+	// to hold the entity's matrices, may also pass name, initial position, rotation and scaling.
+	// Set up positional matrices for the entity
 	CEntity
 	(
 		CEntityTemplate* entityTemplate,
 		TEntityUID       UID,
+		CTransformStore* transforms,
 		const string&    name = "",
 		const CVector3&  position = CVector3::kOrigin, 
 		const CVector3&  rotation = CVector3( 0.0f, 0.0f, 0.0f ),
@@ -135,8 +218,7 @@ public:
 	// Destructor - base class destructors should always be virtual
 	virtual ~CEntity()
 	{
-		delete[] m_Matrices;
-		delete[] m_RelMatrices;
+		m_Transforms->Free( EntityUIDSlot( m_UID ) );
 	}
 
 private:
@@ -171,14 +253,35 @@ public:
 	/////////////////////////////////////
 	// Matrix access
 
-	// Direct access to position and matrix
+	// Direct access to position and matrix. These are views into the transform store, only valid
+	// until it is next compacted (see CEntityManager::CompactTransforms). Access marks the entity
+	// as moved (see HasMoved)
 	CVector3& Position( TUInt32 node = 0 )
 	{
-		return m_RelMatrices[node].Position();
+		m_Moved = true;
+		return RelMatrices()[node].Position();
 	}
 	CMatrix4x4& Matrix( TUInt32 node = 0 )
 	{
-		return m_RelMatrices[node];
+		m_Moved = true;
+		return RelMatrices()[node];
+	}
+
+	// Whether the entity's matrices may have changed since ClearMoved was last called. Used by the
+	// entity manager to update the spatial index only for entities that have moved
+	bool HasMoved()
+	{
+		return m_Moved;
+	}
+	void ClearMoved()
+	{
+		m_Moved = false;
+	}
+
+	// Absolute world matrices for each node, from the last call to CalculateMatrices
+	const CMatrix4x4* GetWorldMatrices()
+	{
+		return m_Transforms->WorldMatrices( EntityUIDSlot( m_UID ) );
 	}
 
 
@@ -194,6 +297,39 @@ public:
 	// May request to render either normal or post-processed materials in the entity (defaults to normal)
 	void Render( CCamera* camera, bool postProcess = false );
 
+	// Calculate the absolute world matrices for each node from the relative matrices and the
+	// node hierarchy. Called by Render, or call before RenderVisible
+	void CalculateMatrices();
+
+	// Get the world space bounding sphere of the entity. Uses the root matrix only, so is up to
+	// date without calling CalculateMatrices
+	void GetBoundingSphere( CVector3* centre, TFloat32* radius );
+
+	// Render the entity from the given camera as above, without calculating matrices or testing
+	// visibility. Use after CalculateMatrices for entities that have already been culled
+	void RenderVisible( CCamera* camera, bool postProcess = false );
+
+	// Find the nearest point where a world space ray hits the entity's mesh within the given
+	// distance (in lengths of the direction vector). Calculates the entity's matrices first. Returns
+	// true if hit, filling pDistance with the distance to the hit
+	bool RayCast( const CVector3& origin, const CVector3& direction, TFloat32 maxDistance,
+	              TFloat32* pDistance );
+
+	// Return true if a world space ray hits the entity's mesh within the given distance, for line
+	// of sight tests. Calculates the entity's matrices first
+	bool RayHits( const CVector3& origin, const CVector3& direction, TFloat32 maxDistance );
+
+	// Get / set the level of detail used to render the entity, 0 is full detail (see CMesh::Render).
+	// Set by CEntityManager::CullEntities from the entity's size on screen
+	TUInt32 GetLOD()
+	{
+		return m_LOD;
+	}
+	void SetLOD( TUInt32 lod )
+	{
+		m_LOD = lod;
+	}
+
 
 /////////////////////////////////////
 //	Private interface
@@ -206,9 +342,28 @@ private:
 	TEntityUID  m_UID;
 	string      m_Name;
 
-	// Relative and absolute world matrices for each node in the template's mesh
-	CMatrix4x4* m_RelMatrices; // Dynamically allocated arrays
-	CMatrix4x4* m_Matrices;
+	// Store holding the relative and absolute world matrices for each node in the template's mesh
+	CTransformStore* m_Transforms;
+
+	// Relative and absolute world matrices for each node (in the transform store)
+	CMatrix4x4* RelMatrices()
+	{
+		return m_Transforms->LocalMatrices( EntityUIDSlot( m_UID ) );
+	}
+	CMatrix4x4* Matrices()
+	{
+		return m_Transforms->WorldMatrices( EntityUIDSlot( m_UID ) );
+	}
+
+	// Frustum plane that last rejected the entity or one of its sub-meshes when rendering, tested
+	// first next time (see CCamera::SphereInFrustum)
+	TUInt32     m_CullPlane;
+
+	// Level of detail to render
+	TUInt32     m_LOD;
+
+	// Set when the matrices are accessed for writing, cleared by the entity manager
+	bool        m_Moved;
 };
 
 
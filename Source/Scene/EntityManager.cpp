@@ -13,17 +13,20 @@ namespace gen
 /////////////////////////////////////
 // Constructors/Destructors
 
-// Constructor reserves space for entities and UID hash map, also sets first UID
+// Constructor reserves space for entities and UID slots
 CEntityManager::CEntityManager()
 {
-	// Initialise list of entities and UID hash map
+	// Initialise list of entities and UID slot map
 	m_Entities.reserve( 1024 );
-	m_EntityUIDMap = new CHashTable<TEntityUID, TUInt32>( 2048, JOneAtATimeHash ); 
-
-	// Set first entity UID that will be used
-	m_NextUID = 0;
-
-	m_IsEnumerating = false;
+	m_EntitySlots.reserve( 2048 );
+
+	m_NumVisibilityWords = 0;
+	m_OcclusionCulling = true;
+	m_ViewportHeight = 0;
+	m_MinPixelRadius = 1.0f;
+	m_TemplateIndexing = false;
+	m_NumTransformsDisordered = 0;
+	m_NumVisibleEntities = 0;
 }
 
 // Destructor removes all entities
@@ -36,17 +39,18 @@ CEntityManager::~CEntityManager()
 /////////////////////////////////////
 // Template creation / destruction
 
-// Create a base entity template with the given type, name and mesh. Returns the new entity
-// template pointer
+// Create a base entity template with the given type, name and mesh, optionally storing mesh
+// vertices in compact format. Returns the new entity template pointer
 CEntityTemplate* CEntityManager::CreateTemplate
 (
 	const string& type,
 	const string& name,
-	const string& mesh
+	const string& mesh,
+	bool          compactVertices /*= false*/
 )
 {
 	// Create new entity template
-	CEntityTemplate* newTemplate = new CEntityTemplate( type, name, mesh );
+	CEntityTemplate* newTemplate = new CEntityTemplate( type, name, mesh, compactVertices );
 
 	// Add the template name / template pointer pair to the map
     m_Templates[name] = newTemplate;
@@ -104,20 +108,21 @@ TEntityUID CEntityManager::CreateEntity
 	// Get template associated with the template name
 	CEntityTemplate* entityTemplate = GetTemplate( templateName );
 
-	// Create new entity with next UID
-	CEntity* newEntity = new CEntity( entityTemplate, m_NextUID, name, position, rotation, scale );
-
-	// Get vector index for new entity and add it to vector
+	// Get vector index for new entity and a UID slot referring to it
 	TUInt32 entityIndex = static_cast<TUInt32>(m_Entities.size());
+	TEntityUID UID = AllocateEntitySlot( entityIndex );
+
+	// Create new entity with the UID, add it to vector and name indexes
+	CEntity* newEntity = new CEntity( entityTemplate, UID, &m_Transforms, name, position, rotation, scale );
 	m_Entities.push_back( newEntity );
+	AddToIndexes( newEntity );
 
-	// Add mapping from UID to entity index into hash map
-	m_EntityUIDMap->SetKeyValue( m_NextUID, entityIndex );
-	
-	m_IsEnumerating = false; // Cancel any entity enumeration (entity list has changed)
+	// Add entity bounds to spatial index
+	CVector3 minBounds, maxBounds;
+	GetEntityBounds( entityIndex, &minBounds, &maxBounds );
+	m_EntityProxies.push_back( m_EntityTree.Insert( minBounds, maxBounds, entityIndex ) );
 
-	// Return UID of new entity then increase it ready for next entity
-	return m_NextUID++;
+	return UID;
 }
 
 // Create a planet, requires a planet template name, may supply entity name and position
@@ -135,21 +140,22 @@ TEntityUID CEntityManager::CreatePlanet
 	// Get planet template associated with the template name
 	CEntityTemplate* planetTemplate = GetTemplate( templateName );
 
-	// Create new planet entity with next UID
-	CPlanetEntity* newEntity =
-		new CPlanetEntity( planetTemplate, m_NextUID, name, spinSpeed, position, rotation, scale );
+	// Get vector index for new entity and a UID slot referring to it
+	TUInt32 entityIndex = static_cast<TUInt32>(m_Entities.size());
+	TEntityUID UID = AllocateEntitySlot( entityIndex );
 
-	// Get vector index for new entity and add it to vector
-	TUInt32 entityIndex = static_cast<int>(m_Entities.size());
+	// Create new planet entity with the UID, add it to vector and name indexes
+	CPlanetEntity* newEntity =
+		new CPlanetEntity( planetTemplate, UID, &m_Transforms, name, spinSpeed, position, rotation, scale );
 	m_Entities.push_back( newEntity );
+	AddToIndexes( newEntity );
 
-	// Add mapping from UID to entity index into hash map
-	m_EntityUIDMap->SetKeyValue( m_NextUID, entityIndex );
-	
-	m_IsEnumerating = false; // Cancel any entity enumeration (entity list has changed)
+	// Add entity bounds to spatial index
+	CVector3 minBounds, maxBounds;
+	GetEntityBounds( entityIndex, &minBounds, &maxBounds );
+	m_EntityProxies.push_back( m_EntityTree.Insert( minBounds, maxBounds, entityIndex ) );
 
-	// Return UID of new entity then increase it ready for next entity
-	return m_NextUID++;
+	return UID;
 }
 
 // Destroy the given entity - returns true if the entity existed and was destroyed
@@ -157,26 +163,36 @@ bool CEntityManager::DestroyEntity( TEntityUID UID )
 {
 	// Find the vector index of the given UID
 	TUInt32 entityIndex;
-	if (!m_EntityUIDMap->LookUpKey( UID, &entityIndex ))
+	if (!FindEntityIndex( UID, &entityIndex ))
 	{
 		// Quit if not found
 		return false;
 	}
 
-	// Delete the given entity and remove from UID map
+	// Delete the given entity and remove from name indexes and spatial index
+	RemoveFromIndexes( m_Entities[entityIndex] );
 	delete m_Entities[entityIndex];
-	m_EntityUIDMap->RemoveKey( UID );
+	m_EntityTree.Remove( m_EntityProxies[entityIndex] );
+
+	// Free the entity's UID slot, increasing its generation so this UID no longer matches it
+	TUInt32 slot = EntityUIDSlot( UID );
+	m_EntitySlots[slot].entityIndex = kiNoEntity;
+	m_EntitySlots[slot].generation = (m_EntitySlots[slot].generation + 1) & kiEntityGenerationMask;
+	m_FreeEntitySlots.push_back( slot );
 
 	// If not removing last entity...
 	if (entityIndex != m_Entities.size() - 1)
 	{
-		// ...put the last entity into the empty entity slot and update UID map
+		// ...put the last entity into the empty entity slot and update its UID slot and spatial index
 		m_Entities[entityIndex] = m_Entities.back();
-		m_EntityUIDMap->SetKeyValue( m_Entities.back()->GetUID(), entityIndex );
+		m_EntitySlots[EntityUIDSlot( m_Entities.back()->GetUID() )].entityIndex = entityIndex;
+		m_EntityProxies[entityIndex] = m_EntityProxies.back();
+		m_EntityTree.SetUserData( m_EntityProxies[entityIndex], entityIndex );
 	}
 	m_Entities.pop_back(); // Remove last entity
-
-	m_IsEnumerating = false; // Cancel any entity enumeration (entity list has changed)
+	m_EntityProxies.pop_back();
+	++m_NumTransformsDisordered;
+	m_NumVisibleEntities = 0; // Visible entity indexes are no longer valid
 	return true;
 }
 
@@ -184,21 +200,273 @@ bool CEntityManager::DestroyEntity( TEntityUID UID )
 // Destroy all entities held by the manager
 void CEntityManager::DestroyAllEntities()
 {
-	m_EntityUIDMap->RemoveAllKeys();
+	// Free all UID slots in use, increasing their generations so old UIDs no longer match
+	for (TUInt32 slot = 0; slot < m_EntitySlots.size(); ++slot)
+	{
+		if (m_EntitySlots[slot].entityIndex != kiNoEntity)
+		{
+			m_EntitySlots[slot].entityIndex = kiNoEntity;
+			m_EntitySlots[slot].generation = (m_EntitySlots[slot].generation + 1) & kiEntityGenerationMask;
+			m_FreeEntitySlots.push_back( slot );
+		}
+	}
+	m_NameIndex.clear();
+	m_NameTrie.Clear();
+	m_TemplateNameIndex.clear();
+	m_TemplateTypeIndex.clear();
+	m_EntityTree.Clear();
+	m_EntityProxies.clear();
 	while (m_Entities.size())
 	{
 		delete m_Entities.back();
 		m_Entities.pop_back();
 	}
+	m_Transforms.Clear();
+	m_NumTransformsDisordered = 0;
+	m_NumVisibleEntities = 0;
+}
+
+// Repack the matrices of all entities in the transform store in the order of the entity list
+void CEntityManager::CompactTransforms()
+{
+	vector<TUInt32> slots( m_Entities.size() );
+	for (TUInt32 entity = 0; entity < m_Entities.size(); ++entity)
+	{
+		slots[entity] = EntityUIDSlot( m_Entities[entity]->GetUID() );
+	}
+	m_Transforms.Compact( slots.empty() ? 0 : &slots[0], static_cast<TUInt32>(slots.size()) );
+	m_NumTransformsDisordered = 0;
+}
 
-	m_IsEnumerating = false; // Cancel any entity enumeration (entity list has changed)
+
+// Get a slot for a new entity at the given index in m_Entities, returns the new entity's UID
+TEntityUID CEntityManager::AllocateEntitySlot( TUInt32 entityIndex )
+{
+	// Reuse the oldest free slot if there are enough free, otherwise add a new slot
+	TUInt32 slot;
+	if (m_FreeEntitySlots.size() >= kiMinFreeEntitySlots)
+	{
+		slot = m_FreeEntitySlots.front();
+		m_FreeEntitySlots.pop_front();
+	}
+	else
+	{
+		slot = static_cast<TUInt32>(m_EntitySlots.size());
+		GEN_ASSERT( slot < kiMaxEntitySlots, "Too many entities" );
+		SEntitySlot newSlot = { 0, 0 };
+		m_EntitySlots.push_back( newSlot );
+	}
+
+	m_EntitySlots[slot].entityIndex = entityIndex;
+	return MakeEntityUID( slot, m_EntitySlots[slot].generation );
+}
+
+
+/////////////////////////////////////
+// Template / Entity access
+
+// Return an entity with the given name & optionally the given template name & template type,
+// or 0 if there is none. Entities are found with the name index, several entities may share a
+// name (if so any one of those matching is returned)
+CEntity* CEntityManager::GetEntity
+(
+	const string& name,
+	const string& templateName /*= ""*/,
+	const string& templateType /*= ""*/
+)
+{
+	pair<TEntityIndexIter, TEntityIndexIter> entities = m_NameIndex.equal_range( name );
+	for (TEntityIndexIter entity = entities.first; entity != entities.second; ++entity)
+	{
+		if (EntityMatches( entity->second, "", templateName, templateType ))
+		{
+			return entity->second;
+		}
+	}
+	return 0;
+}
+
+
+// Enable or disable indexes of entities by template name and template type
+void CEntityManager::SetTemplateIndexing( bool enable )
+{
+	if (enable == m_TemplateIndexing)
+	{
+		return;
+	}
+	m_TemplateIndexing = enable;
+
+	m_TemplateNameIndex.clear();
+	m_TemplateTypeIndex.clear();
+	if (enable)
+	{
+		for (TUInt32 entity = 0; entity < m_Entities.size(); ++entity)
+		{
+			CEntityTemplate* entityTemplate = m_Entities[entity]->Template();
+			m_TemplateNameIndex.insert( TEntityIndex::value_type( entityTemplate->GetName(), m_Entities[entity] ) );
+			m_TemplateTypeIndex.insert( TEntityIndex::value_type( entityTemplate->GetType(), m_Entities[entity] ) );
+		}
+	}
+}
+
+// Add the given entity to the name indexes
+void CEntityManager::AddToIndexes( CEntity* entity )
+{
+	m_NameIndex.insert( TEntityIndex::value_type( entity->GetName(), entity ) );
+	m_NameTrie.Insert( entity->GetName(), entity );
+	if (m_TemplateIndexing)
+	{
+		m_TemplateNameIndex.insert( TEntityIndex::value_type( entity->Template()->GetName(), entity ) );
+		m_TemplateTypeIndex.insert( TEntityIndex::value_type( entity->Template()->GetType(), entity ) );
+	}
+}
+
+// Remove the entry for the given entity with the given key from a name index
+void CEntityManager::RemoveFromIndex
+(
+	TEntityIndex& index,
+	const string& key,
+	CEntity*      entity
+)
+{
+	pair<TEntityIndexIter, TEntityIndexIter> entries = index.equal_range( key );
+	for (TEntityIndexIter entry = entries.first; entry != entries.second; ++entry)
+	{
+		if (entry->second == entity)
+		{
+			index.erase( entry );
+			return;
+		}
+	}
+}
+
+// Add the entities with the given key in a name index to the given list
+void CEntityManager::FindInIndex
+(
+	TEntityIndex&     index,
+	const string&     key,
+	vector<CEntity*>& entities
+)
+{
+	pair<TEntityIndexIter, TEntityIndexIter> entries = index.equal_range( key );
+	for (TEntityIndexIter entry = entries.first; entry != entries.second; ++entry)
+	{
+		entities.push_back( entry->second );
+	}
+}
+
+// Remove the given entity from the name indexes
+void CEntityManager::RemoveFromIndexes( CEntity* entity )
+{
+	RemoveFromIndex( m_NameIndex, entity->GetName(), entity );
+	m_NameTrie.Remove( entity->GetName(), entity );
+	if (m_TemplateIndexing)
+	{
+		RemoveFromIndex( m_TemplateNameIndex, entity->Template()->GetName(), entity );
+		RemoveFromIndex( m_TemplateTypeIndex, entity->Template()->GetType(), entity );
+	}
+}
+
+
+// Find the entities matching the given name, template name and template type (may contain
+// wildcards, empty strings match anything), and prepare the given enumeration to step through them
+void CEntityManager::EnumEntities
+(
+	const string&       name,
+	const string&       templateName,
+	const string&       templateType,
+	CEntityEnumeration* enumeration
+)
+{
+	// Find entities that may match using the name trie if a name is given, otherwise the template
+	// name or template type index if possible: directly for a template name or type without
+	// wildcards, or for each matching template. Otherwise visit all entities
+	m_QueryEntities.clear();
+	bool allEntities = false;
+	if (name.length() > 0)
+	{
+		m_NameTrie.FindMatching( name, m_QueryEntities );
+	}
+	else if (m_TemplateIndexing && templateName.length() > 0 &&
+	         WildcardPrefix( templateName ).length() == templateName.length())
+	{
+		FindInIndex( m_TemplateNameIndex, templateName, m_QueryEntities );
+	}
+	else if (m_TemplateIndexing && templateName.length() == 0 && templateType.length() > 0 &&
+	         WildcardPrefix( templateType ).length() == templateType.length())
+	{
+		FindInIndex( m_TemplateTypeIndex, templateType, m_QueryEntities );
+	}
+	else if (m_TemplateIndexing && (templateName.length() > 0 || templateType.length() > 0))
+	{
+		for (TTemplateIter entityTemplate = m_Templates.begin(); entityTemplate != m_Templates.end(); ++entityTemplate)
+		{
+			if ((templateName.length() == 0 || WildcardMatch( entityTemplate->second->GetName(), templateName )) &&
+			    (templateType.length() == 0 || WildcardMatch( entityTemplate->second->GetType(), templateType )))
+			{
+				FindInIndex( m_TemplateNameIndex, entityTemplate->second->GetName(), m_QueryEntities );
+			}
+		}
+	}
+	else
+	{
+		allEntities = true;
+	}
+
+	// Keep the UIDs of the entities that match all parameters
+	enumeration->m_EntityManager = this;
+	enumeration->Clear();
+	TUInt32 numEntities = static_cast<TUInt32>(allEntities ? m_Entities.size() : m_QueryEntities.size());
+	for (TUInt32 entity = 0; entity < numEntities; ++entity)
+	{
+		CEntity* queryEntity = allEntities ? m_Entities[entity] : m_QueryEntities[entity];
+		if (EntityMatches( queryEntity, name, templateName, templateType ))
+		{
+			enumeration->m_EntityUIDs.push_back( queryEntity->GetUID() );
+		}
+	}
+}
+
+// Return true if the given entity matches the name, template name and template type (may contain
+// wildcards, empty strings match anything)
+bool CEntityManager::EntityMatches
+(
+	CEntity*      entity,
+	const string& name,
+	const string& templateName,
+	const string& templateType
+)
+{
+	return (name.length() == 0 || WildcardMatch( entity->GetName(), name )) &&
+	       (templateName.length() == 0 || WildcardMatch( entity->Template()->GetName(), templateName )) &&
+	       (templateType.length() == 0 || WildcardMatch( entity->Template()->GetType(), templateType ));
+}
+
+
+/////////////////////////////////////
+// Entity Enumeration
+
+// Return the next entity found by the query, or 0 if there are no more. Skips entities that
+// have been destroyed since the query
+CEntity* CEntityEnumeration::Next()
+{
+	while (m_NextEntity < m_EntityUIDs.size())
+	{
+		CEntity* entity = m_EntityManager->GetEntity( m_EntityUIDs[m_NextEntity++] );
+		if (entity)
+		{
+			return entity;
+		}
+	}
+	return 0;
 }
 
 
 /////////////////////////////////////
 // Update / Rendering
 
-// Call all entity update functions. Pass the time since last update
+// Call all entity update functions. Pass the time since last update. Also updates the bounds of
+// each entity in the spatial index
 void CEntityManager::UpdateAllEntities( float updateTime )
 {
 	TUInt32 entity = 0;
@@ -211,21 +479,353 @@ void CEntityManager::UpdateAllEntities( float updateTime )
 		}
 		else
 		{
+			// Update bounds in spatial index only if the entity has moved (static entities cost
+			// nothing here), cheap unless the entity has moved some distance
+			if (m_Entities[entity]->HasMoved())
+			{
+				CVector3 minBounds, maxBounds;
+				GetEntityBounds( entity, &minBounds, &maxBounds );
+				m_EntityTree.Move( m_EntityProxies[entity], minBounds, maxBounds );
+				m_Entities[entity]->ClearMoved();
+			}
 			++entity;
 		}
 	}
+
+	// Repack entity matrices once a quarter of the entities have been disordered by destruction
+	if (m_NumTransformsDisordered * 4 > m_Entities.size())
+	{
+		CompactTransforms();
+	}
 }
 
 // Render all entities from the given camera
 // May request to render either normal or post-processed materials in the entities (defaults to normal)
 void CEntityManager::RenderAllEntities( CCamera* camera, bool postProcess /*= false*/ )
 {
-	TEntityIter entity = m_Entities.begin();
-	while (entity != m_Entities.end())
+	CullEntities( camera );
+	RenderVisibleEntities( camera, postProcess );
+}
+
+// Render the entities found visible by the last call to CullEntities, from the same camera
+// May request to render either normal or post-processed materials in the entities (defaults to normal)
+void CEntityManager::RenderVisibleEntities( CCamera* camera, bool postProcess /*= false*/ )
+{
+	for (TUInt32 visible = 0; visible < m_NumVisibleEntities; ++visible)
+	{
+		m_Entities[m_VisibleEntities[visible]]->RenderVisible( camera, postProcess );
+	}
+}
+
+// Cull entities against the camera's frustum using the spatial index, then a batch test of the
+// bounding spheres of the entities found, then by size on screen and against occluders. Returns
+// the number of visible entities
+TUInt32 CEntityManager::CullEntities( CCamera* camera )
+{
+	// Find entities whose bounds are not outside the frustum. Parts of the tree entirely outside
+	// are skipped, and parts entirely inside are not tested further
+	m_QueryResults.clear();
+	m_EntityTree.QueryPlanes( camera->GetFrustumNormals(), camera->GetFrustumDists(), 6,
+	                          m_QueryResults );
+	TUInt32 numFound = static_cast<TUInt32>(m_QueryResults.size());
+	if (numFound == 0)
+	{
+		m_NumVisibleEntities = 0;
+		return 0;
+	}
+
+	// Gather world space bounding spheres of the entities found into contiguous arrays
+	m_CullCentres.Resize( numFound );
+	m_CullRadii.resize( numFound );
+	m_VisibleEntities.resize( numFound );
+	for (TUInt32 found = 0; found < numFound; ++found)
+	{
+		CVector3 centre;
+		m_Entities[m_QueryResults[found]]->GetBoundingSphere( &centre, &m_CullRadii[found] );
+		m_CullCentres.Set( found, centre );
+	}
+
+	// Test all spheres at once, leaving a compact list of visible spheres. Convert to entity indexes
+	TUInt32 numVisible = camera->CullSpheres( m_CullCentres, &m_CullRadii[0], &m_VisibleEntities[0] );
+	if (m_ViewportHeight == 0)
+	{
+		for (TUInt32 visible = 0; visible < numVisible; ++visible)
+		{
+			m_VisibleEntities[visible] = m_QueryResults[m_VisibleEntities[visible]];
+		}
+	}
+	else
+	{
+		// Also drop entities too small on screen to contribute, and select the level of detail of
+		// the others from their size on screen
+		TUInt32 numLarge = 0;
+		TUInt32 numLODRadii = static_cast<TUInt32>(m_LODPixelRadii.size());
+		for (TUInt32 visible = 0; visible < numVisible; ++visible)
+		{
+			TUInt32 found = m_VisibleEntities[visible];
+			TFloat32 pixelRadius = camera->PixelRadius( m_CullCentres.Get( found ), m_CullRadii[found],
+			                                            m_ViewportHeight );
+			if (pixelRadius < m_MinPixelRadius)
+			{
+				continue;
+			}
+
+			TUInt32 lod = 0;
+			while (lod < numLODRadii && pixelRadius < m_LODPixelRadii[lod])
+			{
+				++lod;
+			}
+			m_Entities[m_QueryResults[found]]->SetLOD( lod );
+			m_VisibleEntities[numLarge++] = m_QueryResults[found];
+		}
+		numVisible = numLarge;
+	}
+
+	if (m_OcclusionCulling)
+	{
+		numVisible = CullOccludedEntities( camera, numVisible );
+	}
+
+	// Prepare the visible entities for rendering
+	for (TUInt32 visible = 0; visible < numVisible; ++visible)
+	{
+		m_Entities[m_VisibleEntities[visible]]->CalculateMatrices();
+	}
+	m_NumVisibleEntities = numVisible;
+	return numVisible;
+}
+
+// Cull entities against the frustums of several cameras together in a single pass over the entity
+// bounding spheres, filling a visibility bitset for each view. Returns the number of entities
+// visible in at least one view
+TUInt32 CEntityManager::CullEntitiesMultiView( CCamera* const* cameras, TUInt32 numCameras )
+{
+	TUInt32 numEntities = static_cast<TUInt32>(m_Entities.size());
+	m_NumVisibilityWords = NumBitsetWords( numEntities );
+	m_ViewVisibility.resize( m_NumVisibilityWords * numCameras );
+	if (numEntities == 0)
+	{
+		return 0;
+	}
+
+	// Gather world space bounding spheres of all entities into contiguous arrays, then test them
+	// against all the frustums at once
+	m_CullCentres.Resize( numEntities );
+	m_CullRadii.resize( numEntities );
+	for (TUInt32 entity = 0; entity < numEntities; ++entity)
+	{
+		CVector3 centre;
+		m_Entities[entity]->GetBoundingSphere( &centre, &m_CullRadii[entity] );
+		m_CullCentres.Set( entity, centre );
+	}
+	CCamera::CullSpheres( cameras, numCameras, m_CullCentres, &m_CullRadii[0], &m_ViewVisibility[0] );
+
+	// Prepare the entities visible in any view for rendering
+	TUInt32 numVisible = 0;
+	for (TUInt32 word = 0; word < m_NumVisibilityWords; ++word)
+	{
+		TUInt32 visibleBits = 0;
+		for (TUInt32 view = 0; view < numCameras; ++view)
+		{
+			visibleBits |= m_ViewVisibility[view * m_NumVisibilityWords + word];
+		}
+		for (TUInt32 entity = word * 32; visibleBits != 0; ++entity, visibleBits >>= 1)
+		{
+			if (visibleBits & 1)
+			{
+				m_Entities[entity]->CalculateMatrices();
+				++numVisible;
+			}
+		}
+	}
+	return numVisible;
+}
+
+// Render the entities visible in the given view in the last call to CullEntitiesMultiView
+// May request to render either normal or post-processed materials in the entities (defaults to normal)
+void CEntityManager::RenderViewEntities( TUInt32 view, CCamera* camera, bool postProcess /*= false*/ )
+{
+	for (TUInt32 word = 0; word < m_NumVisibilityWords; ++word)
+	{
+		TUInt32 visibleBits = m_ViewVisibility[view * m_NumVisibilityWords + word];
+		for (TUInt32 entity = word * 32; visibleBits != 0; ++entity, visibleBits >>= 1)
+		{
+			if (visibleBits & 1)
+			{
+				m_Entities[entity]->RenderVisible( camera, postProcess );
+			}
+		}
+	}
+}
+
+// Remove entities hidden behind visible occluders from the first numVisible entries of
+// m_VisibleEntities, returning the number remaining
+TUInt32 CEntityManager::CullOccludedEntities( CCamera* camera, TUInt32 numVisible )
+{
+	// Render the occluders in view into the occlusion buffer. Occluders outside the view cannot
+	// hide anything in it
+	m_OcclusionBuffer.Begin( camera->GetViewProjMatrix() );
+	for (TUInt32 visible = 0; visible < numVisible; ++visible)
+	{
+		CEntity* entity = m_Entities[m_VisibleEntities[visible]];
+		CEntityTemplate* entityTemplate = entity->Template();
+		if (entityTemplate->IsOccluder() && entityTemplate->NumOccluderTriangles() > 0)
+		{
+			entity->CalculateMatrices();
+			m_OcclusionBuffer.AddOccluder( entityTemplate->OccluderVertices(),
+			                               entityTemplate->OccluderNodes(),
+			                               entityTemplate->NumOccluderTriangles(),
+			                               entity->GetWorldMatrices() );
+		}
+	}
+	m_OcclusionBuffer.Rasterise();
+
+	// Test the bounds of each entity against the buffer, keeping those that may be visible
+	TUInt32 numUnoccluded = 0;
+	for (TUInt32 visible = 0; visible < numVisible; ++visible)
+	{
+		CVector3 minBounds, maxBounds;
+		GetEntityBounds( m_VisibleEntities[visible], &minBounds, &maxBounds );
+		if (m_OcclusionBuffer.IsAABBVisible( minBounds, maxBounds ))
+		{
+			m_VisibleEntities[numUnoccluded++] = m_VisibleEntities[visible];
+		}
+	}
+	return numUnoccluded;
+}
+
+
+/////////////////////////////////////
+// Spatial Queries
+
+// Update the bounds of the given entity in the spatial index after it has been moved
+void CEntityManager::EntityMoved( TEntityUID UID )
+{
+	TUInt32 entityIndex;
+	if (FindEntityIndex( UID, &entityIndex ))
+	{
+		CVector3 minBounds, maxBounds;
+		GetEntityBounds( entityIndex, &minBounds, &maxBounds );
+		m_EntityTree.Move( m_EntityProxies[entityIndex], minBounds, maxBounds );
+		m_Entities[entityIndex]->ClearMoved();
+	}
+}
+
+// Find the entities whose bounds are within the given radius of a point
+void CEntityManager::GetEntitiesInRadius
+(
+	const CVector3&   centre,
+	TFloat32          radius,
+	vector<CEntity*>& entities
+)
+{
+	m_QueryResults.clear();
+	m_EntityTree.QueryRadius( centre, radius, m_QueryResults );
+	entities.resize( m_QueryResults.size() );
+	for (TUInt32 found = 0; found < m_QueryResults.size(); ++found)
+	{
+		entities[found] = m_Entities[m_QueryResults[found]];
+	}
+}
+
+// Find the nearest entity whose mesh is hit by a ray from the given point, within the given
+// distance along the ray. Returns 0 if no entity is hit, otherwise optionally fills pDistance
+// with the distance to the hit
+CEntity* CEntityManager::RayCast
+(
+	const CVector3& origin,
+	const CVector3& direction,
+	TFloat32        maxDistance,
+	TFloat32*       pDistance /*= 0*/
+)
+{
+	// Test the meshes of the entities whose bounds are on the ray, only looking for hits nearer
+	// than the nearest so far
+	m_QueryResults.clear();
+	m_EntityTree.QueryRay( origin, direction, maxDistance, m_QueryResults );
+	CEntity* nearestEntity = 0;
+	TFloat32 nearest = maxDistance;
+	for (TUInt32 found = 0; found < m_QueryResults.size(); ++found)
+	{
+		CEntity* entity = m_Entities[m_QueryResults[found]];
+		TFloat32 distance;
+		if (entity->RayCast( origin, direction, nearest, &distance ))
+		{
+			nearestEntity = entity;
+			nearest = distance;
+		}
+	}
+
+	if (nearestEntity && pDistance)
+	{
+		*pDistance = nearest;
+	}
+	return nearestEntity;
+}
+
+// Return true if no entity mesh blocks the straight line between two points. Optionally pass up
+// to two entities to ignore
+bool CEntityManager::LineOfSight
+(
+	const CVector3& from,
+	const CVector3& to,
+	const CEntity*  ignore1 /*= 0*/,
+	const CEntity*  ignore2 /*= 0*/
+)
+{
+	// Ray from one point to the other, so the line is distances 0 to 1 along it
+	CVector3 direction = to - from;
+	m_QueryResults.clear();
+	m_EntityTree.QueryRay( from, direction, 1.0f, m_QueryResults );
+	for (TUInt32 found = 0; found < m_QueryResults.size(); ++found)
 	{
-		(*entity)->Render( camera, postProcess );
-		++entity;
+		CEntity* entity = m_Entities[m_QueryResults[found]];
+		if (entity != ignore1 && entity != ignore2 && entity->RayHits( from, direction, 1.0f ))
+		{
+			return false;
+		}
 	}
+	return true;
+}
+
+// Find the entities whose bounds are hit by a ray from the given point, within the given distance
+// along the ray
+void CEntityManager::GetEntitiesOnRay
+(
+	const CVector3&   origin,
+	const CVector3&   direction,
+	TFloat32          maxDistance,
+	vector<CEntity*>& entities
+)
+{
+	m_QueryResults.clear();
+	m_EntityTree.QueryRay( origin, direction, maxDistance, m_QueryResults );
+	entities.resize( m_QueryResults.size() );
+	for (TUInt32 found = 0; found < m_QueryResults.size(); ++found)
+	{
+		entities[found] = m_Entities[m_QueryResults[found]];
+	}
+}
+
+
+/////////////////////////////////////
+// Spatial Index
+
+// Get the world space bounds of the entity at the given index for the spatial index - the box
+// around its bounding sphere
+void CEntityManager::GetEntityBounds
+(
+	TUInt32   entityIndex,
+	CVector3* minBounds,
+	CVector3* maxBounds
+)
+{
+	CVector3 centre;
+	TFloat32 radius;
+	m_Entities[entityIndex]->GetBoundingSphere( &centre, &radius );
+	CVector3 extent( radius, radius, radius );
+	*minBounds = centre - extent;
+	*maxBounds = centre + extent;
 }
 
 
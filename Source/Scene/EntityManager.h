@@ -8,19 +8,72 @@
 #pragma once
 
 #include <map>
+#include <deque>
+#include <unordered_map>
 using namespace std;
 
 #include "Defines.h"
-#include "CHashTable.h"
+#include "CRadixTrie.h"
+#include "CAABBTree.h"
 #include "Entity.h"
 #include "PlanetEntity.h"
 #include "Camera.h"
+#include "OcclusionBuffer.h"
 
 namespace gen
 {
 
+class CEntityManager;
+
+// An enumeration of the entities found by a query of the entity manager (see EnumEntities).
+// The entities found are held by UID, so any number of enumerations may be in progress at once,
+// and entities may be created and destroyed during an enumeration. Entities destroyed after the
+// query are skipped, entities created after the query are not included
+class CEntityEnumeration
+{
+public:
+	// Construct an empty enumeration
+	CEntityEnumeration()
+	{
+		m_EntityManager = 0;
+		m_NextEntity = 0;
+	}
+
+	// Return the next entity found by the query, or 0 if there are no more
+	CEntity* Next();
+
+	// Return the number of entities found by the query (including any destroyed since)
+	TUInt32 NumEntities()
+	{
+		return static_cast<TUInt32>(m_EntityUIDs.size());
+	}
+
+	// Restart the enumeration from the first entity found
+	void Restart()
+	{
+		m_NextEntity = 0;
+	}
+
+	// Remove the entities found, Next will return 0
+	void Clear()
+	{
+		m_EntityUIDs.clear();
+		m_NextEntity = 0;
+	}
+
+private:
+	friend class CEntityManager;
+
+	CEntityManager*    m_EntityManager;
+	vector<TEntityUID> m_EntityUIDs;
+	TUInt32            m_NextEntity;
+};
+
+
 // The entity manager is responsible for creation, update, rendering and deletion of
-// entities. It also manages UIDs for entities using a hash table
+// entities. It also manages UIDs for entities using a slot map, indexes entities by name for
+// quick look-up, and keeps a spatial index of entity bounds (a dynamic AABB tree) for culling
+// and spatial queries
 class CEntityManager
 {
 /////////////////////////////////////
@@ -46,13 +99,14 @@ public:
 	/////////////////////////////////////
 	// Template creation / destruction
 
-	// Create a base entity template with the given type, name and mesh. Returns the new entity
-	// template pointer
+	// Create a base entity template with the given type, name and mesh, optionally storing mesh
+	// vertices in compact format. Returns the new entity template pointer
 	CEntityTemplate* CEntityManager::CreateTemplate
 	(
 		const string& type,
 		const string& name,
-		const string& mesh
+		const string& mesh,
+		bool          compactVertices = false
 	);
 
 	// Note: Planets use the base template class, don't need a custom function
@@ -96,6 +150,12 @@ public:
 	// Destroy all entities held by the manager
 	void DestroyAllEntities();
 
+	// Repack the matrices of all entities in the transform store in the order of the entity list,
+	// so update and culling loops read them sequentially. Destroying entities leaves the store out
+	// of order, so this is called at the end of UpdateAllEntities once enough entities have been
+	// destroyed. Invalidates any references held to entity matrices
+	void CompactTransforms();
+
 
 	/////////////////////////////////////
 	// Template / Entity access
@@ -129,79 +189,66 @@ public:
 	// Return the entity with the given UID
 	CEntity* GetEntity( TEntityUID UID )
 	{
-		// Find the entity UID in the entity hash map
+		// Find the entity index from the UID's slot in the slot map
 		TUInt32 entityIndex;
-		if (!m_EntityUIDMap->LookUpKey( UID, &entityIndex ))
+		if (!FindEntityIndex( UID, &entityIndex ))
 		{
 			return 0;
 		}
 		return m_Entities[entityIndex];
 	}
 
-	// Return the entity with the given name & optionally the given template name & template type
+	// Return an entity with the given name & optionally the given template name & template type,
+	// or 0 if there is none. Entities are found with the name index, several entities may share a
+	// name (if so any one of those matching is returned). The template name and type may contain
+	// wildcards (see EnumEntities)
 	CEntity* GetEntity( const string& name, const string& templateName = "",
-	                    const string& templateType = "" )
+	                    const string& templateType = "" );
+
+	// Return the number of entities with the given name
+	TUInt32 NumEntitiesWithName( const string& name )
 	{
-		TEntityIter entity = m_Entities.begin();
-		while (entity != m_Entities.end())
-		{
-			if ((*entity)->GetName() == name && 
-				(templateName.length() == 0 || (*entity)->Template()->GetName() == templateName) &&
-				(templateType.length() == 0 || (*entity)->Template()->GetType() == templateType))
-			{
-				return (*entity);
-			}
-			++entity;
-		}
-		return 0;
+		return static_cast<TUInt32>(m_NameIndex.count( name ));
 	}
 
 
+	// Enable or disable indexes of entities by template name and template type (disabled by
+	// default). When enabled, queries that give a template name or type but no entity name
+	// only visit the entities of the matching templates. Costs a little time for each entity
+	// creation and destruction
+	void SetTemplateIndexing( bool enable );
+
+
+	// Find the entities matching the given name, template name and template type, and prepare the
+	// given enumeration to step through them. Each may contain the wildcards '*' (any characters)
+	// and '?' (any one character), e.g. "Ship*", and an empty string matches anything. Entities
+	// are found with a trie of names, so only the entities whose names begin with the part of the
+	// name before any wildcard are visited. If no name is given, only the entities of matching
+	// templates are visited if template indexing is enabled, otherwise all entities are visited
+	void EnumEntities( const string& name, const string& templateName, const string& templateType,
+	                   CEntityEnumeration* enumeration );
+
+
 	// Begin an enumeration of entities matching given name, template name and template type
-	// An empty string indicates to match anything in this field (would be nice to support
-	// wildcards, e.g. match name of "Ship*")
+	// (may contain wildcards, see EnumEntities). This is a single enumeration held by the manager,
+	// use EnumEntities for several enumerations at once
 	void BeginEnumEntities( const string& name, const string& templateName,
 	                        const string& templateType = "" )
 	{
-		m_IsEnumerating = true;
-		m_EnumEntity = m_Entities.begin();
-		m_EnumName = name;
-		m_EnumTemplateName = templateName;
-		m_EnumTemplateType = templateType;
+		EnumEntities( name, templateName, templateType, &m_Enumeration );
 	}
 
 	// Finish enumerating entities (see above)
 	void EndEnumEntities()
 	{
-		m_IsEnumerating = false;
+		m_Enumeration.Clear();
 	}
 
 	// Return next entity matching parameters passed to a previous call to BeginEnumEntities
 	// Returns 0 if BeginEnumEntities not called or no more matching entities
 	CEntity* EnumEntity()
 	{
-		if (!m_IsEnumerating)
-		{
-			return 0;
-		}
-
-		while (m_EnumEntity != m_Entities.end())
-		{
-			if ((m_EnumName.length() == 0 || (*m_EnumEntity)->GetName() == m_EnumName) && 
-				(m_EnumTemplateName.length() == 0 ||
-				 (*m_EnumEntity)->Template()->GetName() == m_EnumTemplateName) &&
-				(m_EnumTemplateType.length() == 0 ||
-				 (*m_EnumEntity)->Template()->GetType() == m_EnumTemplateType))
-			{
-				CEntity* foundEntity = *m_EnumEntity;
-				++m_EnumEntity;
-				return foundEntity;
-			}
-			++m_EnumEntity;
-		}
-		
-		m_IsEnumerating = false;
-		return 0;
+		return m_Enumeration.Next();
 	}
 
 
@@ -209,13 +256,138 @@ public:
 	// Update / Rendering
 
 	// Call all entity update functions - not the ideal method, OK for this example
-	// Pass the time since last update
+	// Pass the time since last update. Also updates the bounds in the spatial index of each entity
+	// that has moved (whose matrices have been accessed for writing, see CEntity::HasMoved)
 	void UpdateAllEntities( float updateTime );
 
 	// Render all entities from point of view of given camera - not the ideal method, OK for this example
 	// May request to render either normal or post-processed materials in the entities (defaults to normal)
+	// Entities are culled in one batch with CullEntities before any are rendered. When rendering
+	// several passes from the same camera, call CullEntities once then RenderVisibleEntities for
+	// each pass instead
 	void RenderAllEntities( CCamera* camera, bool postProcess = false );
 
+	// Render the entities found visible by the last call to CullEntities, which must be from the
+	// same camera. Destroying an entity empties the visible list until CullEntities is called again
+	// May request to render either normal or post-processed materials in the entities (defaults to normal)
+	void RenderVisibleEntities( CCamera* camera, bool postProcess = false );
+
+	// Cull entities against the camera's frustum. Entities that may be visible are found with a
+	// hierarchical query of the spatial index, so only the parts of the scene near the frustum are
+	// visited. Their bounding spheres are then culled in a single batch, entities too small on
+	// screen are removed and the level of detail of the others selected (if a viewport height has
+	// been set), then entities hidden behind occluders are removed (if occlusion culling is
+	// enabled), and the world matrices of the visible entities calculated. Returns the number of
+	// visible entities, their indexes (for GetEntityAtIndex) are then available from
+	// GetVisibleEntityIndex
+	TUInt32 CullEntities( CCamera* camera );
+
+	// Return the array index of a visible entity found by the last call to CullEntities
+	TUInt32 GetVisibleEntityIndex( TUInt32 visibleIndex )
+	{
+		return m_VisibleEntities[visibleIndex];
+	}
+
+
+	// Cull entities against the frustums of several cameras together (e.g. main, shadow and
+	// reflection views) in a single pass over the entity bounding spheres. Pass up to
+	// kiMaxCullCameras cameras with up to date frustum planes. Fills a visibility bitset for each
+	// view (in the order of the cameras) and calculates the world matrices of entities visible in
+	// any view. Unlike CullEntities, entities are not culled by screen size or occlusion. Returns
+	// the number of entities visible in at least one view
+	TUInt32 CullEntitiesMultiView( CCamera* const* cameras, TUInt32 numCameras );
+
+	// Return true if the entity at the given array index was visible in the given view in the last
+	// call to CullEntitiesMultiView
+	bool IsVisibleInView( TUInt32 view, TUInt32 entityIndex )
+	{
+		return ((m_ViewVisibility[view * m_NumVisibilityWords + entityIndex / 32] >> (entityIndex & 31)) & 1) != 0;
+	}
+
+	// Return the visibility bitset of the given view from the last call to CullEntitiesMultiView -
+	// bit (i % 32) of word (i / 32) is set if the entity at array index i is visible
+	const TUInt32* GetViewVisibility( TUInt32 view )
+	{
+		return &m_ViewVisibility[view * m_NumVisibilityWords];
+	}
+
+	// Render the entities visible in the given view in the last call to CullEntitiesMultiView, from
+	// the given camera (normally the camera of that view)
+	// May request to render either normal or post-processed materials in the entities (defaults to normal)
+	void RenderViewEntities( TUInt32 view, CCamera* camera, bool postProcess = false );
+
+
+	// Enable or disable occlusion culling in CullEntities (enabled by default). Entities whose
+	// template is an occluder (see CEntityTemplate::SetOccluder) are rendered into a small depth
+	// buffer on the CPU, then entities entirely behind that depth are culled
+	void SetOcclusionCulling( bool enable )
+	{
+		m_OcclusionCulling = enable;
+	}
+	bool GetOcclusionCulling()
+	{
+		return m_OcclusionCulling;
+	}
+
+
+	// Set the height in pixels of the viewport that entities are rendered to, used to find the size
+	// of entities on screen in CullEntities. Set 0 (the default) to disable culling by screen size
+	// and level of detail selection
+	void SetViewportHeight( TUInt32 viewportHeight )
+	{
+		m_ViewportHeight = viewportHeight;
+	}
+
+	// Set the radius in pixels of an entity's bounding sphere on screen below which it is culled
+	// (default 1 pixel)
+	void SetMinPixelRadius( TFloat32 pixelRadius )
+	{
+		m_MinPixelRadius = pixelRadius;
+	}
+
+	// Set the screen size bands used to select the level of detail of each visible entity. Pass the
+	// smallest radius in pixels of an entity's bounding sphere on screen for each level of detail in
+	// turn, in decreasing order. Entities smaller than the first radius use level 1, smaller than
+	// the second use level 2 etc. (see CEntity::GetLOD). Pass no radii to always use level 0
+	void SetLODPixelRadii( const TFloat32* pixelRadii, TUInt32 numRadii )
+	{
+		m_LODPixelRadii.assign( pixelRadii, pixelRadii + numRadii );
+	}
+
+
+	/////////////////////////////////////
+	// Spatial Queries
+	// Queries use the bounds in the spatial index, which are updated when entities are created and
+	// in UpdateAllEntities for entities that have moved. Call EntityMoved after moving an entity
+	// outside of its Update function if it must be found by queries before the next
+	// UpdateAllEntities
+
+	// Update the bounds of the given entity in the spatial index after it has been moved
+	void EntityMoved( TEntityUID UID );
+
+	// Find the entities whose bounds are within the given radius of a point. Fills the given vector
+	// with the entities found, in no particular order
+	void GetEntitiesInRadius( const CVector3& centre, TFloat32 radius, vector<CEntity*>& entities );
+
+	// Find the entities whose bounds are hit by a ray from the given point, within the given
+	// distance along the ray (in lengths of the direction vector). Fills the given vector with the
+	// entities found, in no particular order
+	void GetEntitiesOnRay( const CVector3& origin, const CVector3& direction, TFloat32 maxDistance,
+	                       vector<CEntity*>& entities );
+
+	// Find the nearest entity whose mesh is hit by a ray from the given point, within the given
+	// distance along the ray (in lengths of the direction vector), e.g. for picking with a ray from
+	// CCamera::WorldPtFromPixel. Entities on the ray are found with the spatial index, then their
+	// meshes are tested. Returns 0 if no entity is hit, otherwise optionally fills pDistance with the
+	// distance to the hit
+	CEntity* RayCast( const CVector3& origin, const CVector3& direction, TFloat32 maxDistance,
+	                  TFloat32* pDistance = 0 );
+
+	// Return true if no entity mesh blocks the straight line between two points. Optionally pass up
+	// to two entities to ignore, e.g. the viewer and the target
+	bool LineOfSight( const CVector3& from, const CVector3& to, const CEntity* ignore1 = 0,
+	                  const CEntity* ignore2 = 0 );
+
 		
 /////////////////////////////////////
 //	Private interface
@@ -248,21 +420,141 @@ private:
 	// fill its space
 	TEntities m_Entities;
 
-	// A mapping from UIDs to indexes into the above array
-	CHashTable<TEntityUID, TUInt32>* m_EntityUIDMap;
+	// Entity UIDs are handles into a slot map. Each slot holds the index of its entity in the
+	// above array (kiNoEntity if the slot is free) and a generation that is increased when the
+	// entity is destroyed. A UID holds slot index and generation, so look-up is a simple array
+	// access and the UID of a destroyed entity will no longer match its slot
+	struct SEntitySlot
+	{
+		TUInt32 entityIndex;
+		TUInt32 generation;
+	};
+	static const TUInt32 kiNoEntity = 0xffffffff;
+	vector<SEntitySlot> m_EntitySlots;
+
+	// Free slots are reused in the order they were freed, and only once there are enough of them.
+	// So a slot's generation increases slowly, making it unlikely that the generation wraps round
+	// while an old UID is still held
+	static const TUInt32 kiMinFreeEntitySlots = 1024;
+	deque<TUInt32> m_FreeEntitySlots;
+
+	// Relative and world matrices for all entities in contiguous arrays, indexed by UID slot
+	CTransformStore m_Transforms;
+
+	// Number of entities destroyed since the transform store was last compacted. Each leaves a gap
+	// in the store and moves an entity in the entity list
+	TUInt32 m_NumTransformsDisordered;
+
+	// Get a slot for a new entity at the given index in m_Entities, returns the new entity's UID
+	TEntityUID AllocateEntitySlot( TUInt32 entityIndex );
+
+	// Find the index in m_Entities of the entity with the given UID, returns false if there is no
+	// such entity. The entity has been destroyed if its slot is not in use or has been reused
+	// (generation doesn't match)
+	bool FindEntityIndex( TEntityUID UID, TUInt32* entityIndex )
+	{
+		TUInt32 slot = EntityUIDSlot( UID );
+		if (slot >= m_EntitySlots.size())
+		{
+			return false;
+		}
+		const SEntitySlot& entitySlot = m_EntitySlots[slot];
+		if (entitySlot.entityIndex == kiNoEntity || entitySlot.generation != EntityUIDGeneration( UID ))
+		{
+			return false;
+		}
+		*entityIndex = entitySlot.entityIndex;
+		return true;
+	}
+
+
+	/////////////////////////////////////
+	// Name Indexes
+
+	// Entities are indexed by name in a hash table allowing several entities with the same key.
+	// Entity pointers are held as they don't change when entities are moved in m_Entities
+	typedef unordered_multimap<string, CEntity*> TEntityIndex;
+	typedef TEntityIndex::iterator TEntityIndexIter;
+
+	// Add the given entity to the name indexes, or remove it from them
+	void AddToIndexes( CEntity* entity );
+	void RemoveFromIndexes( CEntity* entity );
 
-	// Entity IDs are provided using a single increasing integer
-	TEntityUID m_NextUID;
+	// Remove the entry for the given entity with the given key from a name index
+	static void RemoveFromIndex( TEntityIndex& index, const string& key, CEntity* entity );
+
+	// Add the entities with the given key in a name index to the given list
+	static void FindInIndex( TEntityIndex& index, const string& key, vector<CEntity*>& entities );
+
+	// Entity name index, trie of entity names for wildcard queries, and optional indexes of
+	// template name and template type (empty unless template indexing is enabled)
+	TEntityIndex         m_NameIndex;
+	CRadixTrie<CEntity*> m_NameTrie;
+	TEntityIndex         m_TemplateNameIndex;
+	TEntityIndex         m_TemplateTypeIndex;
+	bool                 m_TemplateIndexing;
+
+
+	/////////////////////////////////////
+	// Spatial Index
+
+	// Get the world space bounds of the entity at the given index for the spatial index - the box
+	// around its bounding sphere, which does not change as the entity rotates
+	void GetEntityBounds( TUInt32 entityIndex, CVector3* minBounds, CVector3* maxBounds );
+
+	// Tree of entity bounds, the user value of each object in the tree is the entity's index in
+	// m_Entities. The tree's proxy for each entity is held in the same order as m_Entities
+	CAABBTree       m_EntityTree;
+	vector<TUInt32> m_EntityProxies;
+
+	// Entity indexes found by a query of the tree, kept to avoid reallocation
+	vector<TUInt32> m_QueryResults;
+
+
+	/////////////////////////////////////
+	// Data for Culling
+
+	// World space bounding spheres of the entities found in the frustum by the spatial index (in
+	// the same order as m_QueryResults) and the indexes of the visible entities, filled by
+	// CullEntities. Kept to avoid reallocation each frame
+	CVector3Stream   m_CullCentres;
+	vector<TFloat32> m_CullRadii;
+	vector<TUInt32>  m_VisibleEntities;
+	TUInt32          m_NumVisibleEntities;
+
+	// Visibility bitsets of each view filled by CullEntitiesMultiView, one after another, and the
+	// number of words in each
+	vector<TUInt32>  m_ViewVisibility;
+	TUInt32          m_NumVisibilityWords;
+
+	// Depth buffer of occluders for occlusion culling
+	bool             m_OcclusionCulling;
+	COcclusionBuffer m_OcclusionBuffer;
+
+	// Viewport height and thresholds for culling by screen size and level of detail selection
+	TUInt32          m_ViewportHeight;
+	TFloat32         m_MinPixelRadius;
+	vector<TFloat32> m_LODPixelRadii;
+
+	// Remove entities hidden behind visible occluders from the first numVisible entries of
+	// m_VisibleEntities, returning the number remaining
+	TUInt32 CullOccludedEntities( CCamera* camera, TUInt32 numVisible );
 
 
 	/////////////////////////////////////
 	// Data for Entity Enumeration
 
-	bool        m_IsEnumerating;
-	TEntityIter m_EnumEntity;
-	string      m_EnumName;
-	string      m_EnumTemplateName;
-	string      m_EnumTemplateType;
+	// Return true if the given entity matches the name, template name and template type (may
+	// contain wildcards, empty strings match anything)
+	bool EntityMatches( CEntity* entity, const string& name, const string& templateName,
+	                    const string& templateType );
+
+	// Enumeration used by BeginEnumEntities / EnumEntity
+	CEntityEnumeration m_Enumeration;
+
+	// Entities found by a query before checking against all of its parameters, kept to avoid
+	// reallocation
+	vector<CEntity*>   m_QueryEntities;
 };
 
 
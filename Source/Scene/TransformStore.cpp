@@ -0,0 +1,186 @@
+/*******************************************
+	TransformStore.cpp
+
+	Contiguous storage of entity node
+	matrices (transform components)
+********************************************/
+
+#include <string.h>
+
+#include "TransformStore.h"
+
+namespace gen
+{
+
+/////////////////////////////////////
+// Constructors/Destructors
+
+// Constructor, pass number of matrices in each chunk (larger ranges get a chunk of their own)
+CTransformStore::CTransformStore( TUInt32 chunkSize /*= 4096*/ )
+{
+	m_ChunkSize = (chunkSize > 0) ? chunkSize : 1;
+	m_NumAllocated = 0;
+	m_NumUsed = 0;
+	m_Generation = 0;
+}
+
+// Destructor
+CTransformStore::~CTransformStore()
+{
+	FreeChunks( m_OldChunks );
+	FreeChunks( m_Chunks );
+}
+
+
+/////////////////////////////////////
+// Allocation
+
+// Allocate the given number of matrices for the given entity slot, which must not already have
+// matrices
+void CTransformStore::Allocate( TUInt32 slot, TUInt32 numMatrices )
+{
+	if (slot >= m_Ranges.size())
+	{
+		SRange emptyRange = { 0, 0, 0, 0 };
+		m_Ranges.resize( slot + 1, emptyRange );
+	}
+	SRange& range = m_Ranges[slot];
+	GEN_ASSERT( range.numMatrices == 0, "Entity slot already has matrices" );
+
+	// Reuse a freed range of the same size if there is one, otherwise add to the end of the last
+	// chunk, starting a new chunk if there is no room
+	TFreeRanges::iterator freeRanges = m_FreeRanges.find( numMatrices );
+	if (freeRanges != m_FreeRanges.end() && !freeRanges->second.empty())
+	{
+		range = freeRanges->second.back();
+		freeRanges->second.pop_back();
+	}
+	else
+	{
+		if (m_Chunks.empty() || m_Chunks.back().numAllocated + numMatrices > m_Chunks.back().size)
+		{
+			AddChunk( m_Chunks, (numMatrices > m_ChunkSize) ? numMatrices : m_ChunkSize );
+		}
+		SChunk& chunk = m_Chunks.back();
+		range.localMatrices = chunk.localMatrices + chunk.numAllocated;
+		range.worldMatrices = chunk.worldMatrices + chunk.numAllocated;
+		range.chunk = static_cast<TUInt32>(m_Chunks.size() - 1);
+		range.numMatrices = numMatrices;
+		chunk.numAllocated += numMatrices;
+		m_NumAllocated += numMatrices;
+	}
+	m_NumUsed += numMatrices;
+}
+
+// Free the matrices of the given entity slot for reuse, does nothing if it has none
+void CTransformStore::Free( TUInt32 slot )
+{
+	if (slot >= m_Ranges.size() || m_Ranges[slot].numMatrices == 0)
+	{
+		return;
+	}
+	SRange& range = m_Ranges[slot];
+	m_NumUsed -= range.numMatrices;
+
+	// If this is the last range in the last chunk then just shorten it, otherwise keep for reuse
+	SChunk& chunk = m_Chunks[range.chunk];
+	if (range.chunk == m_Chunks.size() - 1 &&
+	    range.localMatrices + range.numMatrices == chunk.localMatrices + chunk.numAllocated)
+	{
+		chunk.numAllocated -= range.numMatrices;
+		m_NumAllocated -= range.numMatrices;
+	}
+	else
+	{
+		m_FreeRanges[range.numMatrices].push_back( range );
+	}
+	range.numMatrices = 0;
+}
+
+// Free the matrices of all slots and release the memory
+void CTransformStore::Clear()
+{
+	FreeChunks( m_OldChunks );
+	FreeChunks( m_Chunks );
+	m_Ranges.clear();
+	m_FreeRanges.clear();
+	m_NumAllocated = 0;
+	m_NumUsed = 0;
+	++m_Generation;
+}
+
+// Repack the matrices of the given slots contiguously in the order given, removing any gaps
+// left by freed ranges. Slots not listed lose their matrices
+void CTransformStore::Compact( const TUInt32* slots, TUInt32 numSlots )
+{
+	// Copy each slot's matrices to the end of a single new chunk
+	vector<SChunk> chunks;
+	AddChunk( chunks, (m_NumUsed > m_ChunkSize) ? m_NumUsed : m_ChunkSize );
+	SChunk& chunk = chunks.back();
+	SRange emptyRange = { 0, 0, 0, 0 };
+	vector<SRange> ranges( m_Ranges.size(), emptyRange );
+	for (TUInt32 slot = 0; slot < numSlots; ++slot)
+	{
+		const SRange& oldRange = m_Ranges[slots[slot]];
+		SRange& range = ranges[slots[slot]];
+		range.localMatrices = chunk.localMatrices + chunk.numAllocated;
+		range.worldMatrices = chunk.worldMatrices + chunk.numAllocated;
+		range.chunk = 0;
+		range.numMatrices = oldRange.numMatrices;
+		for (TUInt32 matrix = 0; matrix < oldRange.numMatrices; ++matrix)
+		{
+			range.localMatrices[matrix] = oldRange.localMatrices[matrix];
+			range.worldMatrices[matrix] = oldRange.worldMatrices[matrix];
+		}
+		chunk.numAllocated += oldRange.numMatrices;
+	}
+
+	// Replace the old chunks. In debug builds keep them filled with NaNs (all bits set) until the
+	// next compaction, so any stale matrix reference gives obviously wrong results
+	FreeChunks( m_OldChunks );
+#ifdef _DEBUG
+	for (TUInt32 oldChunk = 0; oldChunk < m_Chunks.size(); ++oldChunk)
+	{
+		memset( static_cast<void*>(m_Chunks[oldChunk].localMatrices), 0xff, m_Chunks[oldChunk].size * sizeof(CMatrix4x4) );
+		memset( static_cast<void*>(m_Chunks[oldChunk].worldMatrices), 0xff, m_Chunks[oldChunk].size * sizeof(CMatrix4x4) );
+	}
+	m_OldChunks.swap( m_Chunks );
+#endif
+	FreeChunks( m_Chunks );
+	m_Chunks.swap( chunks );
+	m_Ranges.swap( ranges );
+	m_FreeRanges.clear();
+	m_NumAllocated = m_Chunks.back().numAllocated;
+	m_NumUsed = m_NumAllocated;
+	++m_Generation;
+}
+
+
+/////////////////////////////////////
+// Private functions
+
+// Add a new chunk of the given size at the end of the given list
+void CTransformStore::AddChunk( vector<SChunk>& chunks, TUInt32 size )
+{
+	SChunk chunk;
+	chunk.localMatrices = AlignedNew<CMatrix4x4>( size );
+	chunk.worldMatrices = AlignedNew<CMatrix4x4>( size );
+	GEN_ASSERT( chunk.localMatrices && chunk.worldMatrices, "Out of memory for entity matrices" );
+	chunk.size = size;
+	chunk.numAllocated = 0;
+	chunks.push_back( chunk );
+}
+
+// Free the memory of the given chunks and empty the list
+void CTransformStore::FreeChunks( vector<SChunk>& chunks )
+{
+	for (TUInt32 chunk = 0; chunk < chunks.size(); ++chunk)
+	{
+		AlignedDelete( chunks[chunk].worldMatrices );
+		AlignedDelete( chunks[chunk].localMatrices );
+	}
+	chunks.clear();
+}
+
+
+} // namespace gen
@@ -0,0 +1,160 @@
+/*******************************************
+	TransformStore.h
+
+	Contiguous storage of entity node
+	matrices (transform components)
+********************************************/
+
+#pragma once
+
+#include <map>
+#include <vector>
+using namespace std;
+
+#include "Defines.h"
+#include "Error.h"
+#include "AlignedAlloc.h"
+#include "CMatrix4x4.h"
+
+namespace gen
+{
+
+// The transform store holds the relative (local) and absolute (world) matrices of every node of
+// every entity in large contiguous aligned arrays (chunks), rather than each entity allocating its
+// own. The matrices of each entity are a single range in a chunk, found from the entity's slot
+// (see EntityUIDSlot). Entities created together are stored together, so loops over entities
+// stream through memory. Ranges of destroyed entities are reused by new entities with the same
+// number of nodes, and Compact repacks the matrices in a given order of slots.
+//
+// Chunks never move once allocated, so pointers and references to matrices remain valid as other
+// entities are created and destroyed, until the next compaction. Each compaction increases the
+// store generation. In debug builds the matrices left behind by a compaction are filled with
+// NaNs and kept until the following compaction, so use of a stale reference is seen at once
+class CTransformStore
+{
+/////////////////////////////////////
+//	Constructors/Destructors
+public:
+
+	// Constructor, pass number of matrices in each chunk (larger ranges get a chunk of their own)
+	CTransformStore( TUInt32 chunkSize = 4096 );
+
+	// Destructor
+	~CTransformStore();
+
+private:
+	// Prevent use of copy constructor and assignment operator (private and not defined)
+	CTransformStore( const CTransformStore& );
+	CTransformStore& operator=( const CTransformStore& );
+
+
+/////////////////////////////////////
+//	Public interface
+public:
+
+	/////////////////////////////////////
+	// Allocation
+
+	// Allocate the given number of matrices for the given entity slot, which must not already have
+	// matrices. The matrices are uninitialised (or left from a previous entity)
+	void Allocate( TUInt32 slot, TUInt32 numMatrices );
+
+	// Free the matrices of the given entity slot for reuse, does nothing if it has none
+	void Free( TUInt32 slot );
+
+	// Free the matrices of all slots and release the memory
+	void Clear();
+
+	// Repack the matrices of the given slots contiguously in the order given, removing any gaps
+	// left by freed ranges. Slots not listed lose their matrices. Invalidates all pointers and
+	// references to matrices
+	void Compact( const TUInt32* slots, TUInt32 numSlots );
+
+
+	/////////////////////////////////////
+	// Access
+
+	// Relative and absolute matrices of the entity in the given slot
+	CMatrix4x4* LocalMatrices( TUInt32 slot )
+	{
+		GEN_ASSERT_OPT( slot < m_Ranges.size() && m_Ranges[slot].numMatrices > 0, "Entity slot has no matrices" );
+		return m_Ranges[slot].localMatrices;
+	}
+	CMatrix4x4* WorldMatrices( TUInt32 slot )
+	{
+		GEN_ASSERT_OPT( slot < m_Ranges.size() && m_Ranges[slot].numMatrices > 0, "Entity slot has no matrices" );
+		return m_Ranges[slot].worldMatrices;
+	}
+
+	// Number of matrices held by the given slot
+	TUInt32 NumMatrices( TUInt32 slot )
+	{
+		return (slot < m_Ranges.size()) ? m_Ranges[slot].numMatrices : 0;
+	}
+
+	// Number of matrices in use / in use or free within the chunks
+	TUInt32 NumUsed()
+	{
+		return m_NumUsed;
+	}
+	TUInt32 NumAllocated()
+	{
+		return m_NumAllocated;
+	}
+
+	// Generation of the store, increased by each compaction (when all matrices move)
+	TUInt32 GetGeneration()
+	{
+		return m_Generation;
+	}
+
+
+/////////////////////////////////////
+//	Private interface
+private:
+
+	// A chunk of matrices, ranges are allocated from the start in order
+	struct SChunk
+	{
+		CMatrix4x4* localMatrices;
+		CMatrix4x4* worldMatrices;
+		TUInt32     size;
+		TUInt32     numAllocated;
+	};
+
+	// Range of matrices used by an entity slot
+	struct SRange
+	{
+		CMatrix4x4* localMatrices;
+		CMatrix4x4* worldMatrices;
+		TUInt32     chunk;
+		TUInt32     numMatrices; // 0 if slot has no matrices
+	};
+
+	// Add a new chunk of the given size at the end of the given list
+	static void AddChunk( vector<SChunk>& chunks, TUInt32 size );
+
+	// Free the memory of the given chunks and empty the list
+	static void FreeChunks( vector<SChunk>& chunks );
+
+	// Chunks of matrices, the number of matrices in each chunk and statistics. m_NumAllocated
+	// counts the matrices allocated from the chunks, m_NumUsed excludes freed ranges
+	vector<SChunk> m_Chunks;
+	TUInt32        m_ChunkSize;
+	TUInt32        m_NumAllocated;
+	TUInt32        m_NumUsed;
+	TUInt32        m_Generation;
+
+	// Chunks replaced by the last compaction, kept (filled with NaNs) in debug builds only
+	vector<SChunk> m_OldChunks;
+
+	// Range held by each entity slot
+	vector<SRange> m_Ranges;
+
+	// Freed ranges, keyed by number of matrices
+	typedef map< TUInt32, vector<SRange> > TFreeRanges;
+	TFreeRanges m_FreeRanges;
+};
+
+
+} // namespace gen